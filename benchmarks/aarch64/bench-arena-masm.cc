@@ -0,0 +1,94 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "arena-vixl.h"
+#include "bench-utils.h"
+#include "globals-vixl.h"
+
+#include "aarch64/instructions-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+#define __ masm->
+
+// Generate a small function with a few labels, each linked from several
+// branches, and a few literals. This is representative of the code a JIT
+// generates for a small method, and of the bookkeeping the MacroAssembler
+// needs for it.
+static void GenerateSmallFunction(MacroAssembler* masm, uint64_t seed) {
+  const int kBranchesPerLabel = 8;
+  Label slow_path, exit;
+  for (int i = 0; i < kBranchesPerLabel; i++) {
+    __ Cbz(XRegister(i), &slow_path);
+    __ Tbnz(XRegister(i), i, &exit);
+    __ Ldr(XRegister(i), seed * (i + 1));
+  }
+  __ Add(x0, x0, x1);
+  __ B(&exit);
+  __ Bind(&slow_path);
+  __ Mov(x0, 0);
+  __ Bind(&exit);
+  __ Ret();
+  masm->FinalizeCode();
+}
+
+// Compile small functions one after the other, as a JIT would, and print the
+// number of functions compiled per second. If `arena` is not NULL, it is reset
+// after each function.
+static void CompileFunctions(BenchCLI* cli, Arena* arena) {
+  MacroAssembler masm(4 * KBytes, PositionIndependentCode, arena);
+
+  BenchTimer timer;
+
+  size_t iterations = 0;
+  do {
+    masm.Reset();
+    if (arena != NULL) arena->Reset();
+    GenerateSmallFunction(&masm, 0x0123456789abcdef + iterations);
+    iterations++;
+  } while (!timer.HasRunFor(cli->GetRunTimeInSeconds()));
+
+  printf("%s arena: ", (arena == NULL) ? "Without" : "With");
+  cli->PrintResults(iterations, timer.GetElapsedSeconds());
+}
+
+// This program measures the cost of the MacroAssembler's bookkeeping (label
+// links, veneer records and literals) when compiling many small functions,
+// with the global allocator and with an `Arena`. Each iteration is one
+// function.
+int main(int argc, char* argv[]) {
+  BenchCLI cli(argc, argv);
+  if (cli.ShouldExitEarly()) return cli.GetExitCode();
+
+  CompileFunctions(&cli, NULL);
+  Arena arena;
+  CompileFunctions(&cli, &arena);
+
+  return cli.GetExitCode();
+}
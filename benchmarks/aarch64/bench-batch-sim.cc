@@ -0,0 +1,98 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <tuple>
+#include <vector>
+
+#include "bench-utils.h"
+#include "globals-vixl.h"
+
+#include "aarch64/instructions-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/simulator-batch-aarch64.h"
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+#define __ masm.
+
+// This program measures the throughput of `BatchSimulator`, running a small
+// function over many argument tuples using one simulator per hardware thread.
+// Each iteration is one simulated call.
+int main(int argc, char* argv[]) {
+  BenchCLI cli(argc, argv);
+  if (cli.ShouldExitEarly()) return cli.GetExitCode();
+
+  const size_t kBatchSize = 4096;
+
+  // uint64_t f(uint64_t x, uint64_t n): apply n rounds of a simple mixing
+  // function to x.
+  MacroAssembler masm;
+  Label loop, done;
+  __ Cbz(x1, &done);
+  __ Bind(&loop);
+  __ Eor(x0, x0, Operand(x0, LSR, 29));
+  __ Mov(x2, 0xbf58476d1ce4e5b9);
+  __ Mul(x0, x0, x2);
+  __ Sub(x1, x1, 1);
+  __ Cbnz(x1, &loop);
+  __ Bind(&done);
+  __ Ret();
+  masm.FinalizeCode();
+
+  std::vector<std::tuple<uint64_t, uint64_t>> arguments;
+  for (size_t i = 0; i < kBatchSize; i++) {
+    arguments.emplace_back(i, i % 16);
+  }
+  std::vector<uint64_t> results(kBatchSize);
+
+  BatchSimulator batch;
+
+  BenchTimer timer;
+
+  size_t iterations = 0;
+  do {
+    batch.Run(*masm.GetBuffer(),
+              0,
+              arguments.data(),
+              results.data(),
+              arguments.size());
+    iterations += kBatchSize;
+  } while (!timer.HasRunFor(cli.GetRunTimeInSeconds()));
+
+  cli.PrintResults(iterations, timer.GetElapsedSeconds());
+  return cli.GetExitCode();
+}
+
+#else   // VIXL_INCLUDE_SIMULATOR_AARCH64
+int main(void) {
+  printf("This benchmark requires AArch64 simulator support.\n");
+  return EXIT_FAILURE;
+}
+#endif  // VIXL_INCLUDE_SIMULATOR_AARCH64
@@ -0,0 +1,99 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "bench-utils.h"
+#include "globals-vixl.h"
+
+#include "aarch64/instructions-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+#define __ masm.
+
+// This program measures the simulation speed of flag-heavy compare-and-branch
+// loops: most of the flags set by the comparisons and flag-setting arithmetic
+// are overwritten without being read, and the rest are only read by
+// conditional branches and selects. Each iteration is one call of the
+// generated function, which runs the loop body kLoopCount times.
+int main(int argc, char* argv[]) {
+  BenchCLI cli(argc, argv);
+  if (cli.ShouldExitEarly()) return cli.GetExitCode();
+
+  const int kLoopCount = 10000;
+
+  MacroAssembler masm;
+  Label start, loop, skip;
+  __ Bind(&start);
+  __ Mov(x0, kLoopCount);
+  __ Mov(x1, 0);
+  __ Mov(x2, 0);
+  __ Bind(&loop);
+  // Flag-setting arithmetic whose flags are never read.
+  __ Adds(x3, x1, x0);
+  __ Subs(x4, x3, 7);
+  __ Ands(x5, x4, 0xff);
+  // A comparison read by a conditional select.
+  __ Cmp(x5, 0x80);
+  __ Csinc(x1, x1, x1, lo);
+  // A comparison read by a conditional branch.
+  __ Tst(x0, 1);
+  __ B(eq, &skip);
+  __ Add(x2, x2, 1);
+  __ Bind(&skip);
+  __ Subs(x0, x0, 1);
+  __ B(ne, &loop);
+  __ Ret();
+  masm.FinalizeCode();
+
+  const Instruction* code = masm.GetLabelAddress<const Instruction*>(&start);
+
+  Decoder decoder;
+  Simulator simulator(&decoder);
+
+  BenchTimer timer;
+
+  size_t iterations = 0;
+  do {
+    simulator.RunFrom(code);
+    iterations++;
+  } while (!timer.HasRunFor(cli.GetRunTimeInSeconds()));
+
+  cli.PrintResults(iterations, timer.GetElapsedSeconds());
+  return cli.GetExitCode();
+}
+
+#else   // VIXL_INCLUDE_SIMULATOR_AARCH64
+int main(void) {
+  printf("This benchmark requires AArch64 simulator support.\n");
+  return EXIT_FAILURE;
+}
+#endif  // VIXL_INCLUDE_SIMULATOR_AARCH64
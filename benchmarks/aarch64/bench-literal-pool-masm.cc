@@ -0,0 +1,79 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "bench-utils.h"
+#include "globals-vixl.h"
+
+#include "aarch64/instructions-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+// This program focuses on the emission of literal pools for constant-heavy
+// code, loading a limited set of 32-bit, 64-bit and 128-bit constants many
+// times. It also reports the size of the code generated, including pools.
+int main(int argc, char* argv[]) {
+  BenchCLI cli(argc, argv);
+  if (cli.ShouldExitEarly()) return cli.GetExitCode();
+
+  const size_t buffer_size = 256 * KBytes;
+  const size_t instructions_per_iteration = 6;
+  // Leave space for the literal pools.
+  const size_t max_buffer_iterations =
+      buffer_size / (2 * instructions_per_iteration * kInstructionSize);
+  // The number of distinct constants of each type.
+  const uint64_t kConstantCount = 32;
+  MacroAssembler masm(buffer_size);
+  masm.SetCPUFeatures(CPUFeatures(CPUFeatures::kFP, CPUFeatures::kNEON));
+
+  BenchTimer timer;
+
+  size_t iterations = 0;
+  size_t code_size = 0;
+  do {
+    masm.Reset();
+
+    for (size_t i = 0; i < max_buffer_iterations; i++) {
+      uint64_t value = 0x0123456789abcdef * ((i % kConstantCount) + 1);
+      masm.Ldr(x0, value);
+      masm.Ldr(w1, static_cast<uint32_t>(value >> 16));
+      masm.Ldr(d2, 1.0 / ((i % kConstantCount) + 3));
+      masm.Ldr(s3, 1.0f / ((i % kConstantCount) + 3));
+      masm.Ldr(q4, value, ~value);
+      masm.Add(x0, x0, x1);
+    }
+
+    masm.FinalizeCode();
+    code_size = masm.GetSizeOfCodeGenerated();
+    iterations++;
+  } while (!timer.HasRunFor(cli.GetRunTimeInSeconds()));
+
+  printf("Code size: %zu bytes\n", code_size);
+  cli.PrintResults(iterations, timer.GetElapsedSeconds());
+  return cli.GetExitCode();
+}
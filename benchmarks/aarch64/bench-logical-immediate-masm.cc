@@ -0,0 +1,136 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "bench-utils.h"
+#include "globals-vixl.h"
+
+#include "aarch64/macro-assembler-aarch64.h"
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+static const int kImmediateCount = 1024;
+
+static uint64_t NextRandom(uint64_t* state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * UINT64_C(0x2545f4914f6cdd1d);
+}
+
+// Return a random 64-bit logical immediate, built from a pattern of random
+// size, length and rotation.
+static uint64_t RandomLogicalImmediate(uint64_t* state) {
+  uint64_t random = NextRandom(state);
+  unsigned size = 2 << (random % 6);
+  unsigned length = 1 + ((random >> 8) % (size - 1));
+  unsigned rotation = (random >> 16) % size;
+  uint64_t pattern = RotateRight(GetUintMask(length), rotation, size);
+  uint64_t value = 0;
+  for (unsigned i = 0; i < 64; i += size) {
+    value |= pattern << i;
+  }
+  return value;
+}
+
+// The immediates are a mix of the values found in typical code: logical
+// immediates, values one bit away from a logical immediate, small integers
+// and arbitrary values.
+static uint64_t GetImmediate(int index, uint64_t* state) {
+  switch (index % 4) {
+    case 0:
+      return RandomLogicalImmediate(state);
+    case 1:
+      return RandomLogicalImmediate(state) ^
+             (UINT64_C(1) << (NextRandom(state) % 64));
+    case 2:
+      return NextRandom(state) % 4096;
+    default:
+      return NextRandom(state);
+  }
+}
+
+// This program measures how fast immediates are checked for being encodable
+// as logical immediates, first with direct calls to
+// `Assembler::IsImmLogical`, then when generating `And`, `Orr`, `Eor`, `Tst`
+// and `Mov` instructions with immediate operands.
+int main(int argc, char* argv[]) {
+  BenchCLI cli(argc, argv);
+  if (cli.ShouldExitEarly()) return cli.GetExitCode();
+
+  uint64_t immediates[kImmediateCount];
+  uint64_t state = 0x0123456789abcdef;
+  for (int i = 0; i < kImmediateCount; i++) {
+    immediates[i] = GetImmediate(i, &state);
+  }
+
+  {
+    BenchTimer timer;
+    size_t iterations = 0;
+    unsigned checksum = 0;
+    do {
+      for (int i = 0; i < kImmediateCount; i++) {
+        unsigned n, imm_s, imm_r;
+        if (Assembler::IsImmLogical(immediates[i],
+                                    kXRegSize,
+                                    &n,
+                                    &imm_s,
+                                    &imm_r)) {
+          checksum += n + imm_s + imm_r;
+        }
+        if (Assembler::IsImmLogical(immediates[i], kWRegSize)) checksum++;
+      }
+      iterations++;
+    } while (!timer.HasRunFor(cli.GetRunTimeInSeconds()));
+    VIXL_CHECK(checksum > 0);
+    printf("IsImmLogical, %d immediates: ", kImmediateCount);
+    cli.PrintResults(iterations, timer.GetElapsedSeconds());
+  }
+
+  {
+    const size_t buffer_size = 256 * KBytes;
+    MacroAssembler masm(buffer_size);
+    BenchTimer timer;
+    size_t iterations = 0;
+    do {
+      masm.Reset();
+      for (int i = 0; i < kImmediateCount; i++) {
+        uint64_t imm = immediates[i];
+        masm.And(x0, x1, imm);
+        masm.Orr(w2, w3, static_cast<uint32_t>(imm));
+        masm.Eor(x4, x5, ~imm);
+        masm.Tst(x6, imm);
+        masm.Mov(x7, imm);
+      }
+      masm.FinalizeCode();
+      iterations++;
+    } while (!timer.HasRunFor(cli.GetRunTimeInSeconds()));
+    printf("MacroAssembler, %d immediates: ", kImmediateCount);
+    cli.PrintResults(iterations, timer.GetElapsedSeconds());
+  }
+
+  return cli.GetExitCode();
+}
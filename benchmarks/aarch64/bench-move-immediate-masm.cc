@@ -0,0 +1,213 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cstring>
+
+#include "bench-utils.h"
+#include "globals-vixl.h"
+
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/move-immediate-aarch64.h"
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+enum ConstantKind {
+  kSmallInteger,
+  kAddress,
+  kDouble,
+  kPatchedMask,
+  kReplicated,
+  kWord,
+  kRandom,
+  kConstantKindCount
+};
+
+static const char* const kConstantKindNames[] = {"small integers",
+                                                 "addresses",
+                                                 "doubles",
+                                                 "patched masks",
+                                                 "replicated",
+                                                 "32-bit values",
+                                                 "random"};
+
+static const int kConstantsPerKind = 256;
+static const int kConstantCount = kConstantKindCount * kConstantsPerKind;
+
+static uint64_t NextRandom(uint64_t* state) {
+  // xorshift64*
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * UINT64_C(0x2545f4914f6cdd1d);
+}
+
+static uint64_t GetConstant(ConstantKind kind, int index, uint64_t* state) {
+  uint64_t random = NextRandom(state);
+  switch (kind) {
+    case kSmallInteger:
+      return static_cast<uint64_t>(static_cast<int64_t>(random % 4001) - 2000);
+    case kAddress:
+      return UINT64_C(0x00007f0000000000) | (random & UINT64_C(0xfffffffff8));
+    case kDouble: {
+      double value = (index + 1) / 7.0;
+      uint64_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      return bits;
+    }
+    case kPatchedMask: {
+      // A mask with a field written into one of its halfwords.
+      const uint64_t kMasks[] = {UINT64_C(0x00ff00ff00ff00ff),
+                                 UINT64_C(0x5555555555555555),
+                                 UINT64_C(0x0000ffffffff0000),
+                                 UINT64_C(0x7fffffffffffffff)};
+      uint64_t mask = kMasks[index % 4];
+      int shift = 16 * ((random >> 16) % 4);
+      return (mask & ~(UINT64_C(0xffff) << shift)) |
+             ((random & 0xffff) << shift);
+    }
+    case kReplicated:
+      if ((index % 2) == 0) return (random & 0xffff) * 0x0001000100010001;
+      return (random & 0xffffffff) * 0x0000000100000001;
+    case kWord:
+      return random & 0xffffffff;
+    case kRandom:
+    case kConstantKindCount:
+      break;
+  }
+  return random;
+}
+
+// Generate functions using 16 constants eight times each with `Mov`, with or
+// without the search for minimal sequences.
+static void BenchmarkMov(BenchCLI* cli,
+                         const uint64_t* constants,
+                         bool minimal) {
+  const int kConstantsPerFunction = 16;
+  const int kUses = 8;
+  MacroAssembler masm(kConstantsPerFunction * kUses * 5 * kInstructionSize);
+  masm.SetMinimalMoveImmediates(minimal);
+  BenchTimer timer;
+  size_t iterations = 0;
+  do {
+    int base = static_cast<int>((iterations * kConstantsPerFunction) %
+                                kConstantCount);
+    masm.Reset();
+    for (int use = 0; use < kUses; use++) {
+      for (int i = 0; i < kConstantsPerFunction; i++) {
+        masm.Mov(x0, constants[base + i]);
+      }
+    }
+    masm.FinalizeCode();
+    iterations++;
+  } while (!timer.HasRunFor(cli->GetRunTimeInSeconds()));
+  const char* name = minimal ? "Mov (minimal)" : "Mov (greedy)";
+  if (minimal) {
+    const MoveImmediateCache& cache = masm.GetMoveImmediateCache();
+    printf("%s, cache hits: %" PRIu64 ", misses: %" PRIu64 "\n",
+           name,
+           cache.GetHitCount(),
+           cache.GetMissCount());
+  }
+  printf("%s, %d constants: ", name, kConstantsPerFunction * kUses);
+  cli->PrintResults(iterations, timer.GetElapsedSeconds());
+}
+
+// This program reports how many instructions the greedy and minimal
+// immediate sequences use for a corpus of constants, then measures the
+// throughput of both searches, and of `Mov` with and without the search for
+// minimal sequences, which uses the MacroAssembler's cache of sequences.
+int main(int argc, char* argv[]) {
+  BenchCLI cli(argc, argv);
+  if (cli.ShouldExitEarly()) return cli.GetExitCode();
+
+  uint64_t constants[kConstantCount];
+  uint64_t state = 0x0123456789abcdef;
+  printf("%-16s %8s %8s\n", "Constants", "Greedy", "Minimal");
+  int greedy_total = 0;
+  int minimal_total = 0;
+  for (int kind = 0; kind < kConstantKindCount; kind++) {
+    int greedy_count = 0;
+    int minimal_count = 0;
+    for (int i = 0; i < kConstantsPerKind; i++) {
+      uint64_t imm = GetConstant(static_cast<ConstantKind>(kind), i, &state);
+      constants[(kind * kConstantsPerKind) + i] = imm;
+      MoveImmediateSequence greedy;
+      MoveImmediateSequence minimal;
+      MoveImmediateSequence::FindGreedy(imm, kXRegSize, &greedy);
+      MoveImmediateSequence::FindMinimal(imm, kXRegSize, &minimal);
+      greedy_count += greedy.GetLength();
+      minimal_count += minimal.GetLength();
+    }
+    printf("%-16s %8d %8d\n",
+           kConstantKindNames[kind],
+           greedy_count,
+           minimal_count);
+    greedy_total += greedy_count;
+    minimal_total += minimal_count;
+  }
+  printf("%-16s %8d %8d\n", "total", greedy_total, minimal_total);
+
+  {
+    BenchTimer timer;
+    size_t iterations = 0;
+    int count = 0;
+    do {
+      for (int i = 0; i < kConstantCount; i++) {
+        MoveImmediateSequence sequence;
+        MoveImmediateSequence::FindGreedy(constants[i], kXRegSize, &sequence);
+        count += sequence.GetLength();
+      }
+      iterations++;
+    } while (!timer.HasRunFor(cli.GetRunTimeInSeconds()));
+    VIXL_CHECK(count > 0);
+    printf("FindGreedy, %d constants: ", kConstantCount);
+    cli.PrintResults(iterations, timer.GetElapsedSeconds());
+  }
+
+  {
+    BenchTimer timer;
+    size_t iterations = 0;
+    int count = 0;
+    do {
+      for (int i = 0; i < kConstantCount; i++) {
+        MoveImmediateSequence sequence;
+        MoveImmediateSequence::FindMinimal(constants[i], kXRegSize, &sequence);
+        count += sequence.GetLength();
+      }
+      iterations++;
+    } while (!timer.HasRunFor(cli.GetRunTimeInSeconds()));
+    VIXL_CHECK(count > 0);
+    printf("FindMinimal, %d constants: ", kConstantCount);
+    cli.PrintResults(iterations, timer.GetElapsedSeconds());
+  }
+
+  BenchmarkMov(&cli, constants, false);
+  BenchmarkMov(&cli, constants, true);
+
+  return cli.GetExitCode();
+}
@@ -0,0 +1,97 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <thread>
+#include <vector>
+
+#include "bench-utils.h"
+#include "code-buffer-vixl.h"
+#include "globals-vixl.h"
+
+#include "aarch64/instructions-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+static const size_t kFunctionSize = 4 * KBytes;
+static const int kFunctionsPerRound = 64;
+
+// Generate `kFunctionsPerRound` functions into `shared`, each with its own
+// MacroAssembler, as a JIT compiler thread would.
+static void GenerateFunctions(SharedCodeBuffer* shared) {
+  for (int i = 0; i < kFunctionsPerRound; i++) {
+    MacroAssembler masm(shared, 2 * kFunctionSize);
+    masm.SetCPUFeatures(CPUFeatures::All());
+    BenchCodeGenerator generator(&masm);
+    generator.Generate(kFunctionSize);
+    masm.FinalizeCode();
+  }
+}
+
+// Generate functions on `thread_count` threads at once, all emitting into the
+// same SharedCodeBuffer, and print the number of functions generated per
+// second.
+static void GenerateInParallel(BenchCLI* cli, int thread_count) {
+  // Leave plenty of space for chunks abandoned when they grow.
+  SharedCodeBuffer shared(thread_count * kFunctionsPerRound * 4 *
+                          kFunctionSize);
+
+  BenchTimer timer;
+
+  size_t iterations = 0;
+  do {
+    shared.Reset();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; i++) {
+      threads.push_back(std::thread(GenerateFunctions, &shared));
+    }
+    for (std::thread& thread : threads) thread.join();
+    iterations += thread_count * kFunctionsPerRound;
+  } while (!timer.HasRunFor(cli->GetRunTimeInSeconds()));
+
+  printf("%d thread%s: ", thread_count, (thread_count == 1) ? "" : "s");
+  cli->PrintResults(iterations, timer.GetElapsedSeconds());
+}
+
+// This program measures how code generation with the MacroAssembler scales
+// when several threads emit into one SharedCodeBuffer. It runs with one thread,
+// then doubles the number of threads up to the number of hardware threads.
+// Each iteration is one function, generated by BenchCodeGenerator.
+int main(int argc, char* argv[]) {
+  BenchCLI cli(argc, argv);
+  if (cli.ShouldExitEarly()) return cli.GetExitCode();
+
+  int max_threads = static_cast<int>(std::thread::hardware_concurrency());
+  if (max_threads < 1) max_threads = 1;
+  for (int threads = 1; threads < max_threads; threads *= 2) {
+    GenerateInParallel(&cli, threads);
+  }
+  GenerateInParallel(&cli, max_threads);
+
+  return cli.GetExitCode();
+}
@@ -0,0 +1,108 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "bench-utils.h"
+#include "globals-vixl.h"
+
+#include "aarch64/instructions-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+#define __ masm.
+
+// This program measures the simulation of pointer-authenticated calls and
+// returns: every call signs the return address on entry and authenticates it
+// on return, as code built with `-mbranch-protection=pac-ret` would.
+int main(int argc, char* argv[]) {
+  BenchCLI cli(argc, argv);
+  if (cli.ShouldExitEarly()) return cli.GetExitCode();
+
+  const int kLoopCount = 10000;
+  const int kCallsPerLoop = 8;
+
+  MacroAssembler masm;
+  masm.SetCPUFeatures(CPUFeatures(CPUFeatures::kPAuth));
+
+  Label start, leaf, nested;
+  __ Bind(&start);
+  __ Paciasp();
+  __ Push(x19, lr);
+  __ Mov(x19, kLoopCount);
+  Label loop;
+  __ Bind(&loop);
+  for (int i = 0; i < kCallsPerLoop; i++) {
+    __ Bl(&nested);
+  }
+  __ Subs(x19, x19, 1);
+  __ B(ne, &loop);
+  __ Pop(lr, x19);
+  __ Autiasp();
+  __ Ret();
+
+  // A non-leaf function, which signs its return address and calls a leaf.
+  __ Bind(&nested);
+  __ Paciasp();
+  __ Push(x29, lr);
+  __ Bl(&leaf);
+  __ Pop(lr, x29);
+  __ Retaa();
+
+  // A leaf function, which signs and authenticates its return address.
+  __ Bind(&leaf);
+  __ Paciasp();
+  __ Add(x0, x0, 1);
+  __ Retaa();
+  masm.FinalizeCode();
+
+  const Instruction* code = masm.GetLabelAddress<const Instruction*>(&start);
+
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.SetCPUFeatures(CPUFeatures(CPUFeatures::kPAuth));
+
+  BenchTimer timer;
+
+  size_t iterations = 0;
+  do {
+    simulator.RunFrom(code);
+    iterations++;
+  } while (!timer.HasRunFor(cli.GetRunTimeInSeconds()));
+
+  cli.PrintResults(iterations, timer.GetElapsedSeconds());
+  return cli.GetExitCode();
+}
+
+#else   // VIXL_INCLUDE_SIMULATOR_AARCH64
+int main(void) {
+  printf("This benchmark requires AArch64 simulator support.\n");
+  return EXIT_FAILURE;
+}
+#endif  // VIXL_INCLUDE_SIMULATOR_AARCH64
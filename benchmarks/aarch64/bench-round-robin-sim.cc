@@ -0,0 +1,101 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <memory>
+#include <vector>
+
+#include "bench-utils.h"
+#include "globals-vixl.h"
+
+#include "aarch64/instructions-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+#define __ masm.
+
+// This program measures the throughput of cooperative scheduling on a single
+// Simulator: many simulated threads, each running an endless loop, are given
+// fixed time slices in round-robin order using `Simulator::SwapContext` and
+// `Simulator::RunFor`. Each iteration is one time slice, including the two
+// context switches around it.
+int main(int argc, char* argv[]) {
+  BenchCLI cli(argc, argv);
+  if (cli.ShouldExitEarly()) return cli.GetExitCode();
+
+  const int kThreadCount = 256;
+  const uint64_t kQuantum = 64;
+
+  MacroAssembler masm;
+  Label start, loop;
+  __ Bind(&start);
+  __ Mov(x1, 0);
+  __ Bind(&loop);
+  __ Add(x1, x1, x0);
+  __ Eor(x2, x1, x0);
+  __ Str(x2, MemOperand(sp, -16, PreIndex));
+  __ Ldr(x3, MemOperand(sp, 16, PostIndex));
+  __ B(&loop);
+  masm.FinalizeCode();
+
+  const Instruction* code = masm.GetLabelAddress<const Instruction*>(&start);
+
+  Decoder decoder;
+  Simulator simulator(&decoder);
+
+  std::vector<std::unique_ptr<SimContext>> threads;
+  for (int i = 0; i < kThreadCount; i++) {
+    threads.push_back(std::make_unique<SimContext>(simulator));
+    threads.back()->WriteXRegister(0, i);
+    threads.back()->WritePc(code);
+  }
+
+  BenchTimer timer;
+
+  size_t iterations = 0;
+  do {
+    for (int i = 0; i < kThreadCount; i++) {
+      simulator.SwapContext(threads[i].get());
+      simulator.RunFor(kQuantum);
+      simulator.SwapContext(threads[i].get());
+    }
+    iterations += kThreadCount;
+  } while (!timer.HasRunFor(cli.GetRunTimeInSeconds()));
+
+  cli.PrintResults(iterations, timer.GetElapsedSeconds());
+  return cli.GetExitCode();
+}
+
+#else   // VIXL_INCLUDE_SIMULATOR_AARCH64
+int main(void) {
+  printf("This benchmark requires AArch64 simulator support.\n");
+  return EXIT_FAILURE;
+}
+#endif  // VIXL_INCLUDE_SIMULATOR_AARCH64
@@ -0,0 +1,101 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "bench-utils.h"
+#include "globals-vixl.h"
+
+#include "aarch64/instructions-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+
+#if defined(VIXL_INCLUDE_SIMULATOR_AARCH64) && \
+    defined(VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT)
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+#define __ masm.
+
+int64_t bench_runtime_call_add(int64_t a, int64_t b) { return a + b; }
+int64_t bench_intercepted_add(int64_t a, int64_t b) { return a + b; }
+
+// This program measures the cost of calls from simulated code to native code,
+// both through `MacroAssembler::CallRuntime` and through branches to addresses
+// registered with `Simulator::RegisterBranchInterception`.
+int main(int argc, char* argv[]) {
+  BenchCLI cli(argc, argv);
+  if (cli.ShouldExitEarly()) return cli.GetExitCode();
+
+  const int kLoopCount = 10000;
+  // Emit several distinct call sites per loop iteration, as compiled code
+  // typically would.
+  const int kCallSitesPerLoop = 8;
+
+  MacroAssembler masm;
+  Label start;
+  __ Bind(&start);
+  __ Push(x19, lr);
+  __ Mov(x19, kLoopCount);
+  __ Mov(x0, 0);
+  Label loop;
+  __ Bind(&loop);
+  for (int i = 0; i < kCallSitesPerLoop; i++) {
+    __ Mov(x1, i);
+    __ CallRuntime(bench_runtime_call_add);
+    __ Mov(x1, 1);
+    __ Mov(x16, reinterpret_cast<uint64_t>(bench_intercepted_add));
+    __ Blr(x16);
+  }
+  __ Subs(x19, x19, 1);
+  __ B(ne, &loop);
+  __ Pop(lr, x19);
+  __ Ret();
+  masm.FinalizeCode();
+
+  const Instruction* code = masm.GetLabelAddress<const Instruction*>(&start);
+
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.RegisterBranchInterception(bench_intercepted_add);
+
+  BenchTimer timer;
+
+  size_t iterations = 0;
+  do {
+    simulator.RunFrom(code);
+    iterations++;
+  } while (!timer.HasRunFor(cli.GetRunTimeInSeconds()));
+
+  cli.PrintResults(iterations, timer.GetElapsedSeconds());
+  return cli.GetExitCode();
+}
+
+#else   // VIXL_INCLUDE_SIMULATOR_AARCH64 && ...
+int main(void) {
+  printf("This benchmark requires AArch64 simulator support.\n");
+  return EXIT_FAILURE;
+}
+#endif  // VIXL_INCLUDE_SIMULATOR_AARCH64 && ...
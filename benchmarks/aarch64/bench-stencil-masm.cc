@@ -0,0 +1,154 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "bench-utils.h"
+#include "code-buffer-vixl.h"
+#include "globals-vixl.h"
+
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/stencil-aarch64.h"
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+#define __ masm->
+
+static const int kSequencesPerFunction = 256;
+
+// The values used by the `index`th sequence of a function.
+static uint64_t GetImmediate(int index) {
+  return UINT64_C(0x0123456789abcdef) * index;
+}
+static uint64_t GetLiteral(int index) { return 0xfedcba9876543210 ^ index; }
+static unsigned GetRegister(int index) { return 1 + (index % 8); }
+static uint64_t GetAddImmediate(int index) { return index % 4096; }
+
+// Generate a function made of `kSequencesPerFunction` sequences of the form:
+//   mov x0, #<immediate>
+//   ldr x9, =<literal>
+//   add x0, x0, x9
+//   add x0, x0, <register>
+//   add x0, x0, #<add immediate>
+//   b <exit>
+// as a baseline JIT tier would for simple operations.
+static void GenerateWithMacroAssembler(MacroAssembler* masm) {
+  Label exit;
+  __ B(&exit);
+  for (int i = 0; i < kSequencesPerFunction; i++) {
+    __ Mov(x0, GetImmediate(i));
+    __ Ldr(x9, GetLiteral(i));
+    __ Add(x0, x0, x9);
+    __ Add(x0, x0, XRegister(GetRegister(i)));
+    __ Add(x0, x0, GetAddImmediate(i));
+    __ B(&exit);
+  }
+  __ Bind(&exit);
+  __ Ret();
+  masm->FinalizeCode();
+}
+
+static void BuildSequenceStencil(Stencil* stencil) {
+  MacroAssembler assembler;
+  MacroAssembler* masm = &assembler;
+  StencilBuilder builder(masm);
+  builder.MovImmediate(0, x0);
+  builder.LdrLiteral(1, x9);
+  __ Add(x0, x0, x9);
+  {
+    ExactAssemblyScope scope(masm, kInstructionSize);
+    __ add(x0, x0, x1);
+  }
+  builder.MarkRegister(2, Stencil::kRegisterRm);
+  builder.AddImmediate(3, x0, x0);
+  builder.B(4);
+  builder.Build(stencil);
+}
+
+static void BuildExitStencil(Stencil* stencil) {
+  MacroAssembler assembler;
+  MacroAssembler* masm = &assembler;
+  StencilBuilder builder(masm);
+  __ Ret();
+  builder.Build(stencil);
+}
+
+// Generate the same function as GenerateWithMacroAssembler, with the exit
+// first, by instantiating stencils.
+static void GenerateWithStencils(CodeBuffer* buffer,
+                                 const Stencil& exit,
+                                 const Stencil& sequence) {
+  exit.Instantiate(buffer, NULL);
+  for (int i = 0; i < kSequencesPerFunction; i++) {
+    uint64_t values[] = {GetImmediate(i),
+                         GetLiteral(i),
+                         GetRegister(i),
+                         GetAddImmediate(i),
+                         0};
+    bool success = sequence.Instantiate(buffer, values);
+    VIXL_CHECK(success);
+  }
+}
+
+// This program compares generating code by instantiating stencils with
+// generating the same code with the MacroAssembler. Each iteration is one
+// function.
+int main(int argc, char* argv[]) {
+  BenchCLI cli(argc, argv);
+  if (cli.ShouldExitEarly()) return cli.GetExitCode();
+
+  {
+    MacroAssembler masm(64 * KBytes);
+    BenchTimer timer;
+    size_t iterations = 0;
+    do {
+      masm.Reset();
+      GenerateWithMacroAssembler(&masm);
+      iterations++;
+    } while (!timer.HasRunFor(cli.GetRunTimeInSeconds()));
+    printf("MacroAssembler: ");
+    cli.PrintResults(iterations, timer.GetElapsedSeconds());
+  }
+
+  {
+    Stencil exit, sequence;
+    BuildExitStencil(&exit);
+    BuildSequenceStencil(&sequence);
+    CodeBuffer buffer(64 * KBytes);
+    BenchTimer timer;
+    size_t iterations = 0;
+    do {
+      buffer.Reset();
+      GenerateWithStencils(&buffer, exit, sequence);
+      iterations++;
+    } while (!timer.HasRunFor(cli.GetRunTimeInSeconds()));
+    buffer.SetClean();
+    printf("Stencils:       ");
+    cli.PrintResults(iterations, timer.GetElapsedSeconds());
+  }
+
+  return cli.GetExitCode();
+}
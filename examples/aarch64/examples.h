@@ -125,4 +125,41 @@ void GenerateRuntimeCallExamples(vixl::aarch64::MacroAssembler* masm);
 // The function implements the standard `strlen` using SVE.
 void GenerateSVEStrlen(vixl::aarch64::MacroAssembler* masm);
 
+// Generate a function with the following prototype:
+//   uint64_t sum_rec(uint64_t n)
+//
+// It provides a recursive implementation of the sum of the integers from 1
+// to n.
+void GenerateSumRec(vixl::aarch64::MacroAssembler* masm);
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+// Run `function` once for each of the `count` inputs, as cooperative threads
+// sharing a single Simulator. The threads are scheduled in round-robin order,
+// each running for at most `quantum` instructions at a time. The value
+// returned by each thread is stored in `results`. Returns the number of
+// context switches.
+int RunRoundRobin(vixl::aarch64::Simulator* simulator,
+                  const vixl::aarch64::Instruction* function,
+                  const uint64_t* inputs,
+                  uint64_t* results,
+                  int count,
+                  uint64_t quantum);
+#endif
+
+// Generate a function with the following prototype:
+//   uint64_t check_magic(const uint8_t* data, size_t size)
+//
+// It returns 1 if `data` starts with the bytes "VIXL", and 0 otherwise.
+void GenerateCheckMagic(vixl::aarch64::MacroAssembler* masm);
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+// Fuzz `function`, generated by GenerateCheckMagic, using the simulator's
+// edge coverage to guide a simple mutation strategy. Returns the number of
+// runs needed to find the magic number, or -1 if it was not found within
+// `max_runs` runs.
+int FuzzCheckMagic(const vixl::aarch64::Instruction* function,
+                   uint32_t seed,
+                   int max_runs);
+#endif
+
 #endif  // VIXL_EXAMPLE_EXAMPLES_H_
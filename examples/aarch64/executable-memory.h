@@ -38,11 +38,42 @@ extern "C" {
 #include <string>
 
 #include "aarch64/assembler-aarch64.h"
+#include "aarch64/code-cache-aarch64.h"
 #include "aarch64/constants-aarch64.h"
 #include "aarch64/cpu-aarch64.h"
 #include "aarch64/macro-assembler-aarch64.h"
 
 #ifndef VIXL_INCLUDE_SIMULATOR_AARCH64
+#if defined(VIXL_CODE_BUFFER_MMAP) && defined(__linux__)
+// Copy generated code into a code cache shared by all the examples, so that
+// it can be executed.
+class ExecutableMemory {
+ public:
+  ExecutableMemory(const vixl::byte* code_start, size_t size)
+      : handle_(GetCodeCache()->Install(
+            code_start, size, vixl::aarch64::CodeCache::kPinned)) {
+    VIXL_CHECK(handle_.IsValid());
+    GetCodeCache()->EnsureIAndDCacheCoherency();
+  }
+  ~ExecutableMemory() { GetCodeCache()->Free(handle_); }
+
+  template <typename T>
+  T GetEntryPoint(const vixl::aarch64::Label& entry_point) const {
+    return GetCodeCache()->GetEntryPoint<T>(handle_,
+                                            entry_point.GetLocation());
+  }
+
+ private:
+  static vixl::aarch64::CodeCache* GetCodeCache() {
+    static vixl::aarch64::CodeCache code_cache;
+    return &code_cache;
+  }
+
+  vixl::aarch64::CodeCache::Handle handle_;
+};
+#else
+// The code cache is not available in this configuration, so give each piece
+// of generated code its own mapping.
 class ExecutableMemory {
  public:
   ExecutableMemory(const vixl::byte* code_start, size_t size)
@@ -84,5 +115,6 @@ class ExecutableMemory {
   vixl::byte* buffer_;
 };
 #endif
+#endif
 
 #endif  // VIXL_EXAMPLE_EXECUTABLE_MEMORY_H_
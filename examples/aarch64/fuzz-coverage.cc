@@ -0,0 +1,144 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cstring>
+#include <vector>
+
+#include "examples.h"
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+#define __ masm->
+
+void GenerateCheckMagic(MacroAssembler* masm) {
+  // uint64_t check_magic(const uint8_t* data, size_t size)
+  //  Argument locations:
+  //    data -> x0
+  //    size -> x1
+  //
+  // Return 1 if `data` starts with "VIXL", and 0 otherwise. The bytes are
+  // checked one at a time so that a coverage-guided fuzzer can make progress
+  // one byte at a time.
+
+  Label reject;
+  const char* magic = "VIXL";
+
+  __ Cmp(x1, 4);
+  __ B(lo, &reject);
+  for (int i = 0; i < 4; i++) {
+    __ Ldrb(w2, MemOperand(x0, i));
+    __ Cmp(w2, magic[i]);
+    __ B(ne, &reject);
+  }
+  __ Mov(x0, 1);
+  __ Ret();
+
+  __ Bind(&reject);
+  __ Mov(x0, 0);
+  __ Ret();
+}
+
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+// A minimal persistent-mode fuzzing loop: a single Simulator runs every input,
+// with only its architectural state reset between runs. Inputs which reach new
+// edges, according to the simulator's coverage bitmap, are kept and mutated
+// further.
+//
+// A real harness would use the fuzzer's shared memory for the bitmap (such as
+// AFL's `__afl_area_ptr`) and let the fuzzer choose the inputs.
+int FuzzCheckMagic(const Instruction* function, uint32_t seed, int max_runs) {
+  const size_t kBitmapSize = 4096;
+  std::vector<uint8_t> bitmap(kBitmapSize);
+  std::vector<uint8_t> seen(kBitmapSize, 0);
+
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.SetCoverageBitmap(bitmap.data(), bitmap.size());
+
+  std::vector<std::vector<uint8_t>> corpus = {{'A', 'A', 'A', 'A'}};
+  uint32_t rng = seed;
+  auto random = [&rng]() {
+    // xorshift32
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+  };
+
+  for (int run = 1; run <= max_runs; run++) {
+    // Mutate one byte of an input from the corpus.
+    std::vector<uint8_t> input = corpus[random() % corpus.size()];
+    input[random() % input.size()] = static_cast<uint8_t>(random());
+
+    memset(bitmap.data(), 0, bitmap.size());
+    simulator.ResetArchitecturalState();
+    simulator.WriteXRegister(0, reinterpret_cast<uintptr_t>(input.data()));
+    simulator.WriteXRegister(1, input.size());
+    simulator.RunFrom(function);
+    if (simulator.ReadXRegister(0) == 1) return run;
+
+    bool new_coverage = false;
+    for (size_t i = 0; i < kBitmapSize; i++) {
+      if ((bitmap[i] != 0) && (seen[i] == 0)) {
+        seen[i] = 1;
+        new_coverage = true;
+      }
+    }
+    if (new_coverage) corpus.push_back(input);
+  }
+  return -1;
+}
+#endif  // VIXL_INCLUDE_SIMULATOR_AARCH64
+
+
+#ifndef TEST_EXAMPLES
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+int main(void) {
+  MacroAssembler masm;
+
+  Label check_magic;
+  masm.Bind(&check_magic);
+  GenerateCheckMagic(&masm);
+  masm.FinalizeCode();
+
+  int runs = FuzzCheckMagic(masm.GetLabelAddress<Instruction*>(&check_magic),
+                            42,
+                            1000000);
+  if (runs < 0) {
+    printf("The magic number was not found.\n");
+    return 1;
+  }
+  printf("Found the magic number after %d runs.\n", runs);
+  return 0;
+}
+#else
+// Without the simulator there is nothing to test.
+int main(void) { return 0; }
+#endif  // VIXL_INCLUDE_SIMULATOR_AARCH64
+#endif  // TEST_EXAMPLES
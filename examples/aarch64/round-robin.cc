@@ -0,0 +1,135 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <memory>
+#include <vector>
+
+#include "examples.h"
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+#define __ masm->
+
+void GenerateSumRec(MacroAssembler* masm) {
+  // uint64_t sum_rec(uint64_t n)
+  // Argument location:
+  //   n -> x0
+
+  Label entry, input_is_zero;
+
+  __ Bind(&entry);
+  // Check for the stopping condition: the input number is null.
+  __ Cbz(x0, &input_is_zero);
+
+  __ Mov(x1, x0);
+  __ Sub(x0, x0, 1);
+  __ Push(x1, lr);
+  __ Bl(&entry);  // Recursive call sum_rec(n - 1).
+  __ Pop(lr, x1);
+  __ Add(x0, x0, x1);
+
+  __ Bind(&input_is_zero);
+  __ Ret();
+}
+
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+int RunRoundRobin(Simulator* simulator,
+                  const Instruction* function,
+                  const uint64_t* inputs,
+                  uint64_t* results,
+                  int count,
+                  uint64_t quantum) {
+  // Create one context per thread. Each context has its own stack, so the
+  // threads can be interleaved in the middle of their recursive calls.
+  std::vector<std::unique_ptr<SimContext>> threads;
+  for (int i = 0; i < count; i++) {
+    threads.push_back(std::make_unique<SimContext>(*simulator));
+    threads.back()->WriteXRegister(0, inputs[i]);
+    threads.back()->WritePc(function);
+  }
+
+  int switches = 0;
+  int running = count;
+  while (running > 0) {
+    for (int i = 0; i < count; i++) {
+      SimContext* thread = threads[i].get();
+      if (thread->IsFinished()) continue;
+
+      // Switch to the thread, run it for a time slice, then switch back.
+      simulator->SwapContext(thread);
+      simulator->RunFor(quantum);
+      simulator->SwapContext(thread);
+      switches++;
+
+      if (thread->IsFinished()) {
+        results[i] = thread->ReadXRegister(0);
+        running--;
+      }
+    }
+  }
+  return switches;
+}
+#endif  // VIXL_INCLUDE_SIMULATOR_AARCH64
+
+
+#ifndef TEST_EXAMPLES
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+int main(void) {
+  MacroAssembler masm;
+  Decoder decoder;
+  Simulator simulator(&decoder);
+
+  // Generate the code for the example function.
+  Label sum_rec;
+  masm.Bind(&sum_rec);
+  GenerateSumRec(&masm);
+  masm.FinalizeCode();
+
+  // Run one thread per input, switching threads every 16 instructions.
+  const uint64_t inputs[] = {0, 1, 10, 100, 42, 250};
+  const int count = sizeof(inputs) / sizeof(inputs[0]);
+  uint64_t results[count];
+  int switches = RunRoundRobin(&simulator,
+                               masm.GetLabelAddress<Instruction*>(&sum_rec),
+                               inputs,
+                               results,
+                               count,
+                               16);
+
+  for (int i = 0; i < count; i++) {
+    printf("sum_rec(%" PRIu64 ") = %" PRIu64 "\n", inputs[i], results[i]);
+  }
+  printf("%d context switches\n", switches);
+
+  return 0;
+}
+#else
+// Without the simulator there is nothing to test.
+int main(void) { return 0; }
+#endif  // VIXL_INCLUDE_SIMULATOR_AARCH64
+#endif  // TEST_EXAMPLES
@@ -42,7 +42,10 @@ RawLiteral::RawLiteral(size_t size,
       low64_(0),
       high64_(0),
       literal_pool_(literal_pool),
-      deletion_policy_(deletion_policy) {
+      deletion_policy_(deletion_policy),
+      has_relocation_(false),
+      relocation_symbol_(0),
+      relocation_addend_(0) {
   VIXL_ASSERT((deletion_policy == kManuallyDeleted) || (literal_pool_ != NULL));
   if (deletion_policy == kDeletedOnPoolDestruction) {
     literal_pool_->DeleteOnDestruction(this);
@@ -50,7 +53,85 @@ RawLiteral::RawLiteral(size_t size,
 }
 
 
-void Assembler::Reset() { GetBuffer()->Reset(); }
+void Relocation::Apply(byte* code, const uintptr_t* symbols) const {
+  uint64_t base = (symbol == kCodeStart) ? reinterpret_cast<uintptr_t>(code)
+                                         : symbols[symbol];
+  uint64_t value = base + addend;
+  switch (type) {
+    case kData64:
+      memcpy(code + offset, &value, sizeof(value));
+      break;
+    case kMovWide64: {
+      Instruction* instr = reinterpret_cast<Instruction*>(code + offset);
+      for (int i = 0; i < 4; i++) {
+        VIXL_ASSERT(instr->Mask(MoveWideImmediateMask) ==
+                    ((i == 0) ? MOVZ_x : MOVK_x));
+        VIXL_ASSERT(instr->GetShiftMoveWide() == i);
+        uint64_t imm16 = (value >> (16 * i)) & 0xffff;
+        instr->SetInstructionBits(
+            (instr->GetInstructionBits() & ~ImmMoveWide_mask) |
+            Assembler::ImmMoveWide(imm16));
+        instr = instr->GetNextInstruction();
+      }
+      break;
+    }
+    default:
+      VIXL_UNREACHABLE();
+  }
+}
+
+
+bool Relocation::CanApply(const byte* code,
+                          size_t code_size,
+                          size_t symbol_count) const {
+  if ((symbol != kCodeStart) && (symbol >= symbol_count)) return false;
+  switch (type) {
+    case kData64:
+      return (code_size >= sizeof(uint64_t)) &&
+             (offset <= (code_size - sizeof(uint64_t)));
+    case kMovWide64: {
+      const size_t size = 4 * kInstructionSize;
+      if ((code_size < size) || (offset > (code_size - size)) ||
+          !IsAligned(offset, kInstructionSize)) {
+        return false;
+      }
+      const Instruction* instr =
+          reinterpret_cast<const Instruction*>(code + offset);
+      int rd = instr->GetRd();
+      for (int i = 0; i < 4; i++) {
+        if ((instr->Mask(MoveWideImmediateMask) !=
+             ((i == 0) ? MOVZ_x : MOVK_x)) ||
+            (instr->GetShiftMoveWide() != i) || (instr->GetRd() != rd)) {
+          return false;
+        }
+        instr = instr->GetNextInstruction();
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void Assembler::Reset() {
+  GetBuffer()->Reset();
+  relocations_.clear();
+}
+
+
+void Assembler::RecordRelocation(ptrdiff_t offset,
+                                 Relocation::Type type,
+                                 uint32_t symbol,
+                                 int64_t addend) {
+  VIXL_ASSERT((offset >= 0) && (offset <= GetCursorOffset()));
+  VIXL_ASSERT(relocations_.empty() || (relocations_.back().offset < offset));
+  Relocation relocation;
+  relocation.offset = static_cast<uint32_t>(offset);
+  relocation.type = type;
+  relocation.symbol = symbol;
+  relocation.addend = addend;
+  relocations_.push_back(relocation);
+}
 
 
 void Assembler::bind(Label* label) {
@@ -87,7 +168,7 @@ ptrdiff_t Assembler::LinkAndGetOffsetTo(Label* label) {
     uintptr_t label_offset = GetLabelAddress<uintptr_t>(label) >> element_shift;
     return label_offset - pc_offset;
   } else {
-    label->AddLink(GetBuffer()->GetCursorOffset());
+    label->AddLink(GetBuffer()->GetCursorOffset(), arena_);
     return 0;
   }
 }
@@ -131,6 +212,12 @@ void Assembler::place(RawLiteral* literal) {
 
   // "bind" the literal.
   literal->SetOffset(GetCursorOffset());
+  if (literal->HasRelocation()) {
+    RecordRelocation(GetCursorOffset(),
+                     Relocation::kData64,
+                     literal->relocation_symbol_,
+                     literal->relocation_addend_);
+  }
   // Copy the data into the pool.
   switch (literal->GetSize()) {
     case kSRegSizeInBytes:
@@ -6831,8 +6918,6 @@ bool Assembler::IsImmLogical(uint64_t value,
   VIXL_ASSERT((width == kBRegSize) || (width == kHRegSize) ||
               (width == kSRegSize) || (width == kDRegSize));
 
-  bool negate = false;
-
   // Logical immediates are encoded using parameters n, imm_s and imm_r using
   // the following table:
   //
@@ -6851,24 +6936,11 @@ bool Assembler::IsImmLogical(uint64_t value,
   //
   // Put another way: the basic format of a logical immediate is a single
   // contiguous stretch of 1 bits, repeated across the whole word at intervals
-  // given by a power of 2. To identify them quickly, we first locate the
-  // lowest stretch of 1 bits, then the next 1 bit above that; that combination
-  // is different for every logical immediate, so it gives us all the
-  // information we need to identify the only logical immediate that our input
-  // could be, and then we simply check if that's the value we actually have.
-  //
-  // (The rotation parameter does give the possibility of the stretch of 1 bits
-  // going 'round the end' of the word. To deal with that, we observe that in
-  // any situation where that happens the bitwise NOT of the value is also a
-  // valid logical immediate. So we simply invert the input whenever its low bit
-  // is set, and then we know that the rotated case can't arise.)
-
-  if (value & 1) {
-    // If the low bit is 1, negate the value, and set a flag to remember that we
-    // did (so that we can adjust the return values appropriately).
-    negate = true;
-    value = ~value;
-  }
+  // given by a power of 2. To identify them quickly, we rotate the value so
+  // that one of these stretches ends up in the low bits, read the length of
+  // the stretch and of the run of 0 bits above it, and check that the value
+  // repeats with that period. This only needs a few bit-counting operations
+  // and no loops or tables.
 
   if (width <= kWRegSize) {
     // To handle 8/16/32-bit logical immediates, the very easiest thing is to repeat
@@ -6884,127 +6956,53 @@ bool Assembler::IsImmLogical(uint64_t value,
     }
   }
 
-  // The basic analysis idea: imagine our input word looks like this.
-  //
-  //    0011111000111110001111100011111000111110001111100011111000111110
-  //                                                          c  b    a
-  //                                                          |<--d-->|
-  //
-  // We find the lowest set bit (as an actual power-of-2 value, not its index)
-  // and call it a. Then we add a to our original number, which wipes out the
-  // bottommost stretch of set bits and replaces it with a 1 carried into the
-  // next zero bit. Then we look for the new lowest set bit, which is in
-  // position b, and subtract it, so now our number is just like the original
-  // but with the lowest stretch of set bits completely gone. Now we find the
-  // lowest set bit again, which is position c in the diagram above. Then we'll
-  // measure the distance d between bit positions a and c (using CLZ), and that
-  // tells us that the only valid logical immediate that could possibly be equal
-  // to this number is the one in which a stretch of bits running from a to just
-  // below b is replicated every d bits.
-  uint64_t a = LowestSetBit(value);
-  uint64_t value_plus_a = value + a;
-  uint64_t b = LowestSetBit(value_plus_a);
-  uint64_t value_plus_a_minus_b = value_plus_a - b;
-  uint64_t c = LowestSetBit(value_plus_a_minus_b);
-
-  int d, clz_a, out_n;
-  uint64_t mask;
-
-  if (c != 0) {
-    // The general case, in which there is more than one stretch of set bits.
-    // Compute the repeat distance d, and set up a bitmask covering the basic
-    // unit of repetition (i.e. a word with the bottom d bits set). Also, in all
-    // of these cases the N bit of the output will be zero.
-    clz_a = CountLeadingZeros(a, kXRegSize);
-    int clz_c = CountLeadingZeros(c, kXRegSize);
-    d = clz_a - clz_c;
-    mask = ((UINT64_C(1) << d) - 1);
-    out_n = 0;
-  } else {
-    // Handle degenerate cases.
-    //
-    // If any of those 'find lowest set bit' operations didn't find a set bit at
-    // all, then the word will have been zero thereafter, so in particular the
-    // last lowest_set_bit operation will have returned zero. So we can test for
-    // all the special case conditions in one go by seeing if c is zero.
-    if (a == 0) {
-      // The input was zero (or all 1 bits, which will come to here too after we
-      // inverted it at the start of the function), for which we just return
-      // false.
-      return false;
-    } else {
-      // Otherwise, if c was zero but a was not, then there's just one stretch
-      // of set bits in our word, meaning that we have the trivial case of
-      // d == 64 and only one 'repetition'. Set up all the same variables as in
-      // the general case above, and set the N bit in the output.
-      clz_a = CountLeadingZeros(a, kXRegSize);
-      d = 64;
-      mask = ~UINT64_C(0);
-      out_n = 1;
-    }
-  }
-
-  // If the repeat period d is not a power of two, it can't be encoded.
-  if (!IsPowerOf2(d)) {
-    return false;
-  }
-
-  if (((b - a) & ~mask) != 0) {
-    // If the bit stretch (b - a) does not fit within the mask derived from the
-    // repeat period, then fail.
+  // Zero and all 1 bits have no stretch of 1 bits followed by a 0 bit, and
+  // can't be encoded.
+  if ((value == 0) || (~value == 0)) {
     return false;
   }
 
-  // The only possible option is b - a repeated every d bits. Now we're going to
-  // actually construct the valid logical immediate derived from that
-  // specification, and see if it equals our original input.
+  // The basic analysis idea: imagine our input word looks like this.
+  //
+  //    1100000000000111110000000000011111000000000001111100000000000111
+  //                                                     ^
+  //                                                     r
+  //
+  // A stretch of 1 bits may wrap around the end of the word, as it does here.
+  // We clear the trailing 1 bits (value & (value + 1)) and count the trailing
+  // zeros, which gives the position r of the lowest stretch that doesn't wrap
+  // (or 64 if there is none, when the value is a single stretch starting at
+  // bit 0). Rotating right by r moves that stretch to the bottom of the word:
+  //
+  //    0000000000011111000000000001111100000000000111110000000000011111
+  //    |<-- z -->|                                                |<o>|
   //
-  // To repeat a value every d bits, we multiply it by a number of the form
-  // (1 + 2^d + 2^(2d) + ...), i.e. 0x0001000100010001 or similar. These can
-  // be derived using a table lookup on CLZ(d).
-  static const uint64_t multipliers[] = {
-      0x0000000000000001UL,
-      0x0000000100000001UL,
-      0x0001000100010001UL,
-      0x0101010101010101UL,
-      0x1111111111111111UL,
-      0x5555555555555555UL,
-  };
-  uint64_t multiplier = multipliers[CountLeadingZeros(d, kXRegSize) - 57];
-  uint64_t candidate = (b - a) * multiplier;
-
-  if (value != candidate) {
-    // The candidate pattern doesn't match our input value, so fail.
+  // If the value is a logical immediate, this normalised value repeats a
+  // basic unit made of o 1 bits at the bottom and z 0 bits at the top, so the
+  // repeat period is d = z + o. That is the case if and only if rotating the
+  // value by d leaves it unchanged. d is then a power of 2, since the value
+  // also repeats every 64 bits, and a shorter common period would split the
+  // stretch of 1 bits.
+
+  int r = CountTrailingZeros(value & (value + 1));
+  uint64_t normalized = RotateRight(value, r & 63, kXRegSize);
+  int z = CountLeadingZeros(normalized);
+  int o = CountTrailingZeros(~normalized);
+  int d = z + o;
+
+  if (RotateRight(value, d & 63, kXRegSize) != value) {
     return false;
   }
 
   // We have a match! This is a valid logical immediate, so now we have to
   // construct the bits and pieces of the instruction encoding that generates
   // it.
-
-  // Count the set bits in our basic stretch. The special case of clz(0) == -1
-  // makes the answer come out right for stretches that reach the very top of
-  // the word (e.g. numbers like 0xffffc00000000000).
-  int clz_b = (b == 0) ? -1 : CountLeadingZeros(b, kXRegSize);
-  int s = clz_a - clz_b;
-
-  // Decide how many bits to rotate right by, to put the low bit of that basic
-  // stretch in position a.
-  int r;
-  if (negate) {
-    // If we inverted the input right at the start of this function, here's
-    // where we compensate: the number of set bits becomes the number of clear
-    // bits, and the rotation count is based on position b rather than position
-    // a (since b is the location of the 'lowest' 1 bit after inversion).
-    s = d - s;
-    r = (clz_b + 1) & (d - 1);
-  } else {
-    r = (clz_a + 1) & (d - 1);
-  }
-
-  // Now we're done, except for having to encode the S output in such a way that
-  // it gives both the number of set bits and the length of the repeated
-  // segment. The s field is encoded like this:
+  //
+  // The input value is the normalised pattern rotated left by r, which is the
+  // same as rotating it right by (-r mod d).
+  //
+  // The s field is encoded in such a way that it gives both the number of set
+  // bits and the length of the repeated segment:
   //
   //     imms    size        S
   //    ssssss    64    UInt(ssssss)
@@ -7014,11 +7012,12 @@ bool Assembler::IsImmLogical(uint64_t value,
   //    1110ss     4    UInt(ss)
   //    11110s     2    UInt(s)
   //
-  // So we 'or' (2 * -d) with our computed s to form imms.
+  // So we 'or' (2 * -d) with the number of set bits minus one to form imms.
+  // The n field is only set for a 64-bit repeat period.
   if ((n != NULL) || (imm_s != NULL) || (imm_r != NULL)) {
-    *n = out_n;
-    *imm_s = ((2 * -d) | (s - 1)) & 0x3f;
-    *imm_r = r;
+    *n = d >> 6;
+    *imm_s = ((2 * -d) | (o - 1)) & 0x3f;
+    *imm_r = -r & (d - 1);
   }
 
   return true;
@@ -27,6 +27,9 @@
 #ifndef VIXL_AARCH64_ASSEMBLER_AARCH64_H_
 #define VIXL_AARCH64_ASSEMBLER_AARCH64_H_
 
+#include <vector>
+
+#include "../arena-vixl.h"
 #include "../assembler-base-vixl.h"
 #include "../code-generation-scopes-vixl.h"
 #include "../cpu-features.h"
@@ -96,10 +99,11 @@ class Label {
     location_ = location;
   }
 
-  void AddLink(ptrdiff_t instruction) {
+  void AddLink(ptrdiff_t instruction, Arena* arena = NULL) {
     // If a label is bound, the assembler already has the information it needs
     // to write the instruction, so there is no need to add it to links_.
     VIXL_ASSERT(!IsBound());
+    links_.SetArena(arena);
     links_.insert(instruction);
   }
 
@@ -162,6 +166,42 @@ class Label {
 class Assembler;
 class LiteralPool;
 
+// A value in the generated code which depends on the address the code is
+// loaded at, or on the address of something outside the code. Relocations are
+// recorded by the Assembler (see `RecordRelocation()`), and must be applied
+// whenever the code is moved or the external addresses change, for example
+// when it is reloaded in another process.
+struct Relocation {
+  enum Type {
+    // A 64-bit address stored as data, for example in a literal.
+    kData64,
+    // A 64-bit address materialised by a MOVZ followed by three MOVKs, for
+    // bits 0-15, 16-31, 32-47 and 48-63 in that order.
+    kMovWide64
+  };
+
+  // The `symbol` of relocations relative to the start of the code itself.
+  static const uint32_t kCodeStart = 0xffffffff;
+
+  // Write the address of `symbol`, plus `addend`, at `offset` in `code`.
+  // Symbols other than kCodeStart are looked up in `symbols`, which are the
+  // addresses of the external symbols, indexed by the user-chosen symbol
+  // indices given when the relocations were recorded.
+  void Apply(byte* code, const uintptr_t* symbols) const;
+
+  // Return whether the relocation can be applied to `code`, of `code_size`
+  // bytes, with `symbol_count` external symbols: it must have a known type,
+  // lie within the code, and for kMovWide64 it must be aligned and describe
+  // the instruction sequence that is actually there. This is meant to check
+  // relocations read from untrusted storage before applying any of them.
+  bool CanApply(const byte* code, size_t code_size, size_t symbol_count) const;
+
+  uint32_t offset;
+  uint32_t type;
+  uint32_t symbol;
+  int64_t addend;
+};
+
 // A literal is a 32-bit or 64-bit piece of data stored in the instruction
 // stream and loaded through a pc relative load. The same literal can be
 // referred to by multiple instructions but a literal can only reside at one
@@ -242,6 +282,18 @@ class RawLiteral {
 
   LiteralPool* GetLiteralPool() const { return literal_pool_; }
 
+  // Mark the literal as holding the address of `symbol`, plus `addend`. A
+  // kData64 relocation is recorded when the literal is placed. The literal
+  // must be 64 bits wide, and must not have been placed yet.
+  void SetRelocation(uint32_t symbol, int64_t addend = 0) {
+    VIXL_ASSERT(size_ == kXRegSizeInBytes);
+    VIXL_ASSERT(!IsPlaced());
+    has_relocation_ = true;
+    relocation_symbol_ = symbol;
+    relocation_addend_ = addend;
+  }
+  bool HasRelocation() const { return has_relocation_; }
+
   ptrdiff_t GetOffset() const {
     VIXL_ASSERT(IsPlaced());
     return offset_ - 1;
@@ -283,6 +335,9 @@ class RawLiteral {
  private:
   LiteralPool* literal_pool_;
   DeletionPolicy deletion_policy_;
+  bool has_relocation_;
+  uint32_t relocation_symbol_;
+  int64_t relocation_addend_;
 
   friend class Assembler;
   friend class LiteralPool;
@@ -406,19 +461,32 @@ class Assembler : public vixl::internal::AssemblerBase {
  public:
   explicit Assembler(
       PositionIndependentCodeOption pic = PositionIndependentCode)
-      : pic_(pic), cpu_features_(CPUFeatures::AArch64LegacyBaseline()) {}
+      : pic_(pic),
+        cpu_features_(CPUFeatures::AArch64LegacyBaseline()),
+        arena_(NULL) {}
   explicit Assembler(
       size_t capacity,
       PositionIndependentCodeOption pic = PositionIndependentCode)
       : AssemblerBase(capacity),
         pic_(pic),
-        cpu_features_(CPUFeatures::AArch64LegacyBaseline()) {}
+        cpu_features_(CPUFeatures::AArch64LegacyBaseline()),
+        arena_(NULL) {}
   Assembler(byte* buffer,
             size_t capacity,
             PositionIndependentCodeOption pic = PositionIndependentCode)
       : AssemblerBase(buffer, capacity),
         pic_(pic),
-        cpu_features_(CPUFeatures::AArch64LegacyBaseline()) {}
+        cpu_features_(CPUFeatures::AArch64LegacyBaseline()),
+        arena_(NULL) {}
+  // Emit into a chunk of `shared`, initially of `capacity` bytes. Several
+  // Assemblers can do this concurrently, from different threads.
+  Assembler(SharedCodeBuffer* shared,
+            size_t capacity,
+            PositionIndependentCodeOption pic = PositionIndependentCode)
+      : AssemblerBase(shared, capacity),
+        pic_(pic),
+        cpu_features_(CPUFeatures::AArch64LegacyBaseline()),
+        arena_(NULL) {}
 
   // Upon destruction, the code will assert that one of the following is true:
   //  * The Assembler object has not been used.
@@ -441,6 +509,18 @@ class Assembler : public vixl::internal::AssemblerBase {
   // Place a literal at the current PC.
   void place(RawLiteral* literal);
 
+  // Record that the value of `type` at `offset` in the buffer is the address
+  // of `symbol` plus `addend`. `symbol` is either Relocation::kCodeStart or an
+  // index chosen by the user to identify an external symbol. Relocations must
+  // be recorded in order of increasing offset, and are discarded by Reset().
+  void RecordRelocation(ptrdiff_t offset,
+                        Relocation::Type type,
+                        uint32_t symbol,
+                        int64_t addend = 0);
+  const std::vector<Relocation>& GetRelocations() const {
+    return relocations_;
+  }
+
   VIXL_DEPRECATED("GetCursorOffset", ptrdiff_t CursorOffset() const) {
     return GetCursorOffset();
   }
@@ -7941,6 +8021,9 @@ class Assembler : public vixl::internal::AssemblerBase {
     cpu_features_ = cpu_features;
   }
 
+  // The arena used for label links, or NULL if they use the global allocator.
+  Arena* GetArena() const { return arena_; }
+
   bool AllowPageOffsetDependentCode() const {
     return (GetPic() == PageOffsetDependentCode) ||
            (GetPic() == PositionDependentCode);
@@ -7951,6 +8034,10 @@ class Assembler : public vixl::internal::AssemblerBase {
   }
 
  protected:
+  // Allocate label links from `arena`. This should be set before any label is
+  // linked.
+  void SetArena(Arena* arena) { arena_ = arena; }
+
   void LoadStore(const CPURegister& rt,
                  const MemOperand& addr,
                  LoadStoreOp op,
@@ -8433,6 +8520,12 @@ class Assembler : public vixl::internal::AssemblerBase {
   PositionIndependentCodeOption pic_;
 
   CPUFeatures cpu_features_;
+
+  // If not NULL, the arena from which label links are allocated.
+  Arena* arena_;
+
+  // The relocations recorded since the last Reset().
+  std::vector<Relocation> relocations_;
 };
 
 
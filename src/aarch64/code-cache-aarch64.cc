@@ -0,0 +1,305 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifdef VIXL_CODE_BUFFER_MMAP
+extern "C" {
+#include <sys/mman.h>
+#include <unistd.h>
+}
+#endif
+
+#include <algorithm>
+
+#include "code-cache-aarch64.h"
+#include "cpu-aarch64.h"
+#include "instructions-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+
+CodeCache::CodeCache(size_t capacity)
+    : capacity_(AlignUp(capacity, kMinChunkSize)),
+      memory_fd_(-1),
+      writable_(NULL),
+      executable_(NULL),
+      top_(0) {
+  VIXL_ASSERT(capacity_ > 0);
+#if defined(VIXL_CODE_BUFFER_MMAP) && defined(__linux__)
+  memory_fd_ = memfd_create("vixl-code-cache", MFD_CLOEXEC);
+  VIXL_CHECK(memory_fd_ >= 0);
+  VIXL_CHECK(ftruncate(memory_fd_, capacity_) == 0);
+  void* writable = mmap(NULL,
+                        capacity_,
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED,
+                        memory_fd_,
+                        0);
+  VIXL_CHECK(writable != MAP_FAILED);
+  void* executable =
+      mmap(NULL, capacity_, PROT_READ | PROT_EXEC, MAP_SHARED, memory_fd_, 0);
+  VIXL_CHECK(executable != MAP_FAILED);
+  writable_ = static_cast<byte*>(writable);
+  executable_ = static_cast<byte*>(executable);
+#else
+  // This requires memory files, and mapping them with mmap.
+  VIXL_UNIMPLEMENTED();
+#endif
+  free_chunks_.resize(GetSizeClass(capacity_) + 1);
+}
+
+
+CodeCache::~CodeCache() {
+#if defined(VIXL_CODE_BUFFER_MMAP) && defined(__linux__)
+  munmap(writable_, capacity_);
+  munmap(executable_, capacity_);
+  close(memory_fd_);
+#endif
+}
+
+
+CodeCache::Handle CodeCache::Install(const byte* code,
+                                     size_t size,
+                                     InstallOption option) {
+  if ((option == kMovable) && !IsPositionIndependent(code, size)) {
+    return Handle();
+  }
+  unsigned size_class = GetSizeClass(size);
+  size_t offset;
+  if (!AllocateChunk(size_class, &offset)) return Handle();
+
+  memcpy(writable_ + offset, code, size);
+  Range range = {offset, size};
+  pending_ranges_.push_back(range);
+  return AddEntry(offset,
+                  GetSizeClassChunkSize(size_class),
+                  size,
+                  option == kMovable);
+}
+
+
+CodeCache::Handle CodeCache::Reserve(size_t size) {
+  unsigned size_class = GetSizeClass(size);
+  size_t offset;
+  if (!AllocateChunk(size_class, &offset)) return Handle();
+  return AddEntry(offset, GetSizeClassChunkSize(size_class), 0, false);
+}
+
+
+void CodeCache::Commit(Handle handle, size_t size) {
+  Entry* entry = &entries_[handle.index_];
+  VIXL_ASSERT(entry->live && !entry->movable);
+  VIXL_ASSERT(size <= entry->chunk_size);
+  entry->size = size;
+  Range range = {entry->offset, size};
+  pending_ranges_.push_back(range);
+}
+
+
+void CodeCache::Free(Handle handle) {
+  Entry* entry = &entries_[handle.index_];
+  VIXL_ASSERT(entry->live);
+  entry->live = false;
+  free_entries_.push_back(handle.index_);
+  if ((entry->offset + entry->chunk_size) == top_) {
+    // Give the space back to the unused end of the region.
+    top_ = entry->offset;
+  } else {
+    free_chunks_[GetSizeClass(entry->chunk_size)].push_back(entry->offset);
+  }
+}
+
+
+void CodeCache::Compact() {
+  std::vector<uint32_t> live;
+  for (uint32_t i = 0; i < entries_.size(); i++) {
+    if (entries_[i].live) live.push_back(i);
+  }
+  std::sort(live.begin(), live.end(), [this](uint32_t a, uint32_t b) {
+    return entries_[a].offset < entries_[b].offset;
+  });
+
+  for (size_t i = 0; i < free_chunks_.size(); i++) {
+    free_chunks_[i].clear();
+  }
+
+  // Slide movable code down over the gaps. Pinned code stays where it is, and
+  // the gap before it, if any, is turned into free chunks. Code only ever
+  // moves to lower addresses, so it never overwrites code yet to be moved.
+  size_t cursor = 0;
+  for (size_t i = 0; i < live.size(); i++) {
+    Entry* entry = &entries_[live[i]];
+    VIXL_ASSERT(entry->offset >= cursor);
+    if (!entry->movable) {
+      AddFreeChunks(cursor, entry->offset - cursor);
+    } else if (entry->offset != cursor) {
+      memmove(writable_ + cursor, writable_ + entry->offset, entry->size);
+      entry->offset = cursor;
+      Range range = {cursor, entry->size};
+      pending_ranges_.push_back(range);
+    }
+    cursor = entry->offset + entry->chunk_size;
+  }
+  top_ = cursor;
+}
+
+
+void CodeCache::EnsureIAndDCacheCoherency() {
+  if (pending_ranges_.empty()) return;
+
+  // Maintain all the pending ranges in one batch; overlapping and adjacent
+  // ranges are merged there, and the barriers are only issued once.
+  std::vector<CPU::CodeRange> ranges;
+  ranges.reserve(pending_ranges_.size());
+  for (size_t i = 0; i < pending_ranges_.size(); i++) {
+    CPU::CodeRange range = {executable_ + pending_ranges_[i].offset,
+                            pending_ranges_[i].size};
+    ranges.push_back(range);
+  }
+  CPU::EnsureIAndDCacheCoherency(ranges.data(), ranges.size());
+  pending_ranges_.clear();
+}
+
+
+CodeCacheStatistics CodeCache::GetStatistics() const {
+  CodeCacheStatistics statistics;
+  statistics.capacity = capacity_;
+  statistics.used_bytes = top_;
+  statistics.allocated_bytes = 0;
+  statistics.live_bytes = 0;
+  statistics.free_bytes = 0;
+  statistics.live_functions = 0;
+  for (size_t i = 0; i < entries_.size(); i++) {
+    if (!entries_[i].live) continue;
+    statistics.allocated_bytes += entries_[i].chunk_size;
+    statistics.live_bytes += entries_[i].size;
+    statistics.live_functions++;
+  }
+  for (unsigned i = 0; i < free_chunks_.size(); i++) {
+    statistics.free_bytes += free_chunks_[i].size() * GetSizeClassChunkSize(i);
+  }
+  VIXL_ASSERT(statistics.used_bytes ==
+              (statistics.allocated_bytes + statistics.free_bytes));
+  return statistics;
+}
+
+
+bool CodeCache::IsPositionIndependent(const byte* code, size_t size) {
+  VIXL_ASSERT(IsAligned(size, kInstructionSize));
+  const Instruction* start = reinterpret_cast<const Instruction*>(code);
+  const Instruction* end = reinterpret_cast<const Instruction*>(code + size);
+  for (const Instruction* instr = start; instr < end;
+       instr = instr->GetNextInstruction()) {
+    const Instruction* target;
+    if (instr->IsPCRelAddressing()) {
+      if (instr->Mask(PCRelAddressingMask) == ADRP) return false;
+      target = instr->GetImmPCOffsetTarget();
+    } else if (instr->IsImmBranch()) {
+      target = instr->GetImmPCOffsetTarget();
+    } else if (instr->IsLoadLiteral()) {
+      target = instr->GetLiteralAddress<const Instruction*>();
+    } else {
+      continue;
+    }
+    if ((target < start) || (target > end)) return false;
+  }
+  return true;
+}
+
+
+unsigned CodeCache::GetSizeClass(size_t size) {
+  unsigned size_class = 0;
+  while (GetSizeClassChunkSize(size_class) < size) size_class++;
+  return size_class;
+}
+
+
+bool CodeCache::AllocateChunk(unsigned size_class, size_t* offset) {
+  if (size_class >= free_chunks_.size()) return false;
+
+  std::vector<size_t>* free_chunks = &free_chunks_[size_class];
+  if (!free_chunks->empty()) {
+    *offset = free_chunks->back();
+    free_chunks->pop_back();
+    return true;
+  }
+
+  size_t chunk_size = GetSizeClassChunkSize(size_class);
+  if ((capacity_ - top_) >= chunk_size) {
+    *offset = top_;
+    top_ += chunk_size;
+    return true;
+  }
+
+  // Split a larger free chunk, keeping the remainder on the free lists.
+  for (unsigned larger = size_class + 1; larger < free_chunks_.size();
+       larger++) {
+    if (!free_chunks_[larger].empty()) {
+      *offset = free_chunks_[larger].back();
+      free_chunks_[larger].pop_back();
+      AddFreeChunks(*offset + chunk_size,
+                    GetSizeClassChunkSize(larger) - chunk_size);
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void CodeCache::AddFreeChunks(size_t offset, size_t size) {
+  VIXL_ASSERT(IsAligned(offset, kMinChunkSize));
+  VIXL_ASSERT(IsAligned(size, kMinChunkSize));
+  while (size > 0) {
+    unsigned size_class = GetSizeClass(size);
+    if (GetSizeClassChunkSize(size_class) > size) size_class--;
+    free_chunks_[size_class].push_back(offset);
+    offset += GetSizeClassChunkSize(size_class);
+    size -= GetSizeClassChunkSize(size_class);
+  }
+}
+
+
+CodeCache::Handle CodeCache::AddEntry(size_t offset,
+                                      size_t chunk_size,
+                                      size_t size,
+                                      bool movable) {
+  Entry entry = {offset, chunk_size, size, movable, true};
+  uint32_t index;
+  if (free_entries_.empty()) {
+    index = static_cast<uint32_t>(entries_.size());
+    entries_.push_back(entry);
+  } else {
+    index = free_entries_.back();
+    free_entries_.pop_back();
+    entries_[index] = entry;
+  }
+  return Handle(index);
+}
+
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -0,0 +1,231 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIXL_AARCH64_CODE_CACHE_AARCH64_H_
+#define VIXL_AARCH64_CODE_CACHE_AARCH64_H_
+
+#include <cstring>
+#include <vector>
+
+#include "../code-buffer-vixl.h"
+#include "../globals-vixl.h"
+
+namespace vixl {
+namespace aarch64 {
+
+// Statistics about the memory used by a CodeCache.
+struct CodeCacheStatistics {
+  // The size of the region reserved for the cache.
+  size_t capacity;
+  // The number of bytes at the start of the region that have been handed out
+  // as chunks, whether they are live or free.
+  size_t used_bytes;
+  // The size of the live chunks, and of the code they contain.
+  size_t allocated_bytes;
+  size_t live_bytes;
+  // The size of the free chunks, available for reuse.
+  size_t free_bytes;
+  size_t live_functions;
+
+  // The fraction of the used region that does not hold live code, either
+  // because it is free or because it is at the end of a partially used chunk.
+  double GetFragmentation() const {
+    if (used_bytes == 0) return 0.0;
+    return 1.0 - (static_cast<double>(live_bytes) / used_bytes);
+  }
+};
+
+// A shared executable region holding many generated functions.
+//
+// The region is reserved up front and carved into chunks whose sizes are
+// powers of two, starting at `kMinChunkSize`. Freed chunks are kept on one
+// free list per size class and reused for later functions of that class.
+//
+// The region is backed by a memory file mapped twice, so that code can be
+// written without ever making executable memory writable: code is written
+// through a writable view and run from an executable view. Code written to
+// the cache is only guaranteed to be visible to instruction fetch after a call
+// to `EnsureIAndDCacheCoherency()`, which performs the cache maintenance for
+// all the code written since the previous call at once.
+//
+// Functions are referred to by handles rather than addresses, so that
+// `Compact()` can move them.
+//
+// The code cache requires VIXL_CODE_BUFFER_MMAP on Linux.
+class CodeCache {
+ public:
+  static const size_t kDefaultCapacity = 16 * MBytes;
+  static const size_t kMinChunkSize = 64;
+
+  class Handle {
+   public:
+    Handle() : index_(kInvalidIndex) {}
+
+    bool IsValid() const { return index_ != kInvalidIndex; }
+
+   private:
+    static const uint32_t kInvalidIndex = 0xffffffff;
+
+    explicit Handle(uint32_t index) : index_(index) {}
+
+    uint32_t index_;
+
+    friend class CodeCache;
+  };
+
+  enum InstallOption {
+    // Check that PC-relative instructions in the code only refer to the code
+    // itself. Such code can be moved by `Compact()`.
+    kMovable,
+    // Do not check the code, for example because it contains data, such as
+    // literal pools, that could be mistaken for PC-relative instructions. The
+    // code is never moved.
+    kPinned
+  };
+
+  explicit CodeCache(size_t capacity = kDefaultCapacity);
+  ~CodeCache();
+
+  // Copy `size` bytes of code into the cache. This returns an invalid handle
+  // if the cache is full or, with `kMovable`, if the code refers to memory
+  // outside itself.
+  Handle Install(const byte* code,
+                 size_t size,
+                 InstallOption option = kMovable);
+  Handle Install(const CodeBuffer& buffer, InstallOption option = kMovable) {
+    return Install(buffer.GetStartAddress<const byte*>(),
+                   buffer.GetSizeInBytes(),
+                   option);
+  }
+
+  // Reserve a chunk of at least `size` bytes, so that code can be generated
+  // directly at its final location, for example with a MacroAssembler using
+  // `GetWritableAddress(handle)` and `GetChunkSize(handle)` as its buffer.
+  // Once done, call `Commit()` with the size of the generated code. Code
+  // generated in place is pinned. This returns an invalid handle if the cache
+  // is full.
+  Handle Reserve(size_t size);
+  void Commit(Handle handle, size_t size);
+
+  // Release the chunk used by `handle`. The handle must not be used again.
+  void Free(Handle handle);
+
+  // Move movable code towards the start of the region, so that the space
+  // freed by dead code can be reused by any size class. This changes the
+  // entry points of moved code. No code in the cache may be running, and
+  // `EnsureIAndDCacheCoherency()` must be called before any code runs again.
+  void Compact();
+
+  // Make all code installed, committed or moved since the previous call
+  // visible to instruction fetch.
+  void EnsureIAndDCacheCoherency();
+
+  // Return the address of `offset` bytes into the code for `handle`, in the
+  // executable view.
+  template <typename T>
+  T GetEntryPoint(Handle handle, ptrdiff_t offset = 0) const {
+    VIXL_ASSERT((offset >= 0) &&
+                (static_cast<size_t>(offset) <= GetSize(handle)));
+    const byte* address = executable_ + GetEntry(handle).offset + offset;
+    T entry_point;
+    VIXL_STATIC_ASSERT(sizeof(T) == sizeof(address));
+    memcpy(&entry_point, &address, sizeof(T));
+    return entry_point;
+  }
+
+  byte* GetWritableAddress(Handle handle) const {
+    return writable_ + GetEntry(handle).offset;
+  }
+
+  // The size of the code for `handle`, and of the chunk holding it.
+  size_t GetSize(Handle handle) const { return GetEntry(handle).size; }
+  size_t GetChunkSize(Handle handle) const {
+    return GetEntry(handle).chunk_size;
+  }
+
+  size_t GetCapacity() const { return capacity_; }
+
+  CodeCacheStatistics GetStatistics() const;
+
+  // Return whether all PC-relative instructions in `code` refer to `code`
+  // itself, so that it can be copied anywhere. ADRP instructions are never
+  // considered position-independent, since their result depends on the page
+  // holding the code.
+  static bool IsPositionIndependent(const byte* code, size_t size);
+
+ private:
+  struct Entry {
+    size_t offset;
+    size_t chunk_size;
+    size_t size;
+    bool movable;
+    bool live;
+  };
+
+  struct Range {
+    size_t offset;
+    size_t size;
+  };
+
+  const Entry& GetEntry(Handle handle) const {
+    VIXL_ASSERT(handle.index_ < entries_.size());
+    VIXL_ASSERT(entries_[handle.index_].live);
+    return entries_[handle.index_];
+  }
+
+  static unsigned GetSizeClass(size_t size);
+  static size_t GetSizeClassChunkSize(unsigned size_class) {
+    return kMinChunkSize << size_class;
+  }
+
+  // Find a chunk of the given size class, from the free lists or from the
+  // unused end of the region. Returns false if there is no space.
+  bool AllocateChunk(unsigned size_class, size_t* offset);
+  // Split the gap [offset, offset + size) into free chunks.
+  void AddFreeChunks(size_t offset, size_t size);
+  Handle AddEntry(size_t offset, size_t chunk_size, size_t size, bool movable);
+
+  size_t capacity_;
+  int memory_fd_;
+  byte* writable_;
+  byte* executable_;
+
+  // The end of the part of the region handed out as chunks.
+  size_t top_;
+
+  std::vector<Entry> entries_;
+  std::vector<uint32_t> free_entries_;
+  // Offsets of the free chunks, for each size class.
+  std::vector<std::vector<size_t> > free_chunks_;
+  // Code written since the last call to EnsureIAndDCacheCoherency().
+  std::vector<Range> pending_ranges_;
+};
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_CODE_CACHE_AARCH64_H_
@@ -0,0 +1,472 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifdef __linux__
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+}
+#endif
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+
+#include "code-registry-aarch64.h"
+
+#ifdef __linux__
+// The GDB JIT interface. GDB sets a breakpoint in `__jit_debug_register_code`,
+// and reads the registered ELF images from `__jit_debug_descriptor`. The
+// definitions are weak so that they can be shared with other JITs in the same
+// program.
+extern "C" {
+struct jit_code_entry {
+  jit_code_entry* next_entry;
+  jit_code_entry* prev_entry;
+  const char* symfile_addr;
+  uint64_t symfile_size;
+};
+
+struct jit_descriptor {
+  uint32_t version;
+  uint32_t action_flag;
+  jit_code_entry* relevant_entry;
+  jit_code_entry* first_entry;
+};
+
+__attribute__((weak, noinline)) void __jit_debug_register_code() {
+  __asm__ __volatile__("" : : : "memory");
+}
+
+__attribute__((weak)) jit_descriptor __jit_debug_descriptor = {1,
+                                                               0,
+                                                               NULL,
+                                                               NULL};
+}
+#endif
+
+namespace vixl {
+namespace aarch64 {
+
+#ifdef __linux__
+
+struct CodeRegistry::GdbEntry {
+  jit_code_entry entry;
+  std::vector<uint8_t> image;
+};
+
+namespace {
+
+// The GDB descriptor is global, so it is protected by a global lock.
+std::mutex gdb_mutex;
+
+const uint32_t kGdbRegister = 1;
+const uint32_t kGdbUnregister = 2;
+
+// The jitdump format is described in
+// tools/perf/Documentation/jitdump-specification.txt in the Linux sources.
+const uint32_t kJitDumpMagic = 0x4a695444;
+const uint32_t kJitDumpVersion = 1;
+const uint32_t kJitDumpHeaderSize = 40;
+const uint32_t kJitDumpCodeLoad = 0;
+const uint32_t kJitDumpCodeClose = 3;
+
+const uint16_t kElfMachineAArch64 = 183;
+
+uint64_t GetTimestamp() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (static_cast<uint64_t>(ts.tv_sec) * 1000000000) + ts.tv_nsec;
+}
+
+// Append `value` to `out`, in little-endian order.
+template <typename T>
+void Append(std::vector<uint8_t>* out, T value) {
+  uint64_t bits = static_cast<uint64_t>(value);
+  for (size_t i = 0; i < sizeof(value); i++) {
+    out->push_back(static_cast<uint8_t>(bits >> (8 * i)));
+  }
+}
+
+void AppendString(std::vector<uint8_t>* out, const std::string& string) {
+  out->insert(out->end(), string.begin(), string.end());
+  out->push_back(0);
+}
+
+void WriteAll(int fd, const uint8_t* data, size_t size) {
+  while (size > 0) {
+    ssize_t written = write(fd, data, size);
+    if (written <= 0) return;
+    data += written;
+    size -= written;
+  }
+}
+
+// Build an ELF image describing `symbols` for GDB. The code is not copied:
+// .text is a NOBITS section at `address`, and the symbol values are relative
+// to it.
+void BuildGdbImage(uint64_t address,
+                   uint64_t size,
+                   const std::vector<std::string>& names,
+                   const std::vector<uint64_t>& offsets,
+                   const std::vector<uint64_t>& sizes,
+                   std::vector<uint8_t>* image) {
+  const uint16_t kSectionCount = 5;
+  const uint16_t kTextIndex = 1;
+  const size_t kElfHeaderSize = 64;
+  const size_t kSymbolSize = 24;
+  const size_t kSectionHeaderSize = 64;
+
+  std::vector<uint8_t> shstrtab;
+  shstrtab.push_back(0);
+  uint32_t text_name = static_cast<uint32_t>(shstrtab.size());
+  AppendString(&shstrtab, ".text");
+  uint32_t symtab_name = static_cast<uint32_t>(shstrtab.size());
+  AppendString(&shstrtab, ".symtab");
+  uint32_t strtab_name = static_cast<uint32_t>(shstrtab.size());
+  AppendString(&shstrtab, ".strtab");
+  uint32_t shstrtab_name = static_cast<uint32_t>(shstrtab.size());
+  AppendString(&shstrtab, ".shstrtab");
+
+  std::vector<uint8_t> strtab;
+  std::vector<uint8_t> symtab;
+  strtab.push_back(0);
+  symtab.resize(kSymbolSize, 0);
+  for (size_t i = 0; i < names.size(); i++) {
+    Append(&symtab, static_cast<uint32_t>(strtab.size()));  // st_name
+    Append(&symtab, static_cast<uint8_t>(0x12));  // STB_GLOBAL, STT_FUNC
+    Append(&symtab, static_cast<uint8_t>(0));     // st_other
+    Append(&symtab, kTextIndex);                  // st_shndx
+    Append(&symtab, offsets[i]);                  // st_value
+    Append(&symtab, sizes[i]);                    // st_size
+    AppendString(&strtab, names[i]);
+  }
+
+  uint64_t symtab_offset = kElfHeaderSize;
+  uint64_t strtab_offset = symtab_offset + symtab.size();
+  uint64_t shstrtab_offset = strtab_offset + strtab.size();
+  uint64_t sections_offset = AlignUp(shstrtab_offset + shstrtab.size(), 8);
+
+  image->clear();
+  const uint8_t ident[] = {0x7f, 'E', 'L', 'F', 2, 1, 1, 0};
+  image->insert(image->end(), ident, ident + sizeof(ident));
+  image->resize(16, 0);
+  Append(image, static_cast<uint16_t>(1));  // e_type: ET_REL
+  Append(image, kElfMachineAArch64);        // e_machine
+  Append(image, static_cast<uint32_t>(1));  // e_version
+  Append(image, static_cast<uint64_t>(0));  // e_entry
+  Append(image, static_cast<uint64_t>(0));  // e_phoff
+  Append(image, sections_offset);           // e_shoff
+  Append(image, static_cast<uint32_t>(0));  // e_flags
+  Append(image, static_cast<uint16_t>(kElfHeaderSize));
+  Append(image, static_cast<uint16_t>(0));  // e_phentsize
+  Append(image, static_cast<uint16_t>(0));  // e_phnum
+  Append(image, static_cast<uint16_t>(kSectionHeaderSize));
+  Append(image, kSectionCount);
+  Append(image, static_cast<uint16_t>(kSectionCount - 1));  // e_shstrndx
+  VIXL_ASSERT(image->size() == kElfHeaderSize);
+
+  image->insert(image->end(), symtab.begin(), symtab.end());
+  image->insert(image->end(), strtab.begin(), strtab.end());
+  image->insert(image->end(), shstrtab.begin(), shstrtab.end());
+  image->resize(sections_offset, 0);
+
+  struct SectionHeader {
+    uint32_t name;
+    uint32_t type;
+    uint64_t flags;
+    uint64_t addr;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t link;
+    uint32_t info;
+    uint64_t addralign;
+    uint64_t entsize;
+  };
+  const SectionHeader sections[kSectionCount] = {
+      {0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+      // .text: SHT_NOBITS, SHF_ALLOC | SHF_EXECINSTR.
+      {text_name, 8, 6, address, 0, size, 0, 0, 4, 0},
+      // .symtab: SHT_SYMTAB, linked to .strtab. All symbols but the first are
+      // global.
+      {symtab_name,
+       2,
+       0,
+       0,
+       symtab_offset,
+       symtab.size(),
+       3,
+       1,
+       8,
+       kSymbolSize},
+      // .strtab and .shstrtab: SHT_STRTAB.
+      {strtab_name, 3, 0, 0, strtab_offset, strtab.size(), 0, 0, 1, 0},
+      {shstrtab_name, 3, 0, 0, shstrtab_offset, shstrtab.size(), 0, 0, 1, 0},
+  };
+  for (const SectionHeader& section : sections) {
+    Append(image, section.name);
+    Append(image, section.type);
+    Append(image, section.flags);
+    Append(image, section.addr);
+    Append(image, section.offset);
+    Append(image, section.size);
+    Append(image, section.link);
+    Append(image, section.info);
+    Append(image, section.addralign);
+    Append(image, section.entsize);
+  }
+}
+
+}  // namespace
+
+
+CodeRegistry::CodeRegistry(int outputs, const char* directory)
+    : outputs_(outputs),
+      perf_map_(NULL),
+      jit_dump_fd_(-1),
+      jit_dump_marker_(NULL),
+      jit_dump_code_index_(0) {
+  std::string pid = std::to_string(getpid());
+  perf_map_path_ = std::string(directory) + "/perf-" + pid + ".map";
+  jit_dump_path_ = std::string(directory) + "/jit-" + pid + ".dump";
+
+  if ((outputs_ & kPerfMap) != 0) {
+    perf_map_ = fopen(perf_map_path_.c_str(), "a");
+  }
+
+  if ((outputs_ & kJitDump) != 0) {
+    jit_dump_fd_ = open(jit_dump_path_.c_str(),
+                        O_CREAT | O_TRUNC | O_RDWR | O_CLOEXEC,
+                        0666);
+    if (jit_dump_fd_ >= 0) {
+      // perf finds jitdump files through an executable mapping of them, which
+      // must stay alive while the profile is recorded.
+      long page_size = sysconf(_SC_PAGESIZE);
+      jit_dump_marker_ = mmap(NULL,
+                              page_size,
+                              PROT_READ | PROT_EXEC,
+                              MAP_PRIVATE,
+                              jit_dump_fd_,
+                              0);
+      if (jit_dump_marker_ == MAP_FAILED) jit_dump_marker_ = NULL;
+
+      std::vector<uint8_t> header;
+      Append(&header, kJitDumpMagic);
+      Append(&header, kJitDumpVersion);
+      Append(&header, kJitDumpHeaderSize);
+      Append(&header, static_cast<uint32_t>(kElfMachineAArch64));
+      Append(&header, static_cast<uint32_t>(0));  // Padding.
+      Append(&header, static_cast<uint32_t>(getpid()));
+      Append(&header, GetTimestamp());
+      Append(&header, static_cast<uint64_t>(0));  // Flags.
+      VIXL_ASSERT(header.size() == kJitDumpHeaderSize);
+      WriteAll(jit_dump_fd_, header.data(), header.size());
+    }
+  }
+}
+
+
+CodeRegistry::~CodeRegistry() {
+  while (!gdb_entries_.empty()) {
+    UnregisterFromGdb(gdb_entries_.begin()->first);
+  }
+  if (perf_map_ != NULL) fclose(perf_map_);
+  if (jit_dump_fd_ >= 0) {
+    std::vector<uint8_t> record;
+    Append(&record, kJitDumpCodeClose);
+    Append(&record, static_cast<uint32_t>(16));  // total_size
+    Append(&record, GetTimestamp());
+    WriteAll(jit_dump_fd_, record.data(), record.size());
+    if (jit_dump_marker_ != NULL) {
+      munmap(jit_dump_marker_, sysconf(_SC_PAGESIZE));
+    }
+    close(jit_dump_fd_);
+  }
+}
+
+
+void CodeRegistry::Register(const char* name,
+                            const void* address,
+                            size_t size,
+                            const LabelSymbol* labels,
+                            size_t label_count) {
+  uint64_t start = reinterpret_cast<uintptr_t>(address);
+
+  // Split the function at each label, in address order. A label bound at the
+  // start of the function replaces the function symbol.
+  std::vector<std::pair<uint64_t, std::string>> boundaries;
+  boundaries.push_back(std::make_pair(0, std::string(name)));
+  for (size_t i = 0; i < label_count; i++) {
+    VIXL_ASSERT(labels[i].label->IsBound());
+    uint64_t offset = labels[i].label->GetLocation();
+    VIXL_ASSERT(offset < size);
+    boundaries.push_back(
+        std::make_pair(offset, std::string(name) + ":" + labels[i].name));
+  }
+  std::stable_sort(boundaries.begin(),
+                   boundaries.end(),
+                   [](const std::pair<uint64_t, std::string>& a,
+                      const std::pair<uint64_t, std::string>& b) {
+                     return a.first < b.first;
+                   });
+
+  std::vector<Symbol> symbols;
+  for (size_t i = 0; i < boundaries.size(); i++) {
+    uint64_t end = (i + 1 < boundaries.size()) ? boundaries[i + 1].first : size;
+    if (end == boundaries[i].first) continue;
+    Symbol symbol = {boundaries[i].second,
+                     start + boundaries[i].first,
+                     end - boundaries[i].first};
+    symbols.push_back(symbol);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (perf_map_ != NULL) WritePerfMap(symbols);
+  if (jit_dump_fd_ >= 0) WriteJitDump(symbols, address);
+  if ((outputs_ & kGdbJitInterface) != 0) {
+    RegisterWithGdb(address, size, symbols);
+  }
+}
+
+
+void CodeRegistry::Unregister(const void* address) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  UnregisterFromGdb(address);
+}
+
+
+void CodeRegistry::WritePerfMap(const std::vector<Symbol>& symbols) {
+  for (const Symbol& symbol : symbols) {
+    fprintf(perf_map_,
+            "%" PRIx64 " %" PRIx64 " %s\n",
+            symbol.address,
+            symbol.size,
+            symbol.name.c_str());
+  }
+  fflush(perf_map_);
+}
+
+
+void CodeRegistry::WriteJitDump(const std::vector<Symbol>& symbols,
+                                const void* code) {
+  uint64_t start = reinterpret_cast<uintptr_t>(code);
+  uint32_t pid = static_cast<uint32_t>(getpid());
+  uint32_t tid = static_cast<uint32_t>(syscall(SYS_gettid));
+  for (const Symbol& symbol : symbols) {
+    // Each record carries a copy of the code it describes.
+    const size_t kRecordHeaderSize = 16;
+    const size_t kCodeLoadSize = 40;
+    uint32_t total_size = static_cast<uint32_t>(
+        kRecordHeaderSize + kCodeLoadSize + symbol.name.size() + 1 +
+        symbol.size);
+    std::vector<uint8_t> record;
+    Append(&record, kJitDumpCodeLoad);
+    Append(&record, total_size);
+    Append(&record, GetTimestamp());
+    Append(&record, pid);
+    Append(&record, tid);
+    Append(&record, symbol.address);  // vma
+    Append(&record, symbol.address);  // code_addr
+    Append(&record, symbol.size);
+    Append(&record, jit_dump_code_index_++);
+    AppendString(&record, symbol.name);
+    const uint8_t* bytes =
+        reinterpret_cast<const uint8_t*>(code) + (symbol.address - start);
+    record.insert(record.end(), bytes, bytes + symbol.size);
+    VIXL_ASSERT(record.size() == total_size);
+    WriteAll(jit_dump_fd_, record.data(), record.size());
+  }
+}
+
+
+void CodeRegistry::RegisterWithGdb(const void* address,
+                                   size_t size,
+                                   const std::vector<Symbol>& symbols) {
+  // Registering the same address twice replaces the first entry.
+  UnregisterFromGdb(address);
+
+  uint64_t start = reinterpret_cast<uintptr_t>(address);
+  std::vector<std::string> names;
+  std::vector<uint64_t> offsets;
+  std::vector<uint64_t> sizes;
+  for (const Symbol& symbol : symbols) {
+    names.push_back(symbol.name);
+    offsets.push_back(symbol.address - start);
+    sizes.push_back(symbol.size);
+  }
+
+  GdbEntry* gdb_entry = new GdbEntry;
+  BuildGdbImage(start, size, names, offsets, sizes, &gdb_entry->image);
+  gdb_entry->entry.symfile_addr =
+      reinterpret_cast<const char*>(gdb_entry->image.data());
+  gdb_entry->entry.symfile_size = gdb_entry->image.size();
+  gdb_entry->entry.prev_entry = NULL;
+  gdb_entries_[address] = gdb_entry;
+
+  std::lock_guard<std::mutex> lock(gdb_mutex);
+  gdb_entry->entry.next_entry = __jit_debug_descriptor.first_entry;
+  if (gdb_entry->entry.next_entry != NULL) {
+    gdb_entry->entry.next_entry->prev_entry = &gdb_entry->entry;
+  }
+  __jit_debug_descriptor.first_entry = &gdb_entry->entry;
+  __jit_debug_descriptor.relevant_entry = &gdb_entry->entry;
+  __jit_debug_descriptor.action_flag = kGdbRegister;
+  __jit_debug_register_code();
+}
+
+
+void CodeRegistry::UnregisterFromGdb(const void* address) {
+  std::map<const void*, GdbEntry*>::iterator it = gdb_entries_.find(address);
+  if (it == gdb_entries_.end()) return;
+  GdbEntry* gdb_entry = it->second;
+  gdb_entries_.erase(it);
+
+  {
+    std::lock_guard<std::mutex> lock(gdb_mutex);
+    jit_code_entry* entry = &gdb_entry->entry;
+    if (entry->prev_entry != NULL) {
+      entry->prev_entry->next_entry = entry->next_entry;
+    } else {
+      __jit_debug_descriptor.first_entry = entry->next_entry;
+    }
+    if (entry->next_entry != NULL) {
+      entry->next_entry->prev_entry = entry->prev_entry;
+    }
+    __jit_debug_descriptor.relevant_entry = entry;
+    __jit_debug_descriptor.action_flag = kGdbUnregister;
+    __jit_debug_register_code();
+  }
+  delete gdb_entry;
+}
+
+#endif  // __linux__
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -0,0 +1,147 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIXL_AARCH64_CODE_REGISTRY_AARCH64_H_
+#define VIXL_AARCH64_CODE_REGISTRY_AARCH64_H_
+
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../code-buffer-vixl.h"
+#include "../globals-vixl.h"
+
+#include "assembler-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+#ifdef __linux__
+
+// Describe generated code to profilers and debuggers, so that they can show
+// symbols for it rather than anonymous addresses.
+//
+// Each registered function can be described in any of the following ways:
+//  * kPerfMap appends a line to `<directory>/perf-<pid>.map`, which `perf
+//    report` reads to symbolise samples.
+//  * kJitDump writes a record to `<directory>/jit-<pid>.dump`, including a copy
+//    of the code, which `perf inject --jit` uses to annotate the code.
+//    Profiles should be recorded with `perf record -k 1`, since records are
+//    timestamped with CLOCK_MONOTONIC.
+//  * kGdbJitInterface builds a small in-memory ELF image describing the
+//    function, and registers it with GDB through `__jit_debug_register_code`.
+//
+// Labels bound in a function can be registered as sub-symbols, named
+// `<function>:<label>`. Each symbol then covers the code up to the next one.
+//
+// Registration is thread-safe. The registry is only declared on Linux.
+class CodeRegistry {
+ public:
+  enum Output {
+    kPerfMap = 1 << 0,
+    kJitDump = 1 << 1,
+    kGdbJitInterface = 1 << 2,
+    kAllOutputs = kPerfMap | kJitDump | kGdbJitInterface
+  };
+
+  // A bound label to register as a sub-symbol.
+  struct LabelSymbol {
+    const char* name;
+    const Label* label;
+  };
+
+  // `outputs` is a combination of `Output` flags. The perf map and jitdump
+  // files are created in `directory`, which is where perf looks for them by
+  // default.
+  explicit CodeRegistry(int outputs = kAllOutputs,
+                        const char* directory = "/tmp");
+  // Unregister all the functions from GDB, and close the files.
+  ~CodeRegistry();
+
+  // Register the `size` bytes of code at `address`, which must be where the
+  // code is executed from, as `name`.
+  void Register(const char* name,
+                const void* address,
+                size_t size,
+                const LabelSymbol* labels = NULL,
+                size_t label_count = 0);
+  // Register the code in `buffer`, which must be finalised, at its executable
+  // address.
+  void Register(const char* name,
+                const CodeBuffer& buffer,
+                const LabelSymbol* labels = NULL,
+                size_t label_count = 0) {
+    Register(name,
+             buffer.GetExecutableStartAddress<const void*>(),
+             buffer.GetSizeInBytes(),
+             labels,
+             label_count);
+  }
+
+  // Unregister the function at `address` from GDB, for example before its
+  // memory is reused. Profiler entries cannot be removed.
+  void Unregister(const void* address);
+
+  std::string GetPerfMapPath() const { return perf_map_path_; }
+  std::string GetJitDumpPath() const { return jit_dump_path_; }
+
+ private:
+  struct Symbol {
+    std::string name;
+    uint64_t address;
+    uint64_t size;
+  };
+
+  void WritePerfMap(const std::vector<Symbol>& symbols);
+  void WriteJitDump(const std::vector<Symbol>& symbols, const void* code);
+  void RegisterWithGdb(const void* address,
+                       size_t size,
+                       const std::vector<Symbol>& symbols);
+  void UnregisterFromGdb(const void* address);
+
+  int outputs_;
+  std::string perf_map_path_;
+  std::string jit_dump_path_;
+  FILE* perf_map_;
+  int jit_dump_fd_;
+  // The jitdump file is mapped executable so that `perf record` sees it.
+  void* jit_dump_marker_;
+  uint64_t jit_dump_code_index_;
+  // The functions registered with GDB, indexed by code address.
+  struct GdbEntry;
+  std::map<const void*, GdbEntry*> gdb_entries_;
+  std::mutex mutex_;
+};
+
+#endif  // __linux__
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_CODE_REGISTRY_AARCH64_H_
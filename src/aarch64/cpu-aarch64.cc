@@ -29,6 +29,8 @@
 #define VIXL_USE_LINUX_HWCAP 1
 #endif
 
+#include <algorithm>
+
 #include "../utils-vixl.h"
 
 #include "cpu-aarch64.h"
@@ -577,5 +579,97 @@ void CPU::EnsureIAndDCacheCoherency(void* address, size_t length) {
 }
 
 
+void CPU::EnsureIAndDCacheCoherency(const CodeRange* ranges, size_t count) {
+#ifdef __aarch64__
+  // See the single-range version above for a description of the cache
+  // maintenance operations and barriers.
+  std::vector<CodeRange> dlines;
+  std::vector<CodeRange> ilines;
+  CoalesceCacheLines(ranges, count, dcache_line_size_, &dlines);
+  CoalesceCacheLines(ranges, count, icache_line_size_, &ilines);
+  if (dlines.empty()) {
+    return;
+  }
+
+  uintptr_t dsize = static_cast<uintptr_t>(dcache_line_size_);
+  uintptr_t isize = static_cast<uintptr_t>(icache_line_size_);
+
+  for (size_t i = 0; i < dlines.size(); i++) {
+    uintptr_t dline = reinterpret_cast<uintptr_t>(dlines[i].address);
+    uintptr_t end = dline + dlines[i].length;
+    do {
+      __asm__ __volatile__("   dc    cvau, %[dline]\n"
+                           :
+                           : [dline] "r"(dline)
+                           : "memory");
+      dline += dsize;
+    } while (dline < end);
+  }
+
+  __asm__ __volatile__("   dsb   ish\n" : : : "memory");
+
+  for (size_t i = 0; i < ilines.size(); i++) {
+    uintptr_t iline = reinterpret_cast<uintptr_t>(ilines[i].address);
+    uintptr_t end = iline + ilines[i].length;
+    do {
+      __asm__ __volatile__("   ic   ivau, %[iline]\n"
+                           :
+                           : [iline] "r"(iline)
+                           : "memory");
+      iline += isize;
+    } while (iline < end);
+  }
+
+  __asm__ __volatile__(
+      "   dsb  ish\n"
+      "   isb\n"
+      :
+      :
+      : "memory");
+#else
+  // If the host isn't AArch64, we must be using the simulator, so this function
+  // doesn't have to do anything.
+  USE(ranges, count);
+#endif
+}
+
+
+void CPU::CoalesceCacheLines(const CodeRange* ranges,
+                             size_t count,
+                             size_t line_size,
+                             std::vector<CodeRange>* lines) {
+  // Cache line sizes are always a power of 2.
+  VIXL_ASSERT(IsPowerOf2(line_size));
+  lines->clear();
+
+  std::vector<std::pair<uintptr_t, uintptr_t> > bounds;
+  bounds.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    if (ranges[i].length == 0) continue;
+    uintptr_t start = reinterpret_cast<uintptr_t>(ranges[i].address);
+    uintptr_t end = start + ranges[i].length;
+    bounds.push_back(std::make_pair(AlignDown(start, line_size),
+                                    AlignUp(end, line_size)));
+  }
+  std::sort(bounds.begin(), bounds.end());
+
+  for (size_t i = 0; i < bounds.size(); i++) {
+    uintptr_t start = bounds[i].first;
+    uintptr_t end = bounds[i].second;
+    if (!lines->empty()) {
+      CodeRange* last = &lines->back();
+      uintptr_t last_start = reinterpret_cast<uintptr_t>(last->address);
+      if (start <= (last_start + last->length)) {
+        // Merge with the previous range.
+        last->length = std::max(last_start + last->length, end) - last_start;
+        continue;
+      }
+    }
+    CodeRange line = {reinterpret_cast<void*>(start), end - start};
+    lines->push_back(line);
+  }
+}
+
+
 }  // namespace aarch64
 }  // namespace vixl
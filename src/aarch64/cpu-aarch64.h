@@ -27,6 +27,8 @@
 #ifndef VIXL_CPU_AARCH64_H
 #define VIXL_CPU_AARCH64_H
 
+#include <vector>
+
 #include "../cpu-features.h"
 #include "../globals-vixl.h"
 
@@ -251,6 +253,28 @@ class CPU {
   // safely run.
   static void EnsureIAndDCacheCoherency(void *address, size_t length);
 
+  // A range of memory, for the batched EnsureIAndDCacheCoherency below.
+  struct CodeRange {
+    void *address;
+    size_t length;
+  };
+
+  // As above, for `count` ranges at once. The cache lines covering the ranges
+  // are coalesced so that each line is maintained once, all the D cache
+  // operations are followed by a single barrier, and so are all the I cache
+  // operations. This is much cheaper than one call per range when many small
+  // functions are made executable together.
+  static void EnsureIAndDCacheCoherency(const CodeRange *ranges, size_t count);
+
+  // Round each of the `count` ranges out to `line_size` boundaries, and merge
+  // the ones that overlap or are adjacent. The result is sorted by address.
+  // This is the coalescing step of the batched EnsureIAndDCacheCoherency.
+  // Unlike cache maintenance, it is available on all hosts.
+  static void CoalesceCacheLines(const CodeRange *ranges,
+                                 size_t count,
+                                 size_t line_size,
+                                 std::vector<CodeRange> *lines);
+
   // Read and interpret the ID registers. This requires
   // CPUFeatures::kIDRegisterEmulation, and therefore cannot be called on
   // non-AArch64 platforms.
@@ -0,0 +1,466 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "elf-object-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+namespace {
+
+// ELF constants, from the ELF specification and the ELF for the Arm 64-bit
+// Architecture ABI. They are defined here rather than taken from <elf.h>, which
+// is not available on all hosts.
+const uint8_t kElfClass64 = 2;
+const uint8_t kElfData2Lsb = 1;
+const uint8_t kElfVersionCurrent = 1;
+const uint16_t kElfTypeRel = 1;
+const uint16_t kElfMachineAArch64 = 183;
+
+const uint32_t kSectionTypeProgBits = 1;
+const uint32_t kSectionTypeSymTab = 2;
+const uint32_t kSectionTypeStrTab = 3;
+const uint32_t kSectionTypeRela = 4;
+
+const uint64_t kSectionFlagAlloc = 0x2;
+const uint64_t kSectionFlagExecInstr = 0x4;
+const uint64_t kSectionFlagInfoLink = 0x40;
+
+const uint8_t kSymbolBindLocal = 0;
+const uint8_t kSymbolBindGlobal = 1;
+const uint8_t kSymbolTypeNoType = 0;
+const uint8_t kSymbolTypeObject = 1;
+const uint8_t kSymbolTypeFunc = 2;
+const uint8_t kSymbolTypeSection = 3;
+
+const size_t kElfHeaderSize = 64;
+const size_t kSectionHeaderSize = 64;
+const size_t kSymbolSize = 24;
+const size_t kRelaSize = 24;
+
+// The sections, in the order they appear in the section header table.
+enum Section {
+  kNullSection,
+  kTextSection,
+  kRodataSection,
+  kRelaTextSection,
+  kRelaRodataSection,
+  kSymTabSection,
+  kStrTabSection,
+  kShStrTabSection,
+  kSectionCount
+};
+
+// The symbol table starts with the null symbol and the section symbols for
+// .text and .rodata, which are the only local symbols.
+const uint32_t kTextSymbolIndex = 1;
+const uint32_t kRodataSymbolIndex = 2;
+const uint32_t kFirstGlobalSymbolIndex = 3;
+
+// Append `value` to `out`, in little-endian order, on `size` bytes.
+void Append(std::vector<uint8_t>* out, uint64_t value, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    out->push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+void AppendPadding(std::vector<uint8_t>* out, size_t alignment) {
+  while ((out->size() % alignment) != 0) out->push_back(0);
+}
+
+// Append `name` to a string table, and return its offset.
+uint32_t AddString(std::vector<uint8_t>* table, const std::string& name) {
+  uint32_t offset = static_cast<uint32_t>(table->size());
+  table->insert(table->end(), name.begin(), name.end());
+  table->push_back(0);
+  return offset;
+}
+
+void AppendSymbol(std::vector<uint8_t>* out,
+                  uint32_t name,
+                  uint8_t bind,
+                  uint8_t type,
+                  uint16_t section,
+                  uint64_t value) {
+  Append(out, name, 4);
+  Append(out, (bind << 4) | type, 1);
+  Append(out, 0, 1);  // st_other: default visibility.
+  Append(out, section, 2);
+  Append(out, value, 8);
+  Append(out, 0, 8);  // st_size: unknown.
+}
+
+struct SectionHeader {
+  uint32_t name;
+  uint32_t type;
+  uint64_t flags;
+  uint64_t offset;
+  uint64_t size;
+  uint32_t link;
+  uint32_t info;
+  uint64_t alignment;
+  uint64_t entry_size;
+};
+
+void AppendSectionHeader(std::vector<uint8_t>* out,
+                         const SectionHeader& header) {
+  Append(out, header.name, 4);
+  Append(out, header.type, 4);
+  Append(out, header.flags, 8);
+  Append(out, 0, 8);  // sh_addr: not allocated yet.
+  Append(out, header.offset, 8);
+  Append(out, header.size, 8);
+  Append(out, header.link, 4);
+  Append(out, header.info, 4);
+  Append(out, header.alignment, 8);
+  Append(out, header.entry_size, 8);
+}
+
+}  // namespace
+
+
+void ElfObjectWriter::Call(const char* symbol) { EmitBranch(symbol, kCall26); }
+
+
+void ElfObjectWriter::Jump(const char* symbol) { EmitBranch(symbol, kJump26); }
+
+
+void ElfObjectWriter::EmitBranch(const char* symbol, RelocationType type) {
+  int index = GetExternalSymbol(symbol);
+  // Opening the scope may emit pools, so only read the offset afterwards.
+  ExactAssemblyScope scope(masm_, kInstructionSize);
+  Relocation relocation;
+  relocation.offset = static_cast<uint32_t>(masm_->GetCursorOffset());
+  relocation.type = type;
+  relocation.symbol = kFirstGlobalSymbolIndex + index;
+  relocation.addend = 0;
+  text_relocations_.push_back(relocation);
+  // The offset is filled in by the linker.
+  if (type == kCall26) {
+    masm_->bl(static_cast<int64_t>(0));
+  } else {
+    masm_->b(static_cast<int64_t>(0));
+  }
+}
+
+
+void ElfObjectWriter::LoadLiteral(const Register& rt, uint64_t value) {
+  std::map<uint64_t, uint64_t>::const_iterator it =
+      literal_offsets_.find(value);
+  uint64_t offset;
+  if (it == literal_offsets_.end()) {
+    offset = AddRodataEntry(value);
+    literal_offsets_[value] = offset;
+  } else {
+    offset = it->second;
+  }
+  LoadFromRodata(rt, offset);
+}
+
+
+void ElfObjectWriter::LoadAddress(const Register& rt,
+                                  const char* symbol,
+                                  int64_t addend) {
+  int index = GetExternalSymbol(symbol);
+  uint64_t offset = AddRodataEntry(0);
+  Relocation relocation;
+  relocation.offset = static_cast<uint32_t>(offset);
+  relocation.type = kAbs64;
+  relocation.symbol = kFirstGlobalSymbolIndex + index;
+  relocation.addend = addend;
+  rodata_relocations_.push_back(relocation);
+  LoadFromRodata(rt, offset);
+}
+
+
+void ElfObjectWriter::LoadFromRodata(const Register& rt,
+                                     uint64_t rodata_offset) {
+  VIXL_ASSERT(rt.IsX());
+  ExactAssemblyScope scope(masm_, 2 * kInstructionSize);
+  Relocation relocation;
+  relocation.offset = static_cast<uint32_t>(masm_->GetCursorOffset());
+  relocation.type = kAdrPrelPgHi21;
+  relocation.symbol = kRodataSymbolIndex;
+  relocation.addend = rodata_offset;
+  text_relocations_.push_back(relocation);
+  masm_->adrp(rt, static_cast<int64_t>(0));
+
+  relocation.offset = static_cast<uint32_t>(masm_->GetCursorOffset());
+  relocation.type = kLdst64AbsLo12Nc;
+  text_relocations_.push_back(relocation);
+  masm_->ldr(rt, MemOperand(rt));
+}
+
+
+void ElfObjectWriter::Export(const char* name,
+                             const Label* label,
+                             SymbolType type) {
+  VIXL_ASSERT(label->IsBound());
+  VIXL_ASSERT(symbol_indices_.count(name) == 0);
+  Symbol symbol;
+  symbol.name = name;
+  symbol.is_defined = true;
+  symbol.type = type;
+  symbol.value = label->GetLocation();
+  symbol_indices_[name] = static_cast<int>(symbols_.size());
+  symbols_.push_back(symbol);
+}
+
+
+void ElfObjectWriter::NameExternalSymbol(uint32_t symbol, const char* name) {
+  VIXL_ASSERT(symbol != Relocation::kCodeStart);
+  VIXL_ASSERT(external_symbols_.count(symbol) == 0);
+  external_symbols_[symbol] = GetExternalSymbol(name);
+}
+
+
+void ElfObjectWriter::GetCodeRelocations(
+    std::vector<Relocation>* relocations) const {
+  const std::vector<Relocation>& code_relocations = masm_->GetRelocations();
+  for (size_t i = 0; i < code_relocations.size(); i++) {
+    const Relocation& code_relocation = code_relocations[i];
+    Relocation relocation;
+    relocation.offset = code_relocation.offset;
+    relocation.addend = code_relocation.addend;
+    if (code_relocation.symbol == Relocation::kCodeStart) {
+      relocation.symbol = kTextSymbolIndex;
+    } else {
+      std::map<uint32_t, int>::const_iterator it =
+          external_symbols_.find(code_relocation.symbol);
+      // The symbol must have been named with NameExternalSymbol().
+      VIXL_CHECK(it != external_symbols_.end());
+      relocation.symbol = kFirstGlobalSymbolIndex + it->second;
+    }
+    switch (code_relocation.type) {
+      case Relocation::kData64:
+        relocation.type = kAbs64;
+        relocations->push_back(relocation);
+        break;
+      case Relocation::kMovWide64: {
+        // The linker fills in each 16-bit immediate. Only the last one checks
+        // for overflow, which cannot happen with 64-bit addresses.
+        static const RelocationType kMovWideTypes[] = {kMovwUabsG0Nc,
+                                                       kMovwUabsG1Nc,
+                                                       kMovwUabsG2Nc,
+                                                       kMovwUabsG3};
+        for (int j = 0; j < 4; j++) {
+          relocation.type = kMovWideTypes[j];
+          relocations->push_back(relocation);
+          relocation.offset += kInstructionSize;
+        }
+        break;
+      }
+      default:
+        VIXL_UNREACHABLE();
+    }
+  }
+}
+
+
+int ElfObjectWriter::GetExternalSymbol(const char* name) {
+  std::map<std::string, int>::const_iterator it = symbol_indices_.find(name);
+  if (it != symbol_indices_.end()) {
+    // Exported symbols cannot be used as external symbols.
+    VIXL_ASSERT(!symbols_[it->second].is_defined);
+    return it->second;
+  }
+  Symbol symbol;
+  symbol.name = name;
+  symbol.is_defined = false;
+  symbol.type = kFunction;
+  symbol.value = 0;
+  int index = static_cast<int>(symbols_.size());
+  symbol_indices_[name] = index;
+  symbols_.push_back(symbol);
+  return index;
+}
+
+
+uint64_t ElfObjectWriter::AddRodataEntry(uint64_t value) {
+  uint64_t offset = rodata_.size();
+  Append(&rodata_, value, sizeof(value));
+  return offset;
+}
+
+
+void ElfObjectWriter::WriteObject(std::vector<uint8_t>* object) const {
+  VIXL_ASSERT(!masm_->GetBuffer()->IsDirty());
+  const CodeBuffer* buffer = masm_->GetBuffer();
+  SectionHeader headers[kSectionCount];
+  memset(headers, 0, sizeof(headers));
+
+  // Section names.
+  std::vector<uint8_t> shstrtab;
+  AddString(&shstrtab, "");
+  headers[kTextSection].name = AddString(&shstrtab, ".text");
+  headers[kRodataSection].name = AddString(&shstrtab, ".rodata");
+  headers[kRelaTextSection].name = AddString(&shstrtab, ".rela.text");
+  headers[kRelaRodataSection].name = AddString(&shstrtab, ".rela.rodata");
+  headers[kSymTabSection].name = AddString(&shstrtab, ".symtab");
+  headers[kStrTabSection].name = AddString(&shstrtab, ".strtab");
+  headers[kShStrTabSection].name = AddString(&shstrtab, ".shstrtab");
+
+  // Symbols. Exported and external symbols are all global, and follow the
+  // section symbols.
+  std::vector<uint8_t> strtab;
+  std::vector<uint8_t> symtab;
+  AddString(&strtab, "");
+  AppendSymbol(&symtab, 0, kSymbolBindLocal, kSymbolTypeNoType, 0, 0);
+  AppendSymbol(&symtab,
+               0,
+               kSymbolBindLocal,
+               kSymbolTypeSection,
+               kTextSection,
+               0);
+  AppendSymbol(&symtab,
+               0,
+               kSymbolBindLocal,
+               kSymbolTypeSection,
+               kRodataSection,
+               0);
+  for (size_t i = 0; i < symbols_.size(); i++) {
+    const Symbol& symbol = symbols_[i];
+    uint8_t type = kSymbolTypeNoType;
+    if (symbol.is_defined) {
+      type = (symbol.type == kFunction) ? kSymbolTypeFunc : kSymbolTypeObject;
+    }
+    AppendSymbol(&symtab,
+                 AddString(&strtab, symbol.name),
+                 kSymbolBindGlobal,
+                 type,
+                 symbol.is_defined ? kTextSection : 0,
+                 symbol.value);
+  }
+
+  // Relocations.
+  std::vector<Relocation> text_relocations = text_relocations_;
+  GetCodeRelocations(&text_relocations);
+  std::vector<uint8_t> rela[2];
+  const std::vector<Relocation>* relocations[2] = {&text_relocations,
+                                                   &rodata_relocations_};
+  for (int i = 0; i < 2; i++) {
+    for (size_t j = 0; j < relocations[i]->size(); j++) {
+      const Relocation& relocation = (*relocations[i])[j];
+      uint64_t symbol = relocation.symbol;
+      Append(&rela[i], relocation.offset, 8);
+      Append(&rela[i], (symbol << 32) | relocation.type, 8);
+      Append(&rela[i], static_cast<uint64_t>(relocation.addend), 8);
+    }
+  }
+
+  headers[kTextSection].type = kSectionTypeProgBits;
+  headers[kTextSection].flags = kSectionFlagAlloc | kSectionFlagExecInstr;
+  headers[kTextSection].size = buffer->GetSizeInBytes();
+  // The MacroAssembler aligns literals relative to the start of the buffer.
+  headers[kTextSection].alignment = 16;
+
+  headers[kRodataSection].type = kSectionTypeProgBits;
+  headers[kRodataSection].flags = kSectionFlagAlloc;
+  headers[kRodataSection].size = rodata_.size();
+  headers[kRodataSection].alignment = 8;
+
+  for (int i = 0; i < 2; i++) {
+    SectionHeader* header = &headers[kRelaTextSection + i];
+    header->type = kSectionTypeRela;
+    header->flags = kSectionFlagInfoLink;
+    header->size = rela[i].size();
+    header->link = kSymTabSection;
+    header->info = kTextSection + i;
+    header->alignment = 8;
+    header->entry_size = kRelaSize;
+  }
+
+  headers[kSymTabSection].type = kSectionTypeSymTab;
+  headers[kSymTabSection].size = symtab.size();
+  headers[kSymTabSection].link = kStrTabSection;
+  headers[kSymTabSection].info = kFirstGlobalSymbolIndex;
+  headers[kSymTabSection].alignment = 8;
+  headers[kSymTabSection].entry_size = kSymbolSize;
+
+  headers[kStrTabSection].type = kSectionTypeStrTab;
+  headers[kStrTabSection].size = strtab.size();
+  headers[kStrTabSection].alignment = 1;
+
+  headers[kShStrTabSection].type = kSectionTypeStrTab;
+  headers[kShStrTabSection].size = shstrtab.size();
+  headers[kShStrTabSection].alignment = 1;
+
+  // Lay out the file: the ELF header, the contents of each section, and the
+  // section header table.
+  const uint8_t* contents[kSectionCount] = {
+      NULL,
+      buffer->GetStartAddress<const uint8_t*>(),
+      rodata_.data(),
+      rela[0].data(),
+      rela[1].data(),
+      symtab.data(),
+      strtab.data(),
+      shstrtab.data()};
+  std::vector<uint8_t> body;
+  for (int i = kTextSection; i < kSectionCount; i++) {
+    AppendPadding(&body, headers[i].alignment);
+    headers[i].offset = kElfHeaderSize + body.size();
+    if (headers[i].size > 0) {
+      body.insert(body.end(), contents[i], contents[i] + headers[i].size);
+    }
+  }
+  AppendPadding(&body, 8);
+  uint64_t section_headers_offset = kElfHeaderSize + body.size();
+
+  object->clear();
+  // e_ident
+  object->push_back(0x7f);
+  object->push_back('E');
+  object->push_back('L');
+  object->push_back('F');
+  object->push_back(kElfClass64);
+  object->push_back(kElfData2Lsb);
+  object->push_back(kElfVersionCurrent);
+  AppendPadding(object, 16);  // OS ABI: none, and padding.
+  Append(object, kElfTypeRel, 2);
+  Append(object, kElfMachineAArch64, 2);
+  Append(object, kElfVersionCurrent, 4);
+  Append(object, 0, 8);  // e_entry
+  Append(object, 0, 8);  // e_phoff
+  Append(object, section_headers_offset, 8);
+  Append(object, 0, 4);  // e_flags
+  Append(object, kElfHeaderSize, 2);
+  Append(object, 0, 2);  // e_phentsize
+  Append(object, 0, 2);  // e_phnum
+  Append(object, kSectionHeaderSize, 2);
+  Append(object, kSectionCount, 2);
+  Append(object, kShStrTabSection, 2);
+  VIXL_ASSERT(object->size() == kElfHeaderSize);
+
+  object->insert(object->end(), body.begin(), body.end());
+  for (int i = 0; i < kSectionCount; i++) {
+    AppendSectionHeader(object, headers[i]);
+  }
+}
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -0,0 +1,147 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIXL_AARCH64_ELF_OBJECT_AARCH64_H_
+#define VIXL_AARCH64_ELF_OBJECT_AARCH64_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../globals-vixl.h"
+
+#include "macro-assembler-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+// Serialise code generated by a MacroAssembler as an ELF64 relocatable object
+// for AArch64, so that it can be linked into a program with the system linker.
+//
+// The object has the following sections:
+//  * .text holds the code, exactly as generated. Code emitted by the
+//    MacroAssembler is position-independent, so it needs no relocation,
+//    including its own literal pools, except for the addresses it records
+//    relocations for (see Assembler::RecordRelocation).
+//  * .rodata holds the literals loaded with `LoadLiteral()` and the addresses
+//    loaded with `LoadAddress()`.
+//  * .rela.text and .rela.rodata hold the relocations.
+//  * .symtab, .strtab and .shstrtab hold the symbols and names.
+//
+// References to anything outside .text must be generated through the helpers
+// below, which emit the code and record the relocations that go with it:
+//  * `Call()` and `Jump()` emit a BL or B to an external symbol
+//    (R_AARCH64_CALL26 and R_AARCH64_JUMP26).
+//  * `LoadLiteral()` and `LoadAddress()` emit an ADRP and LDR pair, loading a
+//    64-bit value from .rodata (R_AARCH64_ADR_PREL_PG_HI21 and
+//    R_AARCH64_LDST64_ABS_LO12_NC). For `LoadAddress()`, the value is the
+//    absolute address of a symbol, filled in by the linker (R_AARCH64_ABS64).
+//
+// The relocations recorded by the MacroAssembler itself, for example by
+// `MovExternalAddress()`, `LdrExternalAddress()` and `CallExternal()`, are
+// written to .rela.text too. Their external symbol indices must be given a
+// name with `NameExternalSymbol()`. A 64-bit literal is relocated with
+// R_AARCH64_ABS64, and a MOVZ and MOVK sequence with R_AARCH64_MOVW_UABS_G0_NC,
+// G1_NC, G2_NC and G3.
+//
+// Bound labels are exported as global symbols with `Export()`.
+class ElfObjectWriter {
+ public:
+  // The ELF relocation types used by the writer.
+  enum RelocationType {
+    kAbs64 = 257,           // R_AARCH64_ABS64
+    kMovwUabsG0Nc = 264,    // R_AARCH64_MOVW_UABS_G0_NC
+    kMovwUabsG1Nc = 266,    // R_AARCH64_MOVW_UABS_G1_NC
+    kMovwUabsG2Nc = 268,    // R_AARCH64_MOVW_UABS_G2_NC
+    kMovwUabsG3 = 269,      // R_AARCH64_MOVW_UABS_G3
+    kAdrPrelPgHi21 = 275,   // R_AARCH64_ADR_PREL_PG_HI21
+    kJump26 = 282,          // R_AARCH64_JUMP26
+    kCall26 = 283,          // R_AARCH64_CALL26
+    kLdst64AbsLo12Nc = 286  // R_AARCH64_LDST64_ABS_LO12_NC
+  };
+
+  // Code is generated into `masm`, which must outlive the writer.
+  explicit ElfObjectWriter(MacroAssembler* masm) : masm_(masm) {}
+
+  // Emit `bl symbol` or `b symbol`.
+  void Call(const char* symbol);
+  void Jump(const char* symbol);
+
+  // Load the 64-bit `value` into `rt` from .rodata. Identical values share a
+  // single entry.
+  void LoadLiteral(const Register& rt, uint64_t value);
+
+  // Load the absolute address of `symbol`, plus `addend`, into `rt`. The
+  // address is stored in .rodata, and filled in by the linker.
+  void LoadAddress(const Register& rt, const char* symbol, int64_t addend = 0);
+
+  // Name the external `symbol` index used by the MacroAssembler's relocations.
+  void NameExternalSymbol(uint32_t symbol, const char* name);
+
+  // Export the bound `label` as a global symbol called `name`.
+  enum SymbolType { kFunction, kObject };
+  void Export(const char* name,
+              const Label* label,
+              SymbolType type = kFunction);
+
+  // Write the object. The MacroAssembler must have been finalised.
+  void WriteObject(std::vector<uint8_t>* object) const;
+
+ private:
+  struct Symbol {
+    std::string name;
+    // True if the symbol is exported from .text, false if it is external.
+    bool is_defined;
+    SymbolType type;
+    uint64_t value;
+  };
+
+  // Emit an ADRP and LDR pair loading `rt` from `rodata_offset` in .rodata.
+  void LoadFromRodata(const Register& rt, uint64_t rodata_offset);
+  void EmitBranch(const char* symbol, RelocationType type);
+  // Append the ELF relocations for the MacroAssembler's relocations.
+  void GetCodeRelocations(std::vector<Relocation>* relocations) const;
+  int GetExternalSymbol(const char* name);
+  uint64_t AddRodataEntry(uint64_t value);
+
+  MacroAssembler* masm_;
+  std::vector<uint8_t> rodata_;
+  std::map<uint64_t, uint64_t> literal_offsets_;
+  std::vector<Symbol> symbols_;
+  std::map<std::string, int> symbol_indices_;
+  // The symbols named with NameExternalSymbol(), as indices in `symbols_`.
+  std::map<uint32_t, int> external_symbols_;
+  // The relocations emitted by the writer. The type is a RelocationType, and
+  // the symbol an index in the ELF symbol table.
+  std::vector<Relocation> text_relocations_;
+  std::vector<Relocation> rodata_relocations_;
+};
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_ELF_OBJECT_AARCH64_H_
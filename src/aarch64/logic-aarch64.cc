@@ -27,9 +27,14 @@
 #ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
 
 #include <cmath>
+#include <cstring>
 
 #include "simulator-aarch64.h"
 
+#ifdef VIXL_HAS_SIMULATED_HOST_CRYPTO
+#include <immintrin.h>
+#endif
+
 namespace vixl {
 namespace aarch64 {
 
@@ -8254,7 +8259,7 @@ static uint8_t GalMul(int table, uint64_t x) {
 }
 
 
-static uint8_t AESMixInner(uint64_t* x, int stage, bool inverse) {
+static uint8_t AESMixInner(const uint8_t* x, int stage, bool inverse) {
   VIXL_ASSERT(IsUint2(stage));
 
   int imc_gm[7] = {0xb, 0xd, 0x9, 0xe};
@@ -8271,34 +8276,23 @@ static uint8_t AESMixInner(uint64_t* x, int stage, bool inverse) {
 }
 
 
-LogicVRegister Simulator::aesmix(LogicVRegister dst,
-                                 const LogicVRegister& src,
-                                 bool inverse) {
-  uint64_t in[16] = {};
-  src.UintArray(kFormat16B, in);
-  dst.ClearForWrite(kFormat16B);
-
+// Portable implementation of the MixColumns (or InvMixColumns) step.
+static void AESMix(const uint8_t* in, uint8_t* out, bool inverse) {
   for (int c = 0; c < 16; c++) {
     int cmod4 = c % 4;
     int d = c - cmod4;
     VIXL_ASSERT((d == 0) || (d == 4) || (d == 8) || (d == 12));
-    dst.SetUint(kFormat16B, c, AESMixInner(&in[d], cmod4, inverse));
+    out[c] = AESMixInner(&in[d], cmod4, inverse);
   }
-
-  return dst;
 }
 
-LogicVRegister Simulator::aes(LogicVRegister dst,
-                              const LogicVRegister& src,
-                              bool decrypt) {
-  dst.ClearForWrite(kFormat16B);
-
+// Portable implementation of the (inverse) ShiftRows and SubBytes steps.
+static void AESRound(const uint8_t* in, uint8_t* out, bool decrypt) {
   // (Inverse) shift rows.
   uint8_t shift[] = {0, 5, 10, 15, 4, 9, 14, 3, 8, 13, 2, 7, 12, 1, 6, 11};
   uint8_t shift_inv[] = {0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3};
-  for (int i = 0; i < LaneCountFromFormat(kFormat16B); i++) {
-    uint8_t index = decrypt ? shift_inv[i] : shift[i];
-    dst.SetUint(kFormat16B, i, src.Uint(kFormat16B, index));
+  for (int i = 0; i < 16; i++) {
+    out[i] = in[decrypt ? shift_inv[i] : shift[i]];
   }
 
   // (Inverse) substitute bytes.
@@ -8351,10 +8345,92 @@ LogicVRegister Simulator::aes(LogicVRegister dst,
       0x55, 0x21, 0x0c, 0x7d,
   };
 
-  for (int i = 0; i < LaneCountFromFormat(kFormat16B); i++) {
-    const uint8_t* table = decrypt ? gf2_inv : gf2;
-    dst.SetUint(kFormat16B, i, table[dst.Uint(kFormat16B, i)]);
+  const uint8_t* table = decrypt ? gf2_inv : gf2;
+  for (int i = 0; i < 16; i++) {
+    out[i] = table[out[i]];
+  }
+}
+
+#ifdef VIXL_HAS_SIMULATED_HOST_CRYPTO
+// With a zero round key, AESENCLAST and AESDECLAST perform exactly the steps
+// of AESE and AESD that follow the initial AddRoundKey.
+__attribute__((target("aes"))) static void HostAESRound(const uint8_t* in,
+                                                        uint8_t* out,
+                                                        bool decrypt) {
+  __m128i state = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+  __m128i zero = _mm_setzero_si128();
+  state = decrypt ? _mm_aesdeclast_si128(state, zero)
+                  : _mm_aesenclast_si128(state, zero);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out), state);
+}
+
+// x86 has no stand-alone MixColumns instruction, so undo the ShiftRows and
+// SubBytes steps of AESENC with AESDECLAST first.
+__attribute__((target("aes"))) static void HostAESMix(const uint8_t* in,
+                                                      uint8_t* out,
+                                                      bool inverse) {
+  __m128i state = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+  __m128i zero = _mm_setzero_si128();
+  if (inverse) {
+    state = _mm_aesimc_si128(state);
+  } else {
+    state = _mm_aesenc_si128(_mm_aesdeclast_si128(state, zero), zero);
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out), state);
+}
+#else
+static void HostAESRound(const uint8_t* in, uint8_t* out, bool decrypt) {
+  USE(in, out, decrypt);
+  VIXL_UNREACHABLE();
+}
+
+static void HostAESMix(const uint8_t* in, uint8_t* out, bool inverse) {
+  USE(in, out, inverse);
+  VIXL_UNREACHABLE();
+}
+#endif
+
+// Apply `step` to the 128-bit state in `src`, using `host_step` instead if the
+// host supports the AES instructions.
+static void AESStep(LogicVRegister dst,
+                    const LogicVRegister& src,
+                    bool inverse,
+                    void (*step)(const uint8_t*, uint8_t*, bool),
+                    void (*host_step)(const uint8_t*, uint8_t*, bool)) {
+  uint8_t in[kQRegSizeInBytes];
+  uint8_t out[kQRegSizeInBytes];
+  for (unsigned i = 0; i < kQRegSizeInBytes; i++) {
+    in[i] = static_cast<uint8_t>(src.Uint(kFormat16B, i));
+  }
+
+  if (Simulator::GetHostCryptoFeatures().aes) {
+    host_step(in, out, inverse);
+#ifdef VIXL_DEBUG
+    uint8_t expected[kQRegSizeInBytes];
+    step(in, expected, inverse);
+    VIXL_ASSERT(memcmp(out, expected, sizeof(out)) == 0);
+#endif
+  } else {
+    step(in, out, inverse);
   }
+
+  dst.ClearForWrite(kFormat16B);
+  for (unsigned i = 0; i < kQRegSizeInBytes; i++) {
+    dst.SetUint(kFormat16B, i, out[i]);
+  }
+}
+
+LogicVRegister Simulator::aesmix(LogicVRegister dst,
+                                 const LogicVRegister& src,
+                                 bool inverse) {
+  AESStep(dst, src, inverse, AESMix, HostAESMix);
+  return dst;
+}
+
+LogicVRegister Simulator::aes(LogicVRegister dst,
+                              const LogicVRegister& src,
+                              bool decrypt) {
+  AESStep(dst, src, decrypt, AESRound, HostAESRound);
   return dst;
 }
 
@@ -27,6 +27,10 @@
 #include "macro-assembler-aarch64.h"
 
 #include <cctype>
+#include <cstring>
+
+#include "peephole-aarch64.h"
+#include "scheduler-aarch64.h"
 
 namespace vixl {
 namespace aarch64 {
@@ -50,7 +54,10 @@ LiteralPool::LiteralPool(MacroAssembler* masm)
     : Pool(masm),
       size_(0),
       first_use_(-1),
-      recommended_checkpoint_(kNoCheckpointRequired) {}
+      recommended_checkpoint_(kNoCheckpointRequired),
+      pooled_literals_(NULL),
+      pooled_literal_count_(0),
+      arena_(NULL) {}
 
 
 LiteralPool::~LiteralPool() VIXL_NEGATIVE_TESTING_ALLOW_EXCEPTION {
@@ -61,18 +68,36 @@ LiteralPool::~LiteralPool() VIXL_NEGATIVE_TESTING_ALLOW_EXCEPTION {
        it++) {
     delete *it;
   }
+  if (arena_ == NULL) delete pooled_literals_;
 }
 
 
 void LiteralPool::Reset() {
-  std::vector<RawLiteral*>::iterator it, end;
+  EntryVector::iterator it, end;
   for (it = entries_.begin(), end = entries_.end(); it != end; ++it) {
     RawLiteral* literal = *it;
-    if (literal->deletion_policy_ == kDeletedOnPlacementByPool) {
+    if (literal->deletion_policy_ == RawLiteral::kDeletedOnPlacementByPool) {
       delete literal;
     }
   }
-  entries_.clear();
+  if (pooled_literals_ != NULL) {
+    PooledLiteralMap::iterator pooled_it;
+    for (pooled_it = pooled_literals_->begin();
+         pooled_it != pooled_literals_->end();
+         ++pooled_it) {
+      pooled_it->second->~RawLiteral();
+    }
+  }
+  if (arena_ == NULL) {
+    entries_.clear();
+    if (pooled_literals_ != NULL) pooled_literals_->clear();
+  } else {
+    // Do not keep pointers to arena memory once the pool is empty, so that the
+    // arena can be reset.
+    entries_ = EntryVector(ArenaAllocator<RawLiteral*>(arena_));
+    pooled_literals_ = NULL;
+  }
+  pooled_literal_count_ = 0;
   size_ = 0;
   first_use_ = -1;
   Pool::Reset();
@@ -145,11 +170,7 @@ void LiteralPool::Emit(EmitOption option) {
     }
 
     // Now populate the literal pool.
-    std::vector<RawLiteral*>::iterator it, end;
-    for (it = entries_.begin(), end = entries_.end(); it != end; ++it) {
-      VIXL_ASSERT((*it)->IsUsed());
-      masm_->place(*it);
-    }
+    PlaceEntries();
 
     if (option == kBranchRequired) masm_->bind(&end_of_pool);
 #ifdef VIXL_DEBUG
@@ -161,6 +182,81 @@ void LiteralPool::Emit(EmitOption option) {
 }
 
 
+static bool IsLargerLiteral(const RawLiteral* a, const RawLiteral* b) {
+  return a->GetSize() > b->GetSize();
+}
+
+
+void LiteralPool::PlaceEntries() {
+  // Place the literals in decreasing order of size, so that the 128-bit and
+  // 64-bit literals are all 8-byte aligned if the first one is. If the pool
+  // starts at an offset which is not 8-byte aligned, lead with a 32-bit
+  // literal when there is one. This aligns the larger literals without any
+  // padding.
+  std::stable_sort(entries_.begin(), entries_.end(), IsLargerLiteral);
+  if (!IsAligned(masm_->GetCursorOffset(), kXRegSizeInBytes) &&
+      (entries_.front()->GetSize() > kWRegSizeInBytes)) {
+    EntryVector::iterator first_w = entries_.end();
+    while ((first_w != entries_.begin()) &&
+           ((*(first_w - 1))->GetSize() == kWRegSizeInBytes)) {
+      --first_w;
+    }
+    if (first_w != entries_.end()) {
+      std::rotate(entries_.begin(), first_w, first_w + 1);
+    }
+  }
+
+  EntryVector::iterator it, end;
+  for (it = entries_.begin(), end = entries_.end(); it != end; ++it) {
+    VIXL_ASSERT((*it)->IsUsed());
+    masm_->place(*it);
+  }
+}
+
+
+void LiteralPool::SetArena(Arena* arena) {
+  VIXL_ASSERT(entries_.empty());
+  VIXL_ASSERT((pooled_literals_ == NULL) || pooled_literals_->empty());
+  if (arena_ == NULL) delete pooled_literals_;
+  pooled_literals_ = NULL;
+  arena_ = arena;
+  // An empty vector does not hold any memory.
+  entries_ = EntryVector(ArenaAllocator<RawLiteral*>(arena));
+}
+
+
+void LiteralPool::CreatePooledLiteralMap() {
+  VIXL_ASSERT(pooled_literals_ == NULL);
+  if (arena_ == NULL) {
+    pooled_literals_ = new PooledLiteralMap();
+  } else {
+    void* storage =
+        arena_->Allocate(sizeof(PooledLiteralMap), alignof(PooledLiteralMap));
+    pooled_literals_ = new (storage)
+        PooledLiteralMap(0,
+                         PooledLiteralKeyHash(),
+                         std::equal_to<PooledLiteralKey>(),
+                         PooledLiteralMap::allocator_type(arena_));
+  }
+}
+
+
+void* LiteralPool::AllocatePooledLiteral() {
+  if (arena_ != NULL) {
+    return arena_->Allocate(sizeof(PooledLiteralStorage),
+                            alignof(PooledLiteralStorage));
+  }
+  size_t chunk = pooled_literal_count_ / kPooledLiteralChunkSize;
+  size_t index = pooled_literal_count_ % kPooledLiteralChunkSize;
+  if (chunk == pooled_literal_chunks_.size()) {
+    pooled_literal_chunks_.emplace_back(
+        new PooledLiteralStorage[kPooledLiteralChunkSize]);
+  }
+  pooled_literal_count_++;
+  return &pooled_literal_chunks_[chunk][index];
+}
+
+
 void LiteralPool::AddEntry(RawLiteral* literal) {
   // A literal must be registered immediately before its first use. Here we
   // cannot control that it is its first use, but we check no code has been
@@ -186,9 +282,43 @@ void LiteralPool::UpdateFirstUse(ptrdiff_t use_position) {
 }
 
 
+VeneerPool::~VeneerPool() {
+  if (arena_ == NULL) delete emitted_veneers_;
+}
+
+
 void VeneerPool::Reset() {
   Pool::Reset();
   unresolved_branches_.Reset();
+  if (arena_ == NULL) {
+    if (emitted_veneers_ != NULL) emitted_veneers_->clear();
+  } else {
+    // The map lives in the arena, which may be reset once we are done.
+    emitted_veneers_ = NULL;
+  }
+}
+
+
+void VeneerPool::SetArena(Arena* arena) {
+  VIXL_ASSERT(IsEmpty());
+  VIXL_ASSERT((emitted_veneers_ == NULL) || emitted_veneers_->empty());
+  if (arena_ == NULL) delete emitted_veneers_;
+  emitted_veneers_ = NULL;
+  arena_ = arena;
+  unresolved_branches_.SetArena(arena);
+}
+
+
+void VeneerPool::CreateEmittedVeneerMap() {
+  VIXL_ASSERT(emitted_veneers_ == NULL);
+  if (arena_ == NULL) {
+    emitted_veneers_ = new EmittedVeneerMap();
+  } else {
+    void* storage =
+        arena_->Allocate(sizeof(EmittedVeneerMap), alignof(EmittedVeneerMap));
+    emitted_veneers_ = new (storage)
+        EmittedVeneerMap(EmittedVeneerMap::allocator_type(arena_));
+  }
 }
 
 
@@ -213,6 +343,9 @@ void VeneerPool::RegisterUnresolvedBranch(ptrdiff_t branch_pos,
 
 
 void VeneerPool::DeleteUnresolvedBranchInfoForLabel(Label* label) {
+  // Once bound, branches to the label no longer need veneers.
+  if (emitted_veneers_ != NULL) emitted_veneers_->erase(label);
+
   if (IsEmpty()) {
     VIXL_ASSERT(checkpoint_ == kNoCheckpointRequired);
     return;
@@ -236,6 +369,20 @@ void VeneerPool::DeleteUnresolvedBranchInfoForLabel(Label* label) {
 }
 
 
+bool VeneerPool::FindReachableVeneerSlow(ptrdiff_t branch_pos,
+                                         const Label* label,
+                                         ImmBranchType branch_type,
+                                         int64_t* imm_offset) const {
+  if (label->IsBound()) return false;
+  EmittedVeneerMap::const_iterator it = emitted_veneers_->find(label);
+  if (it == emitted_veneers_->end()) return false;
+  int64_t offset = (it->second - branch_pos) >> kInstructionSizeLog2;
+  if (!Instruction::IsValidImmPCOffset(branch_type, offset)) return false;
+  *imm_offset = offset;
+  return true;
+}
+
+
 bool VeneerPool::ShouldEmitVeneer(int64_t first_unreacheable_pc,
                                   size_t amount) {
   ptrdiff_t offset =
@@ -280,21 +427,33 @@ void VeneerPool::Emit(EmitOption option, size_t amount) {
     BranchInfo* branch_info = it.Current();
     if (ShouldEmitVeneer(branch_info->first_unreacheable_pc_,
                          amount + kVeneerEmissionMargin)) {
-      CodeBufferCheckScope scope(masm_,
-                                 kVeneerCodeSize,
-                                 CodeBufferCheckScope::kCheck,
-                                 CodeBufferCheckScope::kExactSize);
       ptrdiff_t branch_pos = branch_info->pc_offset_;
       Instruction* branch = masm_->GetInstructionAt(branch_pos);
       Label* label = branch_info->label_;
 
-      // Patch the branch to point to the current position, and emit a branch
-      // to the label.
-      Instruction* veneer = masm_->GetCursorAddress<Instruction*>();
-      branch->SetImmPCOffsetTarget(veneer);
-      {
-        ExactAssemblyScopeWithoutPoolsCheck guard(masm_, kInstructionSize);
-        masm_->b(label);
+      int64_t imm_offset;
+      if (FindReachableVeneer(branch_pos,
+                              label,
+                              branch_info->branch_type_,
+                              &imm_offset)) {
+        // Reuse a veneer emitted earlier for the same label.
+        branch->SetImmPCOffsetTarget(branch->GetInstructionAtOffset(
+            imm_offset * kInstructionSize));
+      } else {
+        CodeBufferCheckScope scope(masm_,
+                                   kVeneerCodeSize,
+                                   CodeBufferCheckScope::kCheck,
+                                   CodeBufferCheckScope::kExactSize);
+        // Patch the branch to point to the current position, and emit a
+        // branch to the label.
+        if (emitted_veneers_ == NULL) CreateEmittedVeneerMap();
+        (*emitted_veneers_)[label] = masm_->GetCursorOffset();
+        Instruction* veneer = masm_->GetCursorAddress<Instruction*>();
+        branch->SetImmPCOffsetTarget(veneer);
+        {
+          ExactAssemblyScopeWithoutPoolsCheck guard(masm_, kInstructionSize);
+          masm_->b(label);
+        }
       }
 
       // Update the label. The branch patched does not point to it any longer.
@@ -312,7 +471,8 @@ void VeneerPool::Emit(EmitOption option, size_t amount) {
 }
 
 
-MacroAssembler::MacroAssembler(PositionIndependentCodeOption pic)
+MacroAssembler::MacroAssembler(PositionIndependentCodeOption pic,
+                               Arena* arena)
     : Assembler(pic),
 #ifdef VIXL_DEBUG
       allow_macro_instructions_(true),
@@ -326,7 +486,14 @@ MacroAssembler::MacroAssembler(PositionIndependentCodeOption pic)
       literal_pool_(this),
       veneer_pool_(this),
       recommended_checkpoint_(Pool::kNoCheckpointRequired),
-      fp_nan_propagation_(NoFPMacroNaNPropagationSelected) {
+      fp_nan_propagation_(NoFPMacroNaNPropagationSelected),
+      minimal_move_immediates_(false),
+      relaxation_start_(-1),
+      peephole_(NULL),
+      scheduler_(NULL) {
+  SetArena(arena);
+  literal_pool_.SetArena(arena);
+  veneer_pool_.SetArena(arena);
   checkpoint_ = GetNextCheckPoint();
 #ifndef VIXL_DEBUG
   USE(allow_macro_instructions_);
@@ -335,7 +502,8 @@ MacroAssembler::MacroAssembler(PositionIndependentCodeOption pic)
 
 
 MacroAssembler::MacroAssembler(size_t capacity,
-                               PositionIndependentCodeOption pic)
+                               PositionIndependentCodeOption pic,
+                               Arena* arena)
     : Assembler(capacity, pic),
 #ifdef VIXL_DEBUG
       allow_macro_instructions_(true),
@@ -349,14 +517,22 @@ MacroAssembler::MacroAssembler(size_t capacity,
       literal_pool_(this),
       veneer_pool_(this),
       recommended_checkpoint_(Pool::kNoCheckpointRequired),
-      fp_nan_propagation_(NoFPMacroNaNPropagationSelected) {
+      fp_nan_propagation_(NoFPMacroNaNPropagationSelected),
+      minimal_move_immediates_(false),
+      relaxation_start_(-1),
+      peephole_(NULL),
+      scheduler_(NULL) {
+  SetArena(arena);
+  literal_pool_.SetArena(arena);
+  veneer_pool_.SetArena(arena);
   checkpoint_ = GetNextCheckPoint();
 }
 
 
 MacroAssembler::MacroAssembler(byte* buffer,
                                size_t capacity,
-                               PositionIndependentCodeOption pic)
+                               PositionIndependentCodeOption pic,
+                               Arena* arena)
     : Assembler(buffer, capacity, pic),
 #ifdef VIXL_DEBUG
       allow_macro_instructions_(true),
@@ -370,7 +546,43 @@ MacroAssembler::MacroAssembler(byte* buffer,
       literal_pool_(this),
       veneer_pool_(this),
       recommended_checkpoint_(Pool::kNoCheckpointRequired),
-      fp_nan_propagation_(NoFPMacroNaNPropagationSelected) {
+      fp_nan_propagation_(NoFPMacroNaNPropagationSelected),
+      minimal_move_immediates_(false),
+      relaxation_start_(-1),
+      peephole_(NULL),
+      scheduler_(NULL) {
+  SetArena(arena);
+  literal_pool_.SetArena(arena);
+  veneer_pool_.SetArena(arena);
+  checkpoint_ = GetNextCheckPoint();
+}
+
+
+MacroAssembler::MacroAssembler(SharedCodeBuffer* shared,
+                               size_t capacity,
+                               PositionIndependentCodeOption pic,
+                               Arena* arena)
+    : Assembler(shared, capacity, pic),
+#ifdef VIXL_DEBUG
+      allow_macro_instructions_(true),
+#endif
+      generate_simulator_code_(VIXL_AARCH64_GENERATE_SIMULATOR_CODE),
+      sp_(sp),
+      tmp_list_(ip0, ip1),
+      v_tmp_list_(d31),
+      p_tmp_list_(CPURegList::Empty(CPURegister::kPRegister)),
+      current_scratch_scope_(NULL),
+      literal_pool_(this),
+      veneer_pool_(this),
+      recommended_checkpoint_(Pool::kNoCheckpointRequired),
+      fp_nan_propagation_(NoFPMacroNaNPropagationSelected),
+      minimal_move_immediates_(false),
+      relaxation_start_(-1),
+      peephole_(NULL),
+      scheduler_(NULL) {
+  SetArena(arena);
+  literal_pool_.SetArena(arena);
+  veneer_pool_.SetArena(arena);
   checkpoint_ = GetNextCheckPoint();
 }
 
@@ -381,6 +593,7 @@ MacroAssembler::~MacroAssembler() {}
 void MacroAssembler::Reset() {
   Assembler::Reset();
 
+  VIXL_ASSERT(!IsRelaxingBranches());
   VIXL_ASSERT(!literal_pool_.IsBlocked());
   literal_pool_.Reset();
   veneer_pool_.Reset();
@@ -390,6 +603,7 @@ void MacroAssembler::Reset() {
 
 
 void MacroAssembler::FinalizeCode(FinalizeOption option) {
+  VIXL_ASSERT(!IsRelaxingBranches());
   if (!literal_pool_.IsEmpty()) {
     // The user may decide to emit more code after Finalize, emit a branch if
     // that's the case.
@@ -402,6 +616,69 @@ void MacroAssembler::FinalizeCode(FinalizeOption option) {
 }
 
 
+void MacroAssembler::MovExternalAddress(const Register& rd,
+                                        uint32_t symbol,
+                                        uintptr_t address) {
+  VIXL_ASSERT(allow_macro_instructions_);
+  VIXL_ASSERT(symbol != Relocation::kCodeStart);
+  EmitRelocatedMovWide(rd, symbol, 0, address);
+}
+
+
+void MacroAssembler::MovCodeAddress(const Register& rd, const Label* label) {
+  VIXL_ASSERT(allow_macro_instructions_);
+  VIXL_ASSERT(label->IsBound());
+  EmitRelocatedMovWide(rd,
+                       Relocation::kCodeStart,
+                       label->GetLocation(),
+                       GetLabelAddress<uintptr_t>(label));
+}
+
+
+void MacroAssembler::EmitRelocatedMovWide(const Register& rd,
+                                          uint32_t symbol,
+                                          int64_t addend,
+                                          uint64_t value) {
+  VIXL_ASSERT(rd.IsX());
+  // Branch relaxation may move the code after it has been emitted.
+  VIXL_ASSERT(!IsRelaxingBranches());
+  // Always use the same sequence, so that any address can be patched in.
+  ExactAssemblyScope scope(this, 4 * kInstructionSize);
+  RecordRelocation(GetCursorOffset(), Relocation::kMovWide64, symbol, addend);
+  movz(rd, value & 0xffff, 0);
+  movk(rd, (value >> 16) & 0xffff, 16);
+  movk(rd, (value >> 32) & 0xffff, 32);
+  movk(rd, (value >> 48) & 0xffff, 48);
+}
+
+
+void MacroAssembler::LdrExternalAddress(const Register& rt,
+                                        uint32_t symbol,
+                                        uintptr_t address) {
+  VIXL_ASSERT(allow_macro_instructions_);
+  VIXL_ASSERT(rt.IsX());
+  VIXL_ASSERT(symbol != Relocation::kCodeStart);
+  VIXL_ASSERT(!IsRelaxingBranches());
+  // This literal is not shared with other loads of the same value, since it
+  // carries a relocation.
+  Literal<uint64_t>* literal =
+      new Literal<uint64_t>(address,
+                            &literal_pool_,
+                            RawLiteral::kDeletedOnPlacementByPool);
+  literal->SetRelocation(symbol);
+  Ldr(rt, literal);
+}
+
+
+void MacroAssembler::CallExternal(uint32_t symbol, uintptr_t address) {
+  VIXL_ASSERT(allow_macro_instructions_);
+  UseScratchRegisterScope temps(this);
+  Register temp = temps.AcquireX();
+  MovExternalAddress(temp, symbol, address);
+  Blr(temp);
+}
+
+
 void MacroAssembler::CheckEmitFor(size_t amount) {
   CheckEmitPoolsFor(amount);
   GetBuffer()->EnsureSpaceFor(amount);
@@ -425,87 +702,37 @@ int MacroAssembler::MoveImmediateHelper(MacroAssembler* masm,
   //  * 1 instruction to move to sp
   MacroEmissionCheckScope guard(masm);
 
-  // Immediates on Aarch64 can be produced using an initial value, and zero to
-  // three move keep operations.
-  //
-  // Initial values can be generated with:
-  //  1. 64-bit move zero (movz).
-  //  2. 32-bit move inverted (movn).
-  //  3. 64-bit move inverted.
-  //  4. 32-bit orr immediate.
-  //  5. 64-bit orr immediate.
-  // Move-keep may then be used to modify each of the 16-bit half words.
-  //
-  // The code below supports all five initial value generators, and
-  // applying move-keep operations to move-zero and move-inverted initial
-  // values.
-
-  // Try to move the immediate in one instruction, and if that fails, switch to
-  // using multiple instructions.
+  // Try to move the immediate in one instruction, and if that fails, use
+  // `movz` or `movn` followed by `movk`. If the MacroAssembler searches for
+  // minimal sequences, also consider 32-bit initial values, logical
+  // immediates combined with `movk`, and copying the low word into the high
+  // word. See `MoveImmediateSequence` for details.
   if (OneInstrMoveImmediateHelper(masm, rd, imm)) {
     return 1;
-  } else {
-    int instruction_count = 0;
-    unsigned reg_size = rd.GetSizeInBits();
-
-    // Generic immediate case. Imm will be represented by
-    //   [imm3, imm2, imm1, imm0], where each imm is 16 bits.
-    // A move-zero or move-inverted is generated for the first non-zero or
-    // non-0xffff immX, and a move-keep for subsequent non-zero immX.
+  }
 
-    uint64_t ignored_halfword = 0;
-    bool invert_move = false;
-    // If the number of 0xffff halfwords is greater than the number of 0x0000
-    // halfwords, it's more efficient to use move-inverted.
-    if (CountClearHalfWords(~imm, reg_size) >
-        CountClearHalfWords(imm, reg_size)) {
-      ignored_halfword = 0xffff;
-      invert_move = true;
-    }
+  unsigned reg_size = rd.GetSizeInBits();
+  MoveImmediateSequence sequence;
+  // Logical immediate instructions can't write to the zero register, so it
+  // only uses `movz`, `movn` and `movk`.
+  if (!emit_code || !masm->UseMinimalMoveImmediates() || rd.IsZero()) {
+    MoveImmediateSequence::FindGreedy(imm, reg_size, &sequence);
+  } else if (!masm->move_immediate_cache_.Lookup(imm, reg_size, &sequence)) {
+    MoveImmediateSequence::FindMinimal(imm, reg_size, &sequence);
+    masm->move_immediate_cache_.Insert(imm, reg_size, sequence);
+  }
+  int instruction_count = sequence.GetLength();
 
+  if (emit_code) {
     // Mov instructions can't move values into the stack pointer, so set up a
     // temporary register, if needed.
-    UseScratchRegisterScope temps;
-    Register temp;
-    if (emit_code) {
-      temps.Open(masm);
-      temp = rd.IsSP() ? temps.AcquireSameSizeAs(rd) : rd;
-    }
-
-    // Iterate through the halfwords. Use movn/movz for the first non-ignored
-    // halfword, and movk for subsequent halfwords.
-    VIXL_ASSERT((reg_size % 16) == 0);
-    bool first_mov_done = false;
-    for (unsigned i = 0; i < (reg_size / 16); i++) {
-      uint64_t imm16 = (imm >> (16 * i)) & 0xffff;
-      if (imm16 != ignored_halfword) {
-        if (!first_mov_done) {
-          if (invert_move) {
-            if (emit_code) masm->movn(temp, ~imm16 & 0xffff, 16 * i);
-            instruction_count++;
-          } else {
-            if (emit_code) masm->movz(temp, imm16, 16 * i);
-            instruction_count++;
-          }
-          first_mov_done = true;
-        } else {
-          // Construct a wider constant.
-          if (emit_code) masm->movk(temp, imm16, 16 * i);
-          instruction_count++;
-        }
-      }
-    }
-
-    VIXL_ASSERT(first_mov_done);
-
-    // Move the temporary if the original destination register was the stack
-    // pointer.
-    if (rd.IsSP()) {
-      if (emit_code) masm->mov(rd, temp);
-      instruction_count++;
-    }
-    return instruction_count;
+    UseScratchRegisterScope temps(masm);
+    Register temp = rd.IsSP() ? temps.AcquireSameSizeAs(rd) : rd;
+    sequence.Emit(masm, temp);
+    if (rd.IsSP()) masm->mov(rd, temp);
   }
+  if (rd.IsSP()) instruction_count++;
+  return instruction_count;
 }
 
 
@@ -546,6 +773,10 @@ void MacroAssembler::B(Label* label) {
   // than the range of this branch.
   VIXL_ASSERT(Instruction::GetImmBranchForwardRange(UncondBranchType) >
               Instruction::kLoadLiteralRange);
+  if (IsRelaxingBranches()) {
+    RecordRelaxedBranch(label, UncondBranchType);
+    return;
+  }
   SingleEmissionCheckScope guard(this);
   b(label);
 }
@@ -559,13 +790,24 @@ void MacroAssembler::B(Label* label, Condition cond) {
               Instruction::kLoadLiteralRange);
   VIXL_ASSERT(allow_macro_instructions_);
   VIXL_ASSERT((cond != al) && (cond != nv));
+  if (IsRelaxingBranches()) {
+    RecordRelaxedBranch(label, CondBranchType, cond);
+    return;
+  }
   EmissionCheckScope guard(this, 2 * kInstructionSize);
 
+  int64_t imm_offset;
   if (label->IsBound() && LabelIsOutOfRange(label, CondBranchType)) {
     Label done;
     b(&done, InvertCondition(cond));
     b(label);
     bind(&done);
+  } else if (veneer_pool_.FindReachableVeneer(GetCursorOffset(),
+                                              label,
+                                              CondBranchType,
+                                              &imm_offset)) {
+    // Branch to the veneer already emitted for the label.
+    b(imm_offset, cond);
   } else {
     if (!label->IsBound()) {
       veneer_pool_.RegisterUnresolvedBranch(GetCursorOffset(),
@@ -585,13 +827,24 @@ void MacroAssembler::Cbnz(const Register& rt, Label* label) {
               Instruction::kLoadLiteralRange);
   VIXL_ASSERT(allow_macro_instructions_);
   VIXL_ASSERT(!rt.IsZero());
+  if (IsRelaxingBranches()) {
+    RecordRelaxedBranch(label, CompareBranchType, ne, rt);
+    return;
+  }
   EmissionCheckScope guard(this, 2 * kInstructionSize);
 
+  int64_t imm_offset;
   if (label->IsBound() && LabelIsOutOfRange(label, CondBranchType)) {
     Label done;
     cbz(rt, &done);
     b(label);
     bind(&done);
+  } else if (veneer_pool_.FindReachableVeneer(GetCursorOffset(),
+                                              label,
+                                              CompareBranchType,
+                                              &imm_offset)) {
+    // Branch to the veneer already emitted for the label.
+    cbnz(rt, imm_offset);
   } else {
     if (!label->IsBound()) {
       veneer_pool_.RegisterUnresolvedBranch(GetCursorOffset(),
@@ -611,13 +864,24 @@ void MacroAssembler::Cbz(const Register& rt, Label* label) {
               Instruction::kLoadLiteralRange);
   VIXL_ASSERT(allow_macro_instructions_);
   VIXL_ASSERT(!rt.IsZero());
+  if (IsRelaxingBranches()) {
+    RecordRelaxedBranch(label, CompareBranchType, eq, rt);
+    return;
+  }
   EmissionCheckScope guard(this, 2 * kInstructionSize);
 
+  int64_t imm_offset;
   if (label->IsBound() && LabelIsOutOfRange(label, CondBranchType)) {
     Label done;
     cbnz(rt, &done);
     b(label);
     bind(&done);
+  } else if (veneer_pool_.FindReachableVeneer(GetCursorOffset(),
+                                              label,
+                                              CompareBranchType,
+                                              &imm_offset)) {
+    // Branch to the veneer already emitted for the label.
+    cbz(rt, imm_offset);
   } else {
     if (!label->IsBound()) {
       veneer_pool_.RegisterUnresolvedBranch(GetCursorOffset(),
@@ -636,13 +900,24 @@ void MacroAssembler::Tbnz(const Register& rt, unsigned bit_pos, Label* label) {
       Instruction::GetImmBranchForwardRange(TestBranchType));
   VIXL_ASSERT(allow_macro_instructions_);
   VIXL_ASSERT(!rt.IsZero());
+  if (IsRelaxingBranches()) {
+    RecordRelaxedBranch(label, TestBranchType, ne, rt, bit_pos);
+    return;
+  }
   EmissionCheckScope guard(this, 2 * kInstructionSize);
 
+  int64_t imm_offset;
   if (label->IsBound() && LabelIsOutOfRange(label, TestBranchType)) {
     Label done;
     tbz(rt, bit_pos, &done);
     b(label);
     bind(&done);
+  } else if (veneer_pool_.FindReachableVeneer(GetCursorOffset(),
+                                              label,
+                                              TestBranchType,
+                                              &imm_offset)) {
+    // Branch to the veneer already emitted for the label.
+    tbnz(rt, bit_pos, imm_offset);
   } else {
     if (!label->IsBound()) {
       veneer_pool_.RegisterUnresolvedBranch(GetCursorOffset(),
@@ -661,13 +936,24 @@ void MacroAssembler::Tbz(const Register& rt, unsigned bit_pos, Label* label) {
       Instruction::GetImmBranchForwardRange(TestBranchType));
   VIXL_ASSERT(allow_macro_instructions_);
   VIXL_ASSERT(!rt.IsZero());
+  if (IsRelaxingBranches()) {
+    RecordRelaxedBranch(label, TestBranchType, eq, rt, bit_pos);
+    return;
+  }
   EmissionCheckScope guard(this, 2 * kInstructionSize);
 
+  int64_t imm_offset;
   if (label->IsBound() && LabelIsOutOfRange(label, TestBranchType)) {
     Label done;
     tbnz(rt, bit_pos, &done);
     b(label);
     bind(&done);
+  } else if (veneer_pool_.FindReachableVeneer(GetCursorOffset(),
+                                              label,
+                                              TestBranchType,
+                                              &imm_offset)) {
+    // Branch to the veneer already emitted for the label.
+    tbz(rt, bit_pos, imm_offset);
   } else {
     if (!label->IsBound()) {
       veneer_pool_.RegisterUnresolvedBranch(GetCursorOffset(),
@@ -680,14 +966,20 @@ void MacroAssembler::Tbz(const Register& rt, unsigned bit_pos, Label* label) {
 
 void MacroAssembler::Bind(Label* label, BranchTargetIdentifier id) {
   VIXL_ASSERT(allow_macro_instructions_);
-  veneer_pool_.DeleteUnresolvedBranchInfoForLabel(label);
+  if (IsRelaxingBranches()) {
+    // The label is bound when the region is laid out. The target identifier
+    // instruction is part of the region's code and directly follows it.
+    RecordRelaxedBranch(label, UnknownBranchType);
+  } else {
+    veneer_pool_.DeleteUnresolvedBranchInfoForLabel(label);
+  }
   if (id == EmitBTI_none) {
-    bind(label);
+    if (!IsRelaxingBranches()) bind(label);
   } else {
     // Emit this inside an ExactAssemblyScope to ensure there are no extra
     // instructions between the bind and the target identifier instruction.
     ExactAssemblyScope scope(this, kInstructionSize);
-    bind(label);
+    if (!IsRelaxingBranches()) bind(label);
     if (id == EmitPACIASP) {
       paciasp();
     } else if (id == EmitPACIBSP) {
@@ -701,11 +993,330 @@ void MacroAssembler::Bind(Label* label, BranchTargetIdentifier id) {
 // Bind a label to a specified offset from the start of the buffer.
 void MacroAssembler::BindToOffset(Label* label, ptrdiff_t offset) {
   VIXL_ASSERT(allow_macro_instructions_);
+  VIXL_ASSERT(!IsRelaxingBranches());
   veneer_pool_.DeleteUnresolvedBranchInfoForLabel(label);
   Assembler::BindToOffset(label, offset);
 }
 
 
+void MacroAssembler::OpenBranchRelaxation(Peephole* peephole,
+                                          Scheduler* scheduler) {
+  VIXL_ASSERT(allow_macro_instructions_);
+  VIXL_ASSERT(!IsRelaxingBranches());
+  VIXL_ASSERT(!IsLiteralPoolBlocked() && !IsVeneerPoolBlocked());
+  // The code in the region moves when it is laid out, so pools must not be
+  // emitted in it. Emit them now, including veneers for all pending branches
+  // since we do not know how much code the region will contain.
+  if (!veneer_pool_.IsEmpty()) {
+    veneer_pool_.Emit(VeneerPool::kBranchRequired,
+                      Instruction::GetImmBranchForwardRange(UncondBranchType));
+  }
+  EmitLiteralPool(LiteralPool::kBranchRequired);
+  BlockPools();
+  relaxation_start_ = GetCursorOffset();
+  relaxed_branches_.clear();
+  peephole_ = peephole;
+  scheduler_ = scheduler;
+}
+
+
+void MacroAssembler::CloseBranchRelaxation() {
+  VIXL_ASSERT(IsRelaxingBranches());
+  ptrdiff_t start = relaxation_start_;
+  relaxation_start_ = -1;
+  ptrdiff_t raw_size = GetCursorOffset() - start;
+  const byte* code = GetBuffer()->GetOffsetAddress<const byte*>(start);
+  std::vector<byte> raw(code, code + raw_size);
+#ifdef VIXL_DEBUG
+  CheckRelaxedRegion(raw);
+#endif
+  if ((peephole_ != NULL) || (scheduler_ != NULL)) {
+    OptimizeRelaxedRegion(&raw);
+    raw_size = raw.size();
+    peephole_ = NULL;
+    scheduler_ = NULL;
+  }
+
+  std::unordered_map<const Label*, size_t> bindings;
+  size_t branches_to_later_labels = 0;
+  for (size_t i = 0; i < relaxed_branches_.size(); i++) {
+    const RelaxedBranch& branch = relaxed_branches_[i];
+    if (branch.type == UnknownBranchType) {
+      VIXL_ASSERT(!branch.label->IsBound());
+      VIXL_ASSERT(bindings.find(branch.label) == bindings.end());
+      bindings[branch.label] = i;
+    }
+  }
+  for (const RelaxedBranch& branch : relaxed_branches_) {
+    if ((branch.type != UnknownBranchType) && !branch.label->IsBound() &&
+        (bindings.find(branch.label) == bindings.end())) {
+      branches_to_later_labels++;
+    }
+  }
+  // Short branches to labels bound after the region rely on veneers emitted
+  // after it, so they must remain in range for a while.
+  ptrdiff_t veneer_margin =
+      VeneerPool::kPoolNonVeneerCodeSize +
+      branches_to_later_labels * VeneerPool::kVeneerCodeSize + 1 * KBytes;
+
+  // Start with every branch in its short form, and lengthen the ones that do
+  // not reach their target. Lengthening a branch can only move targets further
+  // away, so this terminates once no branch changes.
+  std::vector<ptrdiff_t> positions(relaxed_branches_.size());
+  ptrdiff_t size;
+  bool changed;
+  do {
+    changed = false;
+    ptrdiff_t growth = 0;
+    for (size_t i = 0; i < relaxed_branches_.size(); i++) {
+      const RelaxedBranch& branch = relaxed_branches_[i];
+      positions[i] = branch.offset + growth;
+      if (branch.type != UnknownBranchType) {
+        growth += (branch.is_long ? 2 : 1) * kInstructionSize;
+      }
+    }
+    size = raw_size + growth;
+
+    for (size_t i = 0; i < relaxed_branches_.size(); i++) {
+      RelaxedBranch& branch = relaxed_branches_[i];
+      if ((branch.type == UnknownBranchType) ||
+          (branch.type == UncondBranchType) || branch.is_long) {
+        continue;
+      }
+      std::unordered_map<const Label*, size_t>::const_iterator binding =
+          bindings.find(branch.label);
+      bool reachable;
+      if (binding != bindings.end()) {
+        ptrdiff_t offset = positions[binding->second] - positions[i];
+        reachable = Instruction::IsValidImmPCOffset(branch.type,
+                                                    offset / kInstructionSize);
+      } else if (branch.label->IsBound()) {
+        ptrdiff_t offset = branch.label->GetLocation() - (start + positions[i]);
+        reachable = Instruction::IsValidImmPCOffset(branch.type,
+                                                    offset / kInstructionSize);
+      } else {
+        reachable = (size + veneer_margin - positions[i]) <
+                    Instruction::GetImmBranchForwardRange(branch.type);
+      }
+      if (!reachable) {
+        branch.is_long = true;
+        changed = true;
+      }
+    }
+  } while (changed);
+
+  GetBuffer()->Rewind(start);
+  {
+    CodeBufferCheckScope scope(this,
+                               size,
+                               CodeBufferCheckScope::kReserveBufferSpace,
+                               CodeBufferCheckScope::kExactSize);
+    ptrdiff_t raw_offset = 0;
+    for (const RelaxedBranch& branch : relaxed_branches_) {
+      if (branch.offset > raw_offset) {
+        GetBuffer()->EmitData(&raw[raw_offset], branch.offset - raw_offset);
+        raw_offset = branch.offset;
+      }
+      if (branch.type == UnknownBranchType) {
+        veneer_pool_.DeleteUnresolvedBranchInfoForLabel(branch.label);
+        bind(branch.label);
+      } else if (branch.is_long) {
+        Label done;
+        EmitRelaxedBranch(branch, &done, true);
+        b(branch.label);
+        bind(&done);
+      } else {
+        if (!branch.label->IsBound() &&
+            (bindings.find(branch.label) == bindings.end()) &&
+            veneer_pool_.BranchTypeUsesVeneers(branch.type)) {
+          veneer_pool_.RegisterUnresolvedBranch(GetCursorOffset(),
+                                                branch.label,
+                                                branch.type);
+        }
+        EmitRelaxedBranch(branch, branch.label, false);
+      }
+    }
+    if (raw_size > raw_offset) {
+      GetBuffer()->EmitData(&raw[raw_offset], raw_size - raw_offset);
+    }
+  }
+
+  relaxed_branches_.clear();
+  ReleasePools();
+  checkpoint_ = GetNextCheckPoint();
+}
+
+
+#ifdef VIXL_DEBUG
+void MacroAssembler::CheckRelaxedRegion(const std::vector<byte>& raw) const {
+  // Literals and veneers record the position of the code using them, which
+  // is about to move.
+  VIXL_ASSERT(literal_pool_.IsEmpty());
+  VIXL_ASSERT(veneer_pool_.IsEmpty());
+  // Only the recorded branches are emitted again once the region has been
+  // laid out, so any other PC-relative instruction would refer to the wrong
+  // place. This also catches the labels linked to from the region.
+  size_t offset = 0;
+  while (offset < raw.size()) {
+    size_t pseudo_size = GetDebugHltSizeAt(raw, offset, raw.size());
+    if (pseudo_size > 0) {
+      offset += pseudo_size;
+      continue;
+    }
+    const Instruction* instr =
+        reinterpret_cast<const Instruction*>(&raw[offset]);
+    VIXL_ASSERT(!instr->IsImmBranch() && !instr->IsPCRelAddressing() &&
+                !instr->IsLoadLiteral());
+    offset += kInstructionSize;
+  }
+}
+#endif
+
+
+size_t MacroAssembler::GetDebugHltSizeAt(const std::vector<byte>& raw,
+                                         size_t offset,
+                                         size_t end) const {
+  VIXL_ASSERT(end <= raw.size());
+  // Without the simulator, HLT is an ordinary instruction.
+  if (!generate_simulator_code_ || (offset >= end)) return 0;
+  return GetDebugHltSize(reinterpret_cast<const Instruction*>(&raw[offset]),
+                         end - offset);
+}
+
+
+void MacroAssembler::OptimizeRelaxedRegion(std::vector<byte>* raw) {
+  std::vector<byte> optimized;
+  optimized.reserve(raw->size());
+  size_t raw_offset = 0;
+  // Each segment runs up to the next branch or binding, or to the end of the
+  // region for the last one.
+  for (size_t i = 0; i <= relaxed_branches_.size(); i++) {
+    RelaxedBranch* branch =
+        (i < relaxed_branches_.size()) ? &relaxed_branches_[i] : NULL;
+    size_t end = (branch != NULL) ? branch->offset : raw->size();
+    // Debug pseudo instructions also end a segment. They are copied as they
+    // are, with their arguments, which are data.
+    while (raw_offset < end) {
+      size_t segment_end = raw_offset;
+      size_t pseudo_size = 0;
+      while (segment_end < end) {
+        pseudo_size = GetDebugHltSizeAt(*raw, segment_end, end);
+        if (pseudo_size > 0) break;
+        segment_end += kInstructionSize;
+      }
+      OptimizeRelaxedSegment(*raw,
+                             raw_offset,
+                             segment_end,
+                             (segment_end == end) ? branch : NULL,
+                             &optimized);
+      optimized.insert(optimized.end(),
+                       raw->begin() + segment_end,
+                       raw->begin() + segment_end + pseudo_size);
+      raw_offset = segment_end + pseudo_size;
+    }
+    if (branch != NULL) branch->offset = optimized.size();
+  }
+  raw->swap(optimized);
+}
+
+
+void MacroAssembler::OptimizeRelaxedSegment(const std::vector<byte>& raw,
+                                            size_t start,
+                                            size_t end,
+                                            RelaxedBranch* branch,
+                                            std::vector<byte>* optimized) {
+  VIXL_ASSERT(IsAligned(end - start, kInstructionSize));
+  std::vector<Instr> segment((end - start) / kInstructionSize);
+  if (!segment.empty()) {
+    memcpy(segment.data(), raw.data() + start, end - start);
+  }
+
+  if (peephole_ != NULL) {
+    peephole_->Optimize(&segment);
+    Register rt;
+    if ((branch != NULL) && (branch->type == CondBranchType) &&
+        !segment.empty() &&
+        peephole_->FoldCompareIntoBranch(segment.back(), branch->cond, &rt)) {
+      segment.pop_back();
+      branch->type = CompareBranchType;
+      branch->rt = rt;
+    }
+  }
+  // Scheduling preserves the values left in registers and flags at the end
+  // of the segment, so it does not affect the branch.
+  if (scheduler_ != NULL) scheduler_->Schedule(&segment);
+
+  const byte* bytes = reinterpret_cast<const byte*>(segment.data());
+  optimized->insert(optimized->end(),
+                    bytes,
+                    bytes + (segment.size() * kInstructionSize));
+}
+
+
+void MacroAssembler::RecordRelaxedBranch(Label* label,
+                                         ImmBranchType type,
+                                         Condition cond,
+                                         const Register& rt,
+                                         unsigned bit_pos) {
+  RelaxedBranch branch;
+  branch.offset = GetCursorOffset() - relaxation_start_;
+  branch.label = label;
+  branch.type = type;
+  branch.cond = cond;
+  branch.rt = rt;
+  branch.bit_pos = bit_pos;
+  branch.is_long = false;
+  relaxed_branches_.push_back(branch);
+}
+
+
+void MacroAssembler::EmitRelaxedBranch(const RelaxedBranch& branch,
+                                       Label* label,
+                                       bool invert) {
+  Condition cond = invert ? InvertCondition(branch.cond) : branch.cond;
+  switch (branch.type) {
+    case CondBranchType:
+      b(label, cond);
+      break;
+    case CompareBranchType:
+      if (cond == eq) {
+        cbz(branch.rt, label);
+      } else {
+        cbnz(branch.rt, label);
+      }
+      break;
+    case TestBranchType:
+      if (cond == eq) {
+        tbz(branch.rt, branch.bit_pos, label);
+      } else {
+        tbnz(branch.rt, branch.bit_pos, label);
+      }
+      break;
+    case UncondBranchType:
+      VIXL_ASSERT(!invert);
+      b(label);
+      break;
+    default:
+      VIXL_UNREACHABLE();
+  }
+}
+
+
+BranchRelaxationScope::BranchRelaxationScope(MacroAssembler* masm,
+                                             Peephole* peephole,
+                                             Scheduler* scheduler)
+    : masm_(masm) {
+  masm_->OpenBranchRelaxation(peephole, scheduler);
+}
+
+
+void BranchRelaxationScope::Close() {
+  if (masm_ == NULL) return;
+  masm_->CloseBranchRelaxation();
+  masm_ = NULL;
+}
+
+
 void MacroAssembler::And(const Register& rd,
                          const Register& rn,
                          const Operand& operand) {
@@ -1568,10 +2179,8 @@ void MacroAssembler::Fmov(VRegister vd, double imm) {
   if (IsImmFP64(rawbits)) {
     fmov(vd, imm);
   } else if (vd.IsScalar()) {
-    ldr(vd,
-        new Literal<double>(imm,
-                            &literal_pool_,
-                            kDeletedOnPlacementByPool));
+    VIXL_ASSERT(!IsRelaxingBranches());
+    ldr(vd, literal_pool_.GetPooledLiteral(imm));
   } else {
     // TODO: consider NEON support for load literal.
     Movi(vd, rawbits);
@@ -1604,10 +2213,8 @@ void MacroAssembler::Fmov(VRegister vd, float imm) {
   if (IsImmFP32(rawbits)) {
     fmov(vd, imm);
   } else if (vd.IsScalar()) {
-    ldr(vd,
-        new Literal<float>(imm,
-                           &literal_pool_,
-                           kDeletedOnPlacementByPool));
+    VIXL_ASSERT(!IsRelaxingBranches());
+    ldr(vd, literal_pool_.GetPooledLiteral(imm));
   } else {
     // TODO: consider NEON support for load literal.
     Movi(vd, rawbits);
@@ -29,12 +29,17 @@
 
 #include <algorithm>
 #include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
+#include "../arena-vixl.h"
 #include "../code-generation-scopes-vixl.h"
 #include "../globals-vixl.h"
 #include "../macro-assembler-interface.h"
 
 #include "assembler-aarch64.h"
+#include "move-immediate-aarch64.h"
 // Required for runtime call support.
 // TODO: Break this dependency. We should be able to separate out the necessary
 // parts so that we don't need to include the whole simulator header.
@@ -67,6 +72,8 @@ namespace aarch64 {
 
 // Forward declaration
 class MacroAssembler;
+class Peephole;
+class Scheduler;
 class UseScratchRegisterScope;
 
 class Pool {
@@ -139,15 +146,73 @@ class LiteralPool : public Pool {
 
   void UpdateFirstUse(ptrdiff_t use_position);
 
+  // Allocate the pool's bookkeeping and pool-owned literals from `arena`. This
+  // can only be called while the pool is empty.
+  void SetArena(Arena* arena);
+
   void DeleteOnDestruction(RawLiteral* literal) {
     deleted_on_destruction_.push_back(literal);
   }
 
+  // Return a literal holding `value`, owned by the pool and destroyed when the
+  // pool is emitted. This is used for the MacroAssembler's immediate loads.
+  // Literals with the same size and value share a single entry in the pool.
+  template <typename T>
+  RawLiteral* GetPooledLiteral(T value);
+  template <typename T>
+  RawLiteral* GetPooledLiteral(T high64, T low64);
+
   // Recommended not exact since the pool can be blocked for short periods.
   static const ptrdiff_t kRecommendedLiteralPoolRange = 128 * KBytes;
 
  private:
-  std::vector<RawLiteral*> entries_;
+  struct PooledLiteralKey {
+    bool operator==(const PooledLiteralKey& other) const {
+      return (size == other.size) && (low64 == other.low64) &&
+             (high64 == other.high64);
+    }
+    size_t size;
+    uint64_t low64;
+    uint64_t high64;
+  };
+
+  struct PooledLiteralKeyHash {
+    size_t operator()(const PooledLiteralKey& key) const {
+      uint64_t hash = key.low64 ^ (key.high64 * 0x9e3779b97f4a7c15);
+      hash += key.size;
+      return static_cast<size_t>(hash ^ (hash >> 32));
+    }
+  };
+
+  // All the `Literal<T>` types have the same layout as `RawLiteral`.
+  struct alignas(RawLiteral) PooledLiteralStorage {
+    char bytes[sizeof(RawLiteral)];
+  };
+
+  // Pool-owned literals are allocated from chunks of this many literals. The
+  // chunks are kept when the pool is emitted, and reused for the next one.
+  static const size_t kPooledLiteralChunkSize = 64;
+
+  typedef std::vector<RawLiteral*, ArenaAllocator<RawLiteral*> > EntryVector;
+  typedef std::unordered_map<
+      PooledLiteralKey,
+      RawLiteral*,
+      PooledLiteralKeyHash,
+      std::equal_to<PooledLiteralKey>,
+      ArenaAllocator<std::pair<const PooledLiteralKey, RawLiteral*> > >
+      PooledLiteralMap;
+
+  // Return the map of pool-owned literals, creating it if necessary.
+  PooledLiteralMap* GetPooledLiteralMap() {
+    if (pooled_literals_ == NULL) CreatePooledLiteralMap();
+    return pooled_literals_;
+  }
+  void CreatePooledLiteralMap();
+
+  void* AllocatePooledLiteral();
+  void PlaceEntries();
+
+  EntryVector entries_;
   size_t size_;
   ptrdiff_t first_use_;
   // The parent class `Pool` provides a `checkpoint_`, which is the buffer
@@ -158,6 +223,17 @@ class LiteralPool : public Pool {
   ptrdiff_t recommended_checkpoint_;
 
   std::vector<RawLiteral*> deleted_on_destruction_;
+
+  // Pool-owned literals in the current pool, by value. This is created on first
+  // use, and discarded when the pool is emitted if it lives in an arena.
+  PooledLiteralMap* pooled_literals_;
+  // Storage for pool-owned literals, used when there is no arena.
+  std::vector<std::unique_ptr<PooledLiteralStorage[]>> pooled_literal_chunks_;
+  size_t pooled_literal_count_;
+
+  // If not NULL, `entries_`, `pooled_literals_` and pool-owned literals are
+  // allocated from this arena.
+  Arena* arena_;
 };
 
 
@@ -178,12 +254,48 @@ inline ptrdiff_t LiteralPool::GetNextRecommendedCheckpoint() {
 }
 
 
+template <typename T>
+RawLiteral* LiteralPool::GetPooledLiteral(T value) {
+  VIXL_STATIC_ASSERT(sizeof(Literal<T>) == sizeof(PooledLiteralStorage));
+  PooledLiteralKey key = {sizeof(value), 0, 0};
+  memcpy(&key.low64, &value, sizeof(value));
+  RawLiteral*& literal = (*GetPooledLiteralMap())[key];
+  if (literal == NULL) {
+    // The pool destroys these literals itself, in `Reset()`.
+    literal = new (AllocatePooledLiteral())
+        Literal<T>(value, this, RawLiteral::kManuallyDeleted);
+  }
+  return literal;
+}
+
+
+template <typename T>
+RawLiteral* LiteralPool::GetPooledLiteral(T high64, T low64) {
+  VIXL_STATIC_ASSERT(sizeof(Literal<T>) == sizeof(PooledLiteralStorage));
+  PooledLiteralKey key = {kQRegSizeInBytes, 0, 0};
+  memcpy(&key.low64, &low64, sizeof(low64));
+  memcpy(&key.high64, &high64, sizeof(high64));
+  RawLiteral*& literal = (*GetPooledLiteralMap())[key];
+  if (literal == NULL) {
+    literal = new (AllocatePooledLiteral())
+        Literal<T>(high64, low64, this, RawLiteral::kManuallyDeleted);
+  }
+  return literal;
+}
+
+
 class VeneerPool : public Pool {
  public:
-  explicit VeneerPool(MacroAssembler* masm) : Pool(masm) {}
+  explicit VeneerPool(MacroAssembler* masm)
+      : Pool(masm), emitted_veneers_(NULL), arena_(NULL) {}
+  ~VeneerPool();
 
   void Reset();
 
+  // Allocate the records of unresolved branches and emitted veneers from
+  // `arena`. This can only be called while the pool is empty.
+  void SetArena(Arena* arena);
+
   void Block() { monitor_++; }
   void Release();
   bool IsBlocked() const { return monitor_ != 0; }
@@ -264,6 +376,18 @@ class VeneerPool : public Pool {
   void CheckEmitFor(size_t amount, EmitOption option = kBranchRequired);
   void Emit(EmitOption option, size_t margin);
 
+  // Veneers are shared between branches to the same label. If a veneer for
+  // `label` has already been emitted and is in range of a branch of type
+  // `branch_type` at `branch_pos`, return true and set `*imm_offset` to the
+  // branch immediate (in instructions) targeting it.
+  bool FindReachableVeneer(ptrdiff_t branch_pos,
+                           const Label* label,
+                           ImmBranchType branch_type,
+                           int64_t* imm_offset) const {
+    if ((emitted_veneers_ == NULL) || emitted_veneers_->empty()) return false;
+    return FindReachableVeneerSlow(branch_pos, label, branch_type, imm_offset);
+  }
+
   // The code size generated for a veneer. Currently one branch instruction.
   // This is for code size checking purposes, and can be extended in the future
   // for example if we decide to add nops between the veneers.
@@ -387,6 +511,12 @@ class VeneerPool : public Pool {
       }
     }
 
+    void SetArena(Arena* arena) {
+      for (int i = 0; i < kNumberOfTrackedBranchTypes; i++) {
+        typed_set_[i].SetArena(arena);
+      }
+    }
+
     static ImmBranchType BranchTypeFromIndex(int index) {
       switch (index) {
         case 0:
@@ -501,8 +631,32 @@ class VeneerPool : public Pool {
     return GetNextCheckPoint();
   }
 
+  bool FindReachableVeneerSlow(ptrdiff_t branch_pos,
+                               const Label* label,
+                               ImmBranchType branch_type,
+                               int64_t* imm_offset) const;
+
   // Information about unresolved (forward) branches.
   BranchInfoSet unresolved_branches_;
+
+  typedef std::unordered_map<
+      const Label*,
+      ptrdiff_t,
+      std::hash<const Label*>,
+      std::equal_to<const Label*>,
+      ArenaAllocator<std::pair<const Label* const, ptrdiff_t> > >
+      EmittedVeneerMap;
+
+  void CreateEmittedVeneerMap();
+
+  // The offset of the most recently emitted veneer for each label that is not
+  // bound yet. This is created when the first veneer is emitted, and discarded
+  // by `Reset()` if it lives in an arena.
+  EmittedVeneerMap* emitted_veneers_;
+
+  // If not NULL, the arena `unresolved_branches_` and `emitted_veneers_` are
+  // allocated from.
+  Arena* arena_;
 };
 
 
@@ -664,13 +818,28 @@ enum FPMacroNaNPropagationOption {
 
 class MacroAssembler : public Assembler, public MacroAssemblerInterface {
  public:
+  // If `arena` is not NULL, the bookkeeping for labels, veneers and literal
+  // pools is allocated from it instead of the global allocator. This memory is
+  // only released when the arena is reset, which is only safe after `Reset()`
+  // has been called (or the MacroAssembler destroyed), and once every label
+  // used is bound or destroyed. User-allocated literals are not affected.
   explicit MacroAssembler(
-      PositionIndependentCodeOption pic = PositionIndependentCode);
+      PositionIndependentCodeOption pic = PositionIndependentCode,
+      Arena* arena = NULL);
   MacroAssembler(size_t capacity,
-                 PositionIndependentCodeOption pic = PositionIndependentCode);
+                 PositionIndependentCodeOption pic = PositionIndependentCode,
+                 Arena* arena = NULL);
   MacroAssembler(byte* buffer,
                  size_t capacity,
-                 PositionIndependentCodeOption pic = PositionIndependentCode);
+                 PositionIndependentCodeOption pic = PositionIndependentCode,
+                 Arena* arena = NULL);
+  // Emit into a chunk of `shared`; see SharedCodeBuffer. Each MacroAssembler
+  // must only be used by one thread at a time, but several can emit into the
+  // same SharedCodeBuffer concurrently.
+  MacroAssembler(SharedCodeBuffer* shared,
+                 size_t capacity,
+                 PositionIndependentCodeOption pic = PositionIndependentCode,
+                 Arena* arena = NULL);
   ~MacroAssembler();
 
   enum FinalizeOption {
@@ -713,6 +882,12 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
   // instruction using 'mov immediate' instructions. A user might prefer loading
   // a constant using the literal pool instead of using multiple 'mov immediate'
   // instructions.
+  // The sequence is found by `MoveImmediateSequence::FindGreedy()`, or by
+  // `FindMinimal()` if `masm` searches for minimal sequences (see
+  // `SetMinimalMoveImmediates()`). Without a MacroAssembler, the count is for
+  // the greedy sequence. It is exact for a MacroAssembler that does not search,
+  // but only an upper bound for one that does: `Mov` may then emit fewer
+  // instructions than reported, never more.
   static int MoveImmediateHelper(MacroAssembler* masm,
                                  const Register& rd,
                                  uint64_t imm);
@@ -1060,12 +1235,14 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
   void Adr(const Register& rd, Label* label) {
     VIXL_ASSERT(allow_macro_instructions_);
     VIXL_ASSERT(!rd.IsZero());
+    VIXL_ASSERT(!IsRelaxingBranches());
     SingleEmissionCheckScope guard(this);
     adr(rd, label);
   }
   void Adrp(const Register& rd, Label* label) {
     VIXL_ASSERT(allow_macro_instructions_);
     VIXL_ASSERT(!rd.IsZero());
+    VIXL_ASSERT(!IsRelaxingBranches());
     SingleEmissionCheckScope guard(this);
     adrp(rd, label);
   }
@@ -1145,6 +1322,7 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
   void BindToOffset(Label* label, ptrdiff_t offset);
   void Bl(Label* label) {
     VIXL_ASSERT(allow_macro_instructions_);
+    VIXL_ASSERT(!IsRelaxingBranches());
     SingleEmissionCheckScope guard(this);
     bl(label);
   }
@@ -1918,78 +2096,66 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
   // signalling NaNs to quiet NaNs when converting between float and double.
   void Ldr(const VRegister& vt, double imm) {
     VIXL_ASSERT(allow_macro_instructions_);
+    VIXL_ASSERT(!IsRelaxingBranches());
     SingleEmissionCheckScope guard(this);
     RawLiteral* literal;
     if (vt.IsD()) {
-      literal = new Literal<double>(imm,
-                                    &literal_pool_,
-                                    RawLiteral::kDeletedOnPlacementByPool);
+      literal = literal_pool_.GetPooledLiteral(imm);
     } else {
-      literal = new Literal<float>(static_cast<float>(imm),
-                                   &literal_pool_,
-                                   RawLiteral::kDeletedOnPlacementByPool);
+      literal = literal_pool_.GetPooledLiteral(static_cast<float>(imm));
     }
     ldr(vt, literal);
   }
   void Ldr(const VRegister& vt, float imm) {
     VIXL_ASSERT(allow_macro_instructions_);
+    VIXL_ASSERT(!IsRelaxingBranches());
     SingleEmissionCheckScope guard(this);
     RawLiteral* literal;
     if (vt.IsS()) {
-      literal = new Literal<float>(imm,
-                                   &literal_pool_,
-                                   RawLiteral::kDeletedOnPlacementByPool);
+      literal = literal_pool_.GetPooledLiteral(imm);
     } else {
-      literal = new Literal<double>(static_cast<double>(imm),
-                                    &literal_pool_,
-                                    RawLiteral::kDeletedOnPlacementByPool);
+      literal = literal_pool_.GetPooledLiteral(static_cast<double>(imm));
     }
     ldr(vt, literal);
   }
   void Ldr(const VRegister& vt, uint64_t high64, uint64_t low64) {
     VIXL_ASSERT(allow_macro_instructions_);
+    VIXL_ASSERT(!IsRelaxingBranches());
     VIXL_ASSERT(vt.IsQ());
     SingleEmissionCheckScope guard(this);
-    ldr(vt,
-        new Literal<uint64_t>(high64,
-                              low64,
-                              &literal_pool_,
-                              RawLiteral::kDeletedOnPlacementByPool));
+    ldr(vt, literal_pool_.GetPooledLiteral(high64, low64));
   }
   void Ldr(const Register& rt, uint64_t imm) {
     VIXL_ASSERT(allow_macro_instructions_);
     VIXL_ASSERT(!rt.IsZero());
+    VIXL_ASSERT(!IsRelaxingBranches());
     SingleEmissionCheckScope guard(this);
     RawLiteral* literal;
     if (rt.Is64Bits()) {
-      literal = new Literal<uint64_t>(imm,
-                                      &literal_pool_,
-                                      RawLiteral::kDeletedOnPlacementByPool);
+      literal = literal_pool_.GetPooledLiteral(imm);
     } else {
       VIXL_ASSERT(rt.Is32Bits());
       VIXL_ASSERT(IsUint32(imm) || IsInt32(imm));
-      literal = new Literal<uint32_t>(static_cast<uint32_t>(imm),
-                                      &literal_pool_,
-                                      RawLiteral::kDeletedOnPlacementByPool);
+      literal = literal_pool_.GetPooledLiteral(static_cast<uint32_t>(imm));
     }
     ldr(rt, literal);
   }
   void Ldrsw(const Register& rt, uint32_t imm) {
     VIXL_ASSERT(allow_macro_instructions_);
     VIXL_ASSERT(!rt.IsZero());
+    VIXL_ASSERT(!IsRelaxingBranches());
     SingleEmissionCheckScope guard(this);
-    ldrsw(rt,
-          new Literal<uint32_t>(imm,
-                                &literal_pool_,
-                                RawLiteral::kDeletedOnPlacementByPool));
+    ldrsw(rt, literal_pool_.GetPooledLiteral(imm));
   }
   void Ldr(const CPURegister& rt, RawLiteral* literal) {
     VIXL_ASSERT(allow_macro_instructions_);
+    VIXL_ASSERT(!IsRelaxingBranches());
     SingleEmissionCheckScope guard(this);
     ldr(rt, literal);
   }
   void Ldrsw(const Register& rt, RawLiteral* literal) {
     VIXL_ASSERT(allow_macro_instructions_);
+    VIXL_ASSERT(!IsRelaxingBranches());
     SingleEmissionCheckScope guard(this);
     ldrsw(rt, literal);
   }
@@ -7930,6 +8096,24 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
 
   bool GenerateSimulatorCode() const { return generate_simulator_code_; }
 
+  // Make `Mov` search for the shortest sequence materialising each immediate,
+  // rather than use `movz` or `movn` followed by `movk`. This saves
+  // instructions for some constants, such as masks with patched halfwords or
+  // replicated words, but makes each new constant several times slower to
+  // generate. The sequences found are cached, see `GetMoveImmediateCache()`.
+  // Size queries (`MoveImmediateHelper()` without a MacroAssembler) still count
+  // the greedy sequence, so with the search enabled they are an upper bound
+  // rather than the exact size emitted.
+  void SetMinimalMoveImmediates(bool value) {
+    minimal_move_immediates_ = value;
+  }
+
+  bool UseMinimalMoveImmediates() const { return minimal_move_immediates_; }
+
+  const MoveImmediateCache& GetMoveImmediateCache() const {
+    return move_immediate_cache_;
+  }
+
   size_t GetLiteralPoolSize() const { return literal_pool_.GetSize(); }
   VIXL_DEPRECATED("GetLiteralPoolSize", size_t LiteralPoolSize() const) {
     return GetLiteralPoolSize();
@@ -8089,6 +8273,26 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
 
   LiteralPool* GetLiteralPool() { return &literal_pool_; }
 
+  // Addresses which depend on where the code, or what it refers to, is loaded.
+  // These record a relocation (see Assembler::RecordRelocation) along with the
+  // code. External symbols are identified by a user-chosen `symbol` index, and
+  // their current `address` is used for the code as generated. Addresses in
+  // the code itself are only correct once the relocations have been applied at
+  // the final location of the code.
+
+  // Materialise `address` in `rd` with a MOVZ and three MOVKs.
+  void MovExternalAddress(const Register& rd,
+                          uint32_t symbol,
+                          uintptr_t address);
+  // Materialise the address of the bound `label` in `rd`, in the same way.
+  void MovCodeAddress(const Register& rd, const Label* label);
+  // Load `address` into `rt` from the literal pool.
+  void LdrExternalAddress(const Register& rt,
+                          uint32_t symbol,
+                          uintptr_t address);
+  // Call `address`, through a scratch register.
+  void CallExternal(uint32_t symbol, uintptr_t address);
+
 // Support for simulated runtime calls.
 
 // `CallRuntime` requires variadic templating, that is only available from
@@ -8137,6 +8341,17 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
   friend class BlockLiteralPoolScope;
   friend class BlockVeneerPoolScope;
 
+  // Start and end a region in which branches are relaxed, and which is
+  // optimised by `peephole` and then scheduled by `scheduler` if they are not
+  // NULL. See `BranchRelaxationScope`, `PeepholeScope` and `SchedulingScope`
+  // below.
+  void OpenBranchRelaxation(Peephole* peephole = NULL,
+                            Scheduler* scheduler = NULL);
+  void CloseBranchRelaxation();
+  bool IsRelaxingBranches() const { return relaxation_start_ >= 0; }
+
+  friend class BranchRelaxationScope;
+
   virtual void SetAllowMacroInstructions(bool value) VIXL_OVERRIDE {
     allow_macro_instructions_ = value;
   }
@@ -8498,6 +8713,85 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
 
   FPMacroNaNPropagationOption fp_nan_propagation_;
 
+  // Whether `Mov` searches for minimal sequences, and the sequences recently
+  // found. See `MoveImmediateHelper()`.
+  bool minimal_move_immediates_;
+  MoveImmediateCache move_immediate_cache_;
+
+  // A branch or label binding recorded in a branch relaxation region. Bindings
+  // use `UnknownBranchType`. For CBZ/CBNZ and TBZ/TBNZ, `cond` is `eq` for
+  // the "zero" form and `ne` for the "non-zero" form, so that all branches can
+  // be inverted with `InvertCondition`.
+  struct RelaxedBranch {
+    // Offset of the branch relative to the start of the region, ignoring the
+    // code generated for preceding branches.
+    ptrdiff_t offset;
+    Label* label;
+    ImmBranchType type;
+    Condition cond;
+    Register rt;
+    unsigned bit_pos;
+    // Whether the branch needs the two-instruction form: an inverted branch
+    // over a B to the label.
+    bool is_long;
+  };
+
+  void RecordRelaxedBranch(Label* label,
+                           ImmBranchType type,
+                           Condition cond = al,
+                           const Register& rt = NoReg,
+                           unsigned bit_pos = 0);
+  void EmitRelaxedBranch(const RelaxedBranch& branch,
+                         Label* label,
+                         bool invert);
+
+  // Offset of the start of the current branch relaxation region, or -1 if
+  // branches are not being relaxed.
+  ptrdiff_t relaxation_start_;
+  std::vector<RelaxedBranch> relaxed_branches_;
+
+  // Check that the code of the current region, held in `raw`, can be moved:
+  // it must not use the pools or contain any PC-relative instruction other
+  // than the recorded branches. The macro instructions which would break this
+  // assert as soon as they are used in a region; this also catches code
+  // emitted directly with the Assembler.
+#ifdef VIXL_DEBUG
+  void CheckRelaxedRegion(const std::vector<byte>& raw) const;
+#endif
+
+  // Return the size of the debug pseudo instruction, with its arguments, at
+  // `offset` in `raw`, or zero if there is none there. Nothing is read at or
+  // after `end`.
+  size_t GetDebugHltSizeAt(const std::vector<byte>& raw,
+                           size_t offset,
+                           size_t end) const;
+
+  // Optimise the straight-line code between the recorded branches and
+  // bindings of the current region, held in `raw`, and update the offsets of
+  // the branches and bindings accordingly. Debug pseudo instructions are
+  // copied unchanged, and nothing is optimised across them.
+  void OptimizeRelaxedRegion(std::vector<byte>* raw);
+  // Optimise the code in [`start`, `end`) of `raw`, appending the result to
+  // `optimized`. `branch` is the branch or binding which immediately follows
+  // the segment, if any.
+  void OptimizeRelaxedSegment(const std::vector<byte>& raw,
+                              size_t start,
+                              size_t end,
+                              RelaxedBranch* branch,
+                              std::vector<byte>* optimized);
+
+  // The peephole optimiser and scheduler for the current branch relaxation
+  // region, if any.
+  Peephole* peephole_;
+  Scheduler* scheduler_;
+
+  // Emit a fixed MOVZ and MOVK sequence materialising `value`, recording a
+  // kMovWide64 relocation to `symbol` plus `addend` for it.
+  void EmitRelocatedMovWide(const Register& rd,
+                            uint32_t symbol,
+                            int64_t addend,
+                            uint64_t value);
+
   friend class Pool;
   friend class LiteralPool;
 };
@@ -8566,6 +8860,86 @@ class BlockPoolsScope {
   MacroAssembler* masm_;
 };
 
+
+// While this scope is open, branches to labels (emitted with `B`, `Cbz`,
+// `Cbnz`, `Tbz` and `Tbnz`) and label bindings (`Bind`) are recorded instead
+// of being emitted. When the scope is closed, the distance to every target is
+// known and each branch is emitted in the shortest form that reaches it: a
+// single instruction where possible, or an inverted branch over a B
+// otherwise. Conditional branches therefore never need a veneer to reach a
+// label bound in the region.
+//
+// Both pools are emitted when the scope is opened and are blocked while it is
+// open. Labels used in the region must outlive the scope and must only be
+// used through the macro instructions listed above. The code of the region
+// moves when it is laid out, so it must not contain any other PC-relative
+// instruction or use the literal pool. In debug builds, the macro instructions
+// which would break this assert when they are used in the region: `Adr`,
+// `Adrp`, `Bl` to a label, literal loads (including `Ldr` and `Ldrsw` of an
+// immediate, and `Fmov` of an immediate which needs the literal pool) and the
+// relocated address helpers such as `MovExternalAddress`. This rules out
+// `Printf` too, which loads its format string with `Adr`. Closing the scope
+// also checks, in debug builds, that code emitted directly with the Assembler
+// follows the same rules.
+//
+// `PeepholeScope` and `SchedulingScope` also optimise the region.
+class BranchRelaxationScope {
+ public:
+  explicit BranchRelaxationScope(MacroAssembler* masm)
+      : BranchRelaxationScope(masm, NULL, NULL) {}
+
+  ~BranchRelaxationScope() { Close(); }
+
+  // Lay out the region, after optimising it if a peephole optimiser or a
+  // scheduler was given. This is done by the destructor if it is not called.
+  void Close();
+
+ protected:
+  BranchRelaxationScope(MacroAssembler* masm,
+                        Peephole* peephole,
+                        Scheduler* scheduler);
+
+ private:
+  MacroAssembler* masm_;
+};
+
+
+// A branch relaxation region whose code is also rewritten by a peephole
+// optimiser when the scope is closed. The optimiser only sees the code
+// between consecutive branches and label bindings, so it never merges
+// instructions across a possible branch target, and no pool is emitted in
+// the region.
+//
+// The same restrictions as for `BranchRelaxationScope` apply. In addition,
+// the region must only contain instructions, and code emitted with an
+// `ExactAssemblyScope` in it may be rewritten like any other. The exception is
+// debug pseudo instructions, such as the ones `Trace` and `Log` emit when
+// generating code for the simulator: they are kept as they are, with their
+// arguments, and also split the code into separately optimised segments.
+class PeepholeScope : public BranchRelaxationScope {
+ public:
+  PeepholeScope(MacroAssembler* masm, Peephole* peephole)
+      : BranchRelaxationScope(masm, peephole, NULL) {}
+};
+
+
+// A branch relaxation region whose code is reordered by a scheduler when the
+// scope is closed, after being rewritten by a peephole optimiser if one is
+// given. As for `PeepholeScope`, instructions are only reordered between
+// consecutive branches and label bindings.
+//
+// The same restrictions as for `PeepholeScope` apply. In particular, code
+// emitted with an `ExactAssemblyScope` may be reordered, except for
+// instructions which the scheduler does not move, such as PC-relative, system
+// and SVE instructions.
+class SchedulingScope : public BranchRelaxationScope {
+ public:
+  SchedulingScope(MacroAssembler* masm,
+                  Scheduler* scheduler,
+                  Peephole* peephole = NULL)
+      : BranchRelaxationScope(masm, peephole, scheduler) {}
+};
+
 MovprfxHelperScope::MovprfxHelperScope(MacroAssembler* masm,
                                        const ZRegister& dst,
                                        const ZRegister& src)
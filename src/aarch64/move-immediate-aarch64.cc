@@ -0,0 +1,383 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "move-immediate-aarch64.h"
+
+#include "assembler-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+namespace {
+
+uint64_t GetHalfword(uint64_t value, int index) {
+  return (value >> (16 * index)) & 0xffff;
+}
+
+
+uint64_t GetHalfwordMask(int index) { return UINT64_C(0xffff) << (16 * index); }
+
+
+// Return the index of the only halfword of `value` which isn't zero, or -1 if
+// there are more than one. Zero is treated as a value in halfword 0.
+int GetOnlyHalfword(uint64_t value, unsigned reg_size) {
+  for (unsigned i = 0; i < (reg_size / 16); i++) {
+    if ((value & ~GetHalfwordMask(i)) == 0) return i;
+  }
+  return -1;
+}
+
+
+bool FindOneInstruction(uint64_t imm,
+                        unsigned reg_size,
+                        MoveImmediateSequence* sequence) {
+  VIXL_ASSERT((imm & ~GetUintMask(reg_size)) == 0);
+  sequence->Clear();
+  int index = GetOnlyHalfword(imm, reg_size);
+  if (index >= 0) {
+    sequence->Append(MoveImmediateSequence::kMovz,
+                     reg_size,
+                     GetHalfword(imm, index),
+                     16 * index);
+    return true;
+  }
+  uint64_t inverted = ~imm & GetUintMask(reg_size);
+  index = GetOnlyHalfword(inverted, reg_size);
+  if (index >= 0) {
+    sequence->Append(MoveImmediateSequence::kMovn,
+                     reg_size,
+                     GetHalfword(inverted, index),
+                     16 * index);
+    return true;
+  }
+  if (Assembler::IsImmLogical(imm, reg_size)) {
+    sequence->Append(MoveImmediateSequence::kOrr, reg_size, imm);
+    return true;
+  }
+  return false;
+}
+
+
+// Fill the halfwords of `value` not set in `known`, a mask of halfword
+// indices, so that the result is a single rotated run of ones, if possible.
+// The result still has to be checked, since it can be all ones or zeros.
+bool FillRun(uint64_t value,
+             int halfword_count,
+             unsigned known,
+             uint64_t* run) {
+  VIXL_ASSERT(known != 0);
+  // The known bits, in order around the register, must change value at most
+  // twice.
+  uint64_t known_bits = 0;
+  int known_bit_count = 0;
+  for (int i = 0; i < halfword_count; i++) {
+    if ((known & (1 << i)) != 0) {
+      known_bits |= GetHalfword(value, i) << known_bit_count;
+      known_bit_count += 16;
+    }
+  }
+  uint64_t rotated =
+      (known_bits >> 1) | ((known_bits & 1) << (known_bit_count - 1));
+  int transitions = CountSetBits(known_bits ^ rotated);
+  if (transitions > 2) return false;
+
+  // Give each unknown halfword the value of the bit before it, to extend the
+  // run or the gap there. If all the known bits are the same, the first
+  // unknown halfword starts a gap (or a run) instead.
+  bool invert = (transitions == 0);
+  int first_known = CountTrailingZeros(known);
+  for (int n = 1; n < halfword_count; n++) {
+    int i = (first_known + n) % halfword_count;
+    if ((known & (1 << i)) != 0) continue;
+    int previous = (i + halfword_count - 1) % halfword_count;
+    bool set = (GetHalfword(value, previous) & 0x8000) != 0;
+    if (invert) {
+      set = !set;
+      invert = false;
+    }
+    value = (value & ~GetHalfwordMask(i)) |
+            (set ? GetHalfwordMask(i) : UINT64_C(0));
+  }
+  *run = value;
+  return !invert;
+}
+
+
+// Find a logical immediate equal to `imm` in all the halfwords not set in
+// `free`, a mask of halfword indices. Logical immediates replicate an element
+// of 2 to 64 bits, so it is enough to look for:
+//  - a replicated halfword, for elements of up to 16 bits,
+//  - a replicated word, which is a run of ones in 32 bits,
+//  - a run of ones in the whole register.
+bool FindLogicalImmediate(uint64_t imm,
+                          unsigned reg_size,
+                          unsigned free,
+                          uint64_t* result) {
+  int halfword_count = reg_size / 16;
+  unsigned known = ~free & ((1 << halfword_count) - 1);
+  VIXL_ASSERT(known != 0);
+
+  bool all_equal = true;
+  uint64_t halfword = GetHalfword(imm, CountTrailingZeros(known));
+  uint64_t word = 0;
+  unsigned word_known = 0;
+  for (int i = 0; i < halfword_count; i++) {
+    if ((known & (1 << i)) == 0) continue;
+    all_equal = all_equal && (GetHalfword(imm, i) == halfword);
+    // Merge the known halfwords of both words.
+    int position = i % 2;
+    if (((word_known & (1 << position)) != 0) &&
+        (GetHalfword(word, position) != GetHalfword(imm, i))) {
+      word_known = 0;
+      break;
+    }
+    word |= GetHalfword(imm, i) << (16 * position);
+    word_known |= 1 << position;
+  }
+
+  uint64_t candidate = (halfword * UINT64_C(0x0001000100010001)) &
+                       GetUintMask(reg_size);
+  if (all_equal && Assembler::IsImmLogical(candidate, reg_size)) {
+    *result = candidate;
+    return true;
+  }
+  if ((reg_size == kXRegSize) && (word_known != 0) &&
+      FillRun(word, 2, word_known, &candidate)) {
+    candidate |= candidate << 32;
+    if (Assembler::IsImmLogical(candidate, reg_size)) {
+      *result = candidate;
+      return true;
+    }
+  }
+  if (FillRun(imm, halfword_count, known, &candidate) &&
+      Assembler::IsImmLogical(candidate, reg_size)) {
+    *result = candidate;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+
+void MoveImmediateSequence::FindGreedy(uint64_t imm,
+                                       unsigned reg_size,
+                                       MoveImmediateSequence* sequence) {
+  VIXL_ASSERT((reg_size == kXRegSize) || (reg_size == kWRegSize));
+  imm &= GetUintMask(reg_size);
+  if (FindOneInstruction(imm, reg_size, sequence)) return;
+
+  // Use `movn` if there are more 0xffff halfwords than zero ones.
+  int clear_count = 0;
+  int set_count = 0;
+  for (unsigned i = 0; i < (reg_size / 16); i++) {
+    if (GetHalfword(imm, i) == 0) clear_count++;
+    if (GetHalfword(imm, i) == 0xffff) set_count++;
+  }
+  uint64_t ignored_halfword = (set_count > clear_count) ? 0xffff : 0;
+  for (unsigned i = 0; i < (reg_size / 16); i++) {
+    uint64_t imm16 = GetHalfword(imm, i);
+    if (imm16 == ignored_halfword) continue;
+    if (sequence->GetLength() != 0) {
+      sequence->Append(kMovk, reg_size, imm16, 16 * i);
+    } else if (ignored_halfword == 0xffff) {
+      sequence->Append(kMovn, reg_size, ~imm16 & 0xffff, 16 * i);
+    } else {
+      sequence->Append(kMovz, reg_size, imm16, 16 * i);
+    }
+  }
+  VIXL_ASSERT(sequence->GetLength() > 1);
+}
+
+
+void MoveImmediateSequence::FindMinimal(uint64_t imm,
+                                        unsigned reg_size,
+                                        MoveImmediateSequence* sequence) {
+  imm &= GetUintMask(reg_size);
+  FindGreedy(imm, reg_size, sequence);
+  // A W register only has two halfwords, so the greedy sequence is minimal.
+  if ((reg_size == kWRegSize) || (sequence->GetLength() == 1)) return;
+  // The greedy search tries every single 64-bit instruction, and 32-bit ones
+  // clear the high word, so a two-instruction sequence is minimal unless the
+  // high word is zero.
+  if ((sequence->GetLength() == 2) && ((imm >> 32) != 0)) return;
+
+  // A 32-bit initial value clears the high word, which is then set with
+  // `movk`, or by copying the low word.
+  uint64_t low = imm & kWRegMask;
+  uint64_t high = imm >> 32;
+  MoveImmediateSequence candidate;
+  FindMinimal(low, kWRegSize, &candidate);
+  if (high == low) {
+    candidate.Append(kReplicate, kXRegSize, 0);
+  } else {
+    for (int i = 2; i < 4; i++) {
+      if (GetHalfword(imm, i) != 0) {
+        candidate.Append(kMovk, kXRegSize, GetHalfword(imm, i), 16 * i);
+      }
+    }
+  }
+  if (candidate.GetLength() < sequence->GetLength()) *sequence = candidate;
+
+  // A 64-bit logical immediate, followed by `movk` for the halfwords which
+  // differ. Try each set of halfwords which could be fixed with fewer
+  // instructions than the current sequence.
+  for (unsigned free = 1; free < 0xf; free++) {
+    if ((1 + CountSetBits(free)) >= sequence->GetLength()) continue;
+    uint64_t value;
+    if (FindLogicalImmediate(imm, kXRegSize, free, &value)) {
+      candidate.Clear();
+      candidate.Append(kOrr, kXRegSize, value);
+      for (int i = 0; i < 4; i++) {
+        if (GetHalfword(value ^ imm, i) != 0) {
+          candidate.Append(kMovk, kXRegSize, GetHalfword(imm, i), 16 * i);
+        }
+      }
+      if (candidate.GetLength() < sequence->GetLength()) *sequence = candidate;
+    }
+  }
+  VIXL_ASSERT(sequence->Evaluate() == imm);
+}
+
+
+void MoveImmediateSequence::Append(Operation operation,
+                                   unsigned reg_size,
+                                   uint64_t imm,
+                                   unsigned shift) {
+  VIXL_ASSERT(length_ < kMaxLength);
+  VIXL_ASSERT((reg_size == kXRegSize) || (reg_size == kWRegSize));
+  VIXL_ASSERT((operation != kReplicate) || (reg_size == kXRegSize));
+  VIXL_ASSERT(((operation != kMovz) && (operation != kMovn) &&
+               (operation != kMovk)) ||
+              IsUint16(imm));
+  steps_[length_].imm = imm;
+  steps_[length_].operation = static_cast<uint8_t>(operation);
+  steps_[length_].reg_size = static_cast<uint8_t>(reg_size);
+  steps_[length_].shift = static_cast<uint8_t>(shift);
+  length_++;
+}
+
+
+uint64_t MoveImmediateSequence::Evaluate() const {
+  uint64_t value = 0;
+  for (int i = 0; i < length_; i++) {
+    uint64_t imm = steps_[i].imm;
+    unsigned shift = steps_[i].shift;
+    switch (GetOperation(i)) {
+      case kMovz:
+        value = imm << shift;
+        break;
+      case kMovn:
+        value = ~(imm << shift);
+        break;
+      case kMovk:
+        value = (value & ~(UINT64_C(0xffff) << shift)) | (imm << shift);
+        break;
+      case kOrr:
+        value = imm;
+        break;
+      case kReplicate:
+        value |= value << 32;
+        break;
+    }
+    value &= GetUintMask(steps_[i].reg_size);
+  }
+  return value;
+}
+
+
+void MoveImmediateSequence::Emit(Assembler* assm, const Register& rd) const {
+  VIXL_ASSERT(!rd.IsSP());
+  for (int i = 0; i < length_; i++) {
+    Register dst = (steps_[i].reg_size == kXRegSize) ? rd.X() : rd.W();
+    uint64_t imm = steps_[i].imm;
+    int shift = steps_[i].shift;
+    switch (GetOperation(i)) {
+      case kMovz:
+        assm->movz(dst, imm, shift);
+        break;
+      case kMovn:
+        assm->movn(dst, imm, shift);
+        break;
+      case kMovk:
+        assm->movk(dst, imm, shift);
+        break;
+      case kOrr:
+        assm->orr(dst, Assembler::AppropriateZeroRegFor(dst), imm);
+        break;
+      case kReplicate:
+        assm->orr(dst, dst, Operand(dst, LSL, 32));
+        break;
+    }
+  }
+}
+
+
+int MoveImmediateCache::GetSetIndex(uint64_t imm, unsigned reg_size) {
+  uint64_t hash = (imm ^ reg_size) * UINT64_C(0x9e3779b97f4a7c15);
+  return 2 * static_cast<int>(hash >> (64 - kSetCountLog2));
+}
+
+
+bool MoveImmediateCache::Lookup(uint64_t imm,
+                                unsigned reg_size,
+                                MoveImmediateSequence* sequence) {
+  int index = GetSetIndex(imm, reg_size);
+  for (int i = index; i < (index + 2); i++) {
+    const Entry& entry = entries_[i];
+    if ((entry.reg_size == reg_size) && (entry.imm == imm)) {
+      *sequence = entry.sequence;
+      hit_count_++;
+      return true;
+    }
+  }
+  miss_count_++;
+  return false;
+}
+
+
+void MoveImmediateCache::Insert(uint64_t imm,
+                                unsigned reg_size,
+                                const MoveImmediateSequence& sequence) {
+  // Evict the older entry of the set.
+  int index = GetSetIndex(imm, reg_size);
+  entries_[index + 1] = entries_[index];
+  entries_[index].imm = imm;
+  entries_[index].reg_size = reg_size;
+  entries_[index].sequence = sequence;
+}
+
+
+void MoveImmediateCache::Clear() {
+  for (int i = 0; i < kEntryCount; i++) {
+    entries_[i].imm = 0;
+    entries_[i].reg_size = 0;
+  }
+}
+
+}  // namespace aarch64
+}  // namespace vixl
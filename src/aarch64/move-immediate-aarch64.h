@@ -0,0 +1,174 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIXL_AARCH64_MOVE_IMMEDIATE_AARCH64_H_
+#define VIXL_AARCH64_MOVE_IMMEDIATE_AARCH64_H_
+
+#include "../globals-vixl.h"
+
+#include "registers-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+class Assembler;
+
+// A short sequence of instructions materialising an immediate in a register.
+//
+// The first instruction ignores the previous value of the register (`movz`,
+// `movn`, or `orr` from the zero register), and the following ones modify it
+// with `movk` or by copying the low word into the high word. Each instruction
+// can use either register size, since W-register writes clear the top of the
+// X register.
+class MoveImmediateSequence {
+ public:
+  enum Operation {
+    kMovz,      // movz rd, #imm, lsl #shift
+    kMovn,      // movn rd, #imm, lsl #shift
+    kMovk,      // movk rd, #imm, lsl #shift
+    kOrr,       // orr rd, zr, #imm
+    kReplicate  // orr xd, xd, xd, lsl #32
+  };
+
+  static const int kMaxLength = 4;
+
+  MoveImmediateSequence() : length_(0) {}
+
+  // Find the conventional sequence: one `movz`, `movn` or `orr` if possible,
+  // otherwise a `movz` or `movn` followed by a `movk` for every other halfword
+  // which isn't zero (respectively 0xffff). Apart from the single `orr`, these
+  // sequences can target the zero register.
+  static void FindGreedy(uint64_t imm,
+                         unsigned reg_size,
+                         MoveImmediateSequence* sequence);
+
+  // Find a sequence of minimal length for `imm`, preferring the greedy
+  // sequence when there is a tie.
+  //
+  // The result is minimal among the sequences made of a `movz`, `movn` or
+  // `orr` of either size followed by `movk`, and among 32-bit such sequences
+  // followed by a copy of the low word into the high word. A 64-bit `movz`
+  // or `movn` followed by an `eor`, `and` or `orr` immediate is never shorter
+  // than an `orr` and a `movk`, so those sequences are covered too.
+  static void FindMinimal(uint64_t imm,
+                          unsigned reg_size,
+                          MoveImmediateSequence* sequence);
+
+  int GetLength() const { return length_; }
+
+  Operation GetOperation(int index) const {
+    VIXL_ASSERT((index >= 0) && (index < length_));
+    return static_cast<Operation>(steps_[index].operation);
+  }
+
+  unsigned GetRegisterSize(int index) const {
+    VIXL_ASSERT((index >= 0) && (index < length_));
+    return steps_[index].reg_size;
+  }
+
+  // For `movz`, `movn` and `movk`, this is the 16-bit payload.
+  uint64_t GetImmediate(int index) const {
+    VIXL_ASSERT((index >= 0) && (index < length_));
+    return steps_[index].imm;
+  }
+
+  unsigned GetShift(int index) const {
+    VIXL_ASSERT((index >= 0) && (index < length_));
+    return steps_[index].shift;
+  }
+
+  void Append(Operation operation,
+              unsigned reg_size,
+              uint64_t imm,
+              unsigned shift = 0);
+
+  void Clear() { length_ = 0; }
+
+  // Compute the value the sequence leaves in an X register.
+  uint64_t Evaluate() const;
+
+  // Emit the sequence. `rd` can be a W or X register, but not the stack
+  // pointer; the size of each instruction is given by the sequence.
+  void Emit(Assembler* assm, const Register& rd) const;
+
+ private:
+  struct Step {
+    uint64_t imm;
+    uint8_t operation;
+    uint8_t reg_size;
+    uint8_t shift;
+  };
+
+  Step steps_[kMaxLength];
+  int length_;
+};
+
+
+// A small two-way set-associative cache of recently materialised immediates,
+// so that code using the same constants many times only searches for their
+// sequence once.
+class MoveImmediateCache {
+ public:
+  static const int kSetCountLog2 = 5;
+  static const int kSetCount = 1 << kSetCountLog2;
+  static const int kEntryCount = 2 * kSetCount;
+
+  MoveImmediateCache() : hit_count_(0), miss_count_(0) { Clear(); }
+
+  // Return true and fill `sequence` if `imm` is in the cache.
+  bool Lookup(uint64_t imm,
+              unsigned reg_size,
+              MoveImmediateSequence* sequence);
+  void Insert(uint64_t imm,
+              unsigned reg_size,
+              const MoveImmediateSequence& sequence);
+  void Clear();
+
+  uint64_t GetHitCount() const { return hit_count_; }
+  uint64_t GetMissCount() const { return miss_count_; }
+
+ private:
+  struct Entry {
+    uint64_t imm;
+    // Zero for unused entries.
+    unsigned reg_size;
+    MoveImmediateSequence sequence;
+  };
+
+  // Return the index of the first entry of the set for `imm`. The first entry
+  // is the most recently inserted.
+  static int GetSetIndex(uint64_t imm, unsigned reg_size);
+
+  Entry entries_[kEntryCount];
+  uint64_t hit_count_;
+  uint64_t miss_count_;
+};
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_MOVE_IMMEDIATE_AARCH64_H_
@@ -0,0 +1,263 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "peephole-aarch64.h"
+
+#include "assembler-aarch64.h"
+#include "instructions-aarch64.h"
+#include "simulator-constants-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+namespace {
+
+// A single register load or store with an unsigned offset, and the pair
+// instruction it can be merged into.
+struct PairableLoadStore {
+  LoadStoreUnsignedOffset single;
+  LoadStorePairOffsetOp pair;
+  unsigned size_log2;
+  bool is_load;
+};
+
+const PairableLoadStore kPairableLoadStores[] = {
+    {LDR_w_unsigned, LDP_w_off, 2, true},
+    {LDR_x_unsigned, LDP_x_off, 3, true},
+    {LDR_s_unsigned, LDP_s_off, 2, true},
+    {LDR_d_unsigned, LDP_d_off, 3, true},
+    {LDR_q_unsigned, LDP_q_off, 4, true},
+    {STR_w_unsigned, STP_w_off, 2, false},
+    {STR_x_unsigned, STP_x_off, 3, false},
+    {STR_s_unsigned, STP_s_off, 2, false},
+    {STR_d_unsigned, STP_d_off, 3, false},
+    {STR_q_unsigned, STP_q_off, 4, false},
+};
+
+const Instruction* AsInstruction(const Instr* instr) {
+  return reinterpret_cast<const Instruction*>(instr);
+}
+
+// Return true if `instr` is `add xn, xn, #imm` or `sub xn, xn, #imm`, and
+// return the amount added to xn in `delta`.
+bool IsBaseUpdate(const Instruction* instr, int64_t* delta) {
+  Instr op = instr->Mask(AddSubImmediateMask);
+  if ((op != ADD_x_imm) && (op != SUB_x_imm)) return false;
+  if ((instr->GetImmAddSubShift() != 0) || (instr->GetRd() != instr->GetRn())) {
+    return false;
+  }
+  *delta = (op == ADD_x_imm) ? instr->GetImmAddSub() : -instr->GetImmAddSub();
+  return true;
+}
+
+// Return true if `instr` is a load or store with an unsigned offset of zero,
+// which has pre- and post-index forms.
+bool IsZeroOffsetLoadStore(const Instruction* instr) {
+  return (instr->Mask(LoadStoreUnsignedOffsetFMask) ==
+          LoadStoreUnsignedOffsetFixed) &&
+         (instr->Mask(LoadStoreMask) != PRFM) &&
+         (instr->GetImmLSUnsigned() == 0);
+}
+
+}  // namespace
+
+
+void Peephole::Optimize(std::vector<Instr>* code) {
+  std::vector<Instr> result;
+  result.reserve(code->size());
+  // Merged instructions are not merged again, so each rewrite sees the code
+  // as it was generated.
+  bool can_merge_last = false;
+  for (size_t i = 0; i < code->size(); i++) {
+    // Debug pseudo instructions are kept as they are, with their arguments.
+    size_t pseudo_size =
+        GetDebugHltSize(AsInstruction(&(*code)[i]),
+                        (code->size() - i) * kInstructionSize);
+    if (pseudo_size > 0) {
+      size_t count = pseudo_size / kInstructionSize;
+      result.insert(result.end(), code->begin() + i, code->begin() + i + count);
+      i += count - 1;
+      can_merge_last = false;
+      continue;
+    }
+    Instr instr = (*code)[i];
+    if (IsEnabled(kRemoveMoveToSelf) && IsMoveToSelf(instr)) {
+      Count(kRemoveMoveToSelf);
+      continue;
+    }
+    Instr merged;
+    if (can_merge_last && Merge(result.back(), instr, &merged)) {
+      result.back() = merged;
+      can_merge_last = false;
+    } else {
+      result.push_back(instr);
+      can_merge_last = true;
+    }
+  }
+  code->swap(result);
+}
+
+
+bool Peephole::FoldCompareIntoBranch(Instr cmp, Condition cond, Register* rt) {
+  if (!IsEnabled(kFoldCompareIntoBranch)) return false;
+  if ((cond != eq) && (cond != ne)) return false;
+  const Instruction* instr = AsInstruction(&cmp);
+  Instr op = instr->Mask(AddSubImmediateMask);
+  if ((op != SUBS_x_imm) && (op != SUBS_w_imm)) return false;
+  // `cmp sp, #0` cannot be folded, since CBZ cannot test the stack pointer.
+  if ((instr->GetRd() != kZeroRegCode) || (instr->GetRn() == kSpRegCode) ||
+      (instr->GetImmAddSub() != 0)) {
+    return false;
+  }
+  unsigned size = (op == SUBS_x_imm) ? kXRegSize : kWRegSize;
+  *rt = Register(instr->GetRn(), size);
+  Count(kFoldCompareIntoBranch);
+  return true;
+}
+
+
+int Peephole::GetTotalCount() const {
+  int total = 0;
+  for (int count : counts_) total += count;
+  return total;
+}
+
+
+void Peephole::ResetCounts() {
+  for (int& count : counts_) count = 0;
+}
+
+
+bool Peephole::IsMoveToSelf(Instr bits) const {
+  const Instruction* instr = AsInstruction(&bits);
+  if (instr->Mask(LogicalShiftedMask) == ORR_x) {
+    // `mov xd, xd`.
+    return (instr->GetRn() == kZeroRegCode) && (instr->GetImmDPShift() == 0) &&
+           (instr->GetRd() == instr->GetRm());
+  }
+  if (instr->Mask(AddSubImmediateMask) == ADD_x_imm) {
+    // `mov sp, sp`, or `add xd, xd, #0`.
+    return (instr->GetImmAddSub() == 0) && (instr->GetRd() == instr->GetRn());
+  }
+  return false;
+}
+
+
+bool Peephole::Merge(Instr first, Instr second, Instr* merged) {
+  return MergePair(first, second, merged) ||
+         FoldIndex(first, second, merged);
+}
+
+
+bool Peephole::MergePair(Instr first, Instr second, Instr* merged) {
+  const Instruction* a = AsInstruction(&first);
+  const Instruction* b = AsInstruction(&second);
+  Instr op = a->Mask(LoadStoreUnsignedOffsetMask);
+  if ((a->Mask(LoadStoreUnsignedOffsetFMask) != LoadStoreUnsignedOffsetFixed) ||
+      (b->Mask(LoadStoreUnsignedOffsetMask) != op) ||
+      (a->GetRn() != b->GetRn())) {
+    return false;
+  }
+  const PairableLoadStore* entry = NULL;
+  for (const PairableLoadStore& candidate : kPairableLoadStores) {
+    if (candidate.single == op) entry = &candidate;
+  }
+  if (entry == NULL) return false;
+  if (!IsEnabled(entry->is_load ? kMergeLoadPair : kMergeStorePair)) {
+    return false;
+  }
+
+  bool is_fp = a->Mask(LoadStoreVMask) != 0;
+  if (entry->is_load) {
+    // Loading the same register twice cannot be a pair, and the first load
+    // must not change the base of the second.
+    if (a->GetRt() == b->GetRt()) return false;
+    if (!is_fp && (a->GetRt() == a->GetRn())) return false;
+  }
+
+  int64_t size = 1 << entry->size_log2;
+  int64_t a_offset = a->GetImmLSUnsigned() << entry->size_log2;
+  int64_t b_offset = b->GetImmLSUnsigned() << entry->size_log2;
+  const Instruction* low;
+  const Instruction* high;
+  if (b_offset == (a_offset + size)) {
+    low = a;
+    high = b;
+  } else if (a_offset == (b_offset + size)) {
+    low = b;
+    high = a;
+  } else {
+    return false;
+  }
+  int64_t offset = (low == a) ? a_offset : b_offset;
+  if (!Assembler::IsImmLSPair(offset, entry->size_log2)) return false;
+
+  *merged = entry->pair | Assembler::ImmLSPair(offset, entry->size_log2) |
+            (a->GetRn() << Rn_offset) | (high->GetRt() << Rt2_offset) |
+            (low->GetRt() << Rt_offset);
+  Count(entry->is_load ? kMergeLoadPair : kMergeStorePair);
+  return true;
+}
+
+
+bool Peephole::FoldIndex(Instr first, Instr second, Instr* merged) {
+  const Instruction* a = AsInstruction(&first);
+  const Instruction* b = AsInstruction(&second);
+  int64_t delta;
+  const Instruction* access;
+  LoadStorePreIndex fixed;
+  Rule rule;
+  if (IsBaseUpdate(a, &delta) && IsZeroOffsetLoadStore(b)) {
+    access = b;
+    fixed = LoadStorePreIndexFixed;
+    rule = kFoldPreIndex;
+  } else if (IsZeroOffsetLoadStore(a) && IsBaseUpdate(b, &delta)) {
+    access = a;
+    fixed = static_cast<LoadStorePreIndex>(LoadStorePostIndexFixed);
+    rule = kFoldPostIndex;
+  } else {
+    return false;
+  }
+  if (!IsEnabled(rule)) return false;
+
+  int base = (access == a) ? b->GetRn() : a->GetRn();
+  if ((access->GetRn() != base) || !IsInt9(delta)) return false;
+  // Write-back to the transferred register is unpredictable.
+  if ((access->Mask(LoadStoreVMask) == 0) && (access->GetRt() == base)) {
+    return false;
+  }
+
+  Instr op = access->Mask(LoadStoreUnsignedOffsetMask) &
+             ~LoadStoreUnsignedOffsetFixed;
+  *merged = fixed | op | Assembler::ImmLS(delta) | (base << Rn_offset) |
+            (access->GetRt() << Rt_offset);
+  Count(rule);
+  return true;
+}
+
+}  // namespace aarch64
+}  // namespace vixl
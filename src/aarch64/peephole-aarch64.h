@@ -0,0 +1,113 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIXL_AARCH64_PEEPHOLE_AARCH64_H_
+#define VIXL_AARCH64_PEEPHOLE_AARCH64_H_
+
+#include <vector>
+
+#include "../globals-vixl.h"
+
+#include "constants-aarch64.h"
+#include "registers-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+// A peephole optimiser for straight-line code, rewriting pairs of adjacent
+// instructions which macro instructions commonly produce when they are
+// expanded independently.
+//
+// The optimiser is normally used through a `PeepholeScope`, which gives it
+// the code of a MacroAssembler region split at every label binding and
+// branch, with no pool in it. It counts how many times each rule was applied.
+class Peephole {
+ public:
+  enum Rule {
+    // Remove `mov xd, xd` and `mov sp, sp`. 32-bit moves are kept, since they
+    // clear the top of the register.
+    kRemoveMoveToSelf,
+    // `ldr rt1, [xn, #imm]` and `ldr rt2, [xn, #imm + size]` become
+    // `ldp rt1, rt2, [xn, #imm]`, and similarly for `str` and `stp`.
+    kMergeLoadPair,
+    kMergeStorePair,
+    // `add xn, xn, #imm` followed by `ldr rt, [xn]` becomes
+    // `ldr rt, [xn, #imm]!`, and similarly for `sub` and `str`.
+    kFoldPreIndex,
+    // `ldr rt, [xn]` followed by `add xn, xn, #imm` becomes
+    // `ldr rt, [xn], #imm`, and similarly for `sub` and `str`.
+    kFoldPostIndex,
+    // `cmp rn, #0` followed by `b.eq` or `b.ne` becomes `cbz` or `cbnz`. This
+    // does not set the flags, so it is only valid if they are not read
+    // afterwards. It is not enabled by default.
+    kFoldCompareIntoBranch,
+    kRuleCount
+  };
+
+  static const int kDefaultRules =
+      (1 << kRemoveMoveToSelf) | (1 << kMergeLoadPair) |
+      (1 << kMergeStorePair) | (1 << kFoldPreIndex) | (1 << kFoldPostIndex);
+  static const int kAllRules = (1 << kRuleCount) - 1;
+
+  // `rules` is a combination of `1 << Rule`.
+  explicit Peephole(int rules = kDefaultRules) : rules_(rules) {
+    ResetCounts();
+  }
+
+  // Rewrite `code`, which must only hold instructions and must not be the
+  // target of any branch other than at its start. Debug pseudo instructions
+  // and their arguments are left unchanged, and nothing is merged across them.
+  void Optimize(std::vector<Instr>* code);
+
+  // If `cmp` compares a register with zero, and `cond` is `eq` or `ne`,
+  // return the register in `rt`, to replace the comparison and the
+  // conditional branch which follows it by a CBZ or CBNZ.
+  bool FoldCompareIntoBranch(Instr cmp, Condition cond, Register* rt);
+
+  bool IsEnabled(Rule rule) const { return (rules_ & (1 << rule)) != 0; }
+
+  int GetCount(Rule rule) const { return counts_[rule]; }
+  int GetTotalCount() const;
+  void ResetCounts();
+
+ private:
+  bool IsMoveToSelf(Instr instr) const;
+  // Try to merge `first` and `second`, which follows it, into `merged`.
+  bool Merge(Instr first, Instr second, Instr* merged);
+  bool MergePair(Instr first, Instr second, Instr* merged);
+  bool FoldIndex(Instr first, Instr second, Instr* merged);
+
+  void Count(Rule rule) { counts_[rule]++; }
+
+  int rules_;
+  int counts_[kRuleCount];
+};
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_PEEPHOLE_AARCH64_H_
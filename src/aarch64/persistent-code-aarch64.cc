@@ -0,0 +1,222 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifdef VIXL_CODE_BUFFER_MMAP
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "cpu-aarch64.h"
+#include "persistent-code-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+namespace {
+
+const char kMagic[8] = {'V', 'I', 'X', 'L', 'C', 'O', 'D', 'E'};
+// This must change whenever the layout of the file, or of Relocation, does.
+const uint32_t kFormatVersion = 1;
+
+// The file starts with this header, followed by the relocations, in order of
+// increasing offset. The code follows, at a page-aligned offset so that it
+// can be made executable where it is mapped.
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t relocation_count;
+  uint64_t key;
+  uint64_t code_offset;
+  uint64_t code_size;
+};
+
+size_t GetPageSize() {
+#ifdef VIXL_CODE_BUFFER_MMAP
+  return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+  return kPageSize;
+#endif
+}
+
+}  // namespace
+
+
+bool PersistentCode::Save(const char* path,
+                          uint64_t key,
+                          const Assembler& assembler) {
+  const CodeBuffer& buffer = assembler.GetBuffer();
+  VIXL_ASSERT(!buffer.IsDirty());
+  const std::vector<Relocation>& relocations = assembler.GetRelocations();
+
+  Header header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kFormatVersion;
+  header.relocation_count = static_cast<uint32_t>(relocations.size());
+  header.key = key;
+  size_t metadata_size =
+      sizeof(header) + (relocations.size() * sizeof(Relocation));
+  header.code_offset = AlignUp(metadata_size, GetPageSize());
+  header.code_size = buffer.GetSizeInBytes();
+
+  // Copy the relocations field by field into zeroed records, so that no
+  // uninitialised padding is written to the file.
+  std::vector<Relocation> records(relocations.size());
+  if (!records.empty()) {
+    memset(records.data(), 0, records.size() * sizeof(Relocation));
+  }
+  for (size_t i = 0; i < relocations.size(); i++) {
+    records[i].offset = relocations[i].offset;
+    records[i].type = relocations[i].type;
+    records[i].symbol = relocations[i].symbol;
+    records[i].addend = relocations[i].addend;
+  }
+
+  FILE* file = fopen(path, "wb");
+  if (file == NULL) return false;
+  std::vector<byte> padding(header.code_offset - metadata_size, 0);
+  bool ok = (fwrite(&header, sizeof(header), 1, file) == 1);
+  if (!records.empty()) {
+    ok = ok && (fwrite(records.data(),
+                       sizeof(Relocation),
+                       records.size(),
+                       file) == records.size());
+  }
+  if (!padding.empty()) {
+    ok = ok &&
+         (fwrite(padding.data(), 1, padding.size(), file) == padding.size());
+  }
+  if (header.code_size > 0) {
+    ok = ok && (fwrite(buffer.GetStartAddress<const byte*>(),
+                       1,
+                       header.code_size,
+                       file) == header.code_size);
+  }
+  // Always close the file, even if writing failed.
+  ok = (fclose(file) == 0) && ok;
+  return ok;
+}
+
+
+bool PersistentCode::Load(const char* path,
+                          uint64_t key,
+                          const uintptr_t* symbols,
+                          size_t symbol_count) {
+#ifdef VIXL_CODE_BUFFER_MMAP
+  Unload();
+
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  struct stat file_stat;
+  if ((fstat(fd, &file_stat) != 0) ||
+      (static_cast<size_t>(file_stat.st_size) < sizeof(Header))) {
+    close(fd);
+    return false;
+  }
+  size_t file_size = static_cast<size_t>(file_stat.st_size);
+  // The mapping is private, so relocating the code does not modify the file.
+  // Only the pages holding relocations are copied.
+  void* mapping =
+      mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) return false;
+  byte* base = static_cast<byte*>(mapping);
+
+  Header header;
+  memcpy(&header, base, sizeof(header));
+  uint64_t metadata_size =
+      sizeof(header) +
+      (static_cast<uint64_t>(header.relocation_count) * sizeof(Relocation));
+  bool ok = (memcmp(header.magic, kMagic, sizeof(kMagic)) == 0) &&
+            (header.version == kFormatVersion) && (header.key == key) &&
+            (metadata_size <= header.code_offset) &&
+            ((header.code_offset % GetPageSize()) == 0) &&
+            (header.code_offset <= file_size) &&
+            (header.code_size == (file_size - header.code_offset));
+
+  // Check every relocation before applying any of them, since the file may
+  // not have been written by `Save()`. Relocations must not overlap, so that
+  // applying one cannot invalidate the next.
+  byte* code = base + header.code_offset;
+  const Relocation* relocations =
+      reinterpret_cast<const Relocation*>(base + sizeof(header));
+  uint64_t end = 0;
+  for (uint32_t i = 0; ok && (i < header.relocation_count); i++) {
+    const Relocation& relocation = relocations[i];
+    ok = (relocation.offset >= end) &&
+         relocation.CanApply(code, header.code_size, symbol_count);
+    end = relocation.offset + ((relocation.type == Relocation::kMovWide64)
+                                   ? (4 * kInstructionSize)
+                                   : sizeof(uint64_t));
+  }
+  for (uint32_t i = 0; ok && (i < header.relocation_count); i++) {
+    relocations[i].Apply(code, symbols);
+  }
+
+  if (ok && (header.code_size > 0)) {
+    ok = (mprotect(code, header.code_size, PROT_READ | PROT_EXEC) == 0);
+  }
+  if (!ok) {
+    munmap(mapping, file_size);
+    return false;
+  }
+  CPU::EnsureIAndDCacheCoherency(code, header.code_size);
+
+  mapping_ = mapping;
+  mapping_size_ = file_size;
+  code_ = code;
+  size_ = header.code_size;
+  return true;
+#else
+  USE(path, key, symbols, symbol_count);
+  // This requires mmap.
+  VIXL_UNIMPLEMENTED();
+  return false;
+#endif
+}
+
+
+void PersistentCode::Unload() {
+  if (mapping_ == NULL) return;
+#ifdef VIXL_CODE_BUFFER_MMAP
+  munmap(mapping_, mapping_size_);
+#endif
+  mapping_ = NULL;
+  mapping_size_ = 0;
+  code_ = NULL;
+  size_ = 0;
+}
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -0,0 +1,98 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIXL_AARCH64_PERSISTENT_CODE_AARCH64_H_
+#define VIXL_AARCH64_PERSISTENT_CODE_AARCH64_H_
+
+#include "../globals-vixl.h"
+
+#include "assembler-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+// Generated code saved to a file, so that later runs of a program can reload
+// it instead of generating it again.
+//
+// The file holds the code generated by an Assembler along with the
+// relocations recorded for it, and a key chosen by the user, typically a hash
+// of whatever the code was generated from. Loading the file maps it into
+// memory, checks the key, applies the relocations in a single pass, and makes
+// the code executable. The format is specific to the host and to the version
+// of VIXL which wrote it: a file which does not match is simply rejected, and
+// the code should then be generated again.
+//
+// Loading requires VIXL_CODE_BUFFER_MMAP.
+class PersistentCode {
+ public:
+  PersistentCode() : mapping_(NULL), mapping_size_(0), code_(NULL), size_(0) {}
+  ~PersistentCode() { Unload(); }
+
+  // Write the code generated by `assembler`, which must have been finalised,
+  // and its relocations to `path`. Return false if the file cannot be
+  // written.
+  static bool Save(const char* path, uint64_t key, const Assembler& assembler);
+
+  // Load the code saved at `path` with the same `key`. `symbols` holds the
+  // current addresses of the external symbols used by the relocations, which
+  // must all be lower than `symbol_count`. Return false, leaving nothing
+  // loaded, if the file does not exist or does not match.
+  bool Load(const char* path,
+            uint64_t key,
+            const uintptr_t* symbols,
+            size_t symbol_count);
+  void Unload();
+
+  bool IsLoaded() const { return code_ != NULL; }
+  size_t GetSize() const { return size_; }
+
+  template <typename T>
+  T GetStartAddress() const {
+    VIXL_STATIC_ASSERT(sizeof(T) >= sizeof(uintptr_t));
+    VIXL_ASSERT(IsLoaded());
+    return reinterpret_cast<T>(code_);
+  }
+  template <typename T>
+  T GetOffsetAddress(ptrdiff_t offset) const {
+    VIXL_STATIC_ASSERT(sizeof(T) >= sizeof(uintptr_t));
+    VIXL_ASSERT(IsLoaded());
+    VIXL_ASSERT((offset >= 0) && (static_cast<size_t>(offset) <= size_));
+    return reinterpret_cast<T>(code_ + offset);
+  }
+
+ private:
+  // The whole file is mapped, and the code is at a page-aligned offset in it.
+  void* mapping_;
+  size_t mapping_size_;
+  byte* code_;
+  size_t size_;
+};
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_PERSISTENT_CODE_AARCH64_H_
@@ -109,21 +109,118 @@ static uint64_t BigShuffle(uint64_t in_data) {
   return out_data;
 }
 
+// The functions above describe the hash, but evaluating them nibble by nibble
+// is slow. ShuffleNibbles and BigShuffle are linear over GF(2), so they (and
+// their compositions) can be evaluated as the XOR of the images of each input
+// byte. SubstituteNibbles works on each nibble independently, so it can be
+// evaluated a byte at a time.
+class PACTables {
+ public:
+  PACTables() {
+    // Populate the tables using the nibble-by-nibble implementations.
+    for (int byte = 0; byte < kBytes; byte++) {
+      for (int value = 0; value < kValues; value++) {
+        uint64_t in_data = static_cast<uint64_t>(value) << (8 * byte);
+        uint64_t big_shuffled = aarch64::BigShuffle(in_data);
+        uint64_t shuffled = aarch64::ShuffleNibbles(in_data);
+        big_shuffle_[byte][value] = big_shuffled;
+        big_shuffle_then_shuffle_[byte][value] =
+            aarch64::ShuffleNibbles(big_shuffled);
+        shuffle_then_big_shuffle_[byte][value] = aarch64::BigShuffle(shuffled);
+      }
+    }
+    for (int value = 0; value < kValues; value++) {
+      // Only the bottom two nibbles are meaningful.
+      substitute_[value] =
+          static_cast<uint8_t>(aarch64::SubstituteNibbles(value));
+    }
+  }
+
+  uint64_t BigShuffle(uint64_t in_data) const {
+    return Apply(big_shuffle_, in_data);
+  }
+  uint64_t BigShuffleThenShuffle(uint64_t in_data) const {
+    return Apply(big_shuffle_then_shuffle_, in_data);
+  }
+  uint64_t ShuffleThenBigShuffle(uint64_t in_data) const {
+    return Apply(shuffle_then_big_shuffle_, in_data);
+  }
+
+  uint64_t SubstituteNibbles(uint64_t in_data) const {
+    uint64_t out_data = 0;
+    for (int byte = 0; byte < kBytes; byte++) {
+      uint64_t value = substitute_[(in_data >> (8 * byte)) & 0xff];
+      out_data |= value << (8 * byte);
+    }
+    return out_data;
+  }
+
+ private:
+  static const int kBytes = 8;
+  static const int kValues = 256;
+  typedef uint64_t LinearTable[kBytes][kValues];
+
+  static uint64_t Apply(const LinearTable& table, uint64_t in_data) {
+    uint64_t out_data = 0;
+    for (int byte = 0; byte < kBytes; byte++) {
+      out_data ^= table[byte][(in_data >> (8 * byte)) & 0xff];
+    }
+    return out_data;
+  }
+
+  LinearTable big_shuffle_;
+  LinearTable big_shuffle_then_shuffle_;
+  LinearTable shuffle_then_big_shuffle_;
+  uint8_t substitute_[kValues];
+};
+
+static const PACTables& GetPACTables() {
+  static const PACTables tables;
+  return tables;
+}
+
 // A simple, non-standard hash function invented for simulating. It mixes
 // reasonably well, however it is unlikely to be cryptographically secure and
 // may have a higher collision chance than other hashing algorithms.
+//
+// This is equivalent to:
+//
+//   working_value = data ^ key.high;
+//   working_value = BigShuffle(working_value);
+//   working_value = ShuffleNibbles(working_value);
+//   working_value ^= key.low;
+//   working_value = ShuffleNibbles(working_value);
+//   working_value = BigShuffle(working_value);
+//   working_value ^= context;
+//   working_value = SubstituteNibbles(working_value);
+//   working_value = BigShuffle(working_value);
+//   working_value = SubstituteNibbles(working_value);
 uint64_t Simulator::ComputePAC(uint64_t data, uint64_t context, PACKey key) {
+  // Pointer-authenticated code tends to sign and authenticate the same
+  // pointers repeatedly (for example, return addresses in function prologues
+  // and epilogues), so check for a recent result first.
+  PACCacheEntry* entry = &pac_cache_[GetPACCacheIndex(data, context, key)];
+  if (entry->valid && (entry->data == data) && (entry->context == context) &&
+      (entry->key_high == key.high) && (entry->key_low == key.low)) {
+    return entry->pac;
+  }
+
+  const PACTables& tables = GetPACTables();
   uint64_t working_value = data ^ key.high;
-  working_value = BigShuffle(working_value);
-  working_value = ShuffleNibbles(working_value);
+  working_value = tables.BigShuffleThenShuffle(working_value);
   working_value ^= key.low;
-  working_value = ShuffleNibbles(working_value);
-  working_value = BigShuffle(working_value);
+  working_value = tables.ShuffleThenBigShuffle(working_value);
   working_value ^= context;
-  working_value = SubstituteNibbles(working_value);
-  working_value = BigShuffle(working_value);
-  working_value = SubstituteNibbles(working_value);
+  working_value = tables.SubstituteNibbles(working_value);
+  working_value = tables.BigShuffle(working_value);
+  working_value = tables.SubstituteNibbles(working_value);
 
+  entry->valid = true;
+  entry->data = data;
+  entry->context = context;
+  entry->key_high = key.high;
+  entry->key_low = key.low;
+  entry->pac = working_value;
   return working_value;
 }
 
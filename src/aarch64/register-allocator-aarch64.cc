@@ -0,0 +1,816 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "register-allocator-aarch64.h"
+
+#include <algorithm>
+#include <map>
+
+namespace vixl {
+namespace aarch64 {
+
+// Move between two physical registers of the same kind and size.
+static void MoveRegister(MacroAssembler* masm,
+                         const CPURegister& dst,
+                         const CPURegister& src) {
+  if (dst.Is(src)) return;
+  if (dst.IsRegister()) {
+    masm->Mov(Register(dst), Register(src));
+  } else if (dst.IsZRegister()) {
+    masm->Mov(ZRegister(dst).VnD(), ZRegister(src).VnD());
+  } else if (dst.IsPRegister()) {
+    masm->Mov(PRegister(dst), PRegister(src));
+  } else if (dst.GetSizeInBits() == kQRegSize) {
+    masm->Mov(VRegister(dst).V16B(), VRegister(src).V16B());
+  } else {
+    masm->Fmov(VRegister(dst), VRegister(src));
+  }
+}
+
+
+VirtualRegister VirtualCode::Allocate(VirtualRegister::Kind kind,
+                                      int size_in_bits) {
+  VirtualRegister reg(static_cast<int>(registers_.size()), kind, size_in_bits);
+  registers_.push_back(reg);
+  return reg;
+}
+
+
+void VirtualCode::Record(Node::Type type,
+                         const std::vector<VirtualRegister>& defs,
+                         const std::vector<VirtualRegister>& uses,
+                         const Emitter& emitter,
+                         Label* label,
+                         int index) {
+  Node node;
+  node.type = type;
+  node.defs = defs;
+  node.uses = uses;
+  node.emitter = emitter;
+  node.label = label;
+  node.index = index;
+  nodes_.push_back(node);
+}
+
+
+void VirtualCode::Emit(const std::vector<VirtualRegister>& defs,
+                       const std::vector<VirtualRegister>& uses,
+                       const Emitter& emitter) {
+  Record(Node::kGeneric, defs, uses, emitter);
+}
+
+
+void VirtualCode::Mov(const VirtualRegister& rd, uint64_t imm) {
+  VIXL_ASSERT(rd.GetKind() == VirtualRegister::kInteger);
+  Emit({rd}, {}, [imm](MacroAssembler* masm, const CPURegister* registers) {
+    masm->Mov(Register(registers[0]), imm);
+  });
+}
+
+
+void VirtualCode::Mov(const VirtualRegister& rd, const VirtualRegister& rn) {
+  VIXL_ASSERT(rd.GetKind() == rn.GetKind());
+  VIXL_ASSERT(rd.GetSizeInBits() == rn.GetSizeInBits());
+  Emit({rd}, {rn}, [](MacroAssembler* masm, const CPURegister* registers) {
+    MoveRegister(masm, registers[0], registers[1]);
+  });
+}
+
+
+void VirtualCode::Add(const VirtualRegister& rd,
+                      const VirtualRegister& rn,
+                      const VirtualRegister& rm) {
+  Emit({rd}, {rn, rm}, [](MacroAssembler* masm, const CPURegister* registers) {
+    masm->Add(Register(registers[0]),
+              Register(registers[1]),
+              Register(registers[2]));
+  });
+}
+
+
+void VirtualCode::Add(const VirtualRegister& rd,
+                      const VirtualRegister& rn,
+                      int64_t imm) {
+  Emit({rd}, {rn}, [imm](MacroAssembler* masm, const CPURegister* registers) {
+    masm->Add(Register(registers[0]), Register(registers[1]), imm);
+  });
+}
+
+
+void VirtualCode::Sub(const VirtualRegister& rd,
+                      const VirtualRegister& rn,
+                      const VirtualRegister& rm) {
+  Emit({rd}, {rn, rm}, [](MacroAssembler* masm, const CPURegister* registers) {
+    masm->Sub(Register(registers[0]),
+              Register(registers[1]),
+              Register(registers[2]));
+  });
+}
+
+
+void VirtualCode::Sub(const VirtualRegister& rd,
+                      const VirtualRegister& rn,
+                      int64_t imm) {
+  Emit({rd}, {rn}, [imm](MacroAssembler* masm, const CPURegister* registers) {
+    masm->Sub(Register(registers[0]), Register(registers[1]), imm);
+  });
+}
+
+
+void VirtualCode::Mul(const VirtualRegister& rd,
+                      const VirtualRegister& rn,
+                      const VirtualRegister& rm) {
+  Emit({rd}, {rn, rm}, [](MacroAssembler* masm, const CPURegister* registers) {
+    masm->Mul(Register(registers[0]),
+              Register(registers[1]),
+              Register(registers[2]));
+  });
+}
+
+
+void VirtualCode::Cmp(const VirtualRegister& rn, const VirtualRegister& rm) {
+  Emit({}, {rn, rm}, [](MacroAssembler* masm, const CPURegister* registers) {
+    masm->Cmp(Register(registers[0]), Register(registers[1]));
+  });
+}
+
+
+void VirtualCode::Cmp(const VirtualRegister& rn, int64_t imm) {
+  Emit({}, {rn}, [imm](MacroAssembler* masm, const CPURegister* registers) {
+    masm->Cmp(Register(registers[0]), imm);
+  });
+}
+
+
+void VirtualCode::Ldr(const VirtualRegister& rt,
+                      const VirtualRegister& base,
+                      int64_t offset) {
+  VIXL_ASSERT((rt.GetKind() == VirtualRegister::kInteger) ||
+              (rt.GetKind() == VirtualRegister::kFP));
+  VIXL_ASSERT(base.GetKind() == VirtualRegister::kInteger);
+  Emit({rt},
+       {base},
+       [offset](MacroAssembler* masm, const CPURegister* registers) {
+         masm->Ldr(registers[0], MemOperand(Register(registers[1]), offset));
+       });
+}
+
+
+void VirtualCode::Str(const VirtualRegister& rt,
+                      const VirtualRegister& base,
+                      int64_t offset) {
+  VIXL_ASSERT((rt.GetKind() == VirtualRegister::kInteger) ||
+              (rt.GetKind() == VirtualRegister::kFP));
+  VIXL_ASSERT(base.GetKind() == VirtualRegister::kInteger);
+  Emit({},
+       {rt, base},
+       [offset](MacroAssembler* masm, const CPURegister* registers) {
+         masm->Str(registers[0], MemOperand(Register(registers[1]), offset));
+       });
+}
+
+
+void VirtualCode::Fadd(const VirtualRegister& vd,
+                       const VirtualRegister& vn,
+                       const VirtualRegister& vm) {
+  Emit({vd}, {vn, vm}, [](MacroAssembler* masm, const CPURegister* registers) {
+    masm->Fadd(VRegister(registers[0]),
+               VRegister(registers[1]),
+               VRegister(registers[2]));
+  });
+}
+
+
+void VirtualCode::Fmul(const VirtualRegister& vd,
+                       const VirtualRegister& vn,
+                       const VirtualRegister& vm) {
+  Emit({vd}, {vn, vm}, [](MacroAssembler* masm, const CPURegister* registers) {
+    masm->Fmul(VRegister(registers[0]),
+               VRegister(registers[1]),
+               VRegister(registers[2]));
+  });
+}
+
+
+void VirtualCode::Bind(Label* label) {
+  Record(Node::kBind, {}, {}, Emitter(), label);
+}
+
+
+void VirtualCode::B(Label* label) {
+  Record(Node::kBranch,
+         {},
+         {},
+         [label](MacroAssembler* masm, const CPURegister*) { masm->B(label); },
+         label);
+}
+
+
+void VirtualCode::B(Condition cond, Label* label) {
+  Record(Node::kBranch,
+         {},
+         {},
+         [cond, label](MacroAssembler* masm, const CPURegister*) {
+           masm->B(cond, label);
+         },
+         label);
+}
+
+
+void VirtualCode::Cbz(const VirtualRegister& rt, Label* label) {
+  Record(Node::kBranch,
+         {},
+         {rt},
+         [label](MacroAssembler* masm, const CPURegister* registers) {
+           masm->Cbz(Register(registers[0]), label);
+         },
+         label);
+}
+
+
+void VirtualCode::Cbnz(const VirtualRegister& rt, Label* label) {
+  Record(Node::kBranch,
+         {},
+         {rt},
+         [label](MacroAssembler* masm, const CPURegister* registers) {
+           masm->Cbnz(Register(registers[0]), label);
+         },
+         label);
+}
+
+
+void VirtualCode::Argument(const VirtualRegister& rd, int index) {
+  VIXL_ASSERT((rd.GetKind() == VirtualRegister::kInteger) ||
+              (rd.GetKind() == VirtualRegister::kFP));
+  VIXL_ASSERT((index >= 0) && (index < 8));
+  Record(Node::kArgument, {rd}, {}, Emitter(), NULL, index);
+}
+
+
+void VirtualCode::Call(Label* function,
+                       const std::vector<VirtualRegister>& args,
+                       const VirtualRegister& result) {
+  std::vector<VirtualRegister> defs;
+  if (result.IsValid()) defs.push_back(result);
+  Record(Node::kCall, defs, args, Emitter(), function);
+  call_count_++;
+}
+
+
+void VirtualCode::Return(const VirtualRegister& result) {
+  std::vector<VirtualRegister> uses;
+  if (result.IsValid()) uses.push_back(result);
+  Record(Node::kReturn, {}, uses, Emitter());
+}
+
+
+void VirtualCode::ComputeIntervals() {
+  Interval unused = {-1, -1, false, false, -1, -1};
+  intervals_.assign(registers_.size(), unused);
+  std::map<const Label*, int> bound;
+  for (size_t i = 0; i < nodes_.size(); i++) {
+    const Node& node = nodes_[i];
+    int position = static_cast<int>(i);
+    if (node.type == Node::kBind) bound[node.label] = position;
+    // Uses are read before defs are written, so visit them first.
+    for (int pass = 0; pass < 2; pass++) {
+      const std::vector<VirtualRegister>& regs =
+          (pass == 0) ? node.uses : node.defs;
+      for (const VirtualRegister& reg : regs) {
+        Interval* interval = &intervals_[reg.GetIndex()];
+        if (interval->start < 0) {
+          interval->start = position;
+          interval->starts_with_def = (pass == 1);
+        }
+        interval->end = position;
+      }
+    }
+  }
+
+  // A value live on entry to a loop is live throughout it, and so is a value
+  // used in a loop before being defined in it, since it is carried around the
+  // back edge. Extending one interval can extend another loop's body, so
+  // iterate until nothing changes.
+  std::vector<std::pair<int, int> > loops;
+  for (size_t i = 0; i < nodes_.size(); i++) {
+    const Node& node = nodes_[i];
+    if (node.type != Node::kBranch) continue;
+    std::map<const Label*, int>::const_iterator it = bound.find(node.label);
+    if (it != bound.end()) {
+      loops.push_back(std::make_pair(it->second, static_cast<int>(i)));
+    }
+  }
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const std::pair<int, int>& loop : loops) {
+      int head = loop.first;
+      int tail = loop.second;
+      for (Interval& interval : intervals_) {
+        if (interval.start < 0) continue;
+        bool live_in = (interval.start < head) && (interval.end >= head);
+        bool carried = (interval.start >= head) && (interval.start <= tail) &&
+                       !interval.starts_with_def;
+        if ((live_in || carried) && (interval.end < tail)) {
+          interval.end = tail;
+          changed = true;
+        }
+        if (carried && (interval.start > head)) {
+          interval.start = head;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < nodes_.size(); i++) {
+    if (nodes_[i].type != Node::kCall) continue;
+    int position = static_cast<int>(i);
+    for (Interval& interval : intervals_) {
+      if ((interval.start < position) && (interval.end > position)) {
+        interval.crosses_call = true;
+      }
+    }
+  }
+}
+
+
+bool VirtualCode::CanUseCalleeSaved(const VirtualRegister& reg) {
+  switch (reg.GetKind()) {
+    case VirtualRegister::kInteger:
+      return true;
+    case VirtualRegister::kFP:
+      // Only the bottom 64 bits of v8-v15 are preserved by calls.
+      return reg.GetSizeInBits() <= static_cast<int>(kDRegSize);
+    case VirtualRegister::kZ:
+    case VirtualRegister::kP:
+      return false;
+  }
+  VIXL_UNREACHABLE();
+  return false;
+}
+
+
+int VirtualCode::GetMaxOperands(File file) const {
+  size_t max = 0;
+  for (const Node& node : nodes_) {
+    // Arguments, calls and returns move spilled values directly to or from
+    // the argument registers.
+    if ((node.type != Node::kGeneric) && (node.type != Node::kBranch)) {
+      continue;
+    }
+    std::vector<int> operands;
+    for (int pass = 0; pass < 2; pass++) {
+      const std::vector<VirtualRegister>& regs =
+          (pass == 0) ? node.defs : node.uses;
+      for (const VirtualRegister& reg : regs) {
+        if (GetFile(reg.GetKind()) != file) continue;
+        if (std::find(operands.begin(), operands.end(), reg.GetIndex()) ==
+            operands.end()) {
+          operands.push_back(reg.GetIndex());
+        }
+      }
+    }
+    max = std::max(max, operands.size());
+  }
+  return static_cast<int>(max);
+}
+
+
+int VirtualCode::AllocateFile(File file,
+                              std::vector<int> caller_saved,
+                              std::vector<int> callee_saved,
+                              int temp_count) {
+  temps_[file].clear();
+  for (int i = 0; i < temp_count; i++) {
+    std::vector<int>* pool = caller_saved.empty() ? &callee_saved
+                                                  : &caller_saved;
+    VIXL_ASSERT(!pool->empty());
+    temps_[file].push_back(pool->back());
+    pool->pop_back();
+  }
+
+  std::vector<int> order;
+  for (size_t i = 0; i < registers_.size(); i++) {
+    if ((GetFile(registers_[i].GetKind()) == file) &&
+        (intervals_[i].start >= 0)) {
+      intervals_[i].code = -1;
+      order.push_back(static_cast<int>(i));
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+    return intervals_[a].start < intervals_[b].start;
+  });
+
+  std::vector<int> active;
+  bool in_use[kNumberOfVRegisters] = {};
+  for (int index : order) {
+    Interval* current = &intervals_[index];
+    for (size_t i = 0; i < active.size();) {
+      const Interval& interval = intervals_[active[i]];
+      if (interval.end < current->start) {
+        in_use[interval.code] = false;
+        active.erase(active.begin() + i);
+      } else {
+        i++;
+      }
+    }
+
+    // Ranges live across a call must use callee-saved registers, and
+    // otherwise prefer caller-saved registers, which need not be saved.
+    bool callee_saved_only = current->crosses_call;
+    if (callee_saved_only && !CanUseCalleeSaved(registers_[index])) {
+      continue;
+    }
+    if (!callee_saved_only) {
+      for (int code : caller_saved) {
+        if (!in_use[code]) {
+          current->code = code;
+          break;
+        }
+      }
+    }
+    if (current->code < 0) {
+      for (int code : callee_saved) {
+        if (!in_use[code]) {
+          current->code = code;
+          break;
+        }
+      }
+    }
+
+    if (current->code < 0) {
+      // Spill whichever range ends last, freeing its register for the
+      // current one if that is not the current range itself.
+      int victim = -1;
+      for (size_t i = 0; i < active.size(); i++) {
+        const Interval& interval = intervals_[active[i]];
+        if (callee_saved_only &&
+            (std::find(callee_saved.begin(),
+                       callee_saved.end(),
+                       interval.code) == callee_saved.end())) {
+          continue;
+        }
+        if ((victim < 0) || (interval.end > intervals_[active[victim]].end)) {
+          victim = static_cast<int>(i);
+        }
+      }
+      if ((victim >= 0) && (intervals_[active[victim]].end > current->end)) {
+        Interval* spilled = &intervals_[active[victim]];
+        current->code = spilled->code;
+        spilled->code = -1;
+        active.erase(active.begin() + victim);
+        in_use[current->code] = false;
+      }
+    }
+
+    if (current->code >= 0) {
+      in_use[current->code] = true;
+      active.push_back(index);
+    }
+  }
+
+  int spills = 0;
+  for (int index : order) {
+    if (intervals_[index].code < 0) spills++;
+  }
+  return spills;
+}
+
+
+void VirtualCode::AllocateFrame() {
+  int offset = 0;
+  z_slot_count_ = 0;
+  p_slot_count_ = 0;
+  for (size_t i = 0; i < registers_.size(); i++) {
+    Interval* interval = &intervals_[i];
+    if ((interval->start < 0) || (interval->code >= 0)) continue;
+    switch (registers_[i].GetKind()) {
+      case VirtualRegister::kInteger:
+      case VirtualRegister::kFP:
+        if (registers_[i].GetSizeInBits() == static_cast<int>(kQRegSize)) {
+          offset = AlignUp(offset, static_cast<int>(kQRegSizeInBytes));
+          interval->slot = offset;
+          offset += kQRegSizeInBytes;
+        } else {
+          interval->slot = offset;
+          offset += kXRegSizeInBytes;
+        }
+        break;
+      case VirtualRegister::kZ:
+        interval->slot = z_slot_count_++;
+        break;
+      case VirtualRegister::kP:
+        interval->slot = p_slot_count_++;
+        break;
+    }
+  }
+
+  callee_saved_ = CPURegList(CPURegister::kRegister, kXRegSize, 0);
+  callee_saved_v_ = CPURegList(CPURegister::kVRegister, kDRegSize, 0);
+  std::vector<int> codes[kFileCount];
+  for (size_t i = 0; i < registers_.size(); i++) {
+    if (intervals_[i].code >= 0) {
+      codes[GetFile(registers_[i].GetKind())].push_back(intervals_[i].code);
+    }
+  }
+  for (int file = 0; file < kFileCount; file++) {
+    codes[file].insert(codes[file].end(),
+                       temps_[file].begin(),
+                       temps_[file].end());
+  }
+  for (int code : codes[kIntegerFile]) {
+    if (CPURegList::GetCalleeSaved().IncludesAliasOf(code)) {
+      callee_saved_.Combine(code);
+    }
+  }
+  for (int code : codes[kVFile]) {
+    if (CPURegList::GetCalleeSavedV().IncludesAliasOf(code)) {
+      callee_saved_v_.Combine(code);
+    }
+  }
+
+  saved_registers_offset_ = offset;
+  int saved_count = callee_saved_.GetCount() + callee_saved_v_.GetCount();
+  if (call_count_ > 0) saved_count++;
+  frame_size_ =
+      AlignUp(offset + saved_count * kXRegSizeInBytes, kXRegSizeInBytes * 2);
+}
+
+
+CPURegister VirtualCode::GetPhysicalRegister(const VirtualRegister& reg,
+                                             int code) const {
+  switch (reg.GetKind()) {
+    case VirtualRegister::kInteger:
+      return Register(code, reg.GetSizeInBits());
+    case VirtualRegister::kFP:
+      return VRegister(code, reg.GetSizeInBits());
+    case VirtualRegister::kZ:
+      return ZRegister(code, reg.GetSizeInBits());
+    case VirtualRegister::kP:
+      return PRegister(code);
+  }
+  VIXL_UNREACHABLE();
+  return NoCPUReg;
+}
+
+
+void VirtualCode::EmitSpill(MacroAssembler* masm,
+                            const VirtualRegister& reg,
+                            const CPURegister& temp,
+                            bool is_load) {
+  const Interval& interval = intervals_[reg.GetIndex()];
+  VIXL_ASSERT(interval.code < 0);
+  switch (reg.GetKind()) {
+    case VirtualRegister::kInteger:
+    case VirtualRegister::kFP: {
+      MemOperand slot(sp, interval.slot);
+      if (is_load) {
+        masm->Ldr(temp, slot);
+      } else {
+        masm->Str(temp, slot);
+      }
+      break;
+    }
+    case VirtualRegister::kZ:
+    case VirtualRegister::kP: {
+      // The Z and P spill areas are above the fixed-size part of the frame.
+      UseScratchRegisterScope temps(masm);
+      Register base = temps.AcquireX();
+      masm->Add(base, sp, frame_size_);
+      if (reg.GetKind() == VirtualRegister::kP) {
+        masm->Addvl(base, base, z_slot_count_);
+      }
+      SVEMemOperand slot(base, interval.slot, SVE_MUL_VL);
+      if (is_load) {
+        masm->Ldr(temp, slot);
+      } else {
+        masm->Str(temp, slot);
+      }
+      break;
+    }
+  }
+}
+
+
+void VirtualCode::EmitMove(MacroAssembler* masm,
+                           const CPURegister& dst,
+                           const VirtualRegister& src) {
+  int code = intervals_[src.GetIndex()].code;
+  if (code >= 0) {
+    MoveRegister(masm, dst, GetPhysicalRegister(src, code));
+  } else {
+    EmitSpill(masm, src, dst, true);
+  }
+}
+
+
+void VirtualCode::EmitMove(MacroAssembler* masm,
+                           const VirtualRegister& dst,
+                           const CPURegister& src) {
+  int code = intervals_[dst.GetIndex()].code;
+  if (code >= 0) {
+    MoveRegister(masm, GetPhysicalRegister(dst, code), src);
+  } else {
+    EmitSpill(masm, dst, src, false);
+  }
+}
+
+
+void VirtualCode::EmitPrologue(MacroAssembler* masm) {
+  // Each vector length holds eight predicates.
+  int vl_count = z_slot_count_ + ((p_slot_count_ + 7) / 8);
+  if (vl_count > 0) masm->Addvl(sp, sp, -vl_count);
+  if (frame_size_ > 0) masm->Sub(sp, sp, frame_size_);
+  CPURegList saved = callee_saved_;
+  if (call_count_ > 0) saved.Combine(lr);
+  masm->StoreCPURegList(saved, MemOperand(sp, saved_registers_offset_));
+  masm->StoreCPURegList(callee_saved_v_,
+                        MemOperand(sp,
+                                   saved_registers_offset_ +
+                                       saved.GetTotalSizeInBytes()));
+}
+
+
+void VirtualCode::EmitEpilogue(MacroAssembler* masm) {
+  CPURegList saved = callee_saved_;
+  if (call_count_ > 0) saved.Combine(lr);
+  masm->LoadCPURegList(saved, MemOperand(sp, saved_registers_offset_));
+  masm->LoadCPURegList(callee_saved_v_,
+                       MemOperand(sp,
+                                  saved_registers_offset_ +
+                                      saved.GetTotalSizeInBytes()));
+  if (frame_size_ > 0) masm->Add(sp, sp, frame_size_);
+  int vl_count = z_slot_count_ + ((p_slot_count_ + 7) / 8);
+  if (vl_count > 0) masm->Addvl(sp, sp, vl_count);
+  masm->Ret();
+}
+
+
+void VirtualCode::EmitNode(MacroAssembler* masm, const Node& node) {
+  switch (node.type) {
+    case Node::kBind:
+      masm->Bind(node.label);
+      return;
+    case Node::kArgument:
+      EmitMove(masm,
+               node.defs[0],
+               GetPhysicalRegister(node.defs[0], node.index));
+      return;
+    case Node::kCall: {
+      int next_x = 0;
+      int next_v = 0;
+      for (const VirtualRegister& arg : node.uses) {
+        bool is_integer = (arg.GetKind() == VirtualRegister::kInteger);
+        VIXL_ASSERT(is_integer || (arg.GetKind() == VirtualRegister::kFP));
+        int code = is_integer ? next_x++ : next_v++;
+        VIXL_ASSERT(code < 8);
+        EmitMove(masm, GetPhysicalRegister(arg, code), arg);
+      }
+      masm->Bl(node.label);
+      if (!node.defs.empty()) {
+        EmitMove(masm, node.defs[0], GetPhysicalRegister(node.defs[0], 0));
+      }
+      return;
+    }
+    case Node::kReturn:
+      if (!node.uses.empty()) {
+        EmitMove(masm, GetPhysicalRegister(node.uses[0], 0), node.uses[0]);
+      }
+      EmitEpilogue(masm);
+      return;
+    case Node::kGeneric:
+    case Node::kBranch:
+      break;
+  }
+
+  // Spilled registers are loaded into temporaries before the instruction, and
+  // stored after it. A register both defined and used gets a single
+  // temporary, so that instructions reading their destination work.
+  std::vector<CPURegister> registers;
+  std::vector<int> spilled;
+  std::vector<CPURegister> spilled_temps;
+  size_t next_temp[kFileCount] = {};
+  for (int pass = 0; pass < 2; pass++) {
+    const std::vector<VirtualRegister>& regs =
+        (pass == 0) ? node.defs : node.uses;
+    for (const VirtualRegister& reg : regs) {
+      int code = intervals_[reg.GetIndex()].code;
+      if (code >= 0) {
+        registers.push_back(GetPhysicalRegister(reg, code));
+        continue;
+      }
+      std::vector<int>::const_iterator it =
+          std::find(spilled.begin(), spilled.end(), reg.GetIndex());
+      if (it != spilled.end()) {
+        registers.push_back(spilled_temps[it - spilled.begin()]);
+        continue;
+      }
+      File file = GetFile(reg.GetKind());
+      VIXL_ASSERT(next_temp[file] < temps_[file].size());
+      CPURegister temp =
+          GetPhysicalRegister(reg, temps_[file][next_temp[file]++]);
+      spilled.push_back(reg.GetIndex());
+      spilled_temps.push_back(temp);
+      registers.push_back(temp);
+    }
+  }
+
+  size_t def_count = node.defs.size();
+  std::vector<bool> loaded(spilled.size(), false);
+  for (size_t i = 0; i < node.uses.size(); i++) {
+    const VirtualRegister& reg = node.uses[i];
+    if (intervals_[reg.GetIndex()].code >= 0) continue;
+    size_t k = std::find(spilled.begin(), spilled.end(), reg.GetIndex()) -
+               spilled.begin();
+    if (!loaded[k]) {
+      EmitSpill(masm, reg, registers[def_count + i], true);
+      loaded[k] = true;
+    }
+  }
+  node.emitter(masm, registers.data());
+  for (size_t i = 0; i < def_count; i++) {
+    const VirtualRegister& reg = node.defs[i];
+    if (intervals_[reg.GetIndex()].code < 0) {
+      EmitSpill(masm, reg, registers[i], false);
+    }
+  }
+}
+
+
+void VirtualCode::Generate(MacroAssembler* masm) {
+  ComputeIntervals();
+
+  // Allocate from the registers the ABI lets us clobber or save, leaving out
+  // the argument registers and anything the MacroAssembler may use as a
+  // scratch register.
+  std::vector<int> caller_saved[kFileCount];
+  std::vector<int> callee_saved[kFileCount];
+  const CPURegList* scratch[kFileCount] = {masm->GetScratchRegisterList(),
+                                           masm->GetScratchVRegisterList(),
+                                           masm->GetScratchPRegisterList()};
+  struct {
+    File file;
+    std::vector<int>* pool;
+    int first;
+    int last;
+  } ranges[] = {{kIntegerFile, caller_saved, 8, 15},
+                {kIntegerFile, callee_saved, 19, 28},
+                {kVFile, caller_saved, 16, 31},
+                {kVFile, callee_saved, 8, 15},
+                {kPFile, caller_saved, 0, 7}};
+  for (const auto& range : ranges) {
+    for (int code = range.first; code <= range.last; code++) {
+      if (!scratch[range.file]->IncludesAliasOf(code)) {
+        range.pool[range.file].push_back(code);
+      }
+    }
+  }
+
+  spill_count_ = 0;
+  for (int i = 0; i < kFileCount; i++) {
+    File file = static_cast<File>(i);
+    int spills = AllocateFile(file, caller_saved[i], callee_saved[i], 0);
+    if (spills > 0) {
+      // Retry with some registers reserved to hold spilled operands.
+      spills = AllocateFile(file,
+                            caller_saved[i],
+                            callee_saved[i],
+                            GetMaxOperands(file));
+    }
+    spill_count_ += spills;
+  }
+
+  AllocateFrame();
+  EmitPrologue(masm);
+  for (const Node& node : nodes_) {
+    EmitNode(masm, node);
+  }
+}
+
+}  // namespace aarch64
+}  // namespace vixl
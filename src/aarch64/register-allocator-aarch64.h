@@ -0,0 +1,326 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIXL_AARCH64_REGISTER_ALLOCATOR_AARCH64_H_
+#define VIXL_AARCH64_REGISTER_ALLOCATOR_AARCH64_H_
+
+#include <functional>
+#include <vector>
+
+#include "../globals-vixl.h"
+
+#include "macro-assembler-aarch64.h"
+#include "operands-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+// A register of a VirtualCode function, mapped to a physical register or to
+// a stack slot when the function is generated.
+class VirtualRegister {
+ public:
+  enum Kind { kInteger, kFP, kZ, kP };
+
+  VirtualRegister() : index_(-1), kind_(kInteger), size_in_bits_(0) {}
+
+  int GetIndex() const { return index_; }
+  Kind GetKind() const { return kind_; }
+  // For Z registers, this is the lane size.
+  int GetSizeInBits() const { return size_in_bits_; }
+  bool IsValid() const { return index_ >= 0; }
+
+ private:
+  friend class VirtualCode;
+
+  VirtualRegister(int index, Kind kind, int size_in_bits)
+      : index_(index), kind_(kind), size_in_bits_(size_in_bits) {}
+
+  int index_;
+  Kind kind_;
+  int size_in_bits_;
+};
+
+
+// A function written with virtual registers, and generated with a
+// MacroAssembler once its registers have been allocated.
+//
+// The function is recorded as a list of instructions, each of which lists the
+// virtual registers it defines and uses, and emits code with the physical
+// registers allocated to them. Registers are then allocated with a linear
+// scan over the live ranges of the virtual registers:
+//  * Registers in the MacroAssembler's scratch lists when the function is
+//    generated are never allocated, so that macro instructions can still use
+//    them.
+//  * x0-x7 and v0-v7 are reserved for arguments and results, so that calls
+//    need no parallel moves. x18 (the platform register), the frame pointer
+//    and the link register are never allocated.
+//  * Ranges which are live across a call are allocated to callee-saved
+//    registers (x19-x28, and d8-d15 for values of at most 64 bits), or
+//    spilled. Callee-saved registers are saved in the prologue.
+//  * When registers run out, the range which ends last is spilled to a stack
+//    slot. Spilled registers are loaded into, and stored from, registers
+//    reserved for this purpose around each instruction using them.
+//
+// Live ranges are computed from the order of the instructions, and extended
+// over loops formed by backward branches, so the function must not use a
+// register before it has been defined on every path leading to the use.
+//
+// For example, this function returns the sum of the integers from 1 to its
+// argument:
+//
+//   VirtualCode code;
+//   VirtualRegister n = code.AllocateX();
+//   VirtualRegister sum = code.AllocateX();
+//   Label loop, done;
+//   code.Argument(n, 0);
+//   code.Mov(sum, 0);
+//   code.Bind(&loop);
+//   code.Cbz(n, &done);
+//   code.Add(sum, sum, n);
+//   code.Sub(n, n, 1);
+//   code.B(&loop);
+//   code.Bind(&done);
+//   code.Return(sum);
+//   code.Generate(&masm);
+class VirtualCode {
+ public:
+  // Emit an instruction, with `registers` holding the physical registers for
+  // the virtual registers it defines, followed by the ones it uses.
+  typedef std::function<void(MacroAssembler* masm,
+                             const CPURegister* registers)>
+      Emitter;
+
+  VirtualCode()
+      : call_count_(0),
+        spill_count_(0),
+        callee_saved_(CPURegister::kRegister, kXRegSize, 0),
+        callee_saved_v_(CPURegister::kVRegister, kDRegSize, 0),
+        saved_registers_offset_(0),
+        frame_size_(0),
+        z_slot_count_(0),
+        p_slot_count_(0) {}
+
+  VirtualRegister AllocateX() {
+    return Allocate(VirtualRegister::kInteger, kXRegSize);
+  }
+  VirtualRegister AllocateW() {
+    return Allocate(VirtualRegister::kInteger, kWRegSize);
+  }
+  VirtualRegister AllocateS() {
+    return Allocate(VirtualRegister::kFP, kSRegSize);
+  }
+  VirtualRegister AllocateD() {
+    return Allocate(VirtualRegister::kFP, kDRegSize);
+  }
+  VirtualRegister AllocateQ() {
+    return Allocate(VirtualRegister::kFP, kQRegSize);
+  }
+  // Z registers have a lane size, and are spilled as whole vectors. The
+  // MacroAssembler must support SVE if they are used.
+  VirtualRegister AllocateZ(int lane_size_in_bits) {
+    return Allocate(VirtualRegister::kZ, lane_size_in_bits);
+  }
+  // Predicates are allocated from p0-p7, so that they can all be used as
+  // governing predicates.
+  VirtualRegister AllocateP() { return Allocate(VirtualRegister::kP, 0); }
+
+  // Record an instruction defining `defs` and using `uses`.
+  void Emit(const std::vector<VirtualRegister>& defs,
+            const std::vector<VirtualRegister>& uses,
+            const Emitter& emitter);
+
+  // Common instructions.
+  void Mov(const VirtualRegister& rd, uint64_t imm);
+  void Mov(const VirtualRegister& rd, const VirtualRegister& rn);
+  void Add(const VirtualRegister& rd,
+           const VirtualRegister& rn,
+           const VirtualRegister& rm);
+  void Add(const VirtualRegister& rd, const VirtualRegister& rn, int64_t imm);
+  void Sub(const VirtualRegister& rd,
+           const VirtualRegister& rn,
+           const VirtualRegister& rm);
+  void Sub(const VirtualRegister& rd, const VirtualRegister& rn, int64_t imm);
+  void Mul(const VirtualRegister& rd,
+           const VirtualRegister& rn,
+           const VirtualRegister& rm);
+  void Cmp(const VirtualRegister& rn, const VirtualRegister& rm);
+  void Cmp(const VirtualRegister& rn, int64_t imm);
+  // Load and store `rt` at `base` plus `offset`.
+  void Ldr(const VirtualRegister& rt,
+           const VirtualRegister& base,
+           int64_t offset = 0);
+  void Str(const VirtualRegister& rt,
+           const VirtualRegister& base,
+           int64_t offset = 0);
+  void Fadd(const VirtualRegister& vd,
+            const VirtualRegister& vn,
+            const VirtualRegister& vm);
+  void Fmul(const VirtualRegister& vd,
+            const VirtualRegister& vn,
+            const VirtualRegister& vm);
+
+  // Control flow. Labels must outlive the VirtualCode.
+  void Bind(Label* label);
+  void B(Label* label);
+  void B(Condition cond, Label* label);
+  void Cbz(const VirtualRegister& rt, Label* label);
+  void Cbnz(const VirtualRegister& rt, Label* label);
+
+  // Define `rd` as argument `index` of the function, in x<index> or
+  // v<index>. Arguments must be read before any call.
+  void Argument(const VirtualRegister& rd, int index);
+  // Call `function`, a label bound in the same MacroAssembler, passing `args`
+  // in x0-x7 and v0-v7 and returning `result` in x0 or v0, which can be
+  // invalid. All caller-saved registers are clobbered.
+  void Call(Label* function,
+            const std::vector<VirtualRegister>& args,
+            const VirtualRegister& result = VirtualRegister());
+  // Return `result`, in x0 or v0, if it is valid.
+  void Return(const VirtualRegister& result = VirtualRegister());
+
+  // Allocate registers, and generate the function in `masm`, at its cursor.
+  void Generate(MacroAssembler* masm);
+
+  // The number of virtual registers which were spilled by Generate().
+  int GetSpillCount() const { return spill_count_; }
+  // The callee-saved registers used by the generated code.
+  CPURegList GetCalleeSavedRegisters() const { return callee_saved_; }
+  CPURegList GetCalleeSavedVRegisters() const { return callee_saved_v_; }
+
+ private:
+  // Virtual registers are allocated from three register files: integer
+  // registers, V registers (shared by FP and Z registers, which alias them),
+  // and predicates.
+  enum File { kIntegerFile, kVFile, kPFile, kFileCount };
+
+  struct Node {
+    enum Type { kGeneric, kBind, kBranch, kArgument, kCall, kReturn };
+    Type type;
+    std::vector<VirtualRegister> defs;
+    std::vector<VirtualRegister> uses;
+    Emitter emitter;
+    // The bound label, the branch target, or the called function.
+    Label* label;
+    // The argument index, for kArgument.
+    int index;
+  };
+
+  // The live range of a virtual register, and where it was allocated.
+  struct Interval {
+    // The first and last nodes using or defining the register, or -1 if it is
+    // not used.
+    int start;
+    int end;
+    // Whether the first node refers to the register to define it.
+    bool starts_with_def;
+    bool crosses_call;
+    // The physical register code, or -1 if the register is spilled.
+    int code;
+    // The offset of the spill slot from the stack pointer, or its index in
+    // the Z or P spill area.
+    int slot;
+  };
+
+  static File GetFile(VirtualRegister::Kind kind) {
+    switch (kind) {
+      case VirtualRegister::kInteger:
+        return kIntegerFile;
+      case VirtualRegister::kFP:
+      case VirtualRegister::kZ:
+        return kVFile;
+      case VirtualRegister::kP:
+        return kPFile;
+    }
+    VIXL_UNREACHABLE();
+    return kIntegerFile;
+  }
+
+  VirtualRegister Allocate(VirtualRegister::Kind kind, int size_in_bits);
+  void Record(Node::Type type,
+              const std::vector<VirtualRegister>& defs,
+              const std::vector<VirtualRegister>& uses,
+              const Emitter& emitter,
+              Label* label = NULL,
+              int index = 0);
+
+  void ComputeIntervals();
+  // Allocate the registers of `file` from `caller_saved` and `callee_saved`,
+  // after reserving `temp_count` of them to hold spilled operands. Return the
+  // number of spilled registers.
+  int AllocateFile(File file,
+                   std::vector<int> caller_saved,
+                   std::vector<int> callee_saved,
+                   int temp_count);
+  // The largest number of registers of `file` used by a single node, and so
+  // the number of temporaries needed if they are all spilled.
+  int GetMaxOperands(File file) const;
+  // Whether callee-saved registers preserve the whole of `reg`.
+  static bool CanUseCalleeSaved(const VirtualRegister& reg);
+  void AllocateFrame();
+
+  CPURegister GetPhysicalRegister(const VirtualRegister& reg, int code) const;
+  void EmitNode(MacroAssembler* masm, const Node& node);
+  void EmitPrologue(MacroAssembler* masm);
+  void EmitEpilogue(MacroAssembler* masm);
+  // Load or store the spilled register `reg`, from or to `reg`.
+  void EmitSpill(MacroAssembler* masm,
+                 const VirtualRegister& reg,
+                 const CPURegister& temp,
+                 bool is_load);
+  // Move between a physical register and a virtual register, which may be
+  // spilled.
+  void EmitMove(MacroAssembler* masm,
+                const CPURegister& dst,
+                const VirtualRegister& src);
+  void EmitMove(MacroAssembler* masm,
+                const VirtualRegister& dst,
+                const CPURegister& src);
+
+  std::vector<VirtualRegister> registers_;
+  std::vector<Node> nodes_;
+  std::vector<Interval> intervals_;
+  int call_count_;
+  int spill_count_;
+
+  // Registers reserved to hold spilled operands, for each register file.
+  std::vector<int> temps_[kFileCount];
+
+  // The frame holds the spill slots and the saved registers, followed by the
+  // spill slots for Z and P registers, whose size depends on the vector
+  // length.
+  CPURegList callee_saved_;
+  CPURegList callee_saved_v_;
+  int saved_registers_offset_;
+  int frame_size_;
+  int z_slot_count_;
+  int p_slot_count_;
+};
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_REGISTER_ALLOCATOR_AARCH64_H_
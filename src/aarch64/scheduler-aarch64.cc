@@ -0,0 +1,613 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "scheduler-aarch64.h"
+
+#include <algorithm>
+
+#include "instructions-aarch64.h"
+#include "simulator-constants-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+namespace {
+
+enum LatencyClass {
+  kAlu,
+  kAluShifted,
+  kMultiply,
+  kDivide,
+  kLoad,
+  kVLoad,
+  kStore,
+  kFPAlu,
+  kFPMultiply,
+  kFPMultiplyAdd,
+  kFPDivide,
+  kFPConvert,
+  kNEONAlu,
+  kNEONMultiply,
+  kBarrier,
+  kLatencyClassCount
+};
+
+// Result latencies, in cycles. Divides and square roots take a variable
+// number of cycles, so a typical value is used.
+const int kLatencies[Scheduler::kCoreModelCount][kLatencyClassCount] = {
+    // Cortex-A53.
+    {1, 2, 3, 12, 3, 4, 1, 4, 4, 8, 18, 4, 3, 4, 1},
+    // Cortex-A72.
+    {1, 2, 3, 12, 4, 5, 1, 4, 4, 7, 12, 4, 3, 4, 1},
+    // Neoverse N1.
+    {1, 2, 2, 12, 4, 5, 1, 2, 3, 4, 10, 3, 2, 4, 1},
+};
+
+// The registers, flags and memory an instruction reads and writes. Where an
+// instruction's operands are not fully decoded, this over-approximates them,
+// which can only prevent reordering.
+struct Effects {
+  // Bit 31 is the stack pointer. The zero register is not tracked.
+  uint32_t x_reads;
+  uint32_t x_writes;
+  uint32_t v_reads;
+  uint32_t v_writes;
+  bool reads_flags;
+  bool writes_flags;
+  bool loads;
+  bool stores;
+  LatencyClass latency;
+};
+
+void ReadX(Effects* effects, unsigned code, Reg31Mode mode) {
+  if ((code == kZeroRegCode) && (mode == Reg31IsZeroRegister)) return;
+  effects->x_reads |= UINT32_C(1) << code;
+}
+
+void WriteX(Effects* effects, unsigned code, Reg31Mode mode) {
+  if ((code == kZeroRegCode) && (mode == Reg31IsZeroRegister)) return;
+  effects->x_writes |= UINT32_C(1) << code;
+}
+
+void ReadV(Effects* effects, unsigned code) {
+  effects->v_reads |= UINT32_C(1) << code;
+}
+
+void WriteV(Effects* effects, unsigned code) {
+  effects->v_writes |= UINT32_C(1) << code;
+}
+
+// An instruction which is neither moved nor moved across.
+Effects BarrierEffects() {
+  Effects effects = {0xffffffff,
+                     0xffffffff,
+                     0xffffffff,
+                     0xffffffff,
+                     true,
+                     true,
+                     true,
+                     true,
+                     kBarrier};
+  return effects;
+}
+
+bool Is(const Instruction* instr, Instr fmask, Instr fixed) {
+  return instr->Mask(fmask) == fixed;
+}
+
+bool AnalyzeDataProcessing(const Instruction* instr, Effects* effects) {
+  unsigned rd = instr->GetRd();
+  unsigned rn = instr->GetRn();
+  unsigned rm = instr->GetRm();
+  // For logical instructions, opc is 3 for ANDS and BICS.
+  bool logical_sets_flags = instr->ExtractBits(30, 29) == 3;
+  effects->latency = kAlu;
+  if (Is(instr, AddSubImmediateFMask, AddSubImmediateFixed)) {
+    bool sets_flags = instr->GetFlagsUpdate() != 0;
+    WriteX(effects, rd, sets_flags ? Reg31IsZeroRegister : Reg31IsStackPointer);
+    ReadX(effects, rn, Reg31IsStackPointer);
+    effects->writes_flags = sets_flags;
+  } else if (Is(instr, LogicalImmediateFMask, LogicalImmediateFixed)) {
+    WriteX(effects,
+           rd,
+           logical_sets_flags ? Reg31IsZeroRegister : Reg31IsStackPointer);
+    ReadX(effects, rn, Reg31IsZeroRegister);
+    effects->writes_flags = logical_sets_flags;
+  } else if (Is(instr, MoveWideImmediateFMask, MoveWideImmediateFixed)) {
+    WriteX(effects, rd, Reg31IsZeroRegister);
+    // MOVK keeps the other bits of the register.
+    if (instr->ExtractBits(30, 29) == 3) {
+      ReadX(effects, rd, Reg31IsZeroRegister);
+    }
+  } else if (Is(instr, BitfieldFMask, BitfieldFixed)) {
+    WriteX(effects, rd, Reg31IsZeroRegister);
+    ReadX(effects, rn, Reg31IsZeroRegister);
+    // BFM keeps the other bits of the register.
+    if (instr->ExtractBits(30, 29) == 1) {
+      ReadX(effects, rd, Reg31IsZeroRegister);
+    }
+  } else if (Is(instr, ExtractFMask, ExtractFixed)) {
+    WriteX(effects, rd, Reg31IsZeroRegister);
+    ReadX(effects, rn, Reg31IsZeroRegister);
+    ReadX(effects, rm, Reg31IsZeroRegister);
+  } else if (Is(instr, AddSubShiftedFMask, AddSubShiftedFixed) ||
+             Is(instr, LogicalShiftedFMask, LogicalShiftedFixed)) {
+    bool is_logical = Is(instr, LogicalShiftedFMask, LogicalShiftedFixed);
+    WriteX(effects, rd, Reg31IsZeroRegister);
+    ReadX(effects, rn, Reg31IsZeroRegister);
+    ReadX(effects, rm, Reg31IsZeroRegister);
+    effects->writes_flags =
+        is_logical ? logical_sets_flags : (instr->GetFlagsUpdate() != 0);
+    if (instr->GetImmDPShift() != 0) effects->latency = kAluShifted;
+  } else if (Is(instr, AddSubExtendedFMask, AddSubExtendedFixed)) {
+    bool sets_flags = instr->GetFlagsUpdate() != 0;
+    WriteX(effects, rd, sets_flags ? Reg31IsZeroRegister : Reg31IsStackPointer);
+    ReadX(effects, rn, Reg31IsStackPointer);
+    ReadX(effects, rm, Reg31IsZeroRegister);
+    effects->writes_flags = sets_flags;
+    effects->latency = kAluShifted;
+  } else if (Is(instr, AddSubWithCarryFMask, AddSubWithCarryFixed)) {
+    WriteX(effects, rd, Reg31IsZeroRegister);
+    ReadX(effects, rn, Reg31IsZeroRegister);
+    ReadX(effects, rm, Reg31IsZeroRegister);
+    effects->reads_flags = true;
+    effects->writes_flags = instr->GetFlagsUpdate() != 0;
+  } else if (Is(instr,
+                ConditionalCompareRegisterFMask,
+                ConditionalCompareRegisterFixed) ||
+             Is(instr,
+                ConditionalCompareImmediateFMask,
+                ConditionalCompareImmediateFixed)) {
+    ReadX(effects, rn, Reg31IsZeroRegister);
+    if (Is(instr,
+           ConditionalCompareRegisterFMask,
+           ConditionalCompareRegisterFixed)) {
+      ReadX(effects, rm, Reg31IsZeroRegister);
+    }
+    effects->reads_flags = true;
+    effects->writes_flags = true;
+  } else if (Is(instr, ConditionalSelectFMask, ConditionalSelectFixed)) {
+    WriteX(effects, rd, Reg31IsZeroRegister);
+    ReadX(effects, rn, Reg31IsZeroRegister);
+    ReadX(effects, rm, Reg31IsZeroRegister);
+    effects->reads_flags = true;
+  } else if (Is(instr,
+                DataProcessing1SourceFMask,
+                DataProcessing1SourceFixed)) {
+    // Pointer authentication instructions also read their destination.
+    WriteX(effects, rd, Reg31IsZeroRegister);
+    ReadX(effects, rd, Reg31IsZeroRegister);
+    ReadX(effects, rn, Reg31IsStackPointer);
+  } else if (Is(instr,
+                DataProcessing2SourceFMask,
+                DataProcessing2SourceFixed)) {
+    WriteX(effects, rd, Reg31IsZeroRegister);
+    ReadX(effects, rn, Reg31IsStackPointer);
+    ReadX(effects, rm, Reg31IsStackPointer);
+    switch (instr->Mask(DataProcessing2SourceMask)) {
+      case UDIV_w:
+      case UDIV_x:
+      case SDIV_w:
+      case SDIV_x:
+        effects->latency = kDivide;
+        break;
+      default:
+        break;
+    }
+  } else if (Is(instr,
+                DataProcessing3SourceFMask,
+                DataProcessing3SourceFixed)) {
+    WriteX(effects, rd, Reg31IsZeroRegister);
+    ReadX(effects, rn, Reg31IsZeroRegister);
+    ReadX(effects, rm, Reg31IsZeroRegister);
+    ReadX(effects, instr->GetRa(), Reg31IsZeroRegister);
+    effects->latency = kMultiply;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool AnalyzeLoadStore(const Instruction* instr, Effects* effects) {
+  bool is_pair = Is(instr, LoadStorePairAnyFMask, LoadStorePairAnyFixed);
+  bool writeback;
+  if (is_pair) {
+    writeback =
+        Is(instr, LoadStorePairPreIndexFMask, LoadStorePairPreIndexFixed) ||
+        Is(instr, LoadStorePairPostIndexFMask, LoadStorePairPostIndexFixed);
+  } else if (Is(instr, LoadStorePreIndexFMask, LoadStorePreIndexFixed) ||
+             Is(instr, LoadStorePostIndexFMask, LoadStorePostIndexFixed)) {
+    writeback = true;
+  } else if (Is(instr,
+                LoadStoreUnsignedOffsetFMask,
+                LoadStoreUnsignedOffsetFixed) ||
+             Is(instr,
+                LoadStoreUnscaledOffsetFMask,
+                LoadStoreUnscaledOffsetFixed)) {
+    writeback = false;
+  } else if (Is(instr,
+                LoadStoreRegisterOffsetFMask,
+                LoadStoreRegisterOffsetFixed)) {
+    writeback = false;
+    ReadX(effects, instr->GetRm(), Reg31IsZeroRegister);
+  } else {
+    return false;
+  }
+  // This excludes prefetches, which are left in place.
+  effects->loads = instr->IsLoad();
+  effects->stores = instr->IsStore();
+  if (!effects->loads && !effects->stores) return false;
+
+  bool is_v = instr->Mask(LoadStoreVMask) != 0;
+  unsigned rts[] = {static_cast<unsigned>(instr->GetRt()),
+                    static_cast<unsigned>(instr->GetRt2())};
+  for (int i = 0; i < (is_pair ? 2 : 1); i++) {
+    if (is_v) {
+      effects->loads ? WriteV(effects, rts[i]) : ReadV(effects, rts[i]);
+    } else if (effects->loads) {
+      WriteX(effects, rts[i], Reg31IsZeroRegister);
+    } else {
+      ReadX(effects, rts[i], Reg31IsZeroRegister);
+    }
+  }
+  ReadX(effects, instr->GetRn(), Reg31IsStackPointer);
+  if (writeback) WriteX(effects, instr->GetRn(), Reg31IsStackPointer);
+  if (effects->stores) {
+    effects->latency = kStore;
+  } else {
+    effects->latency = is_v ? kVLoad : kLoad;
+  }
+  return true;
+}
+
+// Scalar floating-point and Advanced SIMD data processing.
+void AnalyzeFPAndNEON(const Instruction* instr, Effects* effects) {
+  unsigned rd = instr->GetRd();
+  unsigned rn = instr->GetRn();
+  effects->latency = kNEONAlu;
+  if (Is(instr, FPIntegerConvertFMask, FPIntegerConvertFixed) ||
+      Is(instr, FPFixedPointConvertFMask, FPFixedPointConvertFixed) ||
+      Is(instr, NEONCopyFMask, NEONCopyFixed)) {
+    // These move values between integer and V registers, in either
+    // direction, and some insert into their destination.
+    ReadX(effects, rn, Reg31IsZeroRegister);
+    WriteX(effects, rd, Reg31IsZeroRegister);
+    ReadV(effects, rn);
+    ReadV(effects, rd);
+    WriteV(effects, rd);
+    if (instr->Mask(FPIntegerConvertMask) == FJCVTZS) {
+      effects->writes_flags = true;
+    }
+    if (!Is(instr, NEONCopyFMask, NEONCopyFixed)) effects->latency = kFPConvert;
+    return;
+  }
+  if (Is(instr, NEONTableFMask, NEONTableFixed)) {
+    // Tables are lists of up to four registers.
+    effects->v_reads = 0xffffffff;
+    WriteV(effects, rd);
+    return;
+  }
+
+  ReadV(effects, rn);
+  ReadV(effects, instr->GetRm());
+  if (Is(instr, NEONByIndexedElementFMask, NEONByIndexedElementFixed) ||
+      Is(instr,
+         NEONScalarByIndexedElementFMask,
+         NEONScalarByIndexedElementFixed)) {
+    // For H-sized elements, bit 20 is part of the index, and the register is
+    // only encoded in bits 16-19.
+    ReadV(effects, instr->GetRmLow16());
+  }
+  if (Is(instr, FPCompareFMask, FPCompareFixed)) {
+    effects->writes_flags = true;
+    effects->latency = kFPAlu;
+    return;
+  }
+  if (Is(instr, FPConditionalCompareFMask, FPConditionalCompareFixed)) {
+    effects->reads_flags = true;
+    effects->writes_flags = true;
+    effects->latency = kFPAlu;
+    return;
+  }
+  // Many NEON instructions accumulate into their destination, or insert
+  // into part of it, so treat them all as reading it, and the field holding
+  // the third source of some forms as a register.
+  ReadV(effects, rd);
+  ReadV(effects, instr->GetRa());
+  WriteV(effects, rd);
+  if (Is(instr, FPConditionalSelectFMask, FPConditionalSelectFixed)) {
+    effects->reads_flags = true;
+    effects->latency = kFPAlu;
+  } else if (Is(instr,
+                FPDataProcessing1SourceFMask,
+                FPDataProcessing1SourceFixed)) {
+    switch (instr->ExtractBits(20, 15)) {
+      case 3:  // FSQRT.
+        effects->latency = kFPDivide;
+        break;
+      case 4:  // FCVT.
+      case 5:
+      case 7:
+        effects->latency = kFPConvert;
+        break;
+      default:
+        effects->latency = kFPAlu;
+        break;
+    }
+  } else if (Is(instr,
+                FPDataProcessing2SourceFMask,
+                FPDataProcessing2SourceFixed)) {
+    switch (instr->ExtractBits(15, 12)) {
+      case 0:  // FMUL.
+      case 8:  // FNMUL.
+        effects->latency = kFPMultiply;
+        break;
+      case 1:  // FDIV.
+        effects->latency = kFPDivide;
+        break;
+      default:
+        effects->latency = kFPAlu;
+        break;
+    }
+  } else if (Is(instr,
+                FPDataProcessing3SourceFMask,
+                FPDataProcessing3SourceFixed)) {
+    effects->latency = kFPMultiplyAdd;
+  } else if (Is(instr, FPImmediateFMask, FPImmediateFixed)) {
+    effects->latency = kFPAlu;
+  } else if (Is(instr, NEON3SameFMask, NEON3SameFixed)) {
+    switch (instr->Mask(NEON3SameMask)) {
+      case NEON_MUL:
+      case NEON_MLA:
+      case NEON_MLS:
+        effects->latency = kNEONMultiply;
+        break;
+      default:
+        break;
+    }
+    switch (instr->Mask(NEON3SameFPMask)) {
+      case NEON_FMUL:
+      case NEON_FMLA:
+      case NEON_FMLS:
+        effects->latency = kNEONMultiply;
+        break;
+      default:
+        break;
+    }
+  } else if (Is(instr, NEON3DifferentFMask, NEON3DifferentFixed) ||
+             Is(instr, NEONByIndexedElementFMask, NEONByIndexedElementFixed)) {
+    effects->latency = kNEONMultiply;
+  }
+}
+
+Effects Analyze(Instr raw) {
+  const Instruction* instr = reinterpret_cast<const Instruction*>(&raw);
+  Effects effects = {0, 0, 0, 0, false, false, false, false, kAlu};
+  // Scalar floating-point and Advanced SIMD data processing is encoded with
+  // op0 = x111.
+  if (instr->ExtractBits(27, 25) == 7) {
+    AnalyzeFPAndNEON(instr, &effects);
+    return effects;
+  }
+  if (AnalyzeDataProcessing(instr, &effects) ||
+      AnalyzeLoadStore(instr, &effects)) {
+    return effects;
+  }
+  return BarrierEffects();
+}
+
+struct Node {
+  Effects effects;
+  int latency;
+  // Successors, with the number of cycles they must wait after this
+  // instruction issues.
+  std::vector<std::pair<int, int> > successors;
+  int predecessor_count;
+};
+
+// Build the dependency graph of `count` instructions at `code`.
+void BuildGraph(const Instr* code,
+                size_t count,
+                Scheduler::CoreModel model,
+                std::vector<Node>* nodes) {
+  nodes->resize(count);
+  for (size_t i = 0; i < count; i++) {
+    Node* node = &(*nodes)[i];
+    node->effects = Analyze(code[i]);
+    node->latency = kLatencies[model][node->effects.latency];
+    node->successors.clear();
+    node->predecessor_count = 0;
+  }
+  for (size_t i = 0; i < count; i++) {
+    const Effects& first = (*nodes)[i].effects;
+    for (size_t j = i + 1; j < count; j++) {
+      const Effects& second = (*nodes)[j].effects;
+      bool true_dependency = ((first.x_writes & second.x_reads) != 0) ||
+                             ((first.v_writes & second.v_reads) != 0) ||
+                             (first.writes_flags && second.reads_flags);
+      bool ordered =
+          ((first.x_reads & second.x_writes) != 0) ||
+          ((first.x_writes & second.x_writes) != 0) ||
+          ((first.v_reads & second.v_writes) != 0) ||
+          ((first.v_writes & second.v_writes) != 0) ||
+          (first.reads_flags && second.writes_flags) ||
+          (first.writes_flags && second.writes_flags) ||
+          (first.stores && (second.loads || second.stores)) ||
+          (first.loads && second.stores);
+      if (true_dependency || ordered) {
+        // Every instruction issues at least one cycle after the previous one.
+        int latency = true_dependency ? (*nodes)[i].latency : 1;
+        (*nodes)[i].successors.push_back(
+            std::make_pair(static_cast<int>(j), latency));
+        (*nodes)[j].predecessor_count++;
+      }
+    }
+  }
+}
+
+// Estimate the cycles taken to issue `nodes` in `order`, and for their
+// results to be ready.
+int Simulate(const std::vector<Node>& nodes, const std::vector<int>& order) {
+  std::vector<int> ready(nodes.size(), 0);
+  int cycle = 0;
+  int end = 0;
+  for (int index : order) {
+    const Node& node = nodes[index];
+    int issue = std::max(cycle, ready[index]);
+    cycle = issue + 1;
+    end = std::max(end, issue + node.latency);
+    for (const std::pair<int, int>& successor : node.successors) {
+      ready[successor.first] =
+          std::max(ready[successor.first], issue + successor.second);
+    }
+  }
+  return end;
+}
+
+}  // namespace
+
+
+int Scheduler::GetLatency(Instr instr) const {
+  return kLatencies[model_][Analyze(instr).latency];
+}
+
+
+int Scheduler::EstimateCycles(const std::vector<Instr>& code) const {
+  std::vector<Node> nodes;
+  BuildGraph(code.data(), code.size(), model_, &nodes);
+  std::vector<int> order(code.size());
+  for (size_t i = 0; i < order.size(); i++) order[i] = static_cast<int>(i);
+  return Simulate(nodes, order);
+}
+
+
+void Scheduler::Schedule(std::vector<Instr>* code) {
+  // Schedule the blocks between barriers separately. Larger blocks are split,
+  // to bound the cost of building their dependency graphs.
+  const size_t kMaxBlockSize = 128;
+  size_t start = 0;
+  for (size_t i = 0; i <= code->size(); i++) {
+    // A debug pseudo instruction is a barrier along with its arguments, which
+    // are data.
+    size_t barrier_count = 0;
+    if (i < code->size()) {
+      const Instruction* instr =
+          reinterpret_cast<const Instruction*>(&(*code)[i]);
+      barrier_count =
+          GetDebugHltSize(instr, (code->size() - i) * kInstructionSize) /
+          kInstructionSize;
+      if ((barrier_count == 0) && (Analyze((*code)[i]).latency == kBarrier)) {
+        barrier_count = 1;
+      }
+    }
+    if ((i == code->size()) || (barrier_count > 0) ||
+        ((i - start) == kMaxBlockSize)) {
+      if ((i - start) > 1) ScheduleBlock(code->data() + start, i - start);
+      if (barrier_count > 0) {
+        i += barrier_count - 1;
+        start = i + 1;
+      } else {
+        start = i;
+      }
+    }
+  }
+}
+
+
+void Scheduler::ScheduleBlock(Instr* code, size_t count) {
+  std::vector<Node> nodes;
+  BuildGraph(code, count, model_, &nodes);
+
+  // The priority of an instruction is the length of the longest chain of
+  // dependencies from it to the end of the block.
+  std::vector<int> heights(count);
+  for (size_t i = count; i-- > 0;) {
+    int height = nodes[i].latency;
+    for (const std::pair<int, int>& successor : nodes[i].successors) {
+      height = std::max(height, successor.second + heights[successor.first]);
+    }
+    heights[i] = height;
+  }
+
+  // Issue instructions one at a time, preferring one whose operands are ready,
+  // then the one with the highest priority, then the earliest.
+  std::vector<int> order;
+  std::vector<int> available;
+  std::vector<int> ready(count, 0);
+  std::vector<int> predecessor_counts(count);
+  for (size_t i = 0; i < count; i++) {
+    predecessor_counts[i] = nodes[i].predecessor_count;
+    if (predecessor_counts[i] == 0) available.push_back(static_cast<int>(i));
+  }
+  int cycle = 0;
+  while (!available.empty()) {
+    size_t best = 0;
+    for (size_t i = 1; i < available.size(); i++) {
+      int candidate = available[i];
+      int current = available[best];
+      int candidate_issue = std::max(cycle, ready[candidate]);
+      int current_issue = std::max(cycle, ready[current]);
+      if ((candidate_issue < current_issue) ||
+          ((candidate_issue == current_issue) &&
+           ((heights[candidate] > heights[current]) ||
+            ((heights[candidate] == heights[current]) &&
+             (candidate < current))))) {
+        best = i;
+      }
+    }
+    int index = available[best];
+    available.erase(available.begin() + best);
+    order.push_back(index);
+    int issue = std::max(cycle, ready[index]);
+    cycle = issue + 1;
+    for (const std::pair<int, int>& successor : nodes[index].successors) {
+      ready[successor.first] =
+          std::max(ready[successor.first], issue + successor.second);
+      if (--predecessor_counts[successor.first] == 0) {
+        available.push_back(successor.first);
+      }
+    }
+  }
+  VIXL_ASSERT(order.size() == count);
+
+  std::vector<int> original(count);
+  for (size_t i = 0; i < count; i++) original[i] = static_cast<int>(i);
+  int original_cycles = Simulate(nodes, original);
+  int cycles = Simulate(nodes, order);
+  if (cycles >= original_cycles) return;
+
+  std::vector<Instr> scheduled(count);
+  for (size_t i = 0; i < count; i++) {
+    scheduled[i] = code[order[i]];
+    if (order[i] != static_cast<int>(i)) moved_count_++;
+  }
+  std::copy(scheduled.begin(), scheduled.end(), code);
+  cycles_saved_ += original_cycles - cycles;
+}
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -0,0 +1,97 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIXL_AARCH64_SCHEDULER_AARCH64_H_
+#define VIXL_AARCH64_SCHEDULER_AARCH64_H_
+
+#include <vector>
+
+#include "../globals-vixl.h"
+
+#include "instructions-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+// A list scheduler for straight-line code, reordering instructions so that
+// long-latency loads, multiplies and FP and NEON operations are not directly
+// followed by the instructions using their results.
+//
+// The scheduler is normally used through a `SchedulingScope`, which gives it
+// the code of a MacroAssembler region split at every label binding and
+// branch, with no pool in it. Instructions are only reordered when this
+// preserves their register and flag dependencies, and loads are never
+// reordered with stores. Instructions which it does not model, such as
+// system, PC-relative, SVE, atomic and exclusive instructions, are not moved,
+// and nothing is moved across them.
+//
+// Latencies come from a table for the selected core, based on the published
+// software optimisation guides, and the core is modelled as issuing one
+// instruction per cycle, in order. The original order is kept when the new
+// one is not estimated to be faster.
+class Scheduler {
+ public:
+  enum CoreModel { kCortexA53, kCortexA72, kNeoverseN1, kCoreModelCount };
+
+  explicit Scheduler(CoreModel model = kCortexA72) : model_(model) {
+    ResetCounts();
+  }
+
+  // Reorder `code`, which must only hold instructions and must not be the
+  // target of any branch other than at its start. Debug pseudo instructions
+  // and their arguments are barriers: they stay in place, and nothing is moved
+  // across them.
+  void Schedule(std::vector<Instr>* code);
+
+  CoreModel GetCoreModel() const { return model_; }
+  // The number of cycles before the result of `instr` can be used.
+  int GetLatency(Instr instr) const;
+  // The number of cycles `code` is estimated to take on the core model.
+  int EstimateCycles(const std::vector<Instr>& code) const;
+
+  // The number of instructions moved, and the number of cycles this is
+  // estimated to save, since the counts were last reset.
+  int GetMovedCount() const { return moved_count_; }
+  int GetCyclesSaved() const { return cycles_saved_; }
+  void ResetCounts() {
+    moved_count_ = 0;
+    cycles_saved_ = 0;
+  }
+
+ private:
+  // Schedule the `count` instructions at `code`, none of which is a barrier.
+  void ScheduleBlock(Instr* code, size_t count);
+
+  CoreModel model_;
+  int moved_count_;
+  int cycles_saved_;
+};
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_SCHEDULER_AARCH64_H_
@@ -44,6 +44,11 @@
 #include <unistd.h>
 #endif
 
+#ifdef VIXL_HAS_SIMULATED_HOST_CRYPTO
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 #ifdef _MSC_VER
 #define VIXL_SYNC() MemoryBarrier()
 #else
@@ -76,6 +81,74 @@ MemoryAccessResult TryMemoryAccess(uintptr_t address, uintptr_t access_size) {
 #endif  // VIXL_ENABLE_IMPLICIT_CHECKS
 }
 
+void SimStack::Allocated::Deleter::operator()(char* data) const {
+#ifndef _WIN32
+  if (IsMapped()) {
+    VIXL_CHECK(munmap(data, mapped_size_) == 0);
+    return;
+  }
+#endif
+  delete[] data;
+}
+
+SimStack::Allocated SimStack::Allocate() {
+#ifndef _WIN32
+  if (use_host_guard_pages_) return AllocateWithHostGuardPages();
+#endif
+  size_t align_to = uint64_t{1} << align_log2_;
+  size_t l = AlignUp(limit_guard_size_, align_to);
+  size_t u = AlignUp(usable_size_, align_to);
+  size_t b = AlignUp(base_guard_size_, align_to);
+  size_t size = l + u + b;
+
+  Allocated a;
+  size_t alloc_size = (align_to - 1) + size;
+  a.data_.reset(new char[alloc_size]());
+  void* data = a.data_.get();
+  auto data_aligned =
+      reinterpret_cast<char*>(std::align(align_to, size, data, alloc_size));
+  a.limit_ = data_aligned + l - 1;
+  a.base_ = data_aligned + l + u;
+  a.alloc_size_ = alloc_size;
+  return a;
+}
+
+SimStack::Allocated SimStack::AllocateWithHostGuardPages() {
+#ifndef _WIN32
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t align_to = std::max<size_t>(uint64_t{1} << align_log2_, page_size);
+  size_t l = AlignUp(limit_guard_size_, align_to);
+  size_t u = AlignUp(usable_size_, align_to);
+  size_t b = AlignUp(base_guard_size_, align_to);
+  // mmap only guarantees page alignment, so reserve enough to align the
+  // usable stack. The extra space is part of the limit guard.
+  size_t alloc_size = (align_to - page_size) + l + u + b;
+
+  // Reserve the whole region as inaccessible, without committing any memory,
+  // then open up the usable stack.
+  void* region = mmap(NULL,
+                      alloc_size,
+                      PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                      -1,
+                      0);
+  VIXL_CHECK(region != MAP_FAILED);
+
+  Allocated a;
+  a.data_ = std::unique_ptr<char[], Allocated::Deleter>(
+      reinterpret_cast<char*>(region), Allocated::Deleter(alloc_size));
+  char* usable = AlignUp(a.data_.get() + l, align_to);
+  VIXL_CHECK(mprotect(usable, u, PROT_READ | PROT_WRITE) == 0);
+  a.limit_ = usable - 1;
+  a.base_ = usable + u;
+  a.alloc_size_ = alloc_size;
+  return a;
+#else
+  VIXL_UNREACHABLE();
+  return Allocated();
+#endif
+}
+
 bool MetaDataDepot::MetaDataMTE::is_active = false;
 
 void SimSystemRegister::SetBits(int msb, int lsb, uint32_t bits) {
@@ -572,9 +645,10 @@ Simulator::Simulator(Decoder* decoder, FILE* stream, SimStack::Allocated stack)
   VIXL_ASSERT((static_cast<int32_t>(-1) >> 1) == -1);
   VIXL_ASSERT((static_cast<uint32_t>(-1) >> 1) == 0x7fffffff);
 
-  // Set up a placeholder pipe for CanReadMemory.
+  // The placeholder pipe for CanReadMemory is opened on first use.
 #ifndef _WIN32
-  VIXL_CHECK(pipe(placeholder_pipe_fd_) == 0);
+  placeholder_pipe_fd_[0] = -1;
+  placeholder_pipe_fd_[1] = -1;
 #endif
 
   // Set up the decoder.
@@ -583,21 +657,15 @@ Simulator::Simulator(Decoder* decoder, FILE* stream, SimStack::Allocated stack)
 
   stream_ = stream;
 
-  print_disasm_ = new PrintDisassembler(stream_);
+  print_disasm_ = NULL;
 
   memory_.AppendMetaData(&meta_data_);
 
-  // The Simulator and Disassembler share the same available list, held by the
-  // auditor. The Disassembler only annotates instructions with features that
-  // are _not_ available, so registering the auditor should have no effect
-  // unless the simulator is about to abort (due to missing features). In
-  // practice, this means that with trace enabled, the simulator will crash just
-  // after the disassembler prints the instruction, with the missing features
-  // enumerated.
-  print_disasm_->RegisterCPUFeaturesAuditor(&cpu_features_auditor_);
-
   SetColouredTrace(false);
   trace_parameters_ = LOG_NONE;
+  coverage_bitmap_ = NULL;
+  coverage_mask_ = 0;
+  log_taken_branches_ = false;
 
   // We have to configure the SVE vector register length before calling
   // ResetState().
@@ -620,9 +688,8 @@ Simulator::Simulator(Decoder* decoder, FILE* stream, SimStack::Allocated stack)
   LogicPRegister ones(pregister_all_true_);
   ones.SetAllBits();
 
-  // Initialize the debugger but disable it by default.
+  // The debugger is disabled by default, and created on first use.
   SetDebuggerEnabled(false);
-  debugger_ = std::make_unique<Debugger>(this);
 }
 
 void Simulator::ResetSystemRegisters() {
@@ -682,14 +749,27 @@ void Simulator::ResetFFR() {
 }
 
 void Simulator::ResetState() {
+  ResetArchitecturalState();
+
+  // Also reset what ResetArchitecturalState() keeps.
+  EnableGCSCheck();
+  meta_data_.ResetState();
+  ResetPACCache();
+}
+
+void Simulator::ResetArchitecturalState() {
   ResetSystemRegisters();
   ResetRegisters();
   ResetVRegisters();
   ResetPRegisters();
 
   WriteSp(memory_.GetStack().GetBase());
-  ResetGCSState();
-  EnableGCSCheck();
+  if (IsAllocatedGCS(gcs_)) {
+    // Reuse the current stack rather than allocating a new one.
+    GetActiveGCSPtr()->clear();
+  } else {
+    ResetGCSState();
+  }
 
   pc_ = NULL;
   pc_modified_ = false;
@@ -698,7 +778,7 @@ void Simulator::ResetState() {
   btype_ = DefaultBType;
   next_btype_ = DefaultBType;
 
-  meta_data_.ResetState();
+  ClearLocalMonitor();
 }
 
 void Simulator::SetVectorLengthInBits(unsigned vector_length) {
@@ -722,12 +802,16 @@ void Simulator::SetVectorLengthInBits(unsigned vector_length) {
 }
 
 Simulator::~Simulator() {
-  // The decoder may outlive the simulator.
-  decoder_->RemoveVisitor(print_disasm_);
-  delete print_disasm_;
+  if (print_disasm_ != NULL) {
+    // The decoder may outlive the simulator.
+    decoder_->RemoveVisitor(print_disasm_);
+    delete print_disasm_;
+  }
 #ifndef _WIN32
-  close(placeholder_pipe_fd_[0]);
-  close(placeholder_pipe_fd_[1]);
+  if (placeholder_pipe_fd_[0] != -1) {
+    close(placeholder_pipe_fd_[0]);
+    close(placeholder_pipe_fd_[1]);
+  }
 #endif
   if (IsAllocatedGCS(gcs_)) {
     GetGCSManager().FreeStack(gcs_);
@@ -765,6 +849,111 @@ void Simulator::RunFrom(const Instruction* first) {
 }
 
 
+uint64_t Simulator::RunFor(uint64_t instruction_budget) {
+  LogAllWrittenRegisters();
+  uint64_t executed = 0;
+  while ((executed < instruction_budget) && !IsSimulationFinished()) {
+    if (ExecuteInstructionOrDebug()) executed++;
+  }
+  return executed;
+}
+
+
+bool Simulator::ExecuteInstructionOrDebug() {
+  if (debugger_enabled_) {
+    Debugger* debugger = GetDebugger();
+    if (debugger->IsAtBreakpoint()) {
+      fprintf(stream_, "Debugger hit breakpoint, breaking...\n");
+      debugger->Debug();
+      return false;
+    }
+  }
+  ExecuteInstruction();
+  return true;
+}
+
+
+void Simulator::SwapContext(SimContext* context) {
+  VIXL_ASSERT(context->vector_length_ == vector_length_);
+
+  for (unsigned i = 0; i < kNumberOfRegisters; i++) {
+    uint64_t value = registers_[i].Get<uint64_t>();
+    registers_[i].Write(context->registers_[i]);
+    context->registers_[i] = value;
+  }
+
+  unsigned vlanes = GetVectorLengthInBytes() / kDRegSizeInBytes;
+  for (unsigned i = 0; i < kNumberOfZRegisters; i++) {
+    for (unsigned lane = 0; lane < vlanes; lane++) {
+      uint64_t value = vregisters_[i].GetLane<uint64_t>(lane);
+      vregisters_[i].Insert(lane, context->vregisters_[i][lane]);
+      context->vregisters_[i][lane] = value;
+    }
+  }
+
+  unsigned planes = GetPredicateLengthInBytes() / kHRegSizeInBytes;
+  for (unsigned lane = 0; lane < planes; lane++) {
+    for (unsigned i = 0; i < kNumberOfPRegisters; i++) {
+      uint16_t value = pregisters_[i].GetLane<uint16_t>(lane);
+      pregisters_[i].Insert(lane, context->pregisters_[i][lane]);
+      context->pregisters_[i][lane] = value;
+    }
+    uint16_t value = ffr_register_.GetLane<uint16_t>(lane);
+    ffr_register_.Insert(lane, context->ffr_register_[lane]);
+    context->ffr_register_[lane] = value;
+  }
+
+  std::swap(nzcv_, context->nzcv_);
+  std::swap(fpcr_, context->fpcr_);
+  std::swap(pc_, context->pc_);
+  std::swap(btype_, context->btype_);
+  std::swap(next_btype_, context->next_btype_);
+  std::swap(last_instr_, context->last_instr_);
+  std::swap(form_hash_, context->form_hash_);
+  std::swap(gcs_, context->gcs_);
+  memory_.SwapStack(&context->stack_);
+
+  // An exclusive access cannot span a context switch.
+  ClearLocalMonitor();
+}
+
+
+SimContext::SimContext(const Simulator& simulator, SimStack::Allocated stack)
+    : vector_length_(simulator.GetVectorLengthInBits()),
+      nzcv_(SimSystemRegister::DefaultValueFor(NZCV)),
+      fpcr_(SimSystemRegister::DefaultValueFor(FPCR)),
+      pc_(Simulator::kEndOfSimAddress),
+      btype_(DefaultBType),
+      next_btype_(DefaultBType),
+      last_instr_(NULL),
+      form_hash_(0),
+      stack_(std::move(stack)) {
+  for (unsigned i = 0; i < kNumberOfRegisters; i++) {
+    registers_[i] = 0xbadbeef;
+  }
+  registers_[kLinkRegCode] =
+      reinterpret_cast<uint64_t>(Simulator::kEndOfSimAddress);
+  registers_[kSpRegCode] = reinterpret_cast<uint64_t>(stack_.GetBase());
+
+  memset(vregisters_, 0, sizeof(vregisters_));
+  memset(pregisters_, 0, sizeof(pregisters_));
+  memset(ffr_register_, 0, sizeof(ffr_register_));
+  // Match Simulator::ResetFFR().
+  int default_active_lanes =
+      simulator.GetPredicateLengthInBytes() / kHRegSizeInBytes;
+  ffr_register_[0] = static_cast<uint16_t>(GetUintMask(default_active_lanes));
+
+  // Allocate a guarded control stack, and remove its seal, as in
+  // Simulator::ResetGCSState().
+  Simulator::GCSManager& manager = Simulator::GetGCSManager();
+  gcs_ = manager.AllocateStack();
+  manager.GetGCSPtr(gcs_)->pop_back();
+}
+
+
+SimContext::~SimContext() { Simulator::GetGCSManager().FreeStack(gcs_); }
+
+
 // clang-format off
 const char* Simulator::xreg_names[] = {"x0",  "x1",  "x2",  "x3",  "x4",  "x5",
                                        "x6",  "x7",  "x8",  "x9",  "x10", "x11",
@@ -943,13 +1132,7 @@ void Simulator::SetColouredTrace(bool value) {
   clr_printf = value ? COLOUR(GREEN) : "";
   clr_branch_marker = value ? COLOUR(GREY) COLOUR_HIGHLIGHT : "";
 
-  if (value) {
-    print_disasm_->SetCPUFeaturesPrefix("// Needs: " COLOUR_BOLD(RED));
-    print_disasm_->SetCPUFeaturesSuffix(COLOUR(NORMAL));
-  } else {
-    print_disasm_->SetCPUFeaturesPrefix("// Needs: ");
-    print_disasm_->SetCPUFeaturesSuffix("");
-  }
+  if (print_disasm_ != NULL) ConfigurePrintDisassembler();
 }
 
 
@@ -957,16 +1140,62 @@ void Simulator::SetTraceParameters(int parameters) {
   bool disasm_before = trace_parameters_ & LOG_DISASM;
   trace_parameters_ = parameters;
   bool disasm_after = trace_parameters_ & LOG_DISASM;
+  log_taken_branches_ = ShouldTraceBranches() || (coverage_bitmap_ != NULL);
 
   if (disasm_before != disasm_after) {
     if (disasm_after) {
-      decoder_->InsertVisitorBefore(print_disasm_, this);
+      decoder_->InsertVisitorBefore(GetPrintDisassembler(), this);
     } else {
       decoder_->RemoveVisitor(print_disasm_);
     }
   }
 }
 
+
+void Simulator::SetCoverageBitmap(uint8_t* bitmap, size_t size) {
+  VIXL_ASSERT((bitmap == NULL) || IsPowerOf2(size));
+  coverage_bitmap_ = bitmap;
+  coverage_mask_ = (bitmap == NULL) ? 0 : (size - 1);
+  log_taken_branches_ = ShouldTraceBranches() || (coverage_bitmap_ != NULL);
+}
+
+
+PrintDisassembler* Simulator::GetPrintDisassembler() {
+  if (print_disasm_ == NULL) {
+    print_disasm_ = new PrintDisassembler(stream_);
+    // The Simulator and Disassembler share the same available list, held by
+    // the auditor. The Disassembler only annotates instructions with features
+    // that are _not_ available, so registering the auditor should have no
+    // effect unless the simulator is about to abort (due to missing
+    // features). In practice, this means that with trace enabled, the
+    // simulator will crash just after the disassembler prints the
+    // instruction, with the missing features enumerated.
+    print_disasm_->RegisterCPUFeaturesAuditor(&cpu_features_auditor_);
+    ConfigurePrintDisassembler();
+  }
+  return print_disasm_;
+}
+
+
+void Simulator::ConfigurePrintDisassembler() {
+  if (coloured_trace_) {
+    print_disasm_->SetCPUFeaturesPrefix("// Needs: " COLOUR_BOLD(RED));
+    print_disasm_->SetCPUFeaturesSuffix(COLOUR(NORMAL));
+  } else {
+    print_disasm_->SetCPUFeaturesPrefix("// Needs: ");
+    print_disasm_->SetCPUFeaturesSuffix("");
+  }
+}
+
+
+Debugger* Simulator::GetDebugger() const {
+  if (!debugger_) {
+    // The debugger drives the simulator, so it needs a non-const pointer.
+    debugger_ = std::make_unique<Debugger>(const_cast<Simulator*>(this));
+  }
+  return debugger_.get();
+}
+
 // Helpers ---------------------------------------------------------------------
 uint64_t Simulator::AddWithCarry(unsigned reg_size,
                                  bool set_flags,
@@ -1084,10 +1313,79 @@ vixl_uint128_t Simulator::Mul64(uint64_t x, uint64_t y) {
                     : result;
 }
 
+const Simulator::HostCryptoFeatures& Simulator::GetHostCryptoFeatures() {
+  static const HostCryptoFeatures features = []() {
+    HostCryptoFeatures result = {false, false, false};
+#ifdef VIXL_HAS_SIMULATED_HOST_CRYPTO
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0) {
+      result.aes = (ecx & bit_AES) != 0;
+      result.pmull = (ecx & bit_PCLMUL) != 0;
+      result.crc32c = (ecx & bit_SSE4_2) != 0;
+    }
+#endif
+    return result;
+  }();
+  return features;
+}
+
+#ifdef VIXL_HAS_SIMULATED_HOST_CRYPTO
+__attribute__((target("pclmul"))) static vixl_uint128_t HostPolynomialMult128(
+    uint64_t op1, uint64_t op2) {
+  __m128i product = _mm_clmulepi64_si128(_mm_cvtsi64_si128(op1),
+                                         _mm_cvtsi64_si128(op2),
+                                         0);
+  uint64_t low = _mm_cvtsi128_si64(product);
+  uint64_t high = _mm_cvtsi128_si64(_mm_unpackhi_epi64(product, product));
+  return std::make_pair(high, low);
+}
+
+__attribute__((target("sse4.2"))) static uint32_t HostCrc32c(uint32_t acc,
+                                                             uint64_t val,
+                                                             size_t size) {
+  switch (size) {
+    case 1:
+      return _mm_crc32_u8(acc, static_cast<uint8_t>(val));
+    case 2:
+      return _mm_crc32_u16(acc, static_cast<uint16_t>(val));
+    case 4:
+      return _mm_crc32_u32(acc, static_cast<uint32_t>(val));
+    default:
+      VIXL_ASSERT(size == 8);
+      return static_cast<uint32_t>(_mm_crc32_u64(acc, val));
+  }
+}
+#else
+static vixl_uint128_t HostPolynomialMult128(uint64_t op1, uint64_t op2) {
+  USE(op1, op2);
+  VIXL_UNREACHABLE();
+  return std::make_pair(0, 0);
+}
+
+static uint32_t HostCrc32c(uint32_t acc, uint64_t val, size_t size) {
+  USE(acc, val, size);
+  VIXL_UNREACHABLE();
+  return 0;
+}
+#endif
+
 vixl_uint128_t Simulator::PolynomialMult128(uint64_t op1,
                                             uint64_t op2,
                                             int lane_size_in_bits) const {
   VIXL_ASSERT(static_cast<unsigned>(lane_size_in_bits) <= kDRegSize);
+  if (GetHostCryptoFeatures().pmull) {
+    vixl_uint128_t result =
+        HostPolynomialMult128(op1 & GetUintMask(lane_size_in_bits), op2);
+    VIXL_ASSERT(result ==
+                PolynomialMult128Reference(op1, op2, lane_size_in_bits));
+    return result;
+  }
+  return PolynomialMult128Reference(op1, op2, lane_size_in_bits);
+}
+
+vixl_uint128_t Simulator::PolynomialMult128Reference(
+    uint64_t op1, uint64_t op2, int lane_size_in_bits) const {
+  VIXL_ASSERT(static_cast<unsigned>(lane_size_in_bits) <= kDRegSize);
   vixl_uint128_t result = std::make_pair(0, 0);
   vixl_uint128_t op2q = std::make_pair(0, op2);
   for (int i = 0; i < lane_size_in_bits; i++) {
@@ -4848,6 +5146,10 @@ bool Simulator::CanReadMemory(uintptr_t address, size_t size) {
   //
   // [1]: https://stackoverflow.com/questions/7134590
 
+  if (placeholder_pipe_fd_[0] == -1) {
+    VIXL_CHECK(pipe(placeholder_pipe_fd_) == 0);
+  }
+
   size_t written = 0;
   bool can_read = true;
   // `write` will normally return after one invocation, but it is allowed to
@@ -5675,7 +5977,7 @@ uint32_t Simulator::Poly32Mod2(unsigned n, uint64_t data, uint32_t poly) {
 
 
 template <typename T>
-uint32_t Simulator::Crc32Checksum(uint32_t acc, T val, uint32_t poly) {
+uint32_t Simulator::Crc32ChecksumReference(uint32_t acc, T val, uint32_t poly) {
   unsigned size = sizeof(val) * 8;  // Number of bits in type T.
   VIXL_ASSERT((size == 8) || (size == 16) || (size == 32));
   uint64_t tempacc = static_cast<uint64_t>(ReverseBits(acc)) << size;
@@ -5684,11 +5986,56 @@ uint32_t Simulator::Crc32Checksum(uint32_t acc, T val, uint32_t poly) {
 }
 
 
-uint32_t Simulator::Crc32Checksum(uint32_t acc, uint64_t val, uint32_t poly) {
+uint32_t Simulator::Crc32ChecksumReference(uint32_t acc,
+                                           uint64_t val,
+                                           uint32_t poly) {
   // Poly32Mod2 cannot handle inputs with more than 32 bits, so compute
   // the CRC of each 32-bit word sequentially.
-  acc = Crc32Checksum(acc, (uint32_t)(val & 0xffffffff), poly);
-  return Crc32Checksum(acc, (uint32_t)(val >> 32), poly);
+  acc = Crc32ChecksumReference(acc, (uint32_t)(val & 0xffffffff), poly);
+  return Crc32ChecksumReference(acc, (uint32_t)(val >> 32), poly);
+}
+
+
+// Lookup table for computing a bit-reflected CRC32 one byte at a time.
+class Crc32Table {
+ public:
+  explicit Crc32Table(uint32_t poly) {
+    uint32_t reflected_poly = ReverseBits(poly);
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc >> 1) ^ (((crc & 1) != 0) ? reflected_poly : 0);
+      }
+      table_[i] = crc;
+    }
+  }
+
+  uint32_t Update(uint32_t acc, uint8_t byte) const {
+    return table_[(acc ^ byte) & 0xff] ^ (acc >> 8);
+  }
+
+ private:
+  uint32_t table_[256];
+};
+
+
+template <typename T>
+uint32_t Simulator::Crc32Checksum(uint32_t acc, T val, uint32_t poly) {
+  VIXL_STATIC_ASSERT(std::is_unsigned<T>::value);
+  uint32_t result = acc;
+  if ((poly == CRC32C_POLY) && GetHostCryptoFeatures().crc32c) {
+    result = HostCrc32c(acc, val, sizeof(val));
+  } else {
+    static const Crc32Table crc32_table(CRC32_POLY);
+    static const Crc32Table crc32c_table(CRC32C_POLY);
+    VIXL_ASSERT((poly == CRC32_POLY) || (poly == CRC32C_POLY));
+    const Crc32Table& table = (poly == CRC32_POLY) ? crc32_table : crc32c_table;
+    for (size_t i = 0; i < sizeof(val); i++) {
+      result = table.Update(result, static_cast<uint8_t>(val >> (i * 8)));
+    }
+  }
+  VIXL_ASSERT(result == Crc32ChecksumReference(acc, val, poly));
+  return result;
 }
 
 
@@ -7260,8 +7607,9 @@ void Simulator::VisitException(const Instruction* instr) {
       if (debugger_enabled_) {
         uint64_t next_instr =
             reinterpret_cast<uint64_t>(pc_->GetNextInstruction());
-        if (!debugger_->IsBreakpoint(next_instr)) {
-          debugger_->RegisterBreakpoint(next_instr);
+        Debugger* debugger = GetDebugger();
+        if (!debugger->IsBreakpoint(next_instr)) {
+          debugger->RegisterBreakpoint(next_instr);
         }
       } else {
         HostBreakpoint();
@@ -114,6 +114,19 @@ class SimStack {
   // Set the minimum alignment for the stack parameters.
   void AlignToBytesLog2(int align_log2) { align_log2_ = align_log2; }
 
+  // Map the stack directly from the host, with the guard regions backed by
+  // inaccessible pages. The usable stack is committed lazily by the host, one
+  // page at a time as it is touched, so large stacks are cheap to allocate.
+  //
+  // All sizes are rounded up to the host page size. Since any access to the
+  // guard regions raises a host fault, the Simulator does not check accesses
+  // against them. With VIXL_ENABLE_IMPLICIT_CHECKS, such faults can be caught
+  // by a signal handler as for any other inaccessible memory; otherwise, they
+  // terminate the process.
+  //
+  // This is not supported on Windows, where this option is ignored.
+  void SetUseHostGuardPages(bool value) { use_host_guard_pages_ = value; }
+
   class Allocated {
    public:
     // Using AAPCS64 terminology, highest addresses at the top:
@@ -136,6 +149,10 @@ class SimStack {
     char* GetBase() const { return base_; }
     char* GetLimit() const { return limit_; }
 
+    // Whether the guard regions are inaccessible host pages, so that accesses
+    // to them fault without the Simulator having to check for them.
+    bool HasHostGuardPages() const { return data_.get_deleter().IsMapped(); }
+
     template <typename T>
     bool IsAccessInGuardRegion(const T* base, size_t size) const {
       VIXL_ASSERT(size > 0);
@@ -150,7 +167,21 @@ class SimStack {
     }
 
    private:
-    std::unique_ptr<char[]> data_;
+    // Release the stack memory with `delete[]` or, if it was mapped from the
+    // host, `munmap`.
+    class Deleter {
+     public:
+      Deleter() : mapped_size_(0) {}
+      explicit Deleter(size_t mapped_size) : mapped_size_(mapped_size) {}
+
+      bool IsMapped() const { return mapped_size_ != 0; }
+      void operator()(char* data) const;
+
+     private:
+      size_t mapped_size_;
+    };
+
+    std::unique_ptr<char[], Deleter> data_;
     char* limit_;
     char* base_;
     size_t alloc_size_;
@@ -159,30 +190,16 @@ class SimStack {
   };
 
   // Allocate the stack, locking the parameters.
-  Allocated Allocate() {
-    size_t align_to = uint64_t{1} << align_log2_;
-    size_t l = AlignUp(limit_guard_size_, align_to);
-    size_t u = AlignUp(usable_size_, align_to);
-    size_t b = AlignUp(base_guard_size_, align_to);
-    size_t size = l + u + b;
-
-    Allocated a;
-    size_t alloc_size = (align_to - 1) + size;
-    a.data_ = std::make_unique<char[]>(alloc_size);
-    void* data = a.data_.get();
-    auto data_aligned =
-        reinterpret_cast<char*>(std::align(align_to, size, data, alloc_size));
-    a.limit_ = data_aligned + l - 1;
-    a.base_ = data_aligned + l + u;
-    a.alloc_size_ = alloc_size;
-    return a;
-  }
+  Allocated Allocate();
 
  private:
+  Allocated AllocateWithHostGuardPages();
+
   size_t base_guard_size_ = 256;
   size_t limit_guard_size_ = 4 * 1024;
   size_t usable_size_ = 8 * 1024;
   size_t align_log2_ = 4;
+  bool use_host_guard_pages_ = false;
 
   static const size_t kDefaultBaseGuardSize = 256;
   static const size_t kDefaultLimitGuardSize = 4 * 1024;
@@ -376,6 +393,10 @@ class Memory {
 
   const SimStack::Allocated& GetStack() { return stack_; }
 
+  // Exchange the active stack with `stack`, for example when switching
+  // between simulated threads.
+  void SwapStack(SimStack::Allocated* stack) { std::swap(stack_, *stack); }
+
   template <typename A>
   bool IsMTETagsMatched(A address, Instruction const* pc = nullptr) const {
     if (MetaDataDepot::MetaDataMTE::IsActive()) {
@@ -396,7 +417,8 @@ class Memory {
                        (sizeof(value) == 4) || (sizeof(value) == 8) ||
                        (sizeof(value) == 16));
     auto base = reinterpret_cast<const char*>(AddressUntag(address));
-    if (stack_.IsAccessInGuardRegion(base, sizeof(value))) {
+    if (!stack_.HasHostGuardPages() &&
+        stack_.IsAccessInGuardRegion(base, sizeof(value))) {
       VIXL_ABORT_WITH_MSG("Attempt to read from stack guard region");
     }
     if (!IsMTETagsMatched(address, pc)) {
@@ -416,7 +438,8 @@ class Memory {
                        (sizeof(value) == 4) || (sizeof(value) == 8) ||
                        (sizeof(value) == 16));
     auto base = reinterpret_cast<char*>(AddressUntag(address));
-    if (stack_.IsAccessInGuardRegion(base, sizeof(value))) {
+    if (!stack_.HasHostGuardPages() &&
+        stack_.IsAccessInGuardRegion(base, sizeof(value))) {
       VIXL_ABORT_WITH_MSG("Attempt to write to stack guard region");
     }
     if (!IsMTETagsMatched(address, pc)) {
@@ -1281,6 +1304,7 @@ class SimExclusiveGlobalMonitor {
 };
 
 class Debugger;
+class SimContext;
 
 template <uint32_t mode>
 uint64_t CryptoOp(uint64_t x, uint64_t y, uint64_t z);
@@ -1292,12 +1316,50 @@ class Simulator : public DecoderVisitor {
                      SimStack::Allocated stack = SimStack().Allocate());
   ~Simulator();
 
+  // Reset the architectural state, as ResetArchitecturalState() does, and
+  // also re-enable GCS checks, remove the branch interceptions and flush the
+  // PAC cache.
   void ResetState();
 
+  // Reset the architectural state (registers, flags, PC, stack pointer, BTI
+  // state, exclusive monitor and guarded control stack), but keep the
+  // configuration and cached state: whether GCS checks are enabled, the branch
+  // interceptions, the memory tags and the PAC cache. An existing guarded
+  // control stack is emptied in place rather than reallocated. This is cheaper
+  // than ResetState() and is intended for running the same code many times,
+  // for example in a persistent-mode fuzzing harness.
+  void ResetArchitecturalState();
+
   // Run the simulator.
   virtual void Run();
   void RunFrom(const Instruction* first);
 
+  // Run the simulator until execution finishes or `instruction_budget`
+  // instructions have been executed, whichever comes first. Execution can be
+  // resumed by calling Run, RunFor or RunUntil again. Returns the number of
+  // instructions executed.
+  uint64_t RunFor(uint64_t instruction_budget);
+
+  // Run the simulator until execution finishes or `predicate(*this)` returns
+  // true. The predicate is checked before each instruction is executed.
+  // Returns the number of instructions executed.
+  template <typename P>
+  uint64_t RunUntil(P predicate) {
+    LogAllWrittenRegisters();
+    uint64_t executed = 0;
+    while (!IsSimulationFinished() && !predicate(*this)) {
+      if (ExecuteInstructionOrDebug()) executed++;
+    }
+    return executed;
+  }
+
+  // Exchange the per-thread state of the simulator (registers, flags, PC,
+  // stack and guarded control stack) with `context`. This allows a single
+  // Simulator to run many simulated threads, using RunFor or RunUntil to
+  // interleave them. Other state, such as memory tags, branch interceptions
+  // and CPU features, is shared by all contexts.
+  void SwapContext(SimContext* context);
+
 
 #if defined(VIXL_HAS_ABI_SUPPORT) && __cplusplus >= 201103L && \
     (defined(_MSC_VER) || defined(__clang__) || GCC_VERSION_OR_NEWER(4, 9, 1))
@@ -1398,6 +1460,11 @@ class Simulator : public DecoderVisitor {
 
   const Instruction* GetLastExecutedInstruction() const { return last_instr_; }
 
+  // Execute the next instruction, or enter the debugger if it is enabled and
+  // the next instruction has a breakpoint. Returns true if an instruction was
+  // executed.
+  bool ExecuteInstructionOrDebug();
+
   void ExecuteInstruction() {
     // The program counter should always be aligned.
     VIXL_ASSERT(IsWordAligned(pc_));
@@ -2541,7 +2608,12 @@ class Simulator : public DecoderVisitor {
     if (ShouldTraceSysRegs()) PrintSystemRegister(id);
   }
   void LogTakenBranch(const Instruction* target) {
-    if (ShouldTraceBranches()) PrintTakenBranch(target);
+    // A single check covers both tracing and coverage, so that neither costs
+    // anything when disabled.
+    if (log_taken_branches_) {
+      if (ShouldTraceBranches()) PrintTakenBranch(target);
+      if (coverage_bitmap_ != NULL) RecordCoverageEdge(target);
+    }
   }
   void LogGCS(bool is_push, uint64_t addr, size_t entry) {
     if (ShouldTraceSysRegs()) PrintGCS(is_push, addr, entry);
@@ -2827,6 +2899,14 @@ class Simulator : public DecoderVisitor {
   }
 
   void SetTraceParameters(int parameters);
+
+  // Record edge coverage into `bitmap`, in the style of AFL: on every taken
+  // branch, the byte indexed by a hash of the branch and target addresses is
+  // incremented (wrapping on overflow). `size` must be a power of two. The
+  // bitmap is not cleared by the simulator, and can be shared memory provided
+  // by a fuzzer. Pass NULL to stop recording coverage.
+  void SetCoverageBitmap(uint8_t* bitmap, size_t size);
+  uint8_t* GetCoverageBitmap() const { return coverage_bitmap_; }
   VIXL_DEPRECATED("SetTraceParameters",
                   void set_trace_parameters(int parameters)) {
     SetTraceParameters(parameters);
@@ -2964,6 +3044,19 @@ class Simulator : public DecoderVisitor {
   }
   void ResetSeenFeatures() { cpu_features_auditor_.ResetSeenFeatures(); }
 
+// The AES, PMULL and CRC32C instructions can be simulated using the equivalent
+// host instructions, when the host supports them. The portable implementations
+// are used otherwise, and to check the host results in debug builds.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define VIXL_HAS_SIMULATED_HOST_CRYPTO
+#endif
+  struct HostCryptoFeatures {
+    bool aes;
+    bool pmull;
+    bool crc32c;
+  };
+  static const HostCryptoFeatures& GetHostCryptoFeatures();
+
 // Runtime call emulation support.
 // It requires VIXL's ABI features, and C++11 or greater.
 // Also, the initialisation of the tuples in RuntimeCall(Non)Void is incorrect
@@ -3210,7 +3303,8 @@ class Simulator : public DecoderVisitor {
 
   void SetDebuggerEnabled(bool enabled) { debugger_enabled_ = enabled; }
 
-  Debugger* GetDebugger() const { return debugger_.get(); }
+  // The debugger is created on first use.
+  Debugger* GetDebugger() const;
 
 #ifdef VIXL_ENABLE_IMPLICIT_CHECKS
   // Returns true if the faulting instruction address (usually the program
@@ -3416,6 +3510,9 @@ class Simulator : public DecoderVisitor {
   vixl_uint128_t PolynomialMult128(uint64_t op1,
                                    uint64_t op2,
                                    int lane_size_in_bits) const;
+  vixl_uint128_t PolynomialMult128Reference(uint64_t op1,
+                                            uint64_t op2,
+                                            int lane_size_in_bits) const;
 
   bool ld1(VectorFormat vform, LogicVRegister dst, uint64_t addr);
   bool ld1(VectorFormat vform, LogicVRegister dst, int index, uint64_t addr);
@@ -5013,9 +5110,15 @@ class Simulator : public DecoderVisitor {
   static const uint32_t CRC32_POLY = 0x04C11DB7;
   static const uint32_t CRC32C_POLY = 0x1EDC6F41;
   uint32_t Poly32Mod2(unsigned n, uint64_t data, uint32_t poly);
+  // Bit-serial reference implementation of the CRC32 instructions. Debug builds
+  // use it to check the results of Crc32Checksum.
+  template <typename T>
+  uint32_t Crc32ChecksumReference(uint32_t acc, T val, uint32_t poly);
+  uint32_t Crc32ChecksumReference(uint32_t acc, uint64_t val, uint32_t poly);
+  // Table-driven implementation, using the host CRC32C instruction if it is
+  // available.
   template <typename T>
   uint32_t Crc32Checksum(uint32_t acc, T val, uint32_t poly);
-  uint32_t Crc32Checksum(uint32_t acc, uint64_t val, uint32_t poly);
 
   bool SysOp_W(int op, int64_t val);
 
@@ -5268,7 +5371,11 @@ class Simulator : public DecoderVisitor {
 
   // Output stream.
   FILE* stream_;
+  // The disassembler used for tracing. This is created on first use, since
+  // most simulators never trace.
   PrintDisassembler* print_disasm_;
+  PrintDisassembler* GetPrintDisassembler();
+  void ConfigurePrintDisassembler();
 
   // General purpose registers. Register 31 is the stack pointer.
   SimRegister registers_[kNumberOfRegisters];
@@ -5368,12 +5475,40 @@ class Simulator : public DecoderVisitor {
   static const PACKey kPACKeyDB;
   static const PACKey kPACKeyGA;
 
+  // A small, direct-mapped cache of recent ComputePAC() results.
+  struct PACCacheEntry {
+    bool valid;
+    uint64_t data;
+    uint64_t context;
+    uint64_t key_high;
+    uint64_t key_low;
+    uint64_t pac;
+  };
+
+  static const int kPACCacheSizeLog2 = 6;
+
+  static size_t GetPACCacheIndex(uint64_t data,
+                                 uint64_t context,
+                                 PACKey key) {
+    uint64_t hash = (data >> kInstructionSizeLog2) ^ context ^ key.high;
+    hash *= UINT64_C(0x9e3779b97f4a7c15);
+    return static_cast<size_t>(hash >> (64 - kPACCacheSizeLog2));
+  }
+
+  void ResetPACCache() {
+    for (PACCacheEntry& entry : pac_cache_) {
+      entry.valid = false;
+    }
+  }
+
+  PACCacheEntry pac_cache_[1 << kPACCacheSizeLog2];
+
   bool CanReadMemory(uintptr_t address, size_t size);
 
 #ifndef _WIN32
   // CanReadMemory needs placeholder file descriptors, so we use a pipe. We can
-  // save some system call overhead by opening them on construction, rather than
-  // on every call to CanReadMemory.
+  // save some system call overhead by opening them on the first call, rather
+  // than on every call to CanReadMemory. Both are -1 until then.
   int placeholder_pipe_fd_[2];
 #endif
 
@@ -5447,6 +5582,20 @@ class Simulator : public DecoderVisitor {
   // A set of TraceParameters flags.
   int trace_parameters_;
 
+  // Edge coverage, as set by SetCoverageBitmap().
+  void RecordCoverageEdge(const Instruction* target) {
+    uint64_t from = reinterpret_cast<uint64_t>(pc_) >> kInstructionSizeLog2;
+    uint64_t to = reinterpret_cast<uint64_t>(target) >> kInstructionSizeLog2;
+    uint64_t hash = (from * UINT64_C(0x9e3779b97f4a7c15)) ^ to;
+    hash ^= hash >> 32;
+    coverage_bitmap_[hash & coverage_mask_]++;
+  }
+  uint8_t* coverage_bitmap_;
+  size_t coverage_mask_;
+
+  // True if either branch tracing or coverage is enabled.
+  bool log_taken_branches_;
+
   // Indicates whether the exclusive-access warning has been printed.
   bool print_exclusive_access_warning_;
   void PrintExclusiveAccessWarning();
@@ -5477,8 +5626,9 @@ class Simulator : public DecoderVisitor {
   // True if the debugger is enabled and might get entered.
   bool debugger_enabled_;
 
-  // Debugger for the simulator.
-  std::unique_ptr<Debugger> debugger_;
+  // Debugger for the simulator. It is created lazily by GetDebugger(), so
+  // that simulators which never enter the debugger don't pay for it.
+  mutable std::unique_ptr<Debugger> debugger_;
 
   // The Guarded Control Stack is represented using a vector, where the more
   // recently stored addresses are at higher-numbered indices.
@@ -5548,8 +5698,10 @@ class Simulator : public DecoderVisitor {
   uint64_t gcs_;
   bool gcs_enabled_;
 
+  friend class SimContext;
+
  public:
-  GCSManager& GetGCSManager() {
+  static GCSManager& GetGCSManager() {
     static GCSManager manager;
     return manager;
   }
@@ -5636,6 +5788,69 @@ class Simulator : public DecoderVisitor {
   }
 };
 
+// The state of a simulated thread, for use with Simulator::SwapContext.
+//
+// A new context starts in the same state as a Simulator after ResetState(),
+// except that its vector and predicate registers are zeroed. Its PC is
+// kEndOfSimAddress, so the entry point must be set with WritePc before the
+// context is run. Each context owns its own stack and guarded control stack.
+class SimContext {
+ public:
+  explicit SimContext(const Simulator& simulator,
+                      SimStack::Allocated stack = SimStack().Allocate());
+  ~SimContext();
+
+  SimContext(const SimContext&) = delete;
+  SimContext& operator=(const SimContext&) = delete;
+
+  // Accessors for setting up or inspecting the thread while it is not
+  // active.
+  uint64_t ReadXRegister(unsigned code) const {
+    VIXL_ASSERT(code < kSpRegCode);
+    return registers_[code];
+  }
+  void WriteXRegister(unsigned code, uint64_t value) {
+    VIXL_ASSERT(code < kSpRegCode);
+    registers_[code] = value;
+  }
+  uint64_t ReadSp() const { return registers_[kSpRegCode]; }
+  void WriteSp(uint64_t value) { registers_[kSpRegCode] = value; }
+
+  const Instruction* ReadPc() const { return pc_; }
+  void WritePc(const Instruction* pc) { pc_ = AddressUntag(pc); }
+
+  // True if the thread has returned to kEndOfSimAddress.
+  bool IsFinished() const { return pc_ == Simulator::kEndOfSimAddress; }
+
+  const SimStack::Allocated& GetStack() const { return stack_; }
+
+ private:
+  // Per-register storage, sized for the largest supported vector length. Only
+  // the part used by the current vector length is exchanged by SwapContext.
+  static const unsigned kVRegLanes = kZRegMaxSizeInBytes / kDRegSizeInBytes;
+  static const unsigned kPRegLanes = kPRegMaxSizeInBytes / kHRegSizeInBytes;
+
+  unsigned vector_length_;
+
+  uint64_t registers_[kNumberOfRegisters];
+  uint64_t vregisters_[kNumberOfZRegisters][kVRegLanes];
+  uint16_t pregisters_[kNumberOfPRegisters][kPRegLanes];
+  uint16_t ffr_register_[kPRegLanes];
+  SimSystemRegister nzcv_;
+  SimSystemRegister fpcr_;
+
+  const Instruction* pc_;
+  BType btype_;
+  BType next_btype_;
+  const Instruction* last_instr_;
+  uint32_t form_hash_;
+
+  uint64_t gcs_;
+  SimStack::Allocated stack_;
+
+  friend class Simulator;
+};
+
 #if defined(VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT) && __cplusplus < 201402L
 // Base case of the recursive template used to emulate C++14
 // `std::index_sequence`.
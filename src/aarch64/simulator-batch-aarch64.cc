@@ -0,0 +1,104 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+
+#include "simulator-batch-aarch64.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace vixl {
+namespace aarch64 {
+
+
+BatchSimulator::Worker::Worker() : simulator(new Simulator(&decoder)) {}
+
+
+Simulator* BatchSimulator::Worker::PrepareCall() {
+  simulator->ResetArchitecturalState();
+  simulator->WriteLr(Simulator::kEndOfSimAddress);
+  return simulator.get();
+}
+
+
+BatchSimulator::BatchSimulator(unsigned thread_count) {
+  if (thread_count == 0) {
+    // `hardware_concurrency()` may return zero if the value is not computable.
+    thread_count = std::max(1U, std::thread::hardware_concurrency());
+  }
+  // Simulators are built sequentially: construction allocates from shared
+  // state, such as the guarded control stack manager.
+  workers_.reserve(thread_count);
+  for (unsigned i = 0; i < thread_count; i++) {
+    workers_.emplace_back(new Worker);
+  }
+}
+
+
+BatchSimulator::~BatchSimulator() {}
+
+
+void BatchSimulator::Dispatch(
+    size_t count, const std::function<void(Worker*, size_t, size_t)>& work) {
+  if (count == 0) return;
+
+  // Hand out work in chunks small enough to balance the load between threads
+  // when calls take different amounts of time, but large enough to make the
+  // cost of claiming a chunk negligible.
+  const size_t kMaxChunkSize = 1024;
+  size_t thread_count = std::min<size_t>(workers_.size(), count);
+  size_t chunk_size = count / (thread_count * 8);
+  chunk_size = std::max<size_t>(1, std::min(chunk_size, kMaxChunkSize));
+
+  std::atomic<size_t> next(0);
+  auto run_worker = [&](Worker* worker) {
+    while (true) {
+      size_t begin = next.fetch_add(chunk_size, std::memory_order_relaxed);
+      if (begin >= count) break;
+      work(worker, begin, std::min(begin + chunk_size, count));
+    }
+  };
+
+  // The calling thread runs the first worker itself.
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (size_t i = 1; i < thread_count; i++) {
+    threads.emplace_back(run_worker, workers_[i].get());
+  }
+  run_worker(workers_[0].get());
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_INCLUDE_SIMULATOR_AARCH64
@@ -0,0 +1,148 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIXL_AARCH64_SIMULATOR_BATCH_AARCH64_H_
+#define VIXL_AARCH64_SIMULATOR_BATCH_AARCH64_H_
+
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "../code-buffer-vixl.h"
+#include "../globals-vixl.h"
+
+#include "abi-aarch64.h"
+#include "decoder-aarch64.h"
+#include "instructions-aarch64.h"
+#include "simulator-aarch64.h"
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+
+namespace vixl {
+namespace aarch64 {
+
+// Run one generated function over many sets of arguments, spreading the work
+// across a pool of host threads.
+//
+// Each thread owns a Decoder and a Simulator, created once when the pool is
+// constructed and reused for every call, so the cost of building the decode
+// graph and setting up simulator state is paid once per thread rather than
+// once per call. The code itself is shared, read-only, by all threads.
+//
+// Example:
+//
+//    BatchSimulator batch;
+//    std::vector<std::tuple<int64_t, int64_t>> args = ...;
+//    std::vector<int64_t> results(args.size());
+//    batch.Run(masm.GetBuffer()->GetStartAddress<Instruction*>(),
+//              args.data(), results.data(), args.size());
+//
+// Arguments and return values are passed according to the AAPCS, as described
+// by `ABI`, with the same restrictions as the templated
+// `Simulator::RunFrom()`: only arguments passed in registers are supported.
+class BatchSimulator {
+ public:
+  // Create a pool of `thread_count` simulators. If `thread_count` is zero, one
+  // simulator is created for each hardware thread.
+  explicit BatchSimulator(unsigned thread_count = 0);
+  ~BatchSimulator();
+
+  unsigned GetThreadCount() const {
+    return static_cast<unsigned>(workers_.size());
+  }
+
+  // Access the simulator used by a given thread, for example to set the CPU
+  // features or vector length before calling Run(). The simulators must not
+  // be modified while Run() is executing.
+  Simulator* GetSimulator(unsigned index) {
+    VIXL_ASSERT(index < GetThreadCount());
+    return workers_[index]->simulator.get();
+  }
+
+  // Call the function at `entry` once for each of the `count` argument tuples
+  // in `arguments`, storing the return value of call `i` in `results[i]`.
+  // Calls are independent: each starts from the architectural state set by
+  // `Simulator::ResetArchitecturalState()`, so no registers or flags are
+  // carried from one call to the next. Memory, including the stack contents,
+  // and the simulators' configuration are preserved.
+  template <typename R, typename... P>
+  void Run(const Instruction* entry,
+           const std::tuple<P...>* arguments,
+           R* results,
+           size_t count) {
+    Dispatch(count, [=](Worker* worker, size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        Simulator* simulator = worker->PrepareCall();
+        results[i] = std::apply(
+            [=](P... args) {
+              return simulator->RunFrom<R, P...>(entry, args...);
+            },
+            arguments[i]);
+      }
+    });
+  }
+
+  // As above, with the entry point given as an offset into `code`.
+  template <typename R, typename... P>
+  void Run(const CodeBuffer& code,
+           ptrdiff_t entry_offset,
+           const std::tuple<P...>* arguments,
+           R* results,
+           size_t count) {
+    Run(code.GetOffsetAddress<const Instruction*>(entry_offset),
+        arguments,
+        results,
+        count);
+  }
+
+ private:
+  struct Worker {
+    Worker();
+
+    // Reset the architectural state left by the previous call, and return
+    // the simulator to use.
+    Simulator* PrepareCall();
+
+    Decoder decoder;
+    std::unique_ptr<Simulator> simulator;
+  };
+
+  // Split [0, count) into chunks and hand them out to the worker threads,
+  // calling `work` on each. Returns when all the work is done.
+  void Dispatch(size_t count,
+                const std::function<void(Worker*, size_t, size_t)>& work);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_INCLUDE_SIMULATOR_AARCH64
+
+#endif  // VIXL_AARCH64_SIMULATOR_BATCH_AARCH64_H_
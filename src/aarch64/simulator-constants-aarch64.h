@@ -27,6 +27,8 @@
 #ifndef VIXL_AARCH64_SIMULATOR_CONSTANTS_AARCH64_H_
 #define VIXL_AARCH64_SIMULATOR_CONSTANTS_AARCH64_H_
 
+#include "../cpu-features.h"
+
 #include "instructions-aarch64.h"
 
 namespace vixl {
@@ -188,6 +190,60 @@ const unsigned kConfigureCPUFeaturesListOffset = 1 * kInstructionSize;
 // These have no effect on the set of 'seen' features (as reported by
 // CPUFeaturesAuditor::HasSeen(...)).
 
+// Return the size in bytes of the debug pseudo instruction at `instr`,
+// including its inline arguments, or zero if `instr` is not one. At most
+// `max_size` bytes from `instr` are read, and the size returned is never
+// larger than `max_size`.
+//
+// Code which rewrites or moves instructions uses this to leave the arguments
+// alone: they are data, even though they are emitted in the instruction
+// stream.
+inline size_t GetDebugHltSize(const Instruction* instr, size_t max_size) {
+  if ((max_size < kInstructionSize) || (instr->Mask(ExceptionMask) != HLT)) {
+    return 0;
+  }
+  size_t size;
+  switch (instr->GetImmException()) {
+    case kUnreachableOpcode:
+    case kSaveCPUFeaturesOpcode:
+    case kRestoreCPUFeaturesOpcode:
+    case kMTEActive:
+    case kMTEInactive:
+      size = kInstructionSize;
+      break;
+    case kPrintfOpcode:
+      size = kPrintfLength;
+      break;
+    case kTraceOpcode:
+      size = kTraceLength;
+      break;
+    case kLogOpcode:
+      size = kLogLength;
+      break;
+    case kRuntimeCallOpcode:
+      size = kRuntimeCallLength;
+      break;
+    case kSetCPUFeaturesOpcode:
+    case kEnableCPUFeaturesOpcode:
+    case kDisableCPUFeaturesOpcode: {
+      // A kNone-terminated list of features, padded to kInstructionSize.
+      const ConfigureCPUFeaturesElementType* list =
+          reinterpret_cast<const ConfigureCPUFeaturesElementType*>(instr);
+      size = kConfigureCPUFeaturesListOffset;
+      while ((size < max_size) &&
+             (list[size] != static_cast<ConfigureCPUFeaturesElementType>(
+                                CPUFeatures::kNone))) {
+        size++;
+      }
+      size = AlignUp(size + 1, kInstructionSize);
+      break;
+    }
+    default:
+      return 0;
+  }
+  return (size < max_size) ? size : max_size;
+}
+
 }  // namespace aarch64
 }  // namespace vixl
 
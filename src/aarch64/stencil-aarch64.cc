@@ -0,0 +1,220 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <cstring>
+
+#include "stencil-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+// The branch offset emitted before a branch hole is patched.
+static const int64_t kUnpatchedBranch = 0;
+
+
+bool Stencil::Instantiate(byte* code, const uint64_t* values) const {
+  memcpy(code, code_.data(), code_.size());
+  return PatchHoles(code, reinterpret_cast<uintptr_t>(code), values);
+}
+
+
+bool Stencil::Instantiate(CodeBuffer* buffer, const uint64_t* values) const {
+  ptrdiff_t offset = buffer->GetCursorOffset();
+  buffer->EnsureSpaceFor(code_.size());
+  buffer->EmitData(code_.data(), code_.size());
+  if (!PatchHoles(buffer->GetOffsetAddress<byte*>(offset), offset, values)) {
+    buffer->Rewind(offset);
+    return false;
+  }
+  return true;
+}
+
+
+bool Stencil::PatchHoles(byte* code,
+                         int64_t position,
+                         const uint64_t* values) const {
+  for (const Patch& patch : patches_) {
+    uint64_t value = values[patch.hole];
+    byte* address = code + patch.offset;
+    Instruction* instr = reinterpret_cast<Instruction*>(address);
+    switch (patch.type) {
+      case kRegisterRd:
+      case kRegisterRn:
+      case kRegisterRm:
+      case kRegisterRa: {
+        static const int kShifts[] = {Rd_offset,
+                                      Rn_offset,
+                                      Rm_offset,
+                                      Ra_offset};
+        if (value >= kNumberOfRegisters) return false;
+        int shift = kShifts[patch.type - kRegisterRd];
+        Instr bits = instr->GetInstructionBits() & ~(0x1f << shift);
+        instr->SetInstructionBits(bits | static_cast<Instr>(value << shift));
+        break;
+      }
+      case kMovImmediate64:
+        // MOVZ followed by three MOVKs, each holding 16 bits of the value.
+        for (int i = 0; i < 4; i++) {
+          Instruction* movewide =
+              reinterpret_cast<Instruction*>(address + (i * kInstructionSize));
+          uint64_t imm16 = (value >> (16 * i)) & 0xffff;
+          movewide->SetInstructionBits(
+              (movewide->GetInstructionBits() & ~ImmMoveWide_mask) |
+              Assembler::ImmMoveWide(imm16));
+        }
+        break;
+      case kAddSubImmediate:
+        if (!IsUint12(value)) return false;
+        instr->SetInstructionBits(
+            (instr->GetInstructionBits() & ~ImmAddSub_mask) |
+            Assembler::ImmAddSub(static_cast<int>(value)));
+        break;
+      case kLiteral64:
+        memcpy(address, &value, sizeof(value));
+        break;
+      case kBranch: {
+        int64_t offset =
+            static_cast<int64_t>(value) - (position + patch.offset);
+        if (!IsAligned(offset, kInstructionSize)) return false;
+        if (!Instruction::IsValidImmPCOffset(instr->GetBranchType(),
+                                             offset / kInstructionSize)) {
+          return false;
+        }
+        instr->SetImmPCOffsetTarget(instr->GetInstructionAtOffset(offset));
+        break;
+      }
+      default:
+        VIXL_UNREACHABLE();
+    }
+  }
+  return true;
+}
+
+
+void StencilBuilder::AddPatch(ptrdiff_t offset,
+                              int hole,
+                              Stencil::PatchType type) {
+  VIXL_ASSERT(IsUint16(hole));
+  Stencil::Patch patch = {static_cast<uint32_t>(offset),
+                          static_cast<uint16_t>(hole),
+                          static_cast<uint16_t>(type)};
+  patches_.push_back(patch);
+}
+
+
+void StencilBuilder::MarkRegister(int hole, Stencil::PatchType field) {
+  VIXL_ASSERT((field >= Stencil::kRegisterRd) &&
+              (field <= Stencil::kRegisterRa));
+  VIXL_ASSERT(masm_->GetCursorOffset() >=
+              static_cast<ptrdiff_t>(kInstructionSize));
+  AddPatch(masm_->GetCursorOffset() - kInstructionSize, hole, field);
+}
+
+
+void StencilBuilder::MovImmediate(int hole, const Register& rd) {
+  VIXL_ASSERT(rd.Is64Bits());
+  ExactAssemblyScope scope(masm_, 4 * kInstructionSize);
+  AddPatch(masm_->GetCursorOffset(), hole, Stencil::kMovImmediate64);
+  masm_->movz(rd, 0, 0);
+  masm_->movk(rd, 0, 16);
+  masm_->movk(rd, 0, 32);
+  masm_->movk(rd, 0, 48);
+}
+
+
+void StencilBuilder::AddImmediate(int hole,
+                                  const Register& rd,
+                                  const Register& rn) {
+  ExactAssemblyScope scope(masm_, kInstructionSize);
+  AddPatch(masm_->GetCursorOffset(), hole, Stencil::kAddSubImmediate);
+  masm_->add(rd, rn, 0);
+}
+
+
+void StencilBuilder::LdrLiteral(int hole, const Register& rt) {
+  VIXL_ASSERT(rt.Is64Bits());
+  RawLiteral* literal =
+      new Literal<uint64_t>(0,
+                            masm_->GetLiteralPool(),
+                            RawLiteral::kDeletedOnPoolDestruction);
+  masm_->Ldr(rt, literal);
+  literal_holes_.push_back(hole);
+  literals_.push_back(literal);
+}
+
+
+void StencilBuilder::B(int hole, Condition cond) {
+  ExactAssemblyScope scope(masm_, kInstructionSize);
+  AddPatch(masm_->GetCursorOffset(), hole, Stencil::kBranch);
+  if (cond == al) {
+    masm_->b(kUnpatchedBranch);
+  } else {
+    masm_->b(kUnpatchedBranch, cond);
+  }
+}
+
+
+void StencilBuilder::Bl(int hole) {
+  ExactAssemblyScope scope(masm_, kInstructionSize);
+  AddPatch(masm_->GetCursorOffset(), hole, Stencil::kBranch);
+  masm_->bl(kUnpatchedBranch);
+}
+
+
+void StencilBuilder::Cbz(int hole, const Register& rt) {
+  ExactAssemblyScope scope(masm_, kInstructionSize);
+  AddPatch(masm_->GetCursorOffset(), hole, Stencil::kBranch);
+  masm_->cbz(rt, kUnpatchedBranch);
+}
+
+
+void StencilBuilder::Cbnz(int hole, const Register& rt) {
+  ExactAssemblyScope scope(masm_, kInstructionSize);
+  AddPatch(masm_->GetCursorOffset(), hole, Stencil::kBranch);
+  masm_->cbnz(rt, kUnpatchedBranch);
+}
+
+
+void StencilBuilder::Build(Stencil* stencil) {
+  masm_->FinalizeCode();
+  for (size_t i = 0; i < literals_.size(); i++) {
+    AddPatch(literals_[i]->GetOffset(), literal_holes_[i], Stencil::kLiteral64);
+  }
+
+  const CodeBuffer* buffer = masm_->GetBuffer();
+  const byte* start = buffer->GetStartAddress<const byte*>();
+  stencil->code_.assign(start, start + buffer->GetSizeInBytes());
+  stencil->patches_ = patches_;
+  stencil->hole_count_ = 0;
+  for (const Stencil::Patch& patch : patches_) {
+    stencil->hole_count_ = std::max(stencil->hole_count_, patch.hole + 1);
+  }
+}
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -0,0 +1,165 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIXL_AARCH64_STENCIL_AARCH64_H_
+#define VIXL_AARCH64_STENCIL_AARCH64_H_
+
+#include <vector>
+
+#include "../code-buffer-vixl.h"
+#include "../globals-vixl.h"
+
+#include "macro-assembler-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+// A pre-assembled code template with holes, which can be instantiated many
+// times by copying it and patching the holes, far more cheaply than
+// generating the same code with the MacroAssembler.
+//
+// Stencils are built with a StencilBuilder. Each hole has an index, and is
+// given a value for each instantiation:
+//  * Register holes take a register code.
+//  * Immediate holes take a 64-bit value, materialised with a fixed MOVZ/MOVK
+//    sequence, or a 12-bit unsigned ADD/SUB immediate.
+//  * Literal holes take a 64-bit value, stored in the stencil's own literal
+//    pool and loaded with LDR (literal). Since the pool is part of the
+//    stencil, the loads stay in range wherever it is instantiated.
+//  * Branch holes take the target of a B, BL, B.cond, CBZ or CBNZ
+//    instruction. Instantiation fails if the target is out of range.
+// A hole can be used several times in the same stencil, for example to use a
+// register in several instructions. Branches between labels of the stencil
+// are position-independent, and need no holes.
+class Stencil {
+ public:
+  enum PatchType {
+    kRegisterRd,
+    kRegisterRn,
+    kRegisterRm,
+    kRegisterRa,
+    kMovImmediate64,
+    kAddSubImmediate,
+    kLiteral64,
+    kBranch
+  };
+
+  Stencil() : hole_count_(0) {}
+
+  // Copy the stencil to `code`, which must have space for GetSizeInBytes()
+  // bytes, and patch the holes with `values`, which must hold
+  // GetHoleCount() values. Branch targets are addresses. Return false if a
+  // value cannot be encoded, in which case the content of `code` is
+  // undefined.
+  bool Instantiate(byte* code, const uint64_t* values) const;
+
+  // Emit the stencil in `buffer`, at its cursor. Branch targets are offsets in
+  // `buffer`, so that the code stays valid if the buffer grows. Return false,
+  // leaving `buffer` unchanged, if a value cannot be encoded. As with an
+  // Assembler, the buffer must be marked clean with `SetClean()` once all
+  // the code has been emitted.
+  bool Instantiate(CodeBuffer* buffer, const uint64_t* values) const;
+
+  size_t GetSizeInBytes() const { return code_.size(); }
+  int GetHoleCount() const { return hole_count_; }
+
+ private:
+  friend class StencilBuilder;
+
+  struct Patch {
+    uint32_t offset;
+    uint16_t hole;
+    uint16_t type;
+  };
+
+  // Patch the holes of the stencil copied at `code`. Branch offsets are
+  // computed from the `position` of the copy, which is either its address or
+  // its offset in a CodeBuffer.
+  bool PatchHoles(byte* code, int64_t position, const uint64_t* values) const;
+
+  std::vector<byte> code_;
+  std::vector<Patch> patches_;
+  int hole_count_;
+};
+
+
+// Build a Stencil with a MacroAssembler.
+//
+// The MacroAssembler must be empty, and must only be used to generate the
+// stencil: instructions are emitted with it as usual, along with holes
+// emitted through the builder. For example:
+//
+//   MacroAssembler masm;
+//   StencilBuilder builder(&masm);
+//   builder.MovImmediate(0, x0);
+//   __ Add(x0, x0, x1);
+//   builder.MarkRegister(1, Stencil::kRegisterRm);
+//   builder.B(2);
+//   Stencil stencil;
+//   builder.Build(&stencil);
+class StencilBuilder {
+ public:
+  explicit StencilBuilder(MacroAssembler* masm) : masm_(masm) {
+    VIXL_ASSERT(masm->GetCursorOffset() == 0);
+  }
+
+  // Mark a register field of the last instruction emitted as `hole`. The
+  // instruction must be a single instruction, so macro instructions which
+  // can expand to several instructions should be avoided here.
+  void MarkRegister(int hole, Stencil::PatchType field);
+
+  // Emit `mov rd, <hole>` as a MOVZ and three MOVKs.
+  void MovImmediate(int hole, const Register& rd);
+  // Emit `add rd, rn, #<hole>`, where the hole holds a 12-bit unsigned value.
+  void AddImmediate(int hole, const Register& rd, const Register& rn);
+  // Emit `ldr rt, <hole>`, loading a 64-bit literal.
+  void LdrLiteral(int hole, const Register& rt);
+
+  // Branch to the target in `hole`.
+  void B(int hole, Condition cond = al);
+  void Bl(int hole);
+  void Cbz(int hole, const Register& rt);
+  void Cbnz(int hole, const Register& rt);
+
+  // Finalise the MacroAssembler, and copy the stencil to `stencil`.
+  void Build(Stencil* stencil);
+
+ private:
+  void AddPatch(ptrdiff_t offset, int hole, Stencil::PatchType type);
+
+  MacroAssembler* masm_;
+  std::vector<Stencil::Patch> patches_;
+  // Literal holes, and the literals holding them. The literals are owned by
+  // the MacroAssembler's literal pool.
+  std::vector<int> literal_holes_;
+  std::vector<RawLiteral*> literals_;
+};
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_STENCIL_AARCH64_H_
@@ -0,0 +1,76 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "arena-vixl.h"
+
+#include <algorithm>
+
+namespace vixl {
+
+Arena::~Arena() {
+  for (size_t i = 0; i < blocks_.size(); i++) {
+    delete[] blocks_[i].memory;
+  }
+}
+
+
+void Arena::Reset() {
+  allocated_size_ = 0;
+  current_block_ = 0;
+  if (blocks_.empty()) {
+    cursor_ = NULL;
+    limit_ = NULL;
+  } else {
+    cursor_ = blocks_[0].memory;
+    limit_ = blocks_[0].memory + blocks_[0].size;
+  }
+}
+
+
+void* Arena::AllocateSlow(size_t size, size_t alignment) {
+  // The worst-case padding needed to align the start of a block.
+  size_t required = size + alignment - 1;
+
+  // Move on to the next block kept by a previous `Reset()`, if it is large
+  // enough. Blocks that are too small are skipped until the next reset.
+  size_t next = (cursor_ == NULL) ? 0 : current_block_ + 1;
+  while ((next < blocks_.size()) && (blocks_[next].size < required)) {
+    next++;
+  }
+  if (next == blocks_.size()) {
+    Block block;
+    block.size = std::max(block_size_, required);
+    block.memory = new char[block.size];
+    blocks_.push_back(block);
+  }
+  current_block_ = next;
+  cursor_ = blocks_[next].memory;
+  limit_ = cursor_ + blocks_[next].size;
+  return Allocate(size, alignment);
+}
+
+}  // namespace vixl
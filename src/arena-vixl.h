@@ -0,0 +1,158 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIXL_ARENA_H_
+#define VIXL_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "globals-vixl.h"
+
+namespace vixl {
+
+// A bump-pointer allocator for short-lived bookkeeping data.
+//
+// Memory is carved out of large blocks and is never freed individually: it is
+// all reclaimed at once by `Reset()`, which keeps the blocks for the next user,
+// or when the arena is destroyed. Destructors of objects placed in the arena
+// are not run.
+//
+// A typical use is to reset the arena after each function generated by a JIT,
+// so that the allocations made while assembling a function (label links,
+// veneer and literal pool records) do not go through the global allocator.
+class Arena {
+ public:
+  static const size_t kDefaultBlockSize = 16 * KBytes;
+
+  explicit Arena(size_t block_size = kDefaultBlockSize)
+      : block_size_(block_size),
+        current_block_(0),
+        cursor_(NULL),
+        limit_(NULL),
+        allocated_size_(0) {}
+  ~Arena();
+
+  // Allocate `size` bytes aligned to `alignment`, which must be a power of
+  // two.
+  void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    VIXL_ASSERT(IsPowerOf2(alignment));
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor_) + alignment - 1) &
+                        ~(alignment - 1);
+    uintptr_t limit = reinterpret_cast<uintptr_t>(limit_);
+    if ((aligned > limit) || (size > (limit - aligned))) {
+      return AllocateSlow(size, alignment);
+    }
+    cursor_ = reinterpret_cast<char*>(aligned + size);
+    allocated_size_ += size;
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  // Make all the memory allocated so far available again. Any object allocated
+  // from the arena must no longer be used.
+  void Reset();
+
+  // The number of bytes handed out since the arena was created or last reset.
+  size_t GetAllocatedSize() const { return allocated_size_; }
+
+ private:
+  static bool IsPowerOf2(size_t value) {
+    return (value != 0) && ((value & (value - 1)) == 0);
+  }
+
+  void* AllocateSlow(size_t size, size_t alignment);
+
+  struct Block {
+    char* memory;
+    size_t size;
+  };
+
+  size_t block_size_;
+  std::vector<Block> blocks_;
+  // The index in `blocks_` of the block `cursor_` points into.
+  size_t current_block_;
+  char* cursor_;
+  char* limit_;
+  size_t allocated_size_;
+
+#if __cplusplus >= 201103L
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+#else
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+#endif
+};
+
+
+// An STL allocator drawing from an `Arena`. Without an arena, it falls back to
+// the global allocator so that containers can use a single type whether or
+// not an arena was supplied.
+template <typename T>
+class ArenaAllocator {
+ public:
+  typedef T value_type;
+  // Containers take their new allocator along with their new contents, so a
+  // container can be switched to or from an arena by assigning to it.
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  explicit ArenaAllocator(Arena* arena = NULL) : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other)  // NOLINT(runtime/explicit)
+      : arena_(other.GetArena()) {}
+
+  T* allocate(size_t n) {
+    if (arena_ == NULL) return std::allocator<T>().allocate(n);
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, size_t n) {
+    // Arena memory is only reclaimed by `Arena::Reset()`.
+    if (arena_ == NULL) std::allocator<T>().deallocate(p, n);
+  }
+
+  Arena* GetArena() const { return arena_; }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const {
+    return arena_ == other.GetArena();
+  }
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& other) const {
+    return arena_ != other.GetArena();
+  }
+
+ private:
+  Arena* arena_;
+};
+
+}  // namespace vixl
+
+#endif  // VIXL_ARENA_H_
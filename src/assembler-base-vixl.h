@@ -48,6 +48,8 @@ class AssemblerBase {
       : buffer_(capacity), allow_assembler_(false) {}
   AssemblerBase(byte* buffer, size_t capacity)
       : buffer_(buffer, capacity), allow_assembler_(false) {}
+  AssemblerBase(SharedCodeBuffer* shared, size_t capacity)
+      : buffer_(shared, capacity), allow_assembler_(false) {}
 
   virtual ~AssemblerBase() {}
 
@@ -27,6 +27,7 @@
 #ifdef VIXL_CODE_BUFFER_MMAP
 extern "C" {
 #include <sys/mman.h>
+#include <unistd.h>
 }
 #endif
 
@@ -36,9 +37,101 @@ extern "C" {
 namespace vixl {
 
 
+SharedCodeBuffer::SharedCodeBuffer(size_t capacity)
+    : buffer_(NULL), capacity_(capacity), top_(0) {
+  VIXL_ASSERT(capacity_ > 0);
+#ifdef VIXL_CODE_BUFFER_MALLOC
+  buffer_ = reinterpret_cast<byte*>(malloc(capacity_));
+#elif defined(VIXL_CODE_BUFFER_MMAP)
+  buffer_ = reinterpret_cast<byte*>(mmap(NULL,
+                                         capacity_,
+                                         PROT_READ | PROT_WRITE,
+                                         MAP_PRIVATE | MAP_ANONYMOUS,
+                                         -1,
+                                         0));
+#else
+#error Unknown code buffer allocator.
+#endif
+  VIXL_CHECK(buffer_ != NULL);
+  VIXL_ASSERT(IsWordAligned(buffer_));
+}
+
+
+SharedCodeBuffer::~SharedCodeBuffer() {
+#ifdef VIXL_CODE_BUFFER_MALLOC
+  free(buffer_);
+#elif defined(VIXL_CODE_BUFFER_MMAP)
+  munmap(buffer_, capacity_);
+#else
+#error Unknown code buffer allocator.
+#endif
+}
+
+
+byte* SharedCodeBuffer::Reserve(size_t size) {
+  size = AlignUp(size, kChunkAlignment);
+  size_t top = top_.load(std::memory_order_relaxed);
+  do {
+    if (size > (capacity_ - top)) return NULL;
+    // Chunks are disjoint, so there is nothing to synchronise with other
+    // threads here. Publishing the generated code is up to the user.
+  } while (!top_.compare_exchange_weak(top,
+                                       top + size,
+                                       std::memory_order_relaxed));
+  return buffer_ + top;
+}
+
+
+bool SharedCodeBuffer::Extend(byte* chunk, size_t size, size_t new_size) {
+  VIXL_ASSERT(new_size >= size);
+  size_t end = GetChunkEnd(chunk, size);
+  size_t new_end = GetChunkEnd(chunk, new_size);
+  if (new_end > capacity_) return false;
+  return top_.compare_exchange_strong(end,
+                                      new_end,
+                                      std::memory_order_relaxed);
+}
+
+
+void SharedCodeBuffer::Release(byte* chunk, size_t size, size_t used) {
+  VIXL_ASSERT(used <= size);
+  size_t end = GetChunkEnd(chunk, size);
+  top_.compare_exchange_strong(end,
+                               GetChunkEnd(chunk, used),
+                               std::memory_order_relaxed);
+}
+
+
+void SharedCodeBuffer::SetExecutable() {
+#ifdef VIXL_CODE_BUFFER_MMAP
+  int ret = mprotect(buffer_, capacity_, PROT_READ | PROT_EXEC);
+  VIXL_CHECK(ret == 0);
+#else
+  // This requires page-aligned memory blocks, which we can only guarantee with
+  // mmap.
+  VIXL_UNIMPLEMENTED();
+#endif
+}
+
+
+void SharedCodeBuffer::SetWritable() {
+#ifdef VIXL_CODE_BUFFER_MMAP
+  int ret = mprotect(buffer_, capacity_, PROT_READ | PROT_WRITE);
+  VIXL_CHECK(ret == 0);
+#else
+  // This requires page-aligned memory blocks, which we can only guarantee with
+  // mmap.
+  VIXL_UNIMPLEMENTED();
+#endif
+}
+
+
 CodeBuffer::CodeBuffer(size_t capacity)
     : buffer_(NULL),
+      executable_buffer_(NULL),
+      memory_fd_(-1),
       managed_(true),
+      shared_(NULL),
       cursor_(NULL),
       dirty_(false),
       capacity_(capacity) {
@@ -63,12 +156,16 @@ CodeBuffer::CodeBuffer(size_t capacity)
   VIXL_ASSERT(IsWordAligned(buffer_));
 
   cursor_ = buffer_;
+  executable_buffer_ = buffer_;
 }
 
 
 CodeBuffer::CodeBuffer(byte* buffer, size_t capacity)
     : buffer_(reinterpret_cast<byte*>(buffer)),
+      executable_buffer_(buffer_),
+      memory_fd_(-1),
       managed_(false),
+      shared_(NULL),
       cursor_(reinterpret_cast<byte*>(buffer)),
       dirty_(false),
       capacity_(capacity) {
@@ -76,13 +173,38 @@ CodeBuffer::CodeBuffer(byte* buffer, size_t capacity)
 }
 
 
+CodeBuffer::CodeBuffer(SharedCodeBuffer* shared, size_t capacity)
+    : buffer_(NULL),
+      executable_buffer_(NULL),
+      memory_fd_(-1),
+      managed_(true),
+      shared_(shared),
+      cursor_(NULL),
+      dirty_(false),
+      capacity_(capacity) {
+  VIXL_ASSERT(shared_ != NULL);
+  buffer_ = shared_->Reserve(capacity_);
+  VIXL_CHECK(buffer_ != NULL);
+  cursor_ = buffer_;
+  executable_buffer_ = buffer_;
+}
+
+
 CodeBuffer::~CodeBuffer() VIXL_NEGATIVE_TESTING_ALLOW_EXCEPTION {
   VIXL_ASSERT(!IsDirty());
-  if (managed_) {
+  if (IsShared()) {
+    // The code stays in the shared buffer, but the rest of the chunk can be
+    // reused.
+    shared_->Release(buffer_, capacity_, GetSizeInBytes());
+  } else if (managed_) {
 #ifdef VIXL_CODE_BUFFER_MALLOC
     free(buffer_);
 #elif defined(VIXL_CODE_BUFFER_MMAP)
     munmap(buffer_, capacity_);
+    if (IsDualMapped()) {
+      munmap(executable_buffer_, capacity_);
+      close(memory_fd_);
+    }
 #else
 #error Unknown code buffer allocator.
 #endif
@@ -92,6 +214,8 @@ CodeBuffer::~CodeBuffer() VIXL_NEGATIVE_TESTING_ALLOW_EXCEPTION {
 
 void CodeBuffer::SetExecutable() {
 #ifdef VIXL_CODE_BUFFER_MMAP
+  VIXL_ASSERT(!IsShared());
+  if (IsDualMapped()) return;
   int ret = mprotect(buffer_, capacity_, PROT_READ | PROT_EXEC);
   VIXL_CHECK(ret == 0);
 #else
@@ -104,6 +228,8 @@ void CodeBuffer::SetExecutable() {
 
 void CodeBuffer::SetWritable() {
 #ifdef VIXL_CODE_BUFFER_MMAP
+  VIXL_ASSERT(!IsShared());
+  if (IsDualMapped()) return;
   int ret = mprotect(buffer_, capacity_, PROT_READ | PROT_WRITE);
   VIXL_CHECK(ret == 0);
 #else
@@ -114,6 +240,35 @@ void CodeBuffer::SetWritable() {
 }
 
 
+void CodeBuffer::EnableDualMapping() {
+#if defined(VIXL_CODE_BUFFER_MMAP) && defined(__linux__)
+  VIXL_ASSERT(managed_ && !IsShared());
+  VIXL_ASSERT(GetSizeInBytes() == 0);
+  VIXL_ASSERT(capacity_ > 0);
+  if (IsDualMapped()) return;
+
+  int fd = memfd_create("vixl-code-buffer", MFD_CLOEXEC);
+  VIXL_CHECK(fd >= 0);
+  VIXL_CHECK(ftruncate(fd, capacity_) == 0);
+  void* writable =
+      mmap(NULL, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  VIXL_CHECK(writable != MAP_FAILED);
+  void* executable =
+      mmap(NULL, capacity_, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+  VIXL_CHECK(executable != MAP_FAILED);
+
+  munmap(buffer_, capacity_);
+  buffer_ = static_cast<byte*>(writable);
+  executable_buffer_ = static_cast<byte*>(executable);
+  cursor_ = buffer_;
+  memory_fd_ = fd;
+#else
+  // This requires memory files, and mapping them with mmap.
+  VIXL_UNIMPLEMENTED();
+#endif
+}
+
+
 void CodeBuffer::EmitString(const char* string) {
   const auto len = strlen(string) + 1;
   VIXL_ASSERT(HasSpaceFor(len));
@@ -170,10 +325,31 @@ void CodeBuffer::Grow(size_t new_capacity) {
   VIXL_ASSERT(managed_);
   VIXL_ASSERT(new_capacity > capacity_);
   ptrdiff_t cursor_offset = GetCursorOffset();
+  if (IsShared()) {
+    // Move to a new chunk if this one cannot be extended. Everything emitted
+    // so far, including pools, moves with the code, and the old chunk is
+    // left unused.
+    if (!shared_->Extend(buffer_, capacity_, new_capacity)) {
+      byte* chunk = shared_->Reserve(new_capacity);
+      VIXL_CHECK(chunk != NULL);
+      memcpy(chunk, buffer_, cursor_offset);
+      buffer_ = chunk;
+      executable_buffer_ = buffer_;
+    }
+    cursor_ = buffer_ + cursor_offset;
+    capacity_ = new_capacity;
+    return;
+  }
 #ifdef VIXL_CODE_BUFFER_MALLOC
   buffer_ = static_cast<byte*>(realloc(buffer_, new_capacity));
   VIXL_CHECK(buffer_ != NULL);
 #elif defined(VIXL_CODE_BUFFER_MMAP)
+  if (IsDualMapped()) {
+    VIXL_CHECK(ftruncate(memory_fd_, new_capacity) == 0);
+    executable_buffer_ = static_cast<byte*>(
+        mremap(executable_buffer_, capacity_, new_capacity, MREMAP_MAYMOVE));
+    VIXL_CHECK(executable_buffer_ != MAP_FAILED);
+  }
   buffer_ = static_cast<byte*>(
       mremap(buffer_, capacity_, new_capacity, MREMAP_MAYMOVE));
   VIXL_CHECK(buffer_ != MAP_FAILED);
@@ -181,6 +357,7 @@ void CodeBuffer::Grow(size_t new_capacity) {
 #error Unknown code buffer allocator.
 #endif
 
+  if (!IsDualMapped()) executable_buffer_ = buffer_;
   cursor_ = buffer_ + cursor_offset;
   capacity_ = new_capacity;
 }
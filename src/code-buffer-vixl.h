@@ -27,6 +27,7 @@
 #ifndef VIXL_CODE_BUFFER_H
 #define VIXL_CODE_BUFFER_H
 
+#include <atomic>
 #include <cstring>
 
 #include "globals-vixl.h"
@@ -34,12 +35,82 @@
 
 namespace vixl {
 
+// A large block of memory from which several CodeBuffers can allocate chunks
+// concurrently, so that independent functions can be generated on different
+// threads directly into the same region. Chunks are reserved with a lock-free
+// bump allocator, and are disjoint.
+//
+// A CodeBuffer allocated from a SharedCodeBuffer grows by extending its chunk
+// in place if no other chunk has been reserved since, or else by moving its
+// code to a new, larger chunk. In both cases the code, including any literal
+// pools and veneers already emitted, stays within a single chunk. When the
+// CodeBuffer is destroyed, the unused end of its chunk is returned if possible.
+//
+// Reserve(), Extend() and Release() are thread-safe. The other operations are
+// not, and must only be used when no CodeBuffer allocates from the
+// SharedCodeBuffer.
+class SharedCodeBuffer {
+ public:
+  // Chunks are aligned to a typical cache line size, so that threads emitting
+  // into neighbouring chunks do not write to the same lines.
+  static const size_t kChunkAlignment = 64;
+
+  explicit SharedCodeBuffer(size_t capacity);
+  ~SharedCodeBuffer();
+
+  // Reserve a chunk of at least `size` bytes. Return NULL if there is not
+  // enough space left.
+  byte* Reserve(size_t size);
+
+  // Try to extend `chunk`, previously reserved with `size` bytes, to
+  // `new_size` bytes. This only succeeds if no other chunk has been reserved
+  // after it.
+  bool Extend(byte* chunk, size_t size, size_t new_size);
+
+  // Give back the end of `chunk`, after its first `used` bytes. This only has
+  // an effect if no other chunk has been reserved after it.
+  void Release(byte* chunk, size_t size, size_t used);
+
+  // Discard all the chunks.
+  void Reset() { top_.store(0, std::memory_order_relaxed); }
+
+  // Make the whole buffer executable or writable. These states are mutually
+  // exclusive, and, as for CodeBuffer, require VIXL_CODE_BUFFER_MMAP.
+  void SetExecutable();
+  void SetWritable();
+
+  template <typename T>
+  T GetStartAddress() const {
+    VIXL_STATIC_ASSERT(sizeof(T) >= sizeof(uintptr_t));
+    return reinterpret_cast<T>(buffer_);
+  }
+
+  size_t GetCapacity() const { return capacity_; }
+  size_t GetUsedBytes() const { return top_.load(std::memory_order_relaxed); }
+
+ private:
+  size_t GetChunkEnd(byte* chunk, size_t size) const {
+    VIXL_ASSERT((chunk >= buffer_) && (chunk < (buffer_ + capacity_)));
+    return AlignUp(static_cast<size_t>(chunk - buffer_) + size,
+                   kChunkAlignment);
+  }
+
+  byte* buffer_;
+  size_t capacity_;
+  // Offset of the first free byte. Chunks are allocated from here.
+  std::atomic<size_t> top_;
+};
+
 class CodeBuffer {
  public:
   static const size_t kDefaultCapacity = 4 * KBytes;
 
   explicit CodeBuffer(size_t capacity = kDefaultCapacity);
   CodeBuffer(byte* buffer, size_t capacity);
+  // Allocate the backing store from `shared`. The buffer can grow, but cannot
+  // be made executable or writable on its own: use the SharedCodeBuffer for
+  // that, once every buffer allocated from it is finalised.
+  CodeBuffer(SharedCodeBuffer* shared, size_t capacity);
   ~CodeBuffer() VIXL_NEGATIVE_TESTING_ALLOW_EXCEPTION;
 
   void Reset();
@@ -48,9 +119,21 @@ class CodeBuffer {
   // exclusive.
   // Note that these require page-aligned memory blocks, which we can only
   // guarantee with VIXL_CODE_BUFFER_MMAP.
+  // For dual-mapped buffers, these have no effect.
   void SetExecutable();
   void SetWritable();
 
+  // Back the buffer with a memory file mapped twice: a writable view, used to
+  // emit code, and an executable view, used to run it. Code can then be
+  // emitted, patched and run without changing memory permissions. The views
+  // are not kept coherent with the instruction cache: as with other buffers,
+  // call `CPU::EnsureIAndDCacheCoherency` on the executable view before
+  // running code written through the writable view.
+  // This requires a managed buffer with no emitted code, and is only
+  // available with VIXL_CODE_BUFFER_MMAP on Linux.
+  void EnableDualMapping();
+  bool IsDualMapped() const { return memory_fd_ >= 0; }
+
   ptrdiff_t GetOffsetFrom(ptrdiff_t offset) const {
     ptrdiff_t cursor_offset = cursor_ - buffer_;
     VIXL_ASSERT((offset >= 0) && (offset <= cursor_offset));
@@ -91,6 +174,26 @@ class CodeBuffer {
     return GetOffsetAddress<T>(GetSizeInBytes());
   }
 
+  // As above, but return addresses in the view of the buffer used to execute
+  // code. These only differ from the addresses above if the buffer is
+  // dual-mapped, in which case the addresses above are in the writable view.
+  template <typename T>
+  T GetExecutableOffsetAddress(ptrdiff_t offset) const {
+    VIXL_STATIC_ASSERT(sizeof(T) >= sizeof(uintptr_t));
+    VIXL_ASSERT((offset >= 0) && (offset <= (cursor_ - buffer_)));
+    return reinterpret_cast<T>(executable_buffer_ + offset);
+  }
+  template <typename T>
+  T GetExecutableStartAddress() const {
+    VIXL_STATIC_ASSERT(sizeof(T) >= sizeof(uintptr_t));
+    return GetExecutableOffsetAddress<T>(0);
+  }
+  template <typename T>
+  T GetExecutableEndAddress() const {
+    VIXL_STATIC_ASSERT(sizeof(T) >= sizeof(uintptr_t));
+    return GetExecutableOffsetAddress<T>(GetSizeInBytes());
+  }
+
   size_t GetRemainingBytes() const {
     VIXL_ASSERT((cursor_ >= buffer_) && (cursor_ <= (buffer_ + capacity_)));
     return (buffer_ + capacity_) - cursor_;
@@ -148,6 +251,8 @@ class CodeBuffer {
 
   bool IsManaged() const { return managed_; }
 
+  bool IsShared() const { return shared_ != NULL; }
+
   void Grow(size_t new_capacity);
 
   bool IsDirty() const { return dirty_; }
@@ -172,10 +277,17 @@ class CodeBuffer {
  private:
   // Backing store of the buffer.
   byte* buffer_;
+  // Executable view of the backing store. This is the same as `buffer_` unless
+  // the buffer is dual-mapped.
+  byte* executable_buffer_;
+  // File descriptor of the memory file backing a dual-mapped buffer, or -1.
+  int memory_fd_;
   // If true the backing store is allocated and deallocated by the buffer. The
   // backing store can then grow on demand. If false the backing store is
   // provided by the user and cannot be resized internally.
   bool managed_;
+  // The SharedCodeBuffer the backing store is allocated from, or NULL.
+  SharedCodeBuffer* shared_;
   // Pointer to the next location to be written.
   byte* cursor_;
   // True if there has been any write since the buffer was created or cleaned.
@@ -30,6 +30,7 @@
 #include <cstring>
 #include <vector>
 
+#include "arena-vixl.h"
 #include "globals-vixl.h"
 
 namespace vixl {
@@ -126,8 +127,19 @@ class InvalSet {
   static KeyType GetKey(const ElementType& element);
   static void SetKey(ElementType* element, KeyType key);
 
+  // Allocate the backing vector, if one is needed, from `arena` rather than
+  // from the global allocator. The arena can only be changed while the set is
+  // not using a vector. When using an arena, `clear()` releases the vector to
+  // the arena, so the set must be cleared (or destroyed) before the arena is
+  // reset. `ElementType` must be trivially destructible.
+  void SetArena(Arena* arena) {
+    VIXL_ASSERT((arena == arena_) || !IsUsingVector());
+    arena_ = arena;
+  }
+
   typedef ElementType _ElementType;
   typedef KeyType _KeyType;
+  typedef std::vector<ElementType, ArenaAllocator<ElementType> > VectorType;
 
  protected:
   // Returns a pointer to the element in vector_ if it was found, or NULL
@@ -212,7 +224,10 @@ class InvalSet {
   // Elements are only invalidated when using the vector. The preallocated
   // storage always only contains valid elements.
   ElementType preallocated_[kNPreallocatedElements];
-  std::vector<ElementType>* vector_;
+  VectorType* vector_;
+
+  // If not NULL, the vector and its storage are allocated from this arena.
+  Arena* arena_;
 
   // Iterators acquire and release this monitor. While a set is acquired,
   // certain operations are illegal to ensure that the iterator will
@@ -307,7 +322,7 @@ class InvalSetIterator {
   // Used when looking at the preallocated elements, or in debug mode when using
   // the vector to track how many times the iterator has advanced.
   size_t index_;
-  typename std::vector<ElementType>::iterator iterator_;
+  typename S::VectorType::iterator iterator_;
   S* inval_set_;
 
   // TODO: These helpers are deprecated and will be removed in future versions
@@ -319,7 +334,11 @@ class InvalSetIterator {
 
 template <TEMPLATE_INVALSET_P_DECL>
 InvalSet<TEMPLATE_INVALSET_P_DEF>::InvalSet()
-    : valid_cached_min_(false), sorted_(true), size_(0), vector_(NULL) {
+    : valid_cached_min_(false),
+      sorted_(true),
+      size_(0),
+      vector_(NULL),
+      arena_(NULL) {
 #ifdef VIXL_DEBUG
   monitor_ = 0;
 #endif
@@ -327,11 +346,16 @@ InvalSet<TEMPLATE_INVALSET_P_DEF>::InvalSet()
 
 template <TEMPLATE_INVALSET_P_DECL>
 InvalSet<TEMPLATE_INVALSET_P_DEF>::InvalSet(InvalSet&& other)
-    : valid_cached_min_(false), sorted_(true), size_(0), vector_(NULL) {
+    : valid_cached_min_(false),
+      sorted_(true),
+      size_(0),
+      vector_(NULL),
+      arena_(NULL) {
   VIXL_ASSERT(other.monitor() == 0);
   if (this != &other) {
     sorted_ = other.sorted_;
     size_ = other.size_;
+    arena_ = other.arena_;
 #ifdef VIXL_DEBUG
     monitor_ = 0;
 #endif
@@ -351,7 +375,8 @@ template <TEMPLATE_INVALSET_P_DECL>
 InvalSet<TEMPLATE_INVALSET_P_DEF>::~InvalSet()
     VIXL_NEGATIVE_TESTING_ALLOW_EXCEPTION {
   VIXL_ASSERT(monitor_ == 0);
-  delete vector_;
+  // Arena-allocated vectors are released with the arena.
+  if (arena_ == NULL) delete vector_;
 }
 
 
@@ -384,8 +409,16 @@ void InvalSet<TEMPLATE_INVALSET_P_DEF>::insert(const ElementType& element) {
       preallocated_[size_] = element;
     } else {
       // Transition to using the vector.
-      vector_ =
-          new std::vector<ElementType>(preallocated_, preallocated_ + size_);
+      if (arena_ == NULL) {
+        vector_ = new VectorType(preallocated_, preallocated_ + size_);
+      } else {
+        void* storage =
+            arena_->Allocate(sizeof(VectorType), alignof(VectorType));
+        vector_ = new (storage)
+            VectorType(preallocated_,
+                       preallocated_ + size_,
+                       ArenaAllocator<ElementType>(arena_));
+      }
       vector_->push_back(element);
     }
   }
@@ -453,7 +486,13 @@ void InvalSet<TEMPLATE_INVALSET_P_DEF>::clear() {
   VIXL_ASSERT(monitor() == 0);
   size_ = 0;
   if (IsUsingVector()) {
-    vector_->clear();
+    if (arena_ == NULL) {
+      vector_->clear();
+    } else {
+      // Go back to the preallocated elements rather than keep pointers into
+      // the arena, which the user may reset once the set is empty.
+      vector_ = NULL;
+    }
   }
   SetSorted(true);
   valid_cached_min_ = false;
@@ -645,7 +684,7 @@ const ElementType InvalSet<TEMPLATE_INVALSET_P_DEF>::CleanBack() {
   VIXL_ASSERT(monitor() == 0);
   if (IsUsingVector()) {
     // Delete the invalid trailing elements.
-    typename std::vector<ElementType>::reverse_iterator it = vector_->rbegin();
+    typename VectorType::reverse_iterator it = vector_->rbegin();
     while (!IsValid(*it)) {
       it++;
     }
@@ -762,7 +801,7 @@ InvalSetIterator<S>::InvalSetIterator(S* inval_set)
     inval_set->Acquire();
 #endif
     if (using_vector_) {
-      iterator_ = typename std::vector<ElementType>::iterator(
+      iterator_ = typename S::VectorType::iterator(
           inval_set_->vector_->begin());
     }
     MoveToValidElement();
@@ -895,7 +934,7 @@ bool InvalSetIterator<S>::operator==(const InvalSetIterator<S>& rhs) const {
     equal = equal && (index_ == rhs.index_);
 #ifdef DEBUG
     // If not using_vector_, iterator_ should be default-initialised.
-    typename std::vector<ElementType>::iterator default_iterator;
+    typename S::VectorType::iterator default_iterator;
     VIXL_ASSERT(iterator_ == default_iterator);
     VIXL_ASSERT(rhs.iterator_ == default_iterator);
 #endif
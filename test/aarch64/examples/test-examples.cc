@@ -617,6 +617,57 @@ TEST(runtime_calls) {
 
 #endif  // VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT
 
+TEST(round_robin) {
+  MacroAssembler masm;
+  Decoder decoder;
+  Simulator simulator(&decoder);
+
+  Label sum_rec;
+  masm.Bind(&sum_rec);
+  GenerateSumRec(&masm);
+  masm.FinalizeCode();
+  const Instruction* function = masm.GetLabelAddress<Instruction*>(&sum_rec);
+
+  const uint64_t inputs[] = {0, 1, 2, 10, 100, 42, 250, 7};
+  const int count = sizeof(inputs) / sizeof(inputs[0]);
+
+  // A thread should produce the same result whatever the time slice, including
+  // when it is switched out after every instruction.
+  const uint64_t quanta[] = {1, 3, 16, 1000};
+  for (uint64_t quantum : quanta) {
+    uint64_t results[count];
+    int switches =
+        RunRoundRobin(&simulator, function, inputs, results, count, quantum);
+    for (int i = 0; i < count; i++) {
+      VIXL_CHECK(results[i] == (inputs[i] * (inputs[i] + 1)) / 2);
+    }
+    VIXL_CHECK(switches >= count);
+  }
+
+  // The simulator's own state is restored after the threads have run.
+  simulator.WriteXRegister(0, 20);
+  simulator.RunFrom(function);
+  VIXL_CHECK(simulator.ReadXRegister(0) == 210);
+}
+
+TEST(fuzz_coverage) {
+  MacroAssembler masm;
+
+  Label check_magic;
+  masm.Bind(&check_magic);
+  GenerateCheckMagic(&masm);
+  masm.FinalizeCode();
+  const Instruction* function =
+      masm.GetLabelAddress<Instruction*>(&check_magic);
+
+  // Coverage feedback finds the four bytes one at a time. Without it, finding
+  // them would take around 2^32 runs.
+  for (uint32_t seed : {1U, 42U, 0xdeadbeefU}) {
+    int runs = FuzzCheckMagic(function, seed, 100000);
+    VIXL_CHECK(runs > 0);
+  }
+}
+
 TEST(sve_strlen) {
   START();
 
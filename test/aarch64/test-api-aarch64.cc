@@ -24,10 +24,16 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <string>
 #include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 #include "test-runner.h"
 #include "test-utils.h"
@@ -35,6 +41,7 @@
 #include "aarch64/macro-assembler-aarch64.h"
 #include "aarch64/registers-aarch64.h"
 #include "aarch64/simulator-aarch64.h"
+#include "aarch64/simulator-batch-aarch64.h"
 #include "aarch64/test-utils-aarch64.h"
 
 #define __ masm.
@@ -698,6 +705,94 @@ TEST(move_immediate_helpers) {
 }
 
 
+// Decode the n, imm_s and imm_r fields of a logical immediate independently
+// of the Assembler and Instruction helpers. Return the value replicated across
+// `width` bits, or zero if the fields are not the canonical encoding of a
+// `width`-bit value, because the pattern is wider than `width`, all of its bits
+// are set, or the unused bits of imm_r are not zero.
+static uint64_t DecodeLogicalImmediate(unsigned n,
+                                       unsigned imm_s,
+                                       unsigned imm_r,
+                                       unsigned width) {
+  unsigned type = (n << 6) | (~imm_s & 0x3f);
+  if (type < 2) return 0;
+  unsigned size = 1 << HighestSetBitPosition(type);
+  unsigned mask = size - 1;
+  if ((size > width) || ((imm_s & mask) == mask) || ((imm_r & ~mask) != 0)) {
+    return 0;
+  }
+  uint64_t pattern = GetUintMask((imm_s & mask) + 1);
+  pattern = RotateRight(pattern, imm_r, size);
+  uint64_t value = 0;
+  for (unsigned i = 0; i < width; i += size) {
+    value |= pattern << i;
+  }
+  return value;
+}
+
+
+TEST(is_imm_logical) {
+  const unsigned kWidths[] = {kBRegSize, kHRegSize, kSRegSize, kDRegSize};
+  const int kExpectedCounts[] = {70, 310, 1302, 5334};
+  for (unsigned i = 0; i < ArrayLength(kWidths); i++) {
+    unsigned width = kWidths[i];
+    uint64_t width_mask = GetUintMask(width);
+
+    // Every canonical encoding is found again from its value.
+    std::vector<uint64_t> valid;
+    for (unsigned n = 0; n <= 1; n++) {
+      for (unsigned imm_s = 0; imm_s < 64; imm_s++) {
+        for (unsigned imm_r = 0; imm_r < 64; imm_r++) {
+          uint64_t value = DecodeLogicalImmediate(n, imm_s, imm_r, width);
+          if (value == 0) continue;
+          valid.push_back(value);
+          unsigned out_n = 0;
+          unsigned out_imm_s = 0;
+          unsigned out_imm_r = 0;
+          VIXL_CHECK(Assembler::IsImmLogical(value,
+                                             width,
+                                             &out_n,
+                                             &out_imm_s,
+                                             &out_imm_r));
+          VIXL_CHECK(out_n == n);
+          VIXL_CHECK(out_imm_s == imm_s);
+          VIXL_CHECK(out_imm_r == imm_r);
+          VIXL_CHECK(Assembler::IsImmLogical(value, width));
+        }
+      }
+    }
+    std::sort(valid.begin(), valid.end());
+    VIXL_CHECK(std::unique(valid.begin(), valid.end()) == valid.end());
+    VIXL_CHECK(static_cast<int>(valid.size()) == kExpectedCounts[i]);
+
+    // Values one bit away from a logical immediate are only accepted if they
+    // are logical immediates themselves.
+    for (uint64_t value : valid) {
+      for (unsigned bit = 0; bit < width; bit++) {
+        uint64_t flipped = value ^ (UINT64_C(1) << bit);
+        bool expected =
+            std::binary_search(valid.begin(), valid.end(), flipped);
+        VIXL_CHECK(Assembler::IsImmLogical(flipped, width) == expected);
+      }
+    }
+
+    VIXL_CHECK(!Assembler::IsImmLogical(0, width));
+    VIXL_CHECK(!Assembler::IsImmLogical(width_mask, width));
+
+    // Only the low `width` bits of the value are considered.
+    uint64_t seed = 0x0123456789abcdef;
+    for (int j = 0; j < 10000; j++) {
+      seed = (seed * 6364136223846793005) + 1442695040888963407;
+      uint64_t value = seed ^ (seed >> 29);
+      bool expected = std::binary_search(valid.begin(),
+                                         valid.end(),
+                                         value & width_mask);
+      VIXL_CHECK(Assembler::IsImmLogical(value, width) == expected);
+    }
+  }
+}
+
+
 TEST(generic_operand_helpers) {
   GenericOperand invalid_1;
   GenericOperand invalid_2;
@@ -1765,6 +1860,43 @@ TEST(sim_stack) {
   VIXL_CHECK(s.IsAccessInGuardRegion(s.GetLimit() - 1280, 10000));
 }
 
+#ifndef _WIN32
+TEST(sim_stack_host_guard_pages) {
+  SimStack builder;
+  builder.SetUseHostGuardPages(true);
+  builder.SetBaseGuardSize(42);
+  builder.SetLimitGuardSize(2049);
+  // The usable stack is committed lazily, so this should be cheap.
+  builder.SetUsableSize(256 * MBytes);
+  SimStack::Allocated s = builder.Allocate();
+  VIXL_CHECK(s.HasHostGuardPages());
+
+  // All sizes are rounded up to the host page size.
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  uintptr_t base = reinterpret_cast<uintptr_t>(s.GetBase());
+  uintptr_t limit = reinterpret_cast<uintptr_t>(s.GetLimit());
+  VIXL_CHECK(IsAligned(base, page_size));
+  VIXL_CHECK(IsAligned(limit + 1, page_size));
+  VIXL_CHECK((s.GetBase() - s.GetLimit() - 1) == (256 * MBytes));
+
+  VIXL_CHECK(s.IsAccessInGuardRegion(s.GetBase(), 1));
+  VIXL_CHECK(s.IsAccessInGuardRegion(s.GetBase() + page_size - 1, 1));
+  VIXL_CHECK(!s.IsAccessInGuardRegion(s.GetBase() - 1, 1));
+  VIXL_CHECK(s.IsAccessInGuardRegion(s.GetLimit(), 1));
+  VIXL_CHECK(s.IsAccessInGuardRegion(s.GetLimit() + 1 - page_size, 1));
+  VIXL_CHECK(!s.IsAccessInGuardRegion(s.GetLimit() + 1, 1));
+
+  // The extremes of the usable stack are writable and start off zeroed.
+  VIXL_CHECK(s.GetBase()[-1] == 0);
+  VIXL_CHECK(s.GetLimit()[1] == 0);
+  s.GetBase()[-1] = 42;
+  s.GetLimit()[1] = 42;
+
+  SimStack::Allocated heap_stack = SimStack().Allocate();
+  VIXL_CHECK(!heap_stack.HasHostGuardPages());
+}
+#endif
+
 void AllocateAndFreeGCS() {
   Decoder d;
   Simulator s(&d);
@@ -1782,7 +1914,317 @@ TEST(sim_gcs_manager) {
   t1.join();
   t2.join();
 }
+
+TEST(sim_batch) {
+  // int64_t f(int64_t a, int32_t b, double c): a * 3 + b, using the stack and
+  // clobbering lr to check that calls do not interfere with each other.
+  MacroAssembler masm;
+  masm.Push(x0, x1);
+  masm.Mov(x3, x30);
+  masm.Mov(x30, 0xbad);
+  masm.Fcvtzs(x2, d0);
+  masm.Pop(x1, x0);
+  masm.Add(x0, x0, Operand(x0, LSL, 1));
+  masm.Add(x0, x0, Operand(w1, SXTW));
+  masm.Add(x0, x0, x2);
+  masm.Ret(x3);
+  masm.FinalizeCode();
+
+  const size_t kCount = 1000;
+  std::vector<std::tuple<int64_t, int32_t, double>> arguments;
+  for (size_t i = 0; i < kCount; i++) {
+    int64_t a = static_cast<int64_t>(i) - 500;
+    arguments.emplace_back(a, -static_cast<int32_t>(i), (i % 2) * 0.5);
+  }
+
+  for (unsigned threads : {1, 3, 8}) {
+    BatchSimulator batch(threads);
+    VIXL_CHECK(batch.GetThreadCount() == threads);
+
+    std::vector<int64_t> results(kCount, 0);
+    batch.Run(*masm.GetBuffer(),
+              0,
+              arguments.data(),
+              results.data(),
+              arguments.size());
+    for (size_t i = 0; i < kCount; i++) {
+      int64_t a = std::get<0>(arguments[i]);
+      int32_t b = std::get<1>(arguments[i]);
+      VIXL_CHECK(results[i] == (a * 3) + b);
+    }
+  }
+}
+
+TEST(sim_batch_independent_calls) {
+  // int64_t f(int64_t a): a + x9 + (Z ? 1 : 0), then leave a in x9 and the Z
+  // flag set. Each call must see the reset value of x9 and clear flags.
+  MacroAssembler masm;
+  masm.Cset(x1, eq);
+  masm.Add(x1, x1, x9);
+  masm.Mov(x9, x0);
+  masm.Add(x0, x0, x1);
+  masm.Cmp(x0, x0);
+  masm.Ret();
+  masm.FinalizeCode();
+
+  const size_t kCount = 100;
+  std::vector<std::tuple<int64_t>> arguments;
+  for (size_t i = 0; i < kCount; i++) {
+    arguments.emplace_back(static_cast<int64_t>(i));
+  }
+
+  BatchSimulator batch(1);
+  std::vector<int64_t> results(kCount, 0);
+  batch.Run(*masm.GetBuffer(),
+            0,
+            arguments.data(),
+            results.data(),
+            arguments.size());
+  for (size_t i = 0; i < kCount; i++) {
+    VIXL_CHECK(results[i] == static_cast<int64_t>(i + 0xbadbeef));
+  }
+}
+
+TEST(sim_reset_state) {
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.WriteXRegister(0, 42);
+  simulator.DisableGCSCheck();
+
+  // Both resets restore the registers, but only ResetState() restores the
+  // configuration.
+  simulator.ResetArchitecturalState();
+  VIXL_CHECK(simulator.ReadXRegister(0) == 0xbadbeef);
+  VIXL_CHECK(!simulator.IsGCSCheckEnabled());
+
+  simulator.WriteXRegister(0, 42);
+  simulator.ResetState();
+  VIXL_CHECK(simulator.ReadXRegister(0) == 0xbadbeef);
+  VIXL_CHECK(simulator.IsGCSCheckEnabled());
+}
 #endif
 
+static void GenerateArenaTestCode(MacroAssembler* masm) {
+  // Link labels from more branches than they have preallocated links for, load
+  // a few literals, and emit enough code for the TBZs to need veneers.
+  Label near, far;
+  for (int i = 0; i < 3 * Label::kNPreallocatedLinks; i++) {
+    masm->Cbz(x0, &near);
+    masm->Tbz(x1, i, &far);
+    masm->Ldr(x2, 0x0123456789abcdef + i);
+    masm->Ldr(d3, 1.0 + i);
+  }
+  masm->Bind(&near);
+  for (int i = 0; i < 10000; i++) {
+    masm->Add(x0, x0, 1);
+  }
+  masm->Bind(&far);
+  masm->Ret();
+  masm->FinalizeCode();
+}
+
+TEST(arena) {
+  // Use small blocks so that the arena needs several of them.
+  Arena arena(1 * KBytes);
+  MacroAssembler masm(PositionIndependentCode, &arena);
+  MacroAssembler ref_masm;
+  VIXL_CHECK(masm.GetArena() == &arena);
+  VIXL_CHECK(ref_masm.GetArena() == NULL);
+
+  for (int i = 0; i < 3; i++) {
+    masm.Reset();
+    ref_masm.Reset();
+    arena.Reset();
+
+    GenerateArenaTestCode(&masm);
+    GenerateArenaTestCode(&ref_masm);
+    VIXL_CHECK(arena.GetAllocatedSize() > 0);
+
+    // The arena must not affect the generated code.
+    size_t size = masm.GetSizeOfCodeGenerated();
+    VIXL_CHECK(size == ref_masm.GetSizeOfCodeGenerated());
+    VIXL_CHECK(memcmp(masm.GetBuffer()->GetStartAddress<byte*>(),
+                      ref_masm.GetBuffer()->GetStartAddress<byte*>(),
+                      size) == 0);
+  }
+}
+
+#if (defined(VIXL_INCLUDE_SIMULATOR_AARCH64) || defined(__aarch64__)) && \
+    defined(VIXL_CODE_BUFFER_MMAP) && defined(__linux__)
+static int64_t RunFromExecutableView(const CodeBuffer& buffer, int64_t arg) {
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.WriteXRegister(0, arg);
+  simulator.RunFrom(buffer.GetExecutableStartAddress<Instruction*>());
+  return simulator.ReadXRegister(0);
+#else
+  CPU::EnsureIAndDCacheCoherency(buffer.GetExecutableStartAddress<void*>(),
+                                 buffer.GetSizeInBytes());
+  return buffer.GetExecutableStartAddress<int64_t (*)(int64_t)>()(arg);
+#endif
+}
+
+TEST(dual_mapped_code_buffer) {
+  MacroAssembler masm;
+  masm.GetBuffer()->EnableDualMapping();
+  masm.Add(x0, x0, 1);
+  masm.Ret();
+  masm.FinalizeCode();
+
+  CodeBuffer* buffer = masm.GetBuffer();
+  buffer->SetExecutable();
+  VIXL_CHECK(RunFromExecutableView(*buffer, 41) == 42);
+
+  // Patch the code through the writable view, without making the buffer
+  // writable again.
+  MacroAssembler patch;
+  patch.Add(x0, x0, 2);
+  patch.FinalizeCode();
+  buffer->UpdateData(0,
+                     patch.GetBuffer()->GetStartAddress<byte*>(),
+                     patch.GetSizeOfCodeGenerated());
+  masm.FinalizeCode();
+  VIXL_CHECK(RunFromExecutableView(*buffer, 41) == 43);
+}
+#endif
+
+TEST(coalesce_cache_lines) {
+  std::vector<CPU::CodeRange> lines;
+  const size_t kLine = 64;
+  byte* base = reinterpret_cast<byte*>(0x10000);
+
+  // Ranges are unordered, some overlap, some are adjacent once rounded to
+  // cache lines, and empty ranges are ignored.
+  CPU::CodeRange ranges[] = {{base + 0x200, 4},
+                             {base + 0x10, 8},
+                             {base + 0x44, 0x40},
+                             {base + 0x30, 0x20},
+                             {base + 0x500, 0},
+                             {base + 0x1fc, 4}};
+  CPU::CoalesceCacheLines(ranges, ArrayLength(ranges), kLine, &lines);
+  VIXL_CHECK(lines.size() == 2);
+  VIXL_CHECK(lines[0].address == base);
+  VIXL_CHECK(lines[0].length == 0xc0);
+  VIXL_CHECK(lines[1].address == base + 0x1c0);
+  VIXL_CHECK(lines[1].length == 0x80);
+
+  CPU::CoalesceCacheLines(ranges, 0, kLine, &lines);
+  VIXL_CHECK(lines.empty());
+}
+
+TEST(batched_cache_maintenance) {
+  MacroAssembler masm;
+  const int kFunctions = 16;
+  ptrdiff_t offsets[kFunctions];
+  for (int i = 0; i < kFunctions; i++) {
+    offsets[i] = masm.GetCursorOffset();
+    masm.Add(x0, x0, i);
+    masm.Ret();
+  }
+  masm.FinalizeCode();
+  masm.GetBuffer()->SetExecutable();
+
+  CPU::CodeRange ranges[kFunctions];
+  for (int i = 0; i < kFunctions; i++) {
+    ranges[i].address = masm.GetBuffer()->GetOffsetAddress<void*>(offsets[i]);
+    ranges[i].length = 2 * kInstructionSize;
+  }
+  CPU::EnsureIAndDCacheCoherency(ranges, kFunctions);
+
+  for (int i = 0; i < kFunctions; i++) {
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+    Decoder decoder;
+    Simulator simulator(&decoder);
+    simulator.WriteXRegister(0, 100);
+    simulator.RunFrom(
+        masm.GetBuffer()->GetOffsetAddress<Instruction*>(offsets[i]));
+    VIXL_CHECK(simulator.ReadXRegister(0) == (100 + i));
+#elif defined(__aarch64__)
+    int64_t (*function)(int64_t) =
+        masm.GetBuffer()->GetOffsetAddress<int64_t (*)(int64_t)>(offsets[i]);
+    VIXL_CHECK(function(100) == (100 + i));
+#endif
+  }
+}
+
+// Generate a function returning `0x0123456789abcdef + (2 * index) + 64`, using
+// a literal. Some of the functions are large enough to need a veneer.
+static void GenerateSharedBufferFunction(MacroAssembler* masm, int index) {
+  Label done;
+  masm->Mov(x1, 0);
+  masm->Ldr(x0, 0x0123456789abcdef + index);
+  masm->Tbnz(x1, 0, &done);
+  int count = ((index % 4) == 0) ? (10 * KBytes) : 64;
+  for (int i = 0; i < count; i++) {
+    masm->Add(x0, x0, 1);
+  }
+  masm->Sub(x0, x0, count - index - 64);
+  masm->Bind(&done);
+  masm->Ret();
+  masm->FinalizeCode();
+}
+
+TEST(shared_code_buffer) {
+  const int kThreads = 4;
+  const int kFunctionsPerThread = 8;
+  const int kFunctions = kThreads * kFunctionsPerThread;
+  SharedCodeBuffer shared(2 * MBytes);
+  byte* starts[kFunctions];
+  size_t sizes[kFunctions];
+
+  // Start with tiny chunks, so that they have to grow.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.push_back(std::thread([&shared, &starts, &sizes, t]() {
+      for (int i = t; i < kFunctions; i += kThreads) {
+        MacroAssembler masm(&shared, 64);
+        GenerateSharedBufferFunction(&masm, i);
+        starts[i] = masm.GetBuffer()->GetStartAddress<byte*>();
+        sizes[i] = masm.GetSizeOfCodeGenerated();
+      }
+    }));
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  for (int i = 0; i < kFunctions; i++) {
+    // The code, including literal pools and veneers, must be the same as if
+    // it had been generated into a private buffer.
+    MacroAssembler ref_masm;
+    GenerateSharedBufferFunction(&ref_masm, i);
+    VIXL_CHECK(sizes[i] == ref_masm.GetSizeOfCodeGenerated());
+    VIXL_CHECK(memcmp(starts[i],
+                      ref_masm.GetBuffer()->GetStartAddress<byte*>(),
+                      sizes[i]) == 0);
+
+    // Functions must not overlap.
+    VIXL_CHECK(starts[i] >= shared.GetStartAddress<byte*>());
+    VIXL_CHECK((starts[i] + sizes[i]) <=
+               (shared.GetStartAddress<byte*>() + shared.GetUsedBytes()));
+    for (int j = 0; j < i; j++) {
+      VIXL_CHECK(((starts[i] + sizes[i]) <= starts[j]) ||
+                 ((starts[j] + sizes[j]) <= starts[i]));
+    }
+  }
+
+  shared.SetExecutable();
+  for (int i = 0; i < kFunctions; i++) {
+    int64_t expected = 0x0123456789abcdef + (2 * i) + 64;
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+    Decoder decoder;
+    Simulator simulator(&decoder);
+    simulator.RunFrom(reinterpret_cast<Instruction*>(starts[i]));
+    VIXL_CHECK(simulator.ReadXRegister(0) == expected);
+#elif defined(__aarch64__)
+    CPU::EnsureIAndDCacheCoherency(starts[i], sizes[i]);
+    VIXL_CHECK(reinterpret_cast<int64_t (*)()>(starts[i])() == expected);
+#else
+    USE(expected);
+#endif
+  }
+  shared.SetWritable();
+}
+
+
 }  // namespace aarch64
 }  // namespace vixl
@@ -4306,6 +4306,64 @@ TEST(ldr_literal) {
 }
 
 
+TEST(ldr_literal_dedup_and_alignment) {
+  SETUP_WITH_FEATURES(CPUFeatures::kNEON, CPUFeatures::kFP);
+
+  START();
+  ptrdiff_t x_loads[2][2];
+  ptrdiff_t q_loads[2];
+  for (int i = 0; i < 2; i++) {
+    // Try both alignments for the start of the pool.
+    masm.EmitLiteralPool(LiteralPool::kBranchRequired);
+    if (i == 1) __ Nop();
+    ASSERT_LITERAL_POOL_SIZE(0);
+
+    // Loads of the same value share a literal, whatever the type of the
+    // register.
+    __ Ldr(w1, 0x3fc00000);
+    __ Ldr(x0, 0x0123456789abcdef);
+    x_loads[i][0] = masm.GetCursorOffset() - kInstructionSize;
+    __ Ldr(s2, 1.5f);
+    __ Ldr(q3, 0xfedcba9876543210, 0x0123456789abcdef);
+    q_loads[i] = masm.GetCursorOffset() - kInstructionSize;
+    __ Ldr(x4, 0x0123456789abcdef);
+    x_loads[i][1] = masm.GetCursorOffset() - kInstructionSize;
+    __ Ldr(q5, 0xfedcba9876543210, 0x0123456789abcdef);
+    __ Ldrsw(x6, 0x3fc00000);
+    ASSERT_LITERAL_POOL_SIZE(4 + 8 + 16);
+  }
+  END();
+
+  for (int i = 0; i < 2; i++) {
+    Instruction* x_load_0 =
+        masm.GetBuffer()->GetOffsetAddress<Instruction*>(x_loads[i][0]);
+    Instruction* x_load_1 =
+        masm.GetBuffer()->GetOffsetAddress<Instruction*>(x_loads[i][1]);
+    Instruction* q_load =
+        masm.GetBuffer()->GetOffsetAddress<Instruction*>(q_loads[i]);
+    uintptr_t x_literal = x_load_0->GetLiteralAddress<uintptr_t>();
+    uintptr_t q_literal = q_load->GetLiteralAddress<uintptr_t>();
+    VIXL_CHECK(x_load_1->GetLiteralAddress<uintptr_t>() == x_literal);
+    // The larger literals are placed first, aligned using the 32-bit literal
+    // if necessary.
+    VIXL_CHECK(IsAligned(x_literal, kXRegSizeInBytes));
+    VIXL_CHECK(IsAligned(q_literal, kXRegSizeInBytes));
+  }
+
+  if (CAN_RUN()) {
+    RUN();
+
+    ASSERT_EQUAL_64(0x0123456789abcdef, x0);
+    ASSERT_EQUAL_64(0x3fc00000, x1);
+    ASSERT_EQUAL_FP32(1.5f, s2);
+    ASSERT_EQUAL_128(0xfedcba9876543210, 0x0123456789abcdef, q3);
+    ASSERT_EQUAL_64(0x0123456789abcdef, x4);
+    ASSERT_EQUAL_128(0xfedcba9876543210, 0x0123456789abcdef, q5);
+    ASSERT_EQUAL_64(0x3fc00000, x6);
+  }
+}
+
+
 TEST(ldr_literal_range) {
   SETUP_WITH_FEATURES(CPUFeatures::kNEON);
 
@@ -6198,6 +6256,69 @@ TEST(flags) {
 }
 
 
+// Check the flags set by W and X operations, read through conditions, as a
+// value and as a carry input.
+TEST(flags_mixed_reads) {
+  SETUP();
+
+  START();
+  __ Mov(x0, 0xffffffff80000000);
+  __ Mov(x1, 0x0000000100000000);
+  __ Mov(x2, 0);
+  // W-sized results only look at the low 32 bits.
+  __ Tst(w0, 0x80000000);
+  __ Cset(x10, mi);
+  __ Cset(x11, ne);
+  __ Tst(w1, w1);
+  __ Cset(x12, eq);
+  __ Cset(x13, pl);
+  __ Adds(w3, w0, w0);
+  __ Cset(x14, eq);
+  __ Cset(x15, vs);
+  __ Cset(x16, cs);
+  // Reading the flags as a value and as a carry input.
+  __ Cmp(x2, 1);
+  __ Mrs(x17, NZCV);
+  __ Adc(x18, x2, x2);
+  __ Ands(x2, x2, x2);
+  __ Adc(x19, x2, x2);
+  // A conditional compare that fails sets the flags to its NZCV immediate.
+  __ Cmp(x1, x1);
+  __ Ccmp(x0, x1, NVFlag, ne);
+  __ Cset(x20, lt);
+  __ Cset(x21, vs);
+  // Branches.
+  Label not_taken, done;
+  __ Mov(x22, 0);
+  __ Subs(x3, x1, 1);
+  __ B(&not_taken, lt);
+  __ B(&done, hi);
+  __ Bind(&not_taken);
+  __ Mov(x22, 1);
+  __ Bind(&done);
+  END();
+
+  if (CAN_RUN()) {
+    RUN();
+
+    ASSERT_EQUAL_64(1, x10);
+    ASSERT_EQUAL_64(1, x11);
+    ASSERT_EQUAL_64(1, x12);
+    ASSERT_EQUAL_64(1, x13);
+    ASSERT_EQUAL_64(1, x14);
+    ASSERT_EQUAL_64(1, x15);
+    ASSERT_EQUAL_64(1, x16);
+    ASSERT_EQUAL_64(NFlag, x17);
+    ASSERT_EQUAL_64(0, x18);
+    ASSERT_EQUAL_64(0, x19);
+    ASSERT_EQUAL_64(0, x20);
+    ASSERT_EQUAL_64(1, x21);
+    ASSERT_EQUAL_64(0, x22);
+    ASSERT_EQUAL_NZCV(CFlag);
+  }
+}
+
+
 TEST(cmp_shift) {
   SETUP();
 
@@ -13052,6 +13173,62 @@ TEST(crc32cx) {
   }
 }
 
+TEST(crc32_check_values) {
+  SETUP_WITH_FEATURES(CPUFeatures::kCRC32);
+
+  // The standard CRC-32 and CRC-32C check values are the checksums of the
+  // string "123456789", computed with an initial value and final XOR of ~0.
+  const char* msg = "123456789";
+  uint64_t msg_lo;
+  uint8_t msg_hi;
+  memcpy(&msg_lo, msg, sizeof(msg_lo));
+  memcpy(&msg_hi, msg + sizeof(msg_lo), sizeof(msg_hi));
+
+  START();
+
+  __ Mov(x0, msg_lo);
+  __ Mov(x1, msg_hi);
+  __ Lsr(x2, x0, 32);
+  __ Lsr(x3, x0, 48);
+
+  // Process the message with the widest accesses.
+  __ Mov(w10, UINT32_MAX);
+  __ Crc32x(w10, w10, x0);
+  __ Crc32b(w10, w10, w1);
+  __ Mvn(w10, w10);
+
+  __ Mov(w11, UINT32_MAX);
+  __ Crc32cx(w11, w11, x0);
+  __ Crc32cb(w11, w11, w1);
+  __ Mvn(w11, w11);
+
+  // Process the message in word, halfword and byte chunks.
+  __ Mov(w12, UINT32_MAX);
+  __ Crc32w(w12, w12, w0);
+  __ Crc32h(w12, w12, w2);
+  __ Crc32h(w12, w12, w3);
+  __ Crc32b(w12, w12, w1);
+  __ Mvn(w12, w12);
+
+  __ Mov(w13, UINT32_MAX);
+  __ Crc32cw(w13, w13, w0);
+  __ Crc32ch(w13, w13, w2);
+  __ Crc32ch(w13, w13, w3);
+  __ Crc32cb(w13, w13, w1);
+  __ Mvn(w13, w13);
+
+  END();
+
+  if (CAN_RUN()) {
+    RUN();
+
+    ASSERT_EQUAL_64(0xcbf43926, x10);
+    ASSERT_EQUAL_64(0xe3069283, x11);
+    ASSERT_EQUAL_64(0xcbf43926, x12);
+    ASSERT_EQUAL_64(0xe3069283, x13);
+  }
+}
+
 TEST(regress_cmp_shift_imm) {
   SETUP();
 
@@ -13454,6 +13631,166 @@ TEST(veneers_hanging) {
 }
 
 
+TEST(veneers_shared) {
+  SETUP();
+  START();
+
+  // Branches to the same label share veneers, both when the veneers are
+  // emitted in the same pool and when the branches are generated after a
+  // veneer for the label already exists.
+  const int kBranchCount = 10;
+  Label target, first_retry, second_retry, done;
+
+  __ Mov(x0, 0);
+  __ Mov(x1, 0);
+  for (int i = 0; i < kBranchCount; i++) {
+    __ Tbz(x0, 0, &target);
+  }
+  VIXL_CHECK(masm.GetNumberOfPotentialVeneers() == kBranchCount);
+
+  // Generate code until the veneer pool is emitted. We expect a branch over the
+  // pool, a single veneer, and the nop itself.
+  ptrdiff_t last_offset;
+  do {
+    last_offset = masm.GetCursorOffset();
+    __ Nop();
+  } while (masm.GetNumberOfPotentialVeneers() > 0);
+  VIXL_CHECK((masm.GetCursorOffset() - last_offset) == (3 * kInstructionSize));
+
+  // These branches can reach the veneer, so they don't need their own.
+  __ Bind(&first_retry);
+  __ Cbz(x0, &target);
+  __ Bind(&second_retry);
+  __ Tbz(x0, 0, &target);
+  VIXL_CHECK(masm.GetNumberOfPotentialVeneers() == 0);
+  __ B(&done);
+
+  __ Bind(&target);
+  __ Add(x1, x1, 1);
+  __ Cmp(x1, 1);
+  __ B(eq, &first_retry);
+  __ Cmp(x1, 2);
+  __ B(eq, &second_retry);
+  __ Bind(&done);
+
+  END();
+  if (CAN_RUN()) {
+    RUN();
+
+    ASSERT_EQUAL_64(3, x1);
+  }
+}
+
+
+TEST(branch_relaxation) {
+  SETUP();
+  START();
+
+  const int max_range = Instruction::GetImmBranchForwardRange(TestBranchType);
+  const int far_count = max_range / kInstructionSize + 100;
+  Label region, before, back, after;
+  Label loop, near, far;
+
+  __ Mov(x1, 1);
+  __ Mov(x2, 0);
+  __ Mov(x10, 0);
+  __ Mov(x11, 0);
+  __ Mov(x12, 0);
+  __ Mov(x13, 0);
+  __ Mov(x14, 0);
+  __ B(&region);
+
+  __ Bind(&before);
+  __ Mov(x14, 7);
+  __ B(&back);
+
+  __ Bind(&region);
+  ptrdiff_t region_start;
+  {
+    BranchRelaxationScope relaxation(&masm);
+    region_start = masm.GetCursorOffset();
+
+    // A backward branch to a label bound in the region.
+    __ Bind(&loop);
+    __ Add(x10, x10, 1);
+    __ Cmp(x10, 3);
+    __ B(lt, &loop);
+
+    // A forward branch to a label bound in the region, in range.
+    __ Cbz(x2, &near);
+    __ Mov(x11, 1);
+    __ Bind(&near);
+
+    // A forward branch to a label bound in the region, out of range.
+    __ Tbnz(x1, 0, &far);
+    for (int i = 0; i < far_count; i++) {
+      __ Add(x13, x13, 1);
+    }
+    __ Bind(&far);
+    __ Mov(x12, 42);
+
+    // Branches to labels bound before and after the region.
+    __ Cbnz(x1, &before);
+    __ Bind(&back);
+    __ Tbz(x2, 0, &after);
+    __ Mov(x12, 0);
+  }
+  // Only the TBNZ needed the long form. No veneers were emitted in the region,
+  // and only the branch to `after` may still need one.
+  const int raw_count = 2 + 1 + far_count + 1 + 1;
+  const int branch_count = 1 + 1 + 2 + 1 + 1;
+  VIXL_CHECK((masm.GetCursorOffset() - region_start) ==
+             (raw_count + branch_count) * kInstructionSize);
+  VIXL_CHECK(masm.GetNumberOfPotentialVeneers() == 1);
+  __ Bind(&after);
+  VIXL_CHECK(masm.GetNumberOfPotentialVeneers() == 0);
+
+  END();
+  if (CAN_RUN()) {
+    RUN();
+
+    ASSERT_EQUAL_64(3, x10);
+    ASSERT_EQUAL_64(0, x11);
+    ASSERT_EQUAL_64(42, x12);
+    ASSERT_EQUAL_64(0, x13);
+    ASSERT_EQUAL_64(7, x14);
+  }
+}
+
+#ifdef VIXL_NEGATIVE_TESTING
+TEST(branch_relaxation_negative_test) {
+  SETUP();
+  START();
+
+  // PC-relative macros and literals are rejected as soon as they are used in
+  // a region, since its code moves when it is laid out.
+  Label label;
+  __ Bind(&label);
+  {
+    BranchRelaxationScope relaxation(&masm);
+    __ Mov(x0, 0);
+    MUST_FAIL_WITH_MESSAGE(__ Adr(x1, &label),
+                           "Assertion failed (!IsRelaxingBranches())");
+    MUST_FAIL_WITH_MESSAGE(__ Bl(&label),
+                           "Assertion failed (!IsRelaxingBranches())");
+    MUST_FAIL_WITH_MESSAGE(__ Ldr(x1, 0x0123456789abcdef),
+                           "Assertion failed (!IsRelaxingBranches())");
+    MUST_FAIL_WITH_MESSAGE(__ Fmov(d1, 1.1),
+                           "Assertion failed (!IsRelaxingBranches())");
+    MUST_FAIL_WITH_MESSAGE(__ MovExternalAddress(x1, 0, 0),
+                           "Assertion failed (!IsRelaxingBranches())");
+    __ Mov(x0, 1);
+  }
+
+  END();
+  if (CAN_RUN()) {
+    RUN();
+    ASSERT_EQUAL_64(1, x0);
+  }
+}
+#endif
+
+
 TEST(collision_literal_veneer_pools) {
   SETUP_WITH_FEATURES(CPUFeatures::kFP);
   START();
@@ -14035,6 +14372,88 @@ TEST(runtime_calls) {
 #endif  // #if defined(VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT) || ...
 }
 
+TEST(runtime_calls_alternating_sites) {
+  SETUP();
+
+#ifndef VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT
+  if (masm.GenerateSimulatorCode()) {
+    // See `runtime_calls`.
+    return;
+  }
+#endif
+
+  START();
+
+  // Call two different runtime functions alternately from the same loop. Each
+  // call site must dispatch to its own function.
+  __ Mov(w20, 0);
+  __ Mov(w21, 0);
+  __ Mov(x22, 3);
+  Label loop;
+  __ Bind(&loop);
+  __ Mov(w0, w20);
+  __ CallRuntime(runtime_call_add_one);
+  __ Mov(w20, w0);
+  __ CallRuntime(runtime_call_no_args);
+  __ Add(w21, w21, w0);
+  __ Subs(x22, x22, 1);
+  __ B(ne, &loop);
+
+  END();
+
+#if defined(VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT) || \
+    !defined(VIXL_INCLUDE_SIMULATOR_AARCH64)
+  if (CAN_RUN()) {
+    RUN();
+
+    ASSERT_EQUAL_32(3, w20);
+    ASSERT_EQUAL_32(3, w21);
+  }
+#endif  // #if defined(VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT) || ...
+}
+
+TEST(runtime_calls_in_branch_relaxation) {
+  SETUP();
+
+#ifndef VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT
+  if (masm.GenerateSimulatorCode()) {
+    // See `runtime_calls`.
+    return;
+  }
+#endif
+
+  START();
+
+  // Simulated runtime calls emit their arguments in the instruction stream.
+  // They must be accepted in a branch relaxation region, and moved unchanged
+  // when it is laid out.
+  Label skip, done;
+  __ Mov(w0, 41);
+  __ Mov(x1, 0);
+  __ Mov(w20, 0);
+  {
+    BranchRelaxationScope relaxation(&masm);
+    __ Cbnz(x1, &skip);
+    __ CallRuntime(runtime_call_add_one);
+    __ Mov(w20, w0);
+    __ Bind(&skip);
+    __ Cbz(x1, &done);
+    __ Mov(w20, 0);
+    __ Bind(&done);
+  }
+
+  END();
+
+#if defined(VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT) || \
+    !defined(VIXL_INCLUDE_SIMULATOR_AARCH64)
+  if (CAN_RUN()) {
+    RUN();
+
+    ASSERT_EQUAL_32(42, w20);
+  }
+#endif  // #if defined(VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT) || ...
+}
+
 #ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
 void void_func() {}
 uint32_t uint32_func() { return 2; }
@@ -14105,6 +14524,94 @@ TEST(branch_interception) {
 #endif  // #ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
 #endif  // #ifdef VIXL_HAS_MACROASSEMBLER_RUNTIME_CALL_SUPPORT
 
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+TEST(run_for_and_run_until) {
+  SETUP();
+  START();
+
+  Label loop;
+  __ Mov(x0, 100);
+  __ Mov(x1, 0);
+  __ Bind(&loop);
+  __ Add(x1, x1, 1);
+  __ Subs(x0, x0, 1);
+  __ B(ne, &loop);
+
+  END();
+
+  if (CAN_RUN()) {
+    const Instruction* start = masm.GetBuffer()->GetStartAddress<Instruction*>();
+    simulator.WritePc(start, Simulator::NoBranchLog);
+
+    // The prologue contains no branches, so a small budget stops inside it.
+    VIXL_CHECK(simulator.RunFor(4) == 4);
+    VIXL_CHECK(simulator.ReadPc() > start);
+    VIXL_CHECK(simulator.ReadPc() < masm.GetLabelAddress<Instruction*>(&loop));
+    VIXL_CHECK(simulator.RunFor(0) == 0);
+
+    // Stop in the middle of the loop.
+    simulator.RunUntil(
+        [](const Simulator& sim) { return sim.ReadXRegister(1) == 42; });
+    VIXL_CHECK(!simulator.IsSimulationFinished());
+    VIXL_CHECK(simulator.ReadXRegister(0) == 59);
+
+    // Run to completion.
+    uint64_t executed = simulator.RunFor(UINT64_MAX);
+    VIXL_CHECK(executed > (58 * 3));
+    VIXL_CHECK(simulator.IsSimulationFinished());
+    VIXL_CHECK(simulator.RunFor(10) == 0);
+
+    ASSERT_EQUAL_64(0, x0);
+    ASSERT_EQUAL_64(100, x1);
+  }
+}
+
+TEST(coverage_bitmap) {
+  SETUP();
+  START();
+
+  Label loop;
+  __ Mov(x0, 10);
+  __ Bind(&loop);
+  __ Subs(x0, x0, 1);
+  __ B(ne, &loop);
+
+  END();
+
+  if (CAN_RUN()) {
+    const size_t kBitmapSize = 1024;
+    uint8_t bitmap[kBitmapSize] = {};
+    simulator.SetCoverageBitmap(bitmap, kBitmapSize);
+    RUN();
+
+    // The back edge of the loop is taken nine times.
+    bool found_back_edge = false;
+    for (size_t i = 0; i < kBitmapSize; i++) {
+      if (bitmap[i] == 9) found_back_edge = true;
+    }
+    VIXL_CHECK(found_back_edge);
+
+    // Running again accumulates into the bitmap.
+    uint8_t first[kBitmapSize];
+    memcpy(first, bitmap, kBitmapSize);
+    simulator.ResetArchitecturalState();
+    RUN();
+    for (size_t i = 0; i < kBitmapSize; i++) {
+      VIXL_CHECK(bitmap[i] == static_cast<uint8_t>(2 * first[i]));
+    }
+
+    // Nothing is recorded once coverage is disabled.
+    simulator.SetCoverageBitmap(NULL, 0);
+    simulator.ResetArchitecturalState();
+    RUN();
+    for (size_t i = 0; i < kBitmapSize; i++) {
+      VIXL_CHECK(bitmap[i] == static_cast<uint8_t>(2 * first[i]));
+    }
+    ASSERT_EQUAL_64(0, x0);
+  }
+}
+#endif  // #ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+
 
 TEST(optimised_mov_register) {
   SETUP();
@@ -15561,6 +16068,36 @@ TEST(large_sim_stack) {
   }
 }
 
+#ifndef _WIN32
+TEST(large_sim_stack_host_guard_pages) {
+  SimStack builder;
+  builder.SetUseHostGuardPages(true);
+  builder.SetUsableSize(64 * MBytes);
+  SimStack::Allocated stack = builder.Allocate();
+  uintptr_t base = reinterpret_cast<uintptr_t>(stack.GetBase());
+  uintptr_t limit = reinterpret_cast<uintptr_t>(stack.GetLimit());
+  SETUP_CUSTOM_SIM(std::move(stack));
+  START();
+
+  // Check that we can access the extremes of the stack.
+  __ Mov(x0, base);
+  __ Mov(x1, limit);
+  __ Mov(x2, sp);
+  __ Add(sp, x1, 1);  // Avoid accessing memory below `sp`.
+
+  __ Mov(x10, 42);
+  __ Poke(x10, 0);
+  __ Peek(x10, base - limit - kXRegSizeInBytes - 1);
+
+  __ Mov(sp, x2);
+
+  END();
+  if (CAN_RUN()) {
+    RUN();
+  }
+}
+#endif
+
 #ifdef VIXL_NEGATIVE_TESTING
 TEST(sim_stack_limit_guard_read) {
   SimStack builder;
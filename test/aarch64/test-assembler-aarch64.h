@@ -252,13 +252,13 @@ namespace aarch64 {
   masm.FinalizeCode()
 
 // Execute the generated code from the memory area.
-#define RUN()                                               \
-  DISASSEMBLE();                                            \
-  VIXL_ASSERT(QUERIED_CAN_RUN());                           \
-  VIXL_ASSERT(CAN_RUN());                                   \
-  masm.GetBuffer()->SetExecutable();                        \
-  ExecuteMemory(masm.GetBuffer()->GetStartAddress<byte*>(), \
-                masm.GetSizeOfCodeGenerated());             \
+#define RUN()                                                         \
+  DISASSEMBLE();                                                      \
+  VIXL_ASSERT(QUERIED_CAN_RUN());                                     \
+  VIXL_ASSERT(CAN_RUN());                                             \
+  masm.GetBuffer()->SetExecutable();                                  \
+  ExecuteMemory(masm.GetBuffer()->GetExecutableStartAddress<byte*>(), \
+                masm.GetSizeOfCodeGenerated());                       \
   masm.GetBuffer()->SetWritable()
 
 // This just provides compatibility with VIXL_INCLUDE_SIMULATOR_AARCH64 builds.
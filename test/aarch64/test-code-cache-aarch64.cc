@@ -0,0 +1,222 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "test-runner.h"
+#include "test-utils.h"
+
+#include "aarch64/code-cache-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+
+#define TEST(name) TEST_(AARCH64_API_code_cache_##name)
+
+namespace vixl {
+namespace aarch64 {
+
+#if defined(VIXL_CODE_BUFFER_MMAP) && defined(__linux__)
+
+// Generate `uint64_t f(uint64_t x)`, returning `x + value`. `padding` nops are
+// added to control the size of the code.
+static void GenerateAddFunction(MacroAssembler* masm,
+                                uint64_t value,
+                                int padding = 0) {
+  Label skip;
+  masm->B(&skip);
+  for (int i = 0; i < padding; i++) {
+    masm->Nop();
+  }
+  masm->Bind(&skip);
+  masm->Add(x0, x0, value);
+  masm->Ret();
+  masm->FinalizeCode();
+}
+
+static CodeCache::Handle InstallAddFunction(CodeCache* cache,
+                                            uint64_t value,
+                                            int padding = 0) {
+  MacroAssembler masm;
+  GenerateAddFunction(&masm, value, padding);
+  return cache->Install(*masm.GetBuffer());
+}
+
+static uint64_t RunAddFunction(const CodeCache& cache,
+                               CodeCache::Handle handle,
+                               uint64_t x) {
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  return simulator.RunFrom<uint64_t, uint64_t>(
+      cache.GetEntryPoint<const Instruction*>(handle), x);
+#elif defined(__aarch64__)
+  return cache.GetEntryPoint<uint64_t (*)(uint64_t)>(handle)(x);
+#else
+  USE(cache, handle);
+  return x;
+#endif
+}
+
+static bool CanRun() {
+#if defined(VIXL_INCLUDE_SIMULATOR_AARCH64) || defined(__aarch64__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+TEST(install) {
+  CodeCache cache(64 * KBytes);
+  CodeCacheStatistics statistics = cache.GetStatistics();
+  VIXL_CHECK(statistics.capacity == 64 * KBytes);
+  VIXL_CHECK(statistics.used_bytes == 0);
+  VIXL_CHECK(statistics.live_functions == 0);
+  VIXL_CHECK(statistics.GetFragmentation() == 0.0);
+
+  CodeCache::Handle small = InstallAddFunction(&cache, 1);
+  CodeCache::Handle large = InstallAddFunction(&cache, 2, 100);
+  VIXL_CHECK(small.IsValid() && large.IsValid());
+  VIXL_CHECK(cache.GetChunkSize(small) == CodeCache::kMinChunkSize);
+  VIXL_CHECK(cache.GetChunkSize(large) == 512);
+  VIXL_CHECK(cache.GetSize(large) == (100 + 3) * kInstructionSize);
+  cache.EnsureIAndDCacheCoherency();
+
+  if (CanRun()) {
+    VIXL_CHECK(RunAddFunction(cache, small, 41) == 42);
+    VIXL_CHECK(RunAddFunction(cache, large, 41) == 43);
+  }
+
+  statistics = cache.GetStatistics();
+  VIXL_CHECK(statistics.used_bytes == 64 + 512);
+  VIXL_CHECK(statistics.allocated_bytes == 64 + 512);
+  VIXL_CHECK(statistics.live_bytes == (3 + 103) * kInstructionSize);
+  VIXL_CHECK(statistics.free_bytes == 0);
+  VIXL_CHECK(statistics.live_functions == 2);
+  VIXL_CHECK(statistics.GetFragmentation() > 0.0);
+
+  // Freed chunks are reused for functions of the same size class.
+  byte* small_address = cache.GetWritableAddress(small);
+  cache.Free(small);
+  VIXL_CHECK(cache.GetStatistics().free_bytes == 64);
+  CodeCache::Handle other = InstallAddFunction(&cache, 3);
+  VIXL_CHECK(cache.GetWritableAddress(other) == small_address);
+  VIXL_CHECK(cache.GetStatistics().free_bytes == 0);
+  cache.EnsureIAndDCacheCoherency();
+  if (CanRun()) {
+    VIXL_CHECK(RunAddFunction(cache, other, 41) == 44);
+  }
+
+  // Freeing the last chunk returns it to the unused end of the region.
+  cache.Free(large);
+  statistics = cache.GetStatistics();
+  VIXL_CHECK(statistics.used_bytes == 64);
+  VIXL_CHECK(statistics.free_bytes == 0);
+}
+
+TEST(full) {
+  CodeCache cache(4 * KBytes);
+  CodeCache::Handle handles[4 * KBytes / CodeCache::kMinChunkSize];
+  for (size_t i = 0; i < ArrayLength(handles); i++) {
+    handles[i] = InstallAddFunction(&cache, i);
+    VIXL_CHECK(handles[i].IsValid());
+  }
+  VIXL_CHECK(!InstallAddFunction(&cache, 0).IsValid());
+  VIXL_CHECK(!cache.Reserve(1).IsValid());
+
+  // Larger chunks can be found once code is compacted.
+  for (size_t i = 0; i < ArrayLength(handles); i += 2) {
+    cache.Free(handles[i]);
+  }
+  VIXL_CHECK(!InstallAddFunction(&cache, 0, 100).IsValid());
+  cache.Compact();
+  CodeCacheStatistics statistics = cache.GetStatistics();
+  VIXL_CHECK(statistics.used_bytes == 2 * KBytes);
+  VIXL_CHECK(statistics.free_bytes == 0);
+  CodeCache::Handle large = InstallAddFunction(&cache, 0, 100);
+  VIXL_CHECK(large.IsValid());
+  cache.EnsureIAndDCacheCoherency();
+
+  if (CanRun()) {
+    VIXL_CHECK(RunAddFunction(cache, large, 41) == 41);
+    for (size_t i = 1; i < ArrayLength(handles); i += 2) {
+      VIXL_CHECK(RunAddFunction(cache, handles[i], 41) == 41 + i);
+    }
+  }
+}
+
+TEST(pinned) {
+  CodeCache cache(64 * KBytes);
+
+  // Code branching outside itself cannot be moved.
+  MacroAssembler masm;
+  {
+    ExactAssemblyScope scope(&masm, 2 * kInstructionSize);
+    masm.b(-1);
+    masm.ret();
+  }
+  masm.FinalizeCode();
+  VIXL_CHECK(!CodeCache::IsPositionIndependent(
+      masm.GetBuffer()->GetStartAddress<byte*>(),
+      masm.GetSizeOfCodeGenerated()));
+  VIXL_CHECK(!cache.Install(*masm.GetBuffer()).IsValid());
+  VIXL_CHECK(cache.Install(*masm.GetBuffer(), CodeCache::kPinned).IsValid());
+
+  // Pinned code stays in place when compacting, but movable code moves
+  // around it.
+  CodeCache::Handle first = InstallAddFunction(&cache, 1);
+  CodeCache::Handle second = InstallAddFunction(&cache, 2);
+  CodeCache::Handle pinned = cache.Reserve(100);
+  VIXL_CHECK(cache.GetChunkSize(pinned) == 128);
+  CodeCache::Handle last = InstallAddFunction(&cache, 3);
+
+  {
+    // Generate code directly in the reserved chunk.
+    MacroAssembler in_place(cache.GetWritableAddress(pinned),
+                            cache.GetChunkSize(pinned));
+    GenerateAddFunction(&in_place, 4);
+    cache.Commit(pinned, in_place.GetSizeOfCodeGenerated());
+  }
+
+  byte* pinned_address = cache.GetWritableAddress(pinned);
+  byte* second_address = cache.GetWritableAddress(second);
+  cache.Free(first);
+  cache.Compact();
+  VIXL_CHECK(cache.GetWritableAddress(pinned) == pinned_address);
+  VIXL_CHECK(cache.GetWritableAddress(second) < second_address);
+  // The gap left before the pinned chunk can be reused.
+  VIXL_CHECK(cache.GetStatistics().free_bytes == CodeCache::kMinChunkSize);
+  cache.EnsureIAndDCacheCoherency();
+
+  if (CanRun()) {
+    VIXL_CHECK(RunAddFunction(cache, second, 41) == 43);
+    VIXL_CHECK(RunAddFunction(cache, pinned, 41) == 45);
+    VIXL_CHECK(RunAddFunction(cache, last, 41) == 44);
+  }
+}
+
+#endif  // defined(VIXL_CODE_BUFFER_MMAP) && defined(__linux__)
+
+}  // namespace aarch64
+}  // namespace vixl
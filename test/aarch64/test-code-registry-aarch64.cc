@@ -0,0 +1,187 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test-runner.h"
+
+#include "aarch64/code-registry-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+
+#define TEST(name) TEST_(AARCH64_API_code_registry_##name)
+
+#ifdef __linux__
+extern "C" {
+struct jit_code_entry {
+  jit_code_entry* next_entry;
+  jit_code_entry* prev_entry;
+  const char* symfile_addr;
+  uint64_t symfile_size;
+};
+
+struct jit_descriptor {
+  uint32_t version;
+  uint32_t action_flag;
+  jit_code_entry* relevant_entry;
+  jit_code_entry* first_entry;
+};
+
+extern jit_descriptor __jit_debug_descriptor;
+}
+#endif
+
+namespace vixl {
+namespace aarch64 {
+
+#ifdef __linux__
+
+static std::vector<uint8_t> ReadFile(const std::string& path) {
+  std::ifstream file(path.c_str(), std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                              std::istreambuf_iterator<char>());
+}
+
+template <typename T>
+static T ReadAt(const std::vector<uint8_t>& data, size_t offset) {
+  T value;
+  VIXL_CHECK(offset + sizeof(value) <= data.size());
+  memcpy(&value, data.data() + offset, sizeof(value));
+  return value;
+}
+
+static bool Contains(const char* data, size_t size, const char* string) {
+  std::string haystack(data, size);
+  return haystack.find(std::string(string) + '\0') != std::string::npos;
+}
+
+
+TEST(register) {
+  char directory[] = "/tmp/vixl-code-registry-XXXXXX";
+  VIXL_CHECK(mkdtemp(directory) != NULL);
+
+  MacroAssembler masm;
+  Label loop;
+  masm.Mov(x1, 0);
+  masm.Bind(&loop);
+  masm.Add(x1, x1, x0);
+  masm.Subs(x0, x0, 1);
+  masm.B(ne, &loop);
+  masm.Mov(x0, x1);
+  masm.Ret();
+  masm.FinalizeCode();
+
+  const CodeBuffer& buffer = *masm.GetBuffer();
+  uint64_t start = buffer.GetStartAddress<uintptr_t>();
+  uint64_t size = buffer.GetSizeInBytes();
+  uint64_t loop_offset = loop.GetLocation();
+
+  std::string perf_map_path;
+  std::string jit_dump_path;
+  {
+    CodeRegistry registry(CodeRegistry::kAllOutputs, directory);
+    perf_map_path = registry.GetPerfMapPath();
+    jit_dump_path = registry.GetJitDumpPath();
+
+    CodeRegistry::LabelSymbol labels[] = {{"loop", &loop}};
+    registry.Register("sum", buffer, labels, 1);
+
+    // The GDB entry describes both symbols.
+    jit_code_entry* entry = __jit_debug_descriptor.first_entry;
+    VIXL_CHECK(entry != NULL);
+    VIXL_CHECK(__jit_debug_descriptor.relevant_entry == entry);
+    VIXL_CHECK(memcmp(entry->symfile_addr, "\177ELF", 4) == 0);
+    VIXL_CHECK(Contains(entry->symfile_addr, entry->symfile_size, "sum"));
+    VIXL_CHECK(Contains(entry->symfile_addr, entry->symfile_size, "sum:loop"));
+
+    registry.Unregister(buffer.GetStartAddress<const void*>());
+    VIXL_CHECK(__jit_debug_descriptor.first_entry != entry);
+  }
+
+  // The perf map splits the function at the label.
+  std::ifstream perf_map(perf_map_path.c_str());
+  std::string line;
+  std::vector<std::string> lines;
+  while (std::getline(perf_map, line)) lines.push_back(line);
+  VIXL_CHECK(lines.size() == 2);
+  std::ostringstream expected;
+  expected << std::hex << start << " " << loop_offset << " sum";
+  VIXL_CHECK(lines[0] == expected.str());
+  expected.str("");
+  expected << std::hex << (start + loop_offset) << " " << (size - loop_offset)
+           << " sum:loop";
+  VIXL_CHECK(lines[1] == expected.str());
+
+  // The jitdump file has a header, a code load record for each symbol,
+  // carrying a copy of the code, and a close record.
+  std::vector<uint8_t> dump = ReadFile(jit_dump_path);
+  VIXL_CHECK(ReadAt<uint32_t>(dump, 0) == 0x4a695444);
+  VIXL_CHECK(ReadAt<uint32_t>(dump, 4) == 1);
+  uint32_t header_size = ReadAt<uint32_t>(dump, 8);
+  VIXL_CHECK(ReadAt<uint32_t>(dump, 12) == 183);
+  VIXL_CHECK(ReadAt<uint32_t>(dump, 20) == static_cast<uint32_t>(getpid()));
+
+  size_t offset = header_size;
+  const char* names[] = {"sum", "sum:loop"};
+  uint64_t offsets[] = {0, loop_offset};
+  uint64_t sizes[] = {loop_offset, size - loop_offset};
+  for (int i = 0; i < 2; i++) {
+    VIXL_CHECK(ReadAt<uint32_t>(dump, offset) == 0);  // JIT_CODE_LOAD
+    uint32_t total_size = ReadAt<uint32_t>(dump, offset + 4);
+    VIXL_CHECK(ReadAt<uint64_t>(dump, offset + 24) == start + offsets[i]);
+    VIXL_CHECK(ReadAt<uint64_t>(dump, offset + 32) == start + offsets[i]);
+    VIXL_CHECK(ReadAt<uint64_t>(dump, offset + 40) == sizes[i]);
+    VIXL_CHECK(ReadAt<uint64_t>(dump, offset + 48) == static_cast<uint64_t>(i));
+    size_t name_offset = offset + 56;
+    size_t name_size = strlen(names[i]) + 1;
+    VIXL_CHECK(memcmp(dump.data() + name_offset, names[i], name_size) == 0);
+    size_t code_offset = name_offset + name_size;
+    VIXL_CHECK(total_size == code_offset + sizes[i] - offset);
+    VIXL_CHECK(memcmp(dump.data() + code_offset,
+                      buffer.GetStartAddress<const uint8_t*>() + offsets[i],
+                      sizes[i]) == 0);
+    offset += total_size;
+  }
+  VIXL_CHECK(ReadAt<uint32_t>(dump, offset) == 3);  // JIT_CODE_CLOSE
+  VIXL_CHECK(offset + ReadAt<uint32_t>(dump, offset + 4) == dump.size());
+
+  unlink(perf_map_path.c_str());
+  unlink(jit_dump_path.c_str());
+  rmdir(directory);
+}
+
+#endif  // __linux__
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -362,6 +362,18 @@ TEST(trace_partial) {
   CHECK_OUTPUT();
 }
 
+TEST(get_debugger_const) {
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  const Simulator& const_simulator = simulator;
+
+  // The debugger can be reached through a const Simulator, and is the same
+  // one whichever reference is used.
+  Debugger* debugger = const_simulator.GetDebugger();
+  VIXL_CHECK(debugger != NULL);
+  VIXL_CHECK(simulator.GetDebugger() == debugger);
+}
+
 #endif  // VIXL_INCLUDE_SIMULATOR_AARCH64
 
 }  // namespace aarch64
@@ -0,0 +1,474 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "test-runner.h"
+#include "test-utils.h"
+
+#include "aarch64/elf-object-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+
+#define TEST(name) TEST_(AARCH64_API_elf_object_##name)
+
+namespace vixl {
+namespace aarch64 {
+
+// A minimal reader for ELF64 little-endian relocatable objects, following the
+// same layout as readelf reports, so that the tests do not depend on the host
+// toolchain.
+class ElfReader {
+ public:
+  struct Section {
+    std::string name;
+    uint32_t name_offset;
+    uint32_t type;
+    uint64_t flags;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t link;
+    uint32_t info;
+    uint64_t alignment;
+    uint64_t entry_size;
+  };
+
+  struct Symbol {
+    std::string name;
+    uint8_t bind;
+    uint8_t type;
+    uint16_t section;
+    uint64_t value;
+  };
+
+  struct Relocation {
+    uint64_t offset;
+    uint32_t type;
+    uint32_t symbol;
+    int64_t addend;
+  };
+
+  explicit ElfReader(const std::vector<uint8_t>& object) : object_(object) {
+    VIXL_CHECK(object_.size() >= 64);
+    uint64_t shoff = Read(0x28, 8);
+    uint64_t shentsize = Read(0x3a, 2);
+    uint64_t shnum = Read(0x3c, 2);
+    uint64_t shstrndx = Read(0x3e, 2);
+    VIXL_CHECK(shentsize == 64);
+    VIXL_CHECK(shoff + (shnum * shentsize) <= object_.size());
+    for (uint64_t i = 0; i < shnum; i++) {
+      uint64_t header = shoff + (i * shentsize);
+      Section section;
+      section.name_offset = static_cast<uint32_t>(Read(header, 4));
+      section.type = static_cast<uint32_t>(Read(header + 0x04, 4));
+      section.flags = Read(header + 0x08, 8);
+      section.offset = Read(header + 0x18, 8);
+      section.size = Read(header + 0x20, 8);
+      section.link = static_cast<uint32_t>(Read(header + 0x28, 4));
+      section.info = static_cast<uint32_t>(Read(header + 0x2c, 4));
+      section.alignment = Read(header + 0x30, 8);
+      section.entry_size = Read(header + 0x38, 8);
+      VIXL_CHECK(section.offset + section.size <= object_.size());
+      sections_.push_back(section);
+    }
+    // Resolve the section names now that the string table is known.
+    VIXL_CHECK(shstrndx < sections_.size());
+    for (size_t i = 0; i < sections_.size(); i++) {
+      sections_[i].name =
+          ReadString(sections_[shstrndx], sections_[i].name_offset);
+    }
+  }
+
+  uint64_t Read(uint64_t offset, int size) const {
+    VIXL_CHECK(offset + size <= object_.size());
+    uint64_t value = 0;
+    for (int i = size - 1; i >= 0; i--) {
+      value = (value << 8) | object_[offset + i];
+    }
+    return value;
+  }
+
+  std::string ReadString(const Section& table, uint64_t offset) const {
+    VIXL_CHECK(offset < table.size);
+    const char* start =
+        reinterpret_cast<const char*>(&object_[table.offset + offset]);
+    return std::string(start, strnlen(start, table.size - offset));
+  }
+
+  const std::vector<Section>& GetSections() const { return sections_; }
+
+  int FindSection(const char* name) const {
+    for (size_t i = 0; i < sections_.size(); i++) {
+      if (sections_[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+  }
+
+  const uint8_t* GetContents(const Section& section) const {
+    return &object_[section.offset];
+  }
+
+  std::vector<Symbol> GetSymbols() const {
+    const Section& symtab = sections_[FindSection(".symtab")];
+    VIXL_CHECK(symtab.entry_size == 24);
+    std::vector<Symbol> symbols;
+    for (uint64_t offset = 0; offset < symtab.size; offset += 24) {
+      uint64_t entry = symtab.offset + offset;
+      Symbol symbol;
+      symbol.name = ReadString(sections_[symtab.link], Read(entry, 4));
+      symbol.bind = static_cast<uint8_t>(Read(entry + 4, 1) >> 4);
+      symbol.type = static_cast<uint8_t>(Read(entry + 4, 1) & 0xf);
+      symbol.section = static_cast<uint16_t>(Read(entry + 6, 2));
+      symbol.value = Read(entry + 8, 8);
+      symbols.push_back(symbol);
+    }
+    return symbols;
+  }
+
+  std::vector<Relocation> GetRelocations(const char* name) const {
+    const Section& rela = sections_[FindSection(name)];
+    VIXL_CHECK(rela.entry_size == 24);
+    std::vector<Relocation> relocations;
+    for (uint64_t offset = 0; offset < rela.size; offset += 24) {
+      uint64_t entry = rela.offset + offset;
+      Relocation relocation;
+      relocation.offset = Read(entry, 8);
+      relocation.type = static_cast<uint32_t>(Read(entry + 8, 4));
+      relocation.symbol = static_cast<uint32_t>(Read(entry + 12, 4));
+      relocation.addend = static_cast<int64_t>(Read(entry + 16, 8));
+      relocations.push_back(relocation);
+    }
+    return relocations;
+  }
+
+ private:
+  const std::vector<uint8_t>& object_;
+  std::vector<Section> sections_;
+};
+
+TEST(layout) {
+  MacroAssembler masm;
+  ElfObjectWriter writer(&masm);
+
+  Label entry, table;
+  masm.Bind(&entry);
+  writer.Call("external_function");
+  writer.LoadLiteral(x1, 0x0123456789abcdef);
+  writer.LoadAddress(x2, "external_data", 16);
+  writer.LoadLiteral(x3, 0x0123456789abcdef);
+  writer.Jump("external_function");
+  masm.Bind(&table);
+  {
+    ExactAssemblyScope scope(&masm, sizeof(uint64_t));
+    masm.dc64(42);
+  }
+  masm.FinalizeCode();
+  writer.Export("vixl_entry", &entry);
+  writer.Export("vixl_table", &table, ElfObjectWriter::kObject);
+
+  std::vector<uint8_t> object;
+  writer.WriteObject(&object);
+  ElfReader reader(object);
+
+  // ELF header: ELF64, little-endian, relocatable, AArch64.
+  VIXL_CHECK(memcmp(&object[0], "\x7f" "ELF", 4) == 0);
+  VIXL_CHECK(reader.Read(4, 1) == 2);
+  VIXL_CHECK(reader.Read(5, 1) == 1);
+  VIXL_CHECK(reader.Read(0x10, 2) == 1);
+  VIXL_CHECK(reader.Read(0x12, 2) == 183);
+
+  int text = reader.FindSection(".text");
+  int rodata = reader.FindSection(".rodata");
+  VIXL_CHECK(text > 0);
+  VIXL_CHECK(rodata > 0);
+  VIXL_CHECK(reader.FindSection(".rela.text") > 0);
+  VIXL_CHECK(reader.FindSection(".rela.rodata") > 0);
+
+  // The code is copied unchanged.
+  const ElfReader::Section& text_section = reader.GetSections()[text];
+  VIXL_CHECK(text_section.type == 1);
+  VIXL_CHECK(text_section.flags == 0x6);
+  VIXL_CHECK(text_section.size == masm.GetSizeOfCodeGenerated());
+  VIXL_CHECK(memcmp(reader.GetContents(text_section),
+                    masm.GetBuffer()->GetStartAddress<const void*>(),
+                    text_section.size) == 0);
+
+  // The literal is shared, and the address is left for the linker.
+  const ElfReader::Section& rodata_section = reader.GetSections()[rodata];
+  VIXL_CHECK(rodata_section.size == 16);
+  VIXL_CHECK(reader.Read(rodata_section.offset, 8) == 0x0123456789abcdef);
+  VIXL_CHECK(reader.Read(rodata_section.offset + 8, 8) == 0);
+
+  std::vector<ElfReader::Symbol> symbols = reader.GetSymbols();
+  VIXL_CHECK(symbols.size() == 7);
+  VIXL_CHECK(symbols[2].type == 3);  // STT_SECTION
+  VIXL_CHECK(symbols[2].section == rodata);
+  VIXL_CHECK(symbols[3].name == "external_function");
+  VIXL_CHECK(symbols[3].bind == 1);  // STB_GLOBAL
+  VIXL_CHECK(symbols[3].section == 0);
+  VIXL_CHECK(symbols[4].name == "external_data");
+  VIXL_CHECK(symbols[4].section == 0);
+  VIXL_CHECK(symbols[5].name == "vixl_entry");
+  VIXL_CHECK(symbols[5].type == 2);  // STT_FUNC
+  VIXL_CHECK(symbols[5].section == text);
+  VIXL_CHECK(symbols[5].value == 0);
+  VIXL_CHECK(symbols[6].name == "vixl_table");
+  VIXL_CHECK(symbols[6].type == 1);  // STT_OBJECT
+  VIXL_CHECK(symbols[6].value == static_cast<uint64_t>(table.GetLocation()));
+  VIXL_CHECK(reader.GetSections()[reader.FindSection(".symtab")].info == 3);
+
+  std::vector<ElfReader::Relocation> text_relocations =
+      reader.GetRelocations(".rela.text");
+  VIXL_CHECK(text_relocations.size() == 8);
+  VIXL_CHECK(text_relocations[0].offset == 0);
+  VIXL_CHECK(text_relocations[0].type == 283);  // R_AARCH64_CALL26
+  VIXL_CHECK(text_relocations[0].symbol == 3);
+  VIXL_CHECK(text_relocations[1].type == 275);  // R_AARCH64_ADR_PREL_PG_HI21
+  VIXL_CHECK(text_relocations[2].type == 286);  // R_AARCH64_LDST64_ABS_LO12_NC
+  VIXL_CHECK(text_relocations[2].symbol == 2);
+  VIXL_CHECK(text_relocations[2].addend == 0);
+  VIXL_CHECK(text_relocations[4].addend == 8);
+  VIXL_CHECK(text_relocations[6].addend == 0);
+  VIXL_CHECK(text_relocations[7].offset == 7 * kInstructionSize);
+  VIXL_CHECK(text_relocations[7].type == 282);  // R_AARCH64_JUMP26
+
+  std::vector<ElfReader::Relocation> rodata_relocations =
+      reader.GetRelocations(".rela.rodata");
+  VIXL_CHECK(rodata_relocations.size() == 1);
+  VIXL_CHECK(rodata_relocations[0].offset == 8);
+  VIXL_CHECK(rodata_relocations[0].type == 257);  // R_AARCH64_ABS64
+  VIXL_CHECK(rodata_relocations[0].symbol == 4);
+  VIXL_CHECK(rodata_relocations[0].addend == 16);
+}
+
+TEST(code_relocations) {
+  MacroAssembler masm;
+  ElfObjectWriter writer(&masm);
+  writer.NameExternalSymbol(7, "external_function");
+  writer.NameExternalSymbol(3, "external_data");
+
+  Label entry;
+  masm.Bind(&entry);
+  masm.CallExternal(7, 0x0123456789abcdef);
+  masm.LdrExternalAddress(x1, 3, 0x0123456789abcdef);
+  masm.MovCodeAddress(x2, &entry);
+  masm.FinalizeCode();
+
+  std::vector<uint8_t> object;
+  writer.WriteObject(&object);
+  ElfReader reader(object);
+
+  std::vector<ElfReader::Symbol> symbols = reader.GetSymbols();
+  VIXL_CHECK(symbols.size() == 5);
+  VIXL_CHECK(symbols[3].name == "external_function");
+  VIXL_CHECK(symbols[4].name == "external_data");
+
+  // The MOVZ and MOVKs of each address are relocated one by one, and the
+  // literal as a whole.
+  const std::vector<Relocation>& code_relocations = masm.GetRelocations();
+  VIXL_CHECK(code_relocations.size() == 3);
+  std::vector<ElfReader::Relocation> text_relocations =
+      reader.GetRelocations(".rela.text");
+  VIXL_CHECK(text_relocations.size() == 9);
+  const uint32_t kMovWideTypes[] = {264, 266, 268, 269};
+  for (int i = 0; i < 4; i++) {
+    // R_AARCH64_MOVW_UABS_G<i>(_NC), for the call.
+    VIXL_CHECK(text_relocations[i].offset ==
+               code_relocations[0].offset + (i * kInstructionSize));
+    VIXL_CHECK(text_relocations[i].type == kMovWideTypes[i]);
+    VIXL_CHECK(text_relocations[i].symbol == 3);
+    VIXL_CHECK(text_relocations[i].addend == 0);
+    // The same for the address of `entry`, relative to .text.
+    VIXL_CHECK(text_relocations[4 + i].offset ==
+               code_relocations[1].offset + (i * kInstructionSize));
+    VIXL_CHECK(text_relocations[4 + i].type == kMovWideTypes[i]);
+    VIXL_CHECK(text_relocations[4 + i].symbol == 1);
+    VIXL_CHECK(text_relocations[4 + i].addend == entry.GetLocation());
+  }
+  // The literal is placed in the pool at the end of the code.
+  VIXL_CHECK(text_relocations[8].offset == code_relocations[2].offset);
+  VIXL_CHECK(text_relocations[8].type == 257);  // R_AARCH64_ABS64
+  VIXL_CHECK(text_relocations[8].symbol == 4);
+  VIXL_CHECK(text_relocations[8].addend == 0);
+}
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+// Link the .text and .rodata sections of `object` at `text` and `rodata`, in
+// the way the system linker would, resolving external symbols with
+// `resolve(name)`.
+template <typename F>
+static void Link(const ElfReader& reader,
+                 uint8_t* text,
+                 uint8_t* rodata,
+                 F resolve) {
+  const std::vector<ElfReader::Section>& sections = reader.GetSections();
+  const ElfReader::Section& text_section =
+      sections[reader.FindSection(".text")];
+  const ElfReader::Section& rodata_section =
+      sections[reader.FindSection(".rodata")];
+  memcpy(text, reader.GetContents(text_section), text_section.size);
+  memcpy(rodata, reader.GetContents(rodata_section), rodata_section.size);
+
+  std::vector<ElfReader::Symbol> symbols = reader.GetSymbols();
+  const char* rela_names[] = {".rela.text", ".rela.rodata"};
+  uint8_t* bases[] = {text, rodata};
+  for (int i = 0; i < 2; i++) {
+    std::vector<ElfReader::Relocation> relocations =
+        reader.GetRelocations(rela_names[i]);
+    for (size_t j = 0; j < relocations.size(); j++) {
+      const ElfReader::Relocation& relocation = relocations[j];
+      const ElfReader::Symbol& symbol = symbols[relocation.symbol];
+      uint64_t s;
+      if (symbol.section == reader.FindSection(".rodata")) {
+        s = reinterpret_cast<uint64_t>(rodata) + symbol.value;
+      } else if (symbol.section == reader.FindSection(".text")) {
+        s = reinterpret_cast<uint64_t>(text) + symbol.value;
+      } else {
+        s = resolve(symbol.name);
+      }
+      uint64_t target = s + relocation.addend;
+      uint8_t* location = bases[i] + relocation.offset;
+      uint64_t p = reinterpret_cast<uint64_t>(location);
+      uint32_t instr;
+      memcpy(&instr, location, sizeof(instr));
+      switch (relocation.type) {
+        case 257: {  // R_AARCH64_ABS64
+          memcpy(location, &target, sizeof(target));
+          continue;
+        }
+        case 264:    // R_AARCH64_MOVW_UABS_G0_NC
+        case 266:    // R_AARCH64_MOVW_UABS_G1_NC
+        case 268:    // R_AARCH64_MOVW_UABS_G2_NC
+        case 269: {  // R_AARCH64_MOVW_UABS_G3
+          // There is no G3_NC, so G3 directly follows G2_NC.
+          int group =
+              (relocation.type == 269) ? 3 : ((relocation.type - 264) / 2);
+          uint32_t imm16 = (target >> (16 * group)) & 0xffff;
+          instr = (instr & ~0x001fffe0) | (imm16 << 5);
+          break;
+        }
+        case 282:    // R_AARCH64_JUMP26
+        case 283: {  // R_AARCH64_CALL26
+          int64_t offset = static_cast<int64_t>(target - p) / 4;
+          VIXL_CHECK(IsIntN(26, offset));
+          instr = (instr & ~0x03ffffff) | (offset & 0x03ffffff);
+          break;
+        }
+        case 275: {  // R_AARCH64_ADR_PREL_PG_HI21
+          int64_t pages =
+              static_cast<int64_t>((target & ~0xfff) - (p & ~0xfff)) >> 12;
+          VIXL_CHECK(IsIntN(21, pages));
+          uint32_t immlo = pages & 3;
+          uint32_t immhi = (pages >> 2) & 0x7ffff;
+          instr = (instr & ~0x60ffffe0) | (immlo << 29) | (immhi << 5);
+          break;
+        }
+        case 286: {  // R_AARCH64_LDST64_ABS_LO12_NC
+          uint32_t imm12 = (target & 0xfff) >> 3;
+          instr = (instr & ~0x003ffc00) | (imm12 << 10);
+          break;
+        }
+        default:
+          VIXL_UNREACHABLE();
+      }
+      memcpy(location, &instr, sizeof(instr));
+    }
+  }
+}
+
+TEST(link_and_run) {
+  uint64_t data[] = {0, 0x100000, 0};
+
+  // Two functions that the object refers to, outside of it.
+  MacroAssembler helpers;
+  Label increment, add_100;
+  helpers.Bind(&increment);
+  helpers.Add(x0, x0, 1);
+  helpers.Ret();
+  helpers.Bind(&add_100);
+  helpers.Add(x0, x0, 100);
+  helpers.Ret();
+  helpers.FinalizeCode();
+
+  // uint64_t vixl_function(): returns 0x1000 + 2 + data[1] + 0x1000 + 100.
+  MacroAssembler masm;
+  ElfObjectWriter writer(&masm);
+  writer.NameExternalSymbol(0, "increment");
+  Label entry;
+  masm.Bind(&entry);
+  masm.Push(lr, xzr);
+  writer.LoadLiteral(x0, 0x1000);
+  writer.Call("increment");
+  // The address given here is replaced when linking.
+  masm.CallExternal(0, 0);
+  writer.LoadAddress(x1, "data", sizeof(data[0]));
+  masm.Ldr(x1, MemOperand(x1));
+  masm.Add(x0, x0, x1);
+  writer.LoadLiteral(x2, 0x1000);
+  masm.Add(x0, x0, x2);
+  masm.Pop(xzr, lr);
+  writer.Jump("add_100");
+  masm.FinalizeCode();
+  writer.Export("vixl_function", &entry);
+
+  std::vector<uint8_t> object;
+  writer.WriteObject(&object);
+  ElfReader reader(object);
+
+  // Lay out the sections on separate pages, as a linker would.
+  std::vector<uint8_t> memory(4 * kPageSize);
+  uint8_t* text = AlignUp(memory.data(), kPageSize);
+  uint8_t* rodata = text + kPageSize;
+  uint8_t* helpers_text = rodata + kPageSize;
+  VIXL_CHECK(helpers.GetSizeOfCodeGenerated() <= kPageSize);
+  memcpy(helpers_text,
+         helpers.GetBuffer()->GetStartAddress<const void*>(),
+         helpers.GetSizeOfCodeGenerated());
+
+  Link(reader, text, rodata, [&](const std::string& name) -> uint64_t {
+    if (name == "increment") {
+      return reinterpret_cast<uint64_t>(helpers_text + increment.GetLocation());
+    }
+    if (name == "add_100") {
+      return reinterpret_cast<uint64_t>(helpers_text + add_100.GetLocation());
+    }
+    VIXL_CHECK(name == "data");
+    return reinterpret_cast<uint64_t>(data);
+  });
+
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.RunFrom(reinterpret_cast<Instruction*>(text));
+  VIXL_CHECK(simulator.ReadXRegister(0) ==
+             (0x1000 + 2 + 0x100000 + 0x1000 + 100));
+}
+#endif
+
+}  // namespace aarch64
+}  // namespace vixl
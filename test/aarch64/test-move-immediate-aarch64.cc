@@ -0,0 +1,367 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cstring>
+
+#include "test-runner.h"
+
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/move-immediate-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+
+#define TEST(name) TEST_(AARCH64_API_move_immediate_##name)
+
+namespace vixl {
+namespace aarch64 {
+
+typedef MoveImmediateSequence Sequence;
+
+// Constants of various shapes: small values, addresses, masks, replicated
+// patterns, floating-point bit patterns and hashing constants.
+static const uint64_t kCorpus[] = {0x0000000000000000,
+                                   0x0000000000001234,
+                                   0xffffffffffffedcb,
+                                   0x0000000012345678,
+                                   0x00000000ffff1234,
+                                   0x00000000ff00ff00,
+                                   0x0000123400005678,
+                                   0x0000ffff1234ffff,
+                                   0x00007fff12345678,
+                                   0x0000aaaabbbbcccc,
+                                   0x0000123456789abc,
+                                   0x00001234ffff5678,
+                                   0x5555555555551234,
+                                   0x0ff0f00f0f0f0f0f,
+                                   0x1234123412341234,
+                                   0x1234567812345678,
+                                   0x00ff00ff00ff1234,
+                                   0x400921fb54442d18,
+                                   0x3ff0000000000000,
+                                   0x9e3779b97f4a7c15,
+                                   0x0123456789abcdef,
+                                   0xfedcba9876543210,
+                                   0x8000000000000001,
+                                   0x7fffffffffff0000};
+
+
+static int GetGreedyLength(uint64_t imm, unsigned reg_size) {
+  Sequence sequence;
+  Sequence::FindGreedy(imm, reg_size, &sequence);
+  return sequence.GetLength();
+}
+
+
+TEST(minimal) {
+  struct {
+    uint64_t imm;
+    int greedy_length;
+    int length;
+  } kCases[] = {// A 32-bit `movn` or `orr`.
+                {0x00000000ffff1234, 2, 1},
+                {0x00000000ff00ff00, 2, 1},
+                // A 32-bit `movn` and a `movk`.
+                {0x00001234ffff5678, 3, 2},
+                // A logical immediate and a `movk`.
+                {0x5555555555551234, 4, 2},
+                {0x00ff00ff00ff1234, 4, 2},
+                {0x0ff0f00f0f0f0f0f, 4, 3},
+                // Replicated halfwords and words.
+                {0x1234123412341234, 4, 3},
+                {0x1234567812345678, 4, 3},
+                // No shorter sequence.
+                {0x0000123456789abc, 3, 3},
+                {0x0123456789abcdef, 4, 4}};
+  for (size_t i = 0; i < ArrayLength(kCases); i++) {
+    Sequence sequence;
+    Sequence::FindMinimal(kCases[i].imm, kXRegSize, &sequence);
+    VIXL_CHECK(sequence.Evaluate() == kCases[i].imm);
+    VIXL_CHECK(GetGreedyLength(kCases[i].imm, kXRegSize) ==
+               kCases[i].greedy_length);
+    VIXL_CHECK(sequence.GetLength() == kCases[i].length);
+  }
+
+  // When the greedy sequence is as short as any other, it is kept.
+  for (size_t i = 0; i < ArrayLength(kCorpus); i++) {
+    for (unsigned reg_size = kWRegSize; reg_size <= kXRegSize; reg_size *= 2) {
+      uint64_t imm = kCorpus[i] & GetUintMask(reg_size);
+      Sequence greedy;
+      Sequence minimal;
+      Sequence::FindGreedy(imm, reg_size, &greedy);
+      Sequence::FindMinimal(imm, reg_size, &minimal);
+      VIXL_CHECK(greedy.Evaluate() == imm);
+      VIXL_CHECK(minimal.Evaluate() == imm);
+      VIXL_CHECK(minimal.GetLength() <= greedy.GetLength());
+      if (minimal.GetLength() == greedy.GetLength()) {
+        for (int j = 0; j < greedy.GetLength(); j++) {
+          VIXL_CHECK(minimal.GetOperation(j) == greedy.GetOperation(j));
+          VIXL_CHECK(minimal.GetImmediate(j) == greedy.GetImmediate(j));
+          VIXL_CHECK(minimal.GetShift(j) == greedy.GetShift(j));
+        }
+      }
+    }
+  }
+}
+
+
+static uint64_t NextRandom(uint64_t* state) {
+  // xorshift64*
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * UINT64_C(0x2545f4914f6cdd1d);
+}
+
+
+static uint64_t RandomLogicalImmediate(uint64_t* state, unsigned reg_size) {
+  unsigned element_size = 2 << (NextRandom(state) % (reg_size == 64 ? 6 : 5));
+  unsigned ones = 1 + (NextRandom(state) % (element_size - 1));
+  unsigned rotation = NextRandom(state) % element_size;
+  uint64_t run = GetUintMask(ones);
+  uint64_t value = run;
+  if (rotation != 0) {
+    value = ((run >> rotation) | (run << (element_size - rotation))) &
+            GetUintMask(element_size);
+  }
+  for (unsigned width = element_size; width < reg_size; width *= 2) {
+    value |= value << width;
+  }
+  return value;
+}
+
+
+static void AppendRandomInitialValue(uint64_t* state,
+                                     unsigned reg_size,
+                                     Sequence* sequence) {
+  switch (NextRandom(state) % 3) {
+    case 0:
+      sequence->Append(Sequence::kMovz,
+                       reg_size,
+                       NextRandom(state) & 0xffff,
+                       16 * (NextRandom(state) % (reg_size / 16)));
+      break;
+    case 1:
+      sequence->Append(Sequence::kMovn,
+                       reg_size,
+                       NextRandom(state) & 0xffff,
+                       16 * (NextRandom(state) % (reg_size / 16)));
+      break;
+    default:
+      sequence->Append(Sequence::kOrr,
+                       reg_size,
+                       RandomLogicalImmediate(state, reg_size));
+      break;
+  }
+}
+
+
+static void AppendRandomMovk(uint64_t* state,
+                             unsigned reg_size,
+                             Sequence* sequence) {
+  sequence->Append(Sequence::kMovk,
+                   reg_size,
+                   NextRandom(state) & 0xffff,
+                   16 * (NextRandom(state) % (reg_size / 16)));
+}
+
+
+// Check that the value of `random` is found with at most as many
+// instructions.
+static void CheckNotLonger(const Sequence& random) {
+  uint64_t imm = random.Evaluate();
+  Sequence sequence;
+  Sequence::FindMinimal(imm, kXRegSize, &sequence);
+  VIXL_CHECK(sequence.Evaluate() == imm);
+  VIXL_CHECK(sequence.GetLength() <= random.GetLength());
+}
+
+
+TEST(random_sequences) {
+  uint64_t state = 0x0123456789abcdef;
+  for (int i = 0; i < 20000; i++) {
+    // An initial value of either size, and up to three `movk`.
+    Sequence random;
+    unsigned reg_size = ((i % 2) == 0) ? kWRegSize : kXRegSize;
+    AppendRandomInitialValue(&state, reg_size, &random);
+    for (int j = 0; j < (i % 4); j++) {
+      AppendRandomMovk(&state, kXRegSize, &random);
+    }
+    CheckNotLonger(random);
+
+    // A 32-bit value copied into the high word.
+    random.Clear();
+    AppendRandomInitialValue(&state, kWRegSize, &random);
+    if ((i % 2) == 0) AppendRandomMovk(&state, kWRegSize, &random);
+    random.Append(Sequence::kReplicate, kXRegSize, 0);
+    CheckNotLonger(random);
+  }
+
+  // A 64-bit `movz` or `movn`, followed by a logical immediate.
+  for (int i = 0; i < 20000; i++) {
+    uint64_t imm = (NextRandom(&state) & 0xffff)
+                   << (16 * (NextRandom(&state) % 4));
+    if ((i % 2) == 0) imm = ~imm;
+    uint64_t logical = RandomLogicalImmediate(&state, kXRegSize);
+    const uint64_t kValues[] = {imm ^ logical, imm & logical, imm | logical};
+    for (size_t j = 0; j < ArrayLength(kValues); j++) {
+      Sequence sequence;
+      Sequence::FindMinimal(kValues[j], kXRegSize, &sequence);
+      VIXL_CHECK(sequence.Evaluate() == kValues[j]);
+      VIXL_CHECK(sequence.GetLength() <= 2);
+    }
+  }
+}
+
+
+TEST(greedy_by_default) {
+  MacroAssembler masm;
+  VIXL_CHECK(!masm.UseMinimalMoveImmediates());
+  masm.Mov(x0, 0x1234567812345678);
+  masm.FinalizeCode();
+  VIXL_CHECK(masm.GetSizeOfCodeGenerated() == (4 * kInstructionSize));
+  const MoveImmediateCache& cache = masm.GetMoveImmediateCache();
+  VIXL_CHECK(cache.GetHitCount() + cache.GetMissCount() == 0);
+
+  // Size queries count the greedy sequence.
+  VIXL_CHECK(MacroAssembler::MoveImmediateHelper(NULL,
+                                                 x0,
+                                                 0x1234567812345678) == 4);
+  VIXL_CHECK(MacroAssembler::MoveImmediateHelper(NULL,
+                                                 x0,
+                                                 0x0000123400005678) == 2);
+}
+
+
+TEST(cache) {
+  MacroAssembler masm;
+  masm.SetMinimalMoveImmediates(true);
+  const MoveImmediateCache& cache = masm.GetMoveImmediateCache();
+  masm.Mov(x0, 0x0000000000001234);
+  VIXL_CHECK(cache.GetHitCount() + cache.GetMissCount() == 0);
+
+  masm.Mov(x0, 0x1234567812345678);
+  VIXL_CHECK(cache.GetHitCount() == 0);
+  VIXL_CHECK(cache.GetMissCount() == 1);
+  masm.Mov(x1, 0x1234567812345678);
+  VIXL_CHECK(cache.GetHitCount() == 1);
+  masm.Mov(w1, 0x12345678);
+  VIXL_CHECK(cache.GetMissCount() == 2);
+  masm.FinalizeCode();
+
+  // The cached sequence is the same as the first one.
+  VIXL_CHECK(masm.GetSizeOfCodeGenerated() ==
+             (1 + 3 + 3 + 2) * kInstructionSize);
+  const Instruction* start =
+      masm.GetBuffer()->GetStartAddress<Instruction*>();
+  for (int i = 1; i < 4; i++) {
+    const Instruction* first =
+        start->GetInstructionAtOffset(i * kInstructionSize);
+    const Instruction* second =
+        start->GetInstructionAtOffset((i + 3) * kInstructionSize);
+    VIXL_CHECK(first->GetRd() == 0);
+    VIXL_CHECK(second->GetRd() == 1);
+    // Copying the low word also uses the register as Rn and Rm.
+    const Instr kRegisterMask = Rd_mask | Rn_mask | Rm_mask;
+    VIXL_CHECK((first->GetInstructionBits() & ~kRegisterMask) ==
+               (second->GetInstructionBits() & ~kRegisterMask));
+  }
+}
+
+
+// Check that `Mov(rd, imm)` emits no more code than a size query reports.
+static void CheckSizeQuery(MacroAssembler* masm,
+                           const Register& rd,
+                           uint64_t imm) {
+  ptrdiff_t start = masm->GetCursorOffset();
+  masm->Mov(rd, imm);
+  ptrdiff_t size = masm->GetCursorOffset() - start;
+  int reported = MacroAssembler::MoveImmediateHelper(NULL, rd, imm);
+  VIXL_CHECK(size <= (reported * static_cast<ptrdiff_t>(kInstructionSize)));
+}
+
+
+TEST(size_query_upper_bound) {
+  MacroAssembler masm;
+  masm.SetMinimalMoveImmediates(true);
+  for (size_t i = 0; i < ArrayLength(kCorpus); i++) {
+    CheckSizeQuery(&masm, x0, kCorpus[i]);
+    CheckSizeQuery(&masm, w0, kCorpus[i] & kWRegMask);
+    CheckSizeQuery(&masm, sp, kCorpus[i] & ~UINT64_C(0xf));
+  }
+
+  // Values that the search can often materialise in fewer instructions.
+  uint64_t state = 0xfedcba9876543210;
+  for (int i = 0; i < 2000; i++) {
+    Sequence random;
+    AppendRandomInitialValue(&state, kWRegSize, &random);
+    AppendRandomMovk(&state, kWRegSize, &random);
+    if ((i % 2) == 0) {
+      random.Append(Sequence::kReplicate, kXRegSize, 0);
+    } else {
+      AppendRandomMovk(&state, kXRegSize, &random);
+    }
+    CheckSizeQuery(&masm, x1, random.Evaluate());
+  }
+  masm.FinalizeCode();
+}
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+TEST(simulated) {
+  MacroAssembler masm;
+  masm.SetMinimalMoveImmediates(true);
+  for (size_t i = 0; i < ArrayLength(kCorpus); i++) {
+    uint64_t imm = kCorpus[i];
+    masm.Mov(x2, imm);
+    masm.Str(x2, MemOperand(x0, 24 * i));
+    masm.Mov(w3, imm & kWRegMask);
+    masm.Str(x3, MemOperand(x0, (24 * i) + 8));
+    // The stack pointer needs a scratch register.
+    masm.Mov(x4, sp);
+    masm.Mov(sp, imm & ~UINT64_C(0xf));
+    masm.Mov(x5, sp);
+    masm.Mov(sp, x4);
+    masm.Str(x5, MemOperand(x0, (24 * i) + 16));
+  }
+  masm.Ret();
+  masm.FinalizeCode();
+  masm.GetBuffer()->SetExecutable();
+
+  uint64_t results[ArrayLength(kCorpus) * 3];
+  memset(results, 0, sizeof(results));
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.WriteXRegister(0, reinterpret_cast<uintptr_t>(results));
+  simulator.RunFrom(masm.GetBuffer()->GetStartAddress<Instruction*>());
+  for (size_t i = 0; i < ArrayLength(kCorpus); i++) {
+    VIXL_CHECK(results[3 * i] == kCorpus[i]);
+    VIXL_CHECK(results[(3 * i) + 1] == (kCorpus[i] & kWRegMask));
+    VIXL_CHECK(results[(3 * i) + 2] == (kCorpus[i] & ~UINT64_C(0xf)));
+  }
+}
+#endif
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -0,0 +1,288 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cstring>
+#include <vector>
+
+#include "test-runner.h"
+
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/peephole-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+
+#define TEST(name) TEST_(AARCH64_API_peephole_##name)
+
+namespace vixl {
+namespace aarch64 {
+
+#define __ masm->
+
+// Generate code with every pattern the peephole optimiser looks for, along
+// with similar code which it must not change. x0 points to 16 input values,
+// and x1 to 24 output values. The code is optimised with `peephole`, or only
+// has its branches relaxed if it is NULL.
+static void GeneratePatterns(MacroAssembler* masm, Peephole* peephole) {
+  // The labels are bound when the scope closes, so they must outlive it.
+  Label label, zero, done, non_zero, done_w;
+  PeepholeScope peephole_scope(masm, peephole);
+
+  // Keep a copy of x0 on the stack, for a load to use as its base.
+  __ Str(x0, MemOperand(sp, -16, PreIndex));
+  __ Mov(x9, sp);
+  __ Mov(x11, 0x0123456789abcdef);
+  __ Mov(x12, 0xfedcba9876543210);
+
+  // Loads which can be paired, in either order.
+  __ Ldr(x2, MemOperand(x0, 8));
+  __ Ldr(x3, MemOperand(x0, 16));
+  __ Ldr(x4, MemOperand(x0, 32));
+  __ Ldr(x5, MemOperand(x0, 24));
+  __ Ldr(w6, MemOperand(x0, 40));
+  __ Ldr(w7, MemOperand(x0, 44));
+  // Loads which cannot: to the same register, and changing the base of the
+  // second load.
+  __ Ldr(x8, MemOperand(x0, 48));
+  __ Ldr(x8, MemOperand(x0, 56));
+  __ Ldr(x9, MemOperand(x9, 0));
+  __ Ldr(x10, MemOperand(x9, 8));
+  __ Ldr(d0, MemOperand(x0, 64));
+  __ Ldr(d1, MemOperand(x0, 72));
+  __ Sub(x9, x9, x0);
+
+  // `mov x11, x11` is a no-op, but `mov w12, w12` clears the top of x12.
+  {
+    ExactAssemblyScope scope(masm, 2 * kInstructionSize);
+    __ mov(x11, x11);
+    __ mov(w12, w12);
+  }
+
+  __ Str(x2, MemOperand(x1, 0));
+  __ Str(x3, MemOperand(x1, 8));
+  __ Str(x4, MemOperand(x1, 24));
+  __ Str(x5, MemOperand(x1, 16));
+  __ Str(w6, MemOperand(x1, 32));
+  __ Str(w7, MemOperand(x1, 36));
+  __ Str(x8, MemOperand(x1, 40));
+  __ Str(x9, MemOperand(x1, 48));
+  __ Str(x10, MemOperand(x1, 56));
+  __ Str(d0, MemOperand(x1, 64));
+  __ Str(d1, MemOperand(x1, 72));
+  __ Str(x11, MemOperand(x1, 80));
+  __ Str(x12, MemOperand(x1, 88));
+
+  // Base register updates around accesses.
+  __ Add(x13, x0, 80);
+  __ Add(x13, x13, 8);
+  __ Ldr(x14, MemOperand(x13));
+  __ Ldr(x15, MemOperand(x13));
+  __ Add(x13, x13, 16);
+  __ Sub(x13, x13, 8);
+  __ Str(x14, MemOperand(x13));
+  __ Sub(x23, x13, x0);
+  __ Str(x23, MemOperand(x1, 96));
+  __ Str(x14, MemOperand(x1, 104));
+  __ Str(x15, MemOperand(x1, 112));
+
+  // A label between two loads prevents pairing them.
+  __ Ldr(x19, MemOperand(x0, 0));
+  __ Bind(&label);
+  __ Ldr(x20, MemOperand(x0, 8));
+
+  __ Cmp(x19, 0);
+  __ B(eq, &zero);
+  __ Mov(x21, 1);
+  __ B(&done);
+  __ Bind(&zero);
+  __ Mov(x21, 2);
+  __ Bind(&done);
+  __ Cmp(w20, 0);
+  __ B(ne, &non_zero);
+  __ Mov(x22, 3);
+  __ B(&done_w);
+  __ Bind(&non_zero);
+  __ Mov(x22, 4);
+  __ Bind(&done_w);
+
+  __ Str(x19, MemOperand(x1, 120));
+  __ Str(x20, MemOperand(x1, 128));
+  __ Str(x21, MemOperand(x1, 136));
+  __ Str(x22, MemOperand(x1, 144));
+  __ Add(sp, sp, 16);
+}
+
+
+static size_t GenerateFunction(MacroAssembler* masm, Peephole* peephole) {
+  GeneratePatterns(masm, peephole);
+  __ Ret();
+  masm->FinalizeCode();
+  return masm->GetSizeOfCodeGenerated();
+}
+
+#undef __
+
+
+TEST(rules) {
+  MacroAssembler reference;
+  size_t reference_size = GenerateFunction(&reference, NULL);
+
+  Peephole peephole;
+  MacroAssembler masm;
+  size_t size = GenerateFunction(&masm, &peephole);
+  VIXL_CHECK(peephole.GetCount(Peephole::kRemoveMoveToSelf) == 1);
+  VIXL_CHECK(peephole.GetCount(Peephole::kMergeLoadPair) == 4);
+  VIXL_CHECK(peephole.GetCount(Peephole::kMergeStorePair) == 9);
+  VIXL_CHECK(peephole.GetCount(Peephole::kFoldPreIndex) == 2);
+  VIXL_CHECK(peephole.GetCount(Peephole::kFoldPostIndex) == 1);
+  VIXL_CHECK(peephole.GetCount(Peephole::kFoldCompareIntoBranch) == 0);
+  VIXL_CHECK(reference_size - size ==
+             peephole.GetTotalCount() * kInstructionSize);
+
+  Peephole all_rules(Peephole::kAllRules);
+  MacroAssembler masm_all_rules;
+  size = GenerateFunction(&masm_all_rules, &all_rules);
+  VIXL_CHECK(all_rules.GetCount(Peephole::kFoldCompareIntoBranch) == 2);
+  VIXL_CHECK(reference_size - size ==
+             all_rules.GetTotalCount() * kInstructionSize);
+
+  Peephole no_rules(0);
+  MacroAssembler masm_no_rules;
+  size = GenerateFunction(&masm_no_rules, &no_rules);
+  VIXL_CHECK(no_rules.GetTotalCount() == 0);
+  VIXL_CHECK(size == reference_size);
+}
+
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+struct PatternState {
+  uint64_t input[16];
+  uint64_t output[24];
+  int64_t registers[kNumberOfRegisters];
+  uint64_t d0;
+  uint64_t d1;
+};
+
+static void RunFunction(MacroAssembler* masm,
+                        uint64_t input_seed,
+                        PatternState* state) {
+  for (int i = 0; i < 16; i++) {
+    state->input[i] = (input_seed * (i + 1)) ^ (UINT64_C(0x5555) << i);
+  }
+  memset(state->output, 0, sizeof(state->output));
+
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.WriteXRegister(0, reinterpret_cast<uintptr_t>(state->input));
+  simulator.WriteXRegister(1, reinterpret_cast<uintptr_t>(state->output));
+  simulator.RunFrom(masm->GetBuffer()->GetStartAddress<Instruction*>());
+  for (unsigned i = 0; i < kNumberOfRegisters; i++) {
+    state->registers[i] = simulator.ReadXRegister(i);
+  }
+  state->d0 = simulator.ReadDRegisterBits(0);
+  state->d1 = simulator.ReadDRegisterBits(1);
+}
+
+
+TEST(equivalence) {
+  MacroAssembler reference;
+  GenerateFunction(&reference, NULL);
+  Peephole peephole(Peephole::kAllRules);
+  MacroAssembler masm;
+  GenerateFunction(&masm, &peephole);
+  reference.GetBuffer()->SetExecutable();
+  masm.GetBuffer()->SetExecutable();
+
+  // The first input value decides which way the branches go.
+  const uint64_t kSeeds[] = {0, 1, 0x100000000, 0x0123456789abcdef};
+  for (uint64_t seed : kSeeds) {
+    PatternState expected;
+    PatternState actual;
+    RunFunction(&reference, seed, &expected);
+    RunFunction(&masm, seed, &actual);
+    VIXL_CHECK(memcmp(expected.input, actual.input, sizeof(actual.input)) ==
+               0);
+    VIXL_CHECK(memcmp(expected.output, actual.output, sizeof(actual.output)) ==
+               0);
+    // x0, x1 and x13 hold pointers to the inputs and outputs, which differ,
+    // and x16 and x17 are scratch registers.
+    for (unsigned i = 2; i < kNumberOfRegisters; i++) {
+      if ((i == 13) || (i == 16) || (i == 17)) continue;
+      VIXL_CHECK(expected.registers[i] == actual.registers[i]);
+    }
+    VIXL_CHECK(expected.d0 == actual.d0);
+    VIXL_CHECK(expected.d1 == actual.d1);
+  }
+}
+#endif
+
+
+// The arguments of debug pseudo instructions are data, even when they look
+// like instructions which could be optimised.
+TEST(pseudo_instructions) {
+  // Encode two loads which would be paired.
+  MacroAssembler encoder;
+  {
+    ExactAssemblyScope scope(&encoder, 2 * kInstructionSize);
+    encoder.ldr(x2, MemOperand(x0));
+    encoder.ldr(x3, MemOperand(x0, 8));
+  }
+  encoder.FinalizeCode();
+  const Instr* loads = encoder.GetBuffer()->GetStartAddress<const Instr*>();
+
+  // Use them as the arguments of a trace pseudo instruction, followed by the
+  // same loads as real code.
+  Peephole peephole;
+  MacroAssembler masm;
+  masm.SetGenerateSimulatorCode(true);
+  {
+    PeepholeScope scope(&masm, &peephole);
+    {
+      ExactAssemblyScope eas(&masm, kTraceLength);
+      masm.hlt(kTraceOpcode);
+      masm.dc32(loads[0]);
+      masm.dc32(loads[1]);
+    }
+    masm.Ldr(x2, MemOperand(x0));
+    masm.Ldr(x3, MemOperand(x0, 8));
+  }
+  masm.FinalizeCode();
+  VIXL_CHECK(peephole.GetCount(Peephole::kMergeLoadPair) == 1);
+  VIXL_CHECK(masm.GetSizeOfCodeGenerated() ==
+             (kTraceLength + kInstructionSize));
+  const Instr* code = masm.GetBuffer()->GetStartAddress<const Instr*>();
+  VIXL_CHECK((code[1] == loads[0]) && (code[2] == loads[1]));
+
+  // The same applies when the optimiser is used directly.
+  std::vector<Instr> segment(code, code + (kTraceLength / kInstructionSize));
+  peephole.ResetCounts();
+  peephole.Optimize(&segment);
+  VIXL_CHECK(peephole.GetTotalCount() == 0);
+  VIXL_CHECK(segment.size() == (kTraceLength / kInstructionSize));
+  VIXL_CHECK((segment[1] == loads[0]) && (segment[2] == loads[1]));
+}
+
+}  // namespace aarch64
+}  // namespace vixl
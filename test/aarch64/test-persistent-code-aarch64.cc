@@ -0,0 +1,301 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "test-runner.h"
+#include "test-utils.h"
+
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/persistent-code-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+
+#define TEST(name) TEST_(AARCH64_API_persistent_code_##name)
+
+namespace vixl {
+namespace aarch64 {
+
+enum TestSymbol { kHelperSymbol, kDataSymbol, kTestSymbolCount };
+
+// Generate `uint64_t f(uint64_t x)`, returning `helper(x + *data + 7)`, where
+// `helper` and `data` are external symbols, and 7 is loaded through an
+// address in the code itself.
+static void GenerateRelocatedFunction(MacroAssembler* masm,
+                                      uintptr_t helper,
+                                      uintptr_t data) {
+  Label table, start;
+  masm->B(&start);
+  masm->Bind(&table);
+  {
+    ExactAssemblyScope scope(masm, sizeof(uint64_t));
+    masm->dc64(7);
+  }
+  masm->Bind(&start);
+  masm->Push(lr, xzr);
+  masm->LdrExternalAddress(x1, kDataSymbol, data);
+  masm->Ldr(x1, MemOperand(x1));
+  masm->Add(x0, x0, x1);
+  masm->MovCodeAddress(x2, &table);
+  masm->Ldr(x2, MemOperand(x2));
+  masm->Add(x0, x0, x2);
+  masm->CallExternal(kHelperSymbol, helper);
+  masm->Pop(xzr, lr);
+  masm->Ret();
+  masm->FinalizeCode();
+}
+
+// Generate `uint64_t helper(uint64_t x)`, returning `x * factor`.
+static void GenerateHelper(MacroAssembler* masm, uint64_t factor) {
+  masm->Mov(x1, factor);
+  masm->Mul(x0, x0, x1);
+  masm->Ret();
+  masm->FinalizeCode();
+}
+
+TEST(relocations) {
+  uint64_t data = 0;
+  MacroAssembler masm;
+  GenerateRelocatedFunction(&masm,
+                            0x0123456789abcdef,
+                            reinterpret_cast<uintptr_t>(&data));
+
+  // The literal is placed after the code using it, so its relocation comes
+  // last.
+  const std::vector<Relocation>& relocations = masm.GetRelocations();
+  VIXL_CHECK(relocations.size() == 3);
+  VIXL_CHECK(relocations[0].type == Relocation::kMovWide64);
+  VIXL_CHECK(relocations[0].symbol == Relocation::kCodeStart);
+  VIXL_CHECK(relocations[0].addend == static_cast<int64_t>(kInstructionSize));
+  VIXL_CHECK(relocations[1].type == Relocation::kMovWide64);
+  VIXL_CHECK(relocations[1].symbol == kHelperSymbol);
+  VIXL_CHECK(relocations[1].addend == 0);
+  VIXL_CHECK(relocations[2].type == Relocation::kData64);
+  VIXL_CHECK(relocations[2].symbol == kDataSymbol);
+  VIXL_CHECK(relocations[0].offset < relocations[1].offset);
+  VIXL_CHECK(relocations[1].offset < relocations[2].offset);
+
+  // The code refers to the addresses it was generated with.
+  byte* code = masm.GetBuffer()->GetStartAddress<byte*>();
+  uint64_t literal;
+  memcpy(&literal, code + relocations[2].offset, sizeof(literal));
+  VIXL_CHECK(literal == reinterpret_cast<uintptr_t>(&data));
+  Instruction* movz =
+      reinterpret_cast<Instruction*>(code + relocations[1].offset);
+  VIXL_CHECK(movz->GetImmMoveWide() == 0xcdef);
+
+  // Applying the relocations updates every address.
+  uintptr_t symbols[kTestSymbolCount] = {0xfedcba9876543210, 0x1122334455};
+  for (size_t i = 0; i < relocations.size(); i++) {
+    relocations[i].Apply(code, symbols);
+  }
+  memcpy(&literal, code + relocations[2].offset, sizeof(literal));
+  VIXL_CHECK(literal == 0x1122334455);
+  for (int i = 0; i < 4; i++) {
+    VIXL_CHECK(static_cast<uint64_t>(movz->GetImmMoveWide()) ==
+               ((symbols[kHelperSymbol] >> (16 * i)) & 0xffff));
+    movz = movz->GetNextInstruction();
+  }
+
+  masm.Reset();
+  VIXL_CHECK(masm.GetRelocations().empty());
+}
+
+#ifdef VIXL_CODE_BUFFER_MMAP
+TEST(save_and_load) {
+  char path[] = "/tmp/vixl-test-persistent-code-XXXXXX";
+  int fd = mkstemp(path);
+  VIXL_CHECK(fd >= 0);
+  close(fd);
+
+  uint64_t data = 100;
+  const uint64_t key = 0x5eed;
+  MacroAssembler helper_masm;
+  GenerateHelper(&helper_masm, 2);
+  {
+    MacroAssembler masm;
+    uintptr_t helper = helper_masm.GetBuffer()->GetStartAddress<uintptr_t>();
+    GenerateRelocatedFunction(&masm,
+                              helper,
+                              reinterpret_cast<uintptr_t>(&data));
+    VIXL_CHECK(PersistentCode::Save(path, key, masm));
+  }
+
+  // Reload the code with the external symbols at new addresses, as if in a new
+  // process.
+  uint64_t other_data = 1000;
+  MacroAssembler other_helper_masm;
+  GenerateHelper(&other_helper_masm, 3);
+  uintptr_t symbols[kTestSymbolCount];
+  symbols[kHelperSymbol] =
+      other_helper_masm.GetBuffer()->GetStartAddress<uintptr_t>();
+  symbols[kDataSymbol] = reinterpret_cast<uintptr_t>(&other_data);
+
+  PersistentCode code;
+  VIXL_CHECK(!code.Load(path, key + 1, symbols, kTestSymbolCount));
+  VIXL_CHECK(!code.Load(path, key, symbols, kTestSymbolCount - 1));
+  VIXL_CHECK(!code.IsLoaded());
+  VIXL_CHECK(code.Load(path, key, symbols, kTestSymbolCount));
+  VIXL_CHECK(code.IsLoaded());
+  VIXL_CHECK(code.GetSize() > 0);
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.WriteXRegister(0, 1);
+  simulator.RunFrom(code.GetStartAddress<Instruction*>());
+  VIXL_CHECK(simulator.ReadXRegister(0) == ((1 + 1000 + 7) * 3));
+#elif defined(__aarch64__)
+  other_helper_masm.GetBuffer()->SetExecutable();
+  CPU::EnsureIAndDCacheCoherency(
+      other_helper_masm.GetBuffer()->GetStartAddress<void*>(),
+      other_helper_masm.GetSizeOfCodeGenerated());
+  uint64_t (*function)(uint64_t) =
+      code.GetStartAddress<uint64_t (*)(uint64_t)>();
+  VIXL_CHECK(function(1) == ((1 + 1000 + 7) * 3));
+  other_helper_masm.GetBuffer()->SetWritable();
+#endif
+  code.Unload();
+  VIXL_CHECK(!code.IsLoaded());
+
+  // Truncated or missing files are rejected.
+  VIXL_CHECK(truncate(path, 16) == 0);
+  VIXL_CHECK(!code.Load(path, key, symbols, kTestSymbolCount));
+  remove(path);
+  VIXL_CHECK(!code.Load(path, key, symbols, kTestSymbolCount));
+}
+
+static std::vector<byte> ReadFile(const char* path) {
+  std::vector<byte> contents;
+  FILE* file = fopen(path, "rb");
+  VIXL_CHECK(file != NULL);
+  byte buffer[256];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    contents.insert(contents.end(), buffer, buffer + size);
+  }
+  fclose(file);
+  return contents;
+}
+
+static void WriteFile(const char* path, const std::vector<byte>& contents) {
+  FILE* file = fopen(path, "wb");
+  VIXL_CHECK(file != NULL);
+  VIXL_CHECK(fwrite(contents.data(), 1, contents.size(), file) ==
+             contents.size());
+  VIXL_CHECK(fclose(file) == 0);
+}
+
+TEST(load_rejects_invalid_relocations) {
+  char path[] = "/tmp/vixl-test-persistent-code-XXXXXX";
+  int fd = mkstemp(path);
+  VIXL_CHECK(fd >= 0);
+  close(fd);
+
+  uint64_t data = 0;
+  const uint64_t key = 0x5eed;
+  MacroAssembler masm;
+  GenerateRelocatedFunction(&masm, 0, reinterpret_cast<uintptr_t>(&data));
+  VIXL_CHECK(PersistentCode::Save(path, key, masm));
+  const std::vector<Relocation>& relocations = masm.GetRelocations();
+  VIXL_CHECK(relocations.size() == 3);
+  VIXL_CHECK(relocations[1].type == Relocation::kMovWide64);
+
+  // The relocations follow the header, and the code ends the file.
+  const std::vector<byte> original = ReadFile(path);
+  size_t code_offset = original.size() - masm.GetSizeOfCodeGenerated();
+  size_t first_relocation = code_offset;
+  for (size_t offset = 0; (offset + sizeof(Relocation)) <= code_offset;
+       offset += sizeof(uint64_t)) {
+    Relocation record;
+    memcpy(&record, &original[offset], sizeof(record));
+    if ((record.offset == relocations[0].offset) &&
+        (record.type == relocations[0].type) &&
+        (record.symbol == relocations[0].symbol) &&
+        (record.addend == relocations[0].addend)) {
+      first_relocation = offset;
+      break;
+    }
+  }
+  VIXL_CHECK(first_relocation < code_offset);
+
+  // The padding of the relocation records is written as zeroes.
+  const size_t padding_start =
+      offsetof(Relocation, symbol) + sizeof(relocations[0].symbol);
+  for (size_t i = 0; i < relocations.size(); i++) {
+    size_t record = first_relocation + (i * sizeof(Relocation));
+    for (size_t j = padding_start; j < offsetof(Relocation, addend); j++) {
+      VIXL_CHECK(original[record + j] == 0);
+    }
+  }
+
+  uintptr_t symbols[kTestSymbolCount] = {0, reinterpret_cast<uintptr_t>(&data)};
+  PersistentCode code;
+  VIXL_CHECK(code.Load(path, key, symbols, kTestSymbolCount));
+  code.Unload();
+
+  // A kMovWide64 relocation which is not aligned.
+  std::vector<byte> contents = original;
+  size_t movz_record = first_relocation + sizeof(Relocation);
+  uint32_t offset = relocations[1].offset + 2;
+  memcpy(&contents[movz_record + offsetof(Relocation, offset)],
+         &offset,
+         sizeof(offset));
+  WriteFile(path, contents);
+  VIXL_CHECK(!code.Load(path, key, symbols, kTestSymbolCount));
+
+  // A kMovWide64 relocation whose second instruction is not the expected
+  // MOVK.
+  contents = original;
+  uint32_t nop = NOP;
+  memcpy(&contents[code_offset + relocations[1].offset + kInstructionSize],
+         &nop,
+         sizeof(nop));
+  WriteFile(path, contents);
+  VIXL_CHECK(!code.Load(path, key, symbols, kTestSymbolCount));
+
+  // Overlapping relocations.
+  contents = original;
+  offset = relocations[1].offset + (2 * kInstructionSize);
+  memcpy(&contents[first_relocation + (2 * sizeof(Relocation)) +
+                   offsetof(Relocation, offset)],
+         &offset,
+         sizeof(offset));
+  WriteFile(path, contents);
+  VIXL_CHECK(!code.Load(path, key, symbols, kTestSymbolCount));
+  VIXL_CHECK(!code.IsLoaded());
+
+  remove(path);
+}
+#endif
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -53,6 +53,53 @@ TEST(compute_pac) {
   VIXL_CHECK(pac1 != pac2);
 }
 
+TEST(compute_pac_reference_values) {
+  Decoder decoder;
+  Simulator sim(&decoder);
+
+  Simulator::PACKey keys[] = {{0x84be85ce9804e94b, 0xec2802d4e0a488e9, 0},
+                              {0xec1119e288704d13, 0xd7f6b76e1cea585e, 1}};
+
+  // These values were generated with a straightforward, nibble-by-nibble
+  // implementation of the hash. They check that the table-driven evaluation
+  // (and result caching) in ComputePAC do not change the results.
+  struct {
+    uint64_t data;
+    uint64_t context;
+    int key;
+    uint64_t pac;
+  } reference[] = {
+      {0x3f2800d6569e01b4, 0x606f949a3cebd0b7, 0, 0x62c95df99a70f235},
+      {0xc69bba40dddccad6, 0xbdc162a6bf8906c3, 1, 0xa0a2188997d94bca},
+      {0xacccfee2b873c40e, 0x2208ba58d97fe006, 0, 0xd1f7b702b9e6338a},
+      {0x7942b05e77b9de46, 0xf7bfd187e61dfc7a, 1, 0x05564183ae6ddf79},
+      {0x6ba9915de3259902, 0x0bf76c2887c5d2b0, 0, 0x9b6267d38a6037e2},
+      {0xd7eda3f877c2f515, 0x73e1da3f024c95bf, 1, 0xd3eaf5306616b318},
+      {0xa4338db77b728354, 0x04175a80ffea3352, 0, 0x90149b9fcf4e40b1},
+      {0x79774e11a59b73b4, 0xb13b0ca3dedc2853, 1, 0x92490cd890980163},
+  };
+
+  // Run through the list twice, so that the second pass can hit in the cache.
+  for (int pass = 0; pass < 2; pass++) {
+    for (size_t i = 0; i < ArrayLength(reference); i++) {
+      uint64_t pac = sim.ComputePAC(reference[i].data,
+                                    reference[i].context,
+                                    keys[reference[i].key]);
+      VIXL_CHECK(pac == reference[i].pac);
+    }
+  }
+
+  // The same data and context with a different key must not hit in the cache.
+  uint64_t pac_a = sim.ComputePAC(reference[0].data,
+                                  reference[0].context,
+                                  keys[0]);
+  uint64_t pac_b = sim.ComputePAC(reference[0].data,
+                                  reference[0].context,
+                                  keys[1]);
+  VIXL_CHECK(pac_a == reference[0].pac);
+  VIXL_CHECK(pac_a != pac_b);
+}
+
 TEST(add_and_auth_pac) {
   Decoder decoder;
   Simulator sim(&decoder);
@@ -0,0 +1,296 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <vector>
+
+#include "test-runner.h"
+
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/register-allocator-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+
+#define TEST(name) TEST_(AARCH64_API_register_allocator_##name)
+
+namespace vixl {
+namespace aarch64 {
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+// Run the function at `offset` in `masm` with `arg` in x0, and check that it
+// preserves the stack pointer and the callee-saved registers.
+static uint64_t RunFunction(Simulator* simulator,
+                            MacroAssembler* masm,
+                            ptrdiff_t offset,
+                            uint64_t arg) {
+  const uint64_t kCalleeSavedMarker = 0x0123456789abcd00;
+  for (unsigned code = 19; code <= 28; code++) {
+    simulator->WriteXRegister(code, kCalleeSavedMarker + code);
+  }
+  for (unsigned code = 8; code <= 15; code++) {
+    simulator->WriteDRegister(code, static_cast<double>(code));
+  }
+  int64_t stack_pointer =
+      simulator->ReadXRegister(kSpRegCode, Reg31IsStackPointer);
+  simulator->WriteXRegister(0, arg);
+  simulator->RunFrom(masm->GetBuffer()->GetOffsetAddress<Instruction*>(offset));
+  VIXL_CHECK(simulator->ReadXRegister(kSpRegCode, Reg31IsStackPointer) ==
+             stack_pointer);
+  for (unsigned code = 19; code <= 28; code++) {
+    VIXL_CHECK(static_cast<uint64_t>(simulator->ReadXRegister(code)) ==
+               kCalleeSavedMarker + code);
+  }
+  for (unsigned code = 8; code <= 15; code++) {
+    VIXL_CHECK(simulator->ReadDRegister(code) == static_cast<double>(code));
+  }
+  return simulator->ReadXRegister(0);
+}
+#endif
+
+
+TEST(spill) {
+  // Keep more values live than there are registers to hold them.
+  const int kValueCount = 40;
+  MacroAssembler masm;
+  VirtualCode code;
+  VirtualRegister base = code.AllocateX();
+  std::vector<VirtualRegister> values;
+  code.Argument(base, 0);
+  for (int i = 0; i < kValueCount; i++) {
+    values.push_back(code.AllocateX());
+    code.Ldr(values[i], base, i * kXRegSizeInBytes);
+  }
+  VirtualRegister sum = code.AllocateX();
+  code.Mov(sum, 0);
+  for (int i = 0; i < kValueCount; i++) {
+    VirtualRegister product = code.AllocateX();
+    code.Mul(product, values[i], values[kValueCount - 1 - i]);
+    code.Add(sum, sum, product);
+  }
+  code.Return(sum);
+  code.Generate(&masm);
+  masm.FinalizeCode();
+  VIXL_CHECK(code.GetSpillCount() > 0);
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+  uint64_t input[kValueCount];
+  uint64_t expected = 0;
+  for (int i = 0; i < kValueCount; i++) {
+    input[i] = UINT64_C(0x9e3779b97f4a7c15) * (i + 1);
+  }
+  for (int i = 0; i < kValueCount; i++) {
+    expected += input[i] * input[kValueCount - 1 - i];
+  }
+  masm.GetBuffer()->SetExecutable();
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  VIXL_CHECK(RunFunction(&simulator,
+                         &masm,
+                         0,
+                         reinterpret_cast<uintptr_t>(input)) == expected);
+#endif
+}
+
+
+// Generate a function returning x0 * x1 + 1, and clobbering every other
+// caller-saved register.
+static void GenerateClobberingHelper(MacroAssembler* masm,
+                                     bool clobber_sve) {
+  masm->Mul(x0, x0, x1);
+  masm->Add(x0, x0, 1);
+  for (unsigned code = 1; code <= 17; code++) {
+    masm->Mov(Register(code, kXRegSize), 0xbad);
+  }
+  for (unsigned code = 0; code < kNumberOfVRegisters; code++) {
+    if ((code >= 8) && (code <= 15)) continue;
+    if (clobber_sve) {
+      masm->Dup(ZRegister(code, kDRegSize), -1);
+    } else {
+      masm->Movi(VRegister(code, kQRegSize).V16B(), 0xbd);
+    }
+  }
+  if (clobber_sve) {
+    for (unsigned code = 0; code < 8; code++) {
+      masm->Pfalse(PRegister(code).VnB());
+    }
+  }
+  masm->Ret();
+}
+
+
+TEST(loop_and_call) {
+  MacroAssembler masm;
+  Label helper;
+  masm.Bind(&helper);
+  GenerateClobberingHelper(&masm, false);
+  ptrdiff_t entry = masm.GetCursorOffset();
+
+  // Sum i * i + 1 for i from n down to 1, counting the iterations in a
+  // double, and keeping a Q register live across the calls.
+  VirtualCode code;
+  VirtualRegister n = code.AllocateX();
+  VirtualRegister sum = code.AllocateX();
+  VirtualRegister count = code.AllocateD();
+  VirtualRegister one = code.AllocateD();
+  VirtualRegister vector = code.AllocateQ();
+  Label loop, done;
+  code.Argument(n, 0);
+  code.Mov(sum, 0);
+  code.Emit({count}, {}, [](MacroAssembler* m, const CPURegister* registers) {
+    m->Fmov(VRegister(registers[0]), 0.0);
+  });
+  code.Emit({one}, {}, [](MacroAssembler* m, const CPURegister* registers) {
+    m->Fmov(VRegister(registers[0]), 1.0);
+  });
+  code.Emit({vector}, {}, [](MacroAssembler* m, const CPURegister* registers) {
+    m->Movi(VRegister(registers[0]).V16B(), 0x42);
+  });
+  code.Bind(&loop);
+  code.Cbz(n, &done);
+  VirtualRegister result = code.AllocateX();
+  code.Call(&helper, {n, n}, result);
+  code.Add(sum, sum, result);
+  code.Fadd(count, count, one);
+  code.Sub(n, n, 1);
+  code.B(&loop);
+  code.Bind(&done);
+  VirtualRegister count_x = code.AllocateX();
+  code.Emit({count_x},
+            {count},
+            [](MacroAssembler* m, const CPURegister* registers) {
+              m->Fcvtzs(Register(registers[0]), VRegister(registers[1]));
+            });
+  code.Add(sum, sum, count_x);
+  VirtualRegister lane = code.AllocateX();
+  code.Emit({lane},
+            {vector},
+            [](MacroAssembler* m, const CPURegister* registers) {
+              m->Umov(Register(registers[0]), VRegister(registers[1]).V2D(), 1);
+            });
+  code.Add(sum, sum, lane);
+  code.Return(sum);
+  code.Generate(&masm);
+  masm.FinalizeCode();
+
+  // Only the Q register, whose upper half is not preserved by calls, needs to
+  // be spilled. The others are live across the call, in callee-saved
+  // registers.
+  VIXL_CHECK(code.GetSpillCount() == 1);
+  VIXL_CHECK(code.GetCalleeSavedRegisters().GetCount() == 2);
+  VIXL_CHECK(code.GetCalleeSavedVRegisters().GetCount() == 2);
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+  masm.GetBuffer()->SetExecutable();
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  for (uint64_t i = 0; i <= 10; i++) {
+    uint64_t expected = 0x4242424242424242;
+    for (uint64_t j = 1; j <= i; j++) expected += (j * j) + 1 + 1;
+    VIXL_CHECK(RunFunction(&simulator, &masm, entry, i) == expected);
+  }
+#endif
+}
+
+
+TEST(sve) {
+  MacroAssembler masm;
+  masm.GetCPUFeatures()->Combine(CPUFeatures::kSVE);
+  Label helper;
+  masm.Bind(&helper);
+  GenerateClobberingHelper(&masm, true);
+  ptrdiff_t entry = masm.GetCursorOffset();
+
+  // Store the sum of 1 to kValueCount to every D-sized lane of the output,
+  // with all the values and the predicate live across a call, so that they
+  // are spilled.
+  const int kValueCount = 8;
+  VirtualCode code;
+  VirtualRegister output = code.AllocateX();
+  VirtualRegister pg = code.AllocateP();
+  std::vector<VirtualRegister> values;
+  code.Argument(output, 0);
+  code.Emit({pg}, {}, [](MacroAssembler* m, const CPURegister* registers) {
+    m->Ptrue(PRegister(registers[0]).VnD());
+  });
+  for (int i = 0; i < kValueCount; i++) {
+    values.push_back(code.AllocateZ(kDRegSize));
+    code.Emit({values[i]},
+              {},
+              [i](MacroAssembler* m, const CPURegister* registers) {
+                m->Dup(ZRegister(registers[0]), i + 1);
+              });
+  }
+  VirtualRegister arg = code.AllocateX();
+  code.Mov(arg, 0);
+  code.Call(&helper, {arg, arg});
+  VirtualRegister sum = code.AllocateZ(kDRegSize);
+  code.Emit({sum}, {}, [](MacroAssembler* m, const CPURegister* registers) {
+    m->Dup(ZRegister(registers[0]), 0);
+  });
+  for (int i = 0; i < kValueCount; i++) {
+    code.Emit({sum},
+              {sum, values[i]},
+              [](MacroAssembler* m, const CPURegister* registers) {
+                m->Add(ZRegister(registers[0]),
+                       ZRegister(registers[1]),
+                       ZRegister(registers[2]));
+              });
+  }
+  code.Emit({},
+            {sum, pg, output},
+            [](MacroAssembler* m, const CPURegister* registers) {
+              m->St1d(ZRegister(registers[0]),
+                      PRegister(registers[1]),
+                      SVEMemOperand(Register(registers[2])));
+            });
+  code.Return();
+  code.Generate(&masm);
+  masm.FinalizeCode();
+  VIXL_CHECK(code.GetSpillCount() == kValueCount + 1);
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+  // The frame depends on the vector length, so try a few.
+  masm.GetBuffer()->SetExecutable();
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  const unsigned kVectorLengths[] = {128, 384, 2048};
+  for (unsigned vl : kVectorLengths) {
+    simulator.SetVectorLengthInBits(vl);
+    uint64_t output_lanes[kZRegMaxSize / kDRegSize] = {};
+    RunFunction(&simulator,
+                &masm,
+                entry,
+                reinterpret_cast<uintptr_t>(output_lanes));
+    for (unsigned i = 0; i < (kZRegMaxSize / kDRegSize); i++) {
+      uint64_t expected =
+          (i < (vl / kDRegSize)) ? (kValueCount * (kValueCount + 1)) / 2 : 0;
+      VIXL_CHECK(output_lanes[i] == expected);
+    }
+  }
+#endif
+}
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -0,0 +1,375 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cstring>
+#include <vector>
+
+#include "test-runner.h"
+
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/scheduler-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+
+#define TEST(name) TEST_(AARCH64_API_scheduler_##name)
+
+namespace vixl {
+namespace aarch64 {
+
+#define __ masm->
+
+// Generate code using up to four labels.
+typedef void (*CodeGenerator)(MacroAssembler* masm, Label* labels);
+
+// Generate code with `generator`, scheduled by `scheduler` unless it is NULL.
+static void Generate(MacroAssembler* masm,
+                     CodeGenerator generator,
+                     Scheduler* scheduler) {
+  // The labels are bound when the scope closes, so they must outlive it.
+  Label labels[4];
+  if (scheduler == NULL) {
+    generator(masm, labels);
+  } else {
+    SchedulingScope scope(masm, scheduler);
+    generator(masm, labels);
+  }
+  masm->FinalizeCode();
+}
+
+static bool HaveSameCode(MacroAssembler* a, MacroAssembler* b) {
+  return (a->GetSizeOfCodeGenerated() == b->GetSizeOfCodeGenerated()) &&
+         (memcmp(a->GetBuffer()->GetStartAddress<const void*>(),
+                 b->GetBuffer()->GetStartAddress<const void*>(),
+                 a->GetSizeOfCodeGenerated()) == 0);
+}
+
+// Check that scheduling the code from `generator` gives the code from
+// `expected`, and return the number of instructions moved.
+static int CheckSchedule(CodeGenerator generator, CodeGenerator expected) {
+  Scheduler scheduler(Scheduler::kCortexA72);
+  MacroAssembler scheduled;
+  Generate(&scheduled, generator, &scheduler);
+  MacroAssembler reference;
+  Generate(&reference, expected, NULL);
+  VIXL_CHECK(HaveSameCode(&scheduled, &reference));
+  VIXL_CHECK((scheduler.GetMovedCount() > 0) ==
+             (scheduler.GetCyclesSaved() > 0));
+  return scheduler.GetMovedCount();
+}
+
+
+static void GenerateLoadUses(MacroAssembler* masm, Label*) {
+  __ Ldr(x2, MemOperand(x0));
+  __ Add(x3, x2, 1);
+  __ Ldr(x4, MemOperand(x0, 8));
+  __ Add(x5, x4, 1);
+}
+
+static void GenerateLoadUsesScheduled(MacroAssembler* masm, Label*) {
+  __ Ldr(x2, MemOperand(x0));
+  __ Ldr(x4, MemOperand(x0, 8));
+  __ Add(x3, x2, 1);
+  __ Add(x5, x4, 1);
+}
+
+static void GenerateFPChains(MacroAssembler* masm, Label*) {
+  __ Fmul(d0, d1, d2);
+  __ Fadd(d3, d0, d4);
+  __ Fmul(d5, d6, d7);
+  __ Fadd(d8, d5, d4);
+  __ Add(x2, x3, x4);
+}
+
+static void GenerateFPChainsScheduled(MacroAssembler* masm, Label*) {
+  __ Fmul(d0, d1, d2);
+  __ Fmul(d5, d6, d7);
+  __ Add(x2, x3, x4);
+  __ Fadd(d3, d0, d4);
+  __ Fadd(d8, d5, d4);
+}
+
+TEST(reorder) {
+  VIXL_CHECK(CheckSchedule(GenerateLoadUses, GenerateLoadUsesScheduled) == 2);
+  VIXL_CHECK(CheckSchedule(GenerateFPChains, GenerateFPChainsScheduled) == 4);
+}
+
+
+// The second load could be hoisted if it did not follow a store.
+static void GenerateStoreThenLoad(MacroAssembler* masm, Label*) {
+  __ Ldr(x2, MemOperand(x0));
+  __ Add(x3, x2, 1);
+  __ Str(x3, MemOperand(x1));
+  __ Ldr(x4, MemOperand(x1, 8));
+  __ Add(x5, x4, 1);
+}
+
+// The second comparison could be hoisted if it did not overwrite the flags.
+static void GenerateFlagUses(MacroAssembler* masm, Label*) {
+  __ Ldr(x2, MemOperand(x0));
+  __ Cmp(x2, 1);
+  __ Cset(x3, eq);
+  __ Cmp(x4, 2);
+  __ Cset(x5, eq);
+}
+
+// Nothing is moved across a barrier.
+static void GenerateBarrier(MacroAssembler* masm, Label*) {
+  __ Ldr(x2, MemOperand(x0));
+  __ Add(x3, x2, 1);
+  __ Dmb(InnerShareable, BarrierAll);
+  __ Ldr(x4, MemOperand(x0, 8));
+  __ Add(x5, x4, 1);
+}
+
+// The load can be hoisted within the loop, but not out of it.
+static void GenerateLabel(MacroAssembler* masm, Label* labels) {
+  __ Ldr(x2, MemOperand(x0));
+  __ Bind(&labels[0]);
+  __ Add(x3, x2, 1);
+  __ Ldr(x4, MemOperand(x0, 8));
+  __ Add(x5, x4, 1);
+  __ Cbz(x5, &labels[0]);
+}
+
+static void GenerateLabelScheduled(MacroAssembler* masm, Label* labels) {
+  __ Ldr(x2, MemOperand(x0));
+  __ Bind(&labels[0]);
+  __ Ldr(x4, MemOperand(x0, 8));
+  __ Add(x3, x2, 1);
+  __ Add(x5, x4, 1);
+  __ Cbz(x5, &labels[0]);
+}
+
+// The multiply reads v2, even though the by-element encoding places the
+// element index in the top bit of the register field.
+static void GenerateByElement(MacroAssembler* masm, Label*) {
+  __ Ldr(q2, MemOperand(x0));
+  __ Mul(v0.V8H(), v1.V8H(), v2.H(), 1);
+  __ Add(v4.V8H(), v0.V8H(), v0.V8H());
+  __ Add(v5.V8H(), v4.V8H(), v4.V8H());
+}
+
+TEST(dependencies) {
+  VIXL_CHECK(CheckSchedule(GenerateStoreThenLoad, GenerateStoreThenLoad) == 0);
+  VIXL_CHECK(CheckSchedule(GenerateFlagUses, GenerateFlagUses) == 0);
+  VIXL_CHECK(CheckSchedule(GenerateBarrier, GenerateBarrier) == 0);
+  VIXL_CHECK(CheckSchedule(GenerateLabel, GenerateLabelScheduled) == 2);
+  VIXL_CHECK(CheckSchedule(GenerateByElement, GenerateByElement) == 0);
+}
+
+
+// The arguments of debug pseudo instructions are data, and are not reordered
+// even when they look like instructions which could be.
+TEST(pseudo_instructions) {
+  MacroAssembler masm;
+  {
+    ExactAssemblyScope scope(&masm, kTraceLength + (2 * kInstructionSize));
+    masm.hlt(kTraceOpcode);
+    masm.add(x3, x2, 1);
+    masm.ldr(x4, MemOperand(x0, 8));
+    // The same instructions, as code.
+    masm.add(x3, x2, 1);
+    masm.ldr(x4, MemOperand(x0, 8));
+  }
+  masm.FinalizeCode();
+  const Instr* code = masm.GetBuffer()->GetStartAddress<const Instr*>();
+  std::vector<Instr> scheduled(code, code + 5);
+  Scheduler scheduler(Scheduler::kCortexA72);
+  scheduler.Schedule(&scheduled);
+  VIXL_CHECK((scheduled[0] == code[0]) && (scheduled[1] == code[1]) &&
+             (scheduled[2] == code[2]));
+  VIXL_CHECK((scheduled[3] == code[4]) && (scheduled[4] == code[3]));
+}
+
+
+TEST(latencies) {
+  MacroAssembler masm;
+  masm.Add(x0, x1, x2);
+  masm.Ldr(x0, MemOperand(x1));
+  masm.Fdiv(d0, d1, d2);
+  masm.FinalizeCode();
+  const Instr* code = masm.GetBuffer()->GetStartAddress<const Instr*>();
+  const Scheduler::CoreModel kModels[] = {Scheduler::kCortexA53,
+                                          Scheduler::kCortexA72,
+                                          Scheduler::kNeoverseN1};
+  for (Scheduler::CoreModel model : kModels) {
+    Scheduler scheduler(model);
+    VIXL_CHECK(scheduler.GetLatency(code[0]) == 1);
+    VIXL_CHECK(scheduler.GetLatency(code[1]) > 1);
+    VIXL_CHECK(scheduler.GetLatency(code[2]) > scheduler.GetLatency(code[1]));
+    std::vector<Instr> dependent(code, code + 3);
+    VIXL_CHECK(scheduler.EstimateCycles(dependent) ==
+               2 + scheduler.GetLatency(code[2]));
+  }
+}
+
+
+// A mix of integer, memory, FP, NEON and flag-setting code, with loops and
+// branches. x0 points to 16 input values, and x1 to 64 output values.
+static void GenerateMixed(MacroAssembler* masm, Label* labels) {
+  Label* skip = &labels[0];
+  Label* done = &labels[1];
+  Label* loop = &labels[2];
+  __ Ldr(x2, MemOperand(x0));
+  __ Ldr(x3, MemOperand(x0, 8));
+  __ Mul(x4, x2, x3);
+  __ Add(x5, x4, x2);
+  __ Ldr(x6, MemOperand(x0, 16));
+  __ Udiv(x7, x6, x3);
+  __ Str(x5, MemOperand(x1));
+  __ Ldr(x8, MemOperand(x1));
+  __ Add(x8, x8, 1);
+  __ Str(x8, MemOperand(x1, 8));
+
+  __ Ldr(d0, MemOperand(x0, 24));
+  __ Ldr(d1, MemOperand(x0, 32));
+  __ Fmul(d2, d0, d1);
+  __ Fadd(d3, d2, d0);
+  __ Fdiv(d4, d3, d1);
+  __ Str(d4, MemOperand(x1, 16));
+  __ Ldr(q5, MemOperand(x0, 48));
+  __ Ldr(q6, MemOperand(x0, 64));
+  __ Mul(v7.V4S(), v5.V4S(), v6.V4S());
+  __ Add(v8.V4S(), v7.V4S(), v5.V4S());
+  __ Str(q8, MemOperand(x1, 32));
+
+  __ Cmp(x2, x3);
+  __ Cset(x9, lo);
+  __ Adds(x10, x2, x3);
+  __ Adc(x11, x4, x5);
+  __ Csel(x12, x6, x7, mi);
+  __ Fcmp(d0, d1);
+  __ Fcsel(d9, d0, d1, gt);
+  __ Fmov(x13, d9);
+  __ Umov(w14, v8.V4S(), 1);
+  __ Ins(v8.V2D(), 1, x2);
+  __ Str(q8, MemOperand(x1, 48));
+
+  __ Cbz(x2, skip);
+  __ Madd(x15, x2, x3, x4);
+  __ Ldr(x19, MemOperand(x0, 80));
+  __ Add(x20, x19, x15);
+  __ B(done);
+  __ Bind(skip);
+  __ Mov(x15, 1);
+  __ Mov(x20, 2);
+  __ Bind(done);
+
+  __ Mov(x22, x0);
+  __ Ldr(x23, MemOperand(x22, 8, PreIndex));
+  __ Ldr(x24, MemOperand(x22, 8));
+  __ Add(x25, x23, x24);
+  __ Ldp(x26, x27, MemOperand(x0, 96));
+  __ Stp(x26, x27, MemOperand(x1, 64));
+
+  // The flags set at the start of the loop body are used at its end.
+  __ Mov(x21, 4);
+  __ Mov(x28, 0);
+  __ Bind(loop);
+  __ Subs(x21, x21, 1);
+  __ Ldr(x10, MemOperand(x0, x21, LSL, kXRegSizeInBytesLog2));
+  __ Mul(x10, x10, x10);
+  __ Add(x28, x28, x10);
+  __ B(ne, loop);
+
+  for (unsigned i = 2; i <= 28; i++) {
+    if ((i == 16) || (i == 17) || (i == 18)) continue;
+    __ Str(XRegister(i), MemOperand(x1, 80 + (i * kXRegSizeInBytes)));
+  }
+  __ Ret();
+}
+
+#undef __
+
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+struct MixedState {
+  uint64_t output[64];
+  int64_t registers[kNumberOfRegisters];
+  uint32_t nzcv;
+};
+
+static void RunMixed(MacroAssembler* masm,
+                     const uint64_t* input,
+                     MixedState* state) {
+  memset(state->output, 0, sizeof(state->output));
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.WriteXRegister(0, reinterpret_cast<uintptr_t>(input));
+  simulator.WriteXRegister(1, reinterpret_cast<uintptr_t>(state->output));
+  simulator.RunFrom(masm->GetBuffer()->GetStartAddress<Instruction*>());
+  for (unsigned i = 0; i < kNumberOfRegisters; i++) {
+    state->registers[i] = simulator.ReadXRegister(i);
+  }
+  state->nzcv = simulator.ReadNzcv().GetRawValue();
+}
+
+
+TEST(equivalence) {
+  MacroAssembler reference;
+  Generate(&reference, GenerateMixed, NULL);
+  reference.GetBuffer()->SetExecutable();
+
+  const Scheduler::CoreModel kModels[] = {Scheduler::kCortexA53,
+                                          Scheduler::kCortexA72,
+                                          Scheduler::kNeoverseN1};
+  for (Scheduler::CoreModel model : kModels) {
+    Scheduler scheduler(model);
+    MacroAssembler masm;
+    Generate(&masm, GenerateMixed, &scheduler);
+    masm.GetBuffer()->SetExecutable();
+    VIXL_CHECK(scheduler.GetMovedCount() > 0);
+    VIXL_CHECK(masm.GetSizeOfCodeGenerated() ==
+               reference.GetSizeOfCodeGenerated());
+
+    // The first input value decides which way the branch goes.
+    const uint64_t kSeeds[] = {0, 1, 0x8000000000000000, 0x0123456789abcdef};
+    for (uint64_t seed : kSeeds) {
+      uint64_t input[16];
+      for (int i = 0; i < 16; i++) {
+        input[i] = (seed * (i + 1)) ^ (UINT64_C(0x3ff0000000000000) >> i);
+      }
+      MixedState expected;
+      MixedState actual;
+      RunMixed(&reference, input, &expected);
+      RunMixed(&masm, input, &actual);
+      VIXL_CHECK(memcmp(expected.output,
+                        actual.output,
+                        sizeof(actual.output)) == 0);
+      // x1 points to each run's own output, and x16 and x17 are scratch
+      // registers, which may hold different values.
+      for (unsigned i = 0; i < kNumberOfRegisters; i++) {
+        if ((i == 1) || (i == 16) || (i == 17)) continue;
+        VIXL_CHECK(expected.registers[i] == actual.registers[i]);
+      }
+      VIXL_CHECK(expected.nzcv == actual.nzcv);
+    }
+  }
+}
+#endif
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -0,0 +1,164 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <vector>
+
+#include "test-runner.h"
+
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+#include "aarch64/stencil-aarch64.h"
+
+#define TEST(name) TEST_(AARCH64_API_stencil_##name)
+
+namespace vixl {
+namespace aarch64 {
+
+#define __ masm.
+
+enum TestHole {
+  kImmediateHole,
+  kLiteralHole,
+  kRegisterHole,
+  kAddImmediateHole,
+  kBranchHole,
+  kTestHoleCount
+};
+
+// Build a stencil computing
+//   x0 = <immediate> + <literal> + <register> + <add immediate>
+// and then branching to <branch>.
+static void BuildTestStencil(Stencil* stencil) {
+  MacroAssembler masm;
+  StencilBuilder builder(&masm);
+  builder.MovImmediate(kImmediateHole, x0);
+  builder.LdrLiteral(kLiteralHole, x9);
+  __ Add(x0, x0, x9);
+  {
+    ExactAssemblyScope scope(&masm, kInstructionSize);
+    __ add(x0, x0, x1);
+  }
+  builder.MarkRegister(kRegisterHole, Stencil::kRegisterRm);
+  builder.AddImmediate(kAddImmediateHole, x0, x0);
+  builder.B(kBranchHole);
+  builder.Build(stencil);
+}
+
+
+TEST(instantiate) {
+  Stencil stencil;
+  BuildTestStencil(&stencil);
+  VIXL_CHECK(stencil.GetHoleCount() == kTestHoleCount);
+
+  // The code starts with the shared return path, which the instances branch
+  // to.
+  MacroAssembler masm;
+  __ Ret();
+  masm.FinalizeCode();
+  CodeBuffer* buffer = masm.GetBuffer();
+
+  uint64_t first_values[] = {0x0123456789abcdef, 0x1000, 2, 42, 0};
+  ptrdiff_t first = buffer->GetCursorOffset();
+  VIXL_CHECK(stencil.Instantiate(buffer, first_values));
+  uint64_t second_values[] = {1, 0xffff000000000000, 3, 4095, 0};
+  ptrdiff_t second = buffer->GetCursorOffset();
+  VIXL_CHECK(stencil.Instantiate(buffer, second_values));
+  VIXL_CHECK(static_cast<size_t>(second - first) == stencil.GetSizeInBytes());
+
+  // Values which cannot be encoded leave the buffer unchanged.
+  uint64_t bad_immediate[] = {0, 0, 2, 4096, 0};
+  VIXL_CHECK(!stencil.Instantiate(buffer, bad_immediate));
+  uint64_t bad_register[] = {0, 0, 32, 0, 0};
+  VIXL_CHECK(!stencil.Instantiate(buffer, bad_register));
+  VIXL_CHECK(static_cast<size_t>(buffer->GetCursorOffset() - second) ==
+             stencil.GetSizeInBytes());
+
+  // Instantiating in memory gives the same code, relocated.
+  std::vector<byte> copy(stencil.GetSizeInBytes());
+  uint64_t copy_values[] = {1, 0xffff000000000000, 3, 4095, 0};
+  copy_values[kBranchHole] = reinterpret_cast<uintptr_t>(copy.data()) - second;
+  VIXL_CHECK(stencil.Instantiate(copy.data(), copy_values));
+  VIXL_CHECK(memcmp(copy.data(),
+                    buffer->GetOffsetAddress<byte*>(second),
+                    copy.size()) == 0);
+  buffer->SetClean();
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+  buffer->SetExecutable();
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.WriteXRegister(1, 100);
+  simulator.WriteXRegister(2, 200);
+  simulator.WriteXRegister(3, 300);
+  simulator.RunFrom(buffer->GetOffsetAddress<Instruction*>(first));
+  VIXL_CHECK(simulator.ReadXRegister(0) ==
+             0x0123456789abcdef + 0x1000 + 200 + 42);
+  simulator.RunFrom(buffer->GetOffsetAddress<Instruction*>(second));
+  VIXL_CHECK(static_cast<uint64_t>(simulator.ReadXRegister(0)) ==
+             1 + 0xffff000000000000 + 300 + 4095);
+#endif
+}
+
+
+TEST(branch_range) {
+  Stencil stencil;
+  {
+    MacroAssembler masm;
+    StencilBuilder builder(&masm);
+    builder.B(0, eq);
+    builder.Cbz(1, x0);
+    builder.Bl(2);
+    builder.Build(&stencil);
+  }
+  VIXL_CHECK(stencil.GetHoleCount() == 3);
+
+  std::vector<byte> code(stencil.GetSizeInBytes());
+  uintptr_t start = reinterpret_cast<uintptr_t>(code.data());
+  const uint64_t kMB = 1024 * 1024;
+
+  // Conditional and compare branches reach +/-1MB, and BL reaches +/-128MB.
+  uint64_t in_range[] = {start - kMB, start + kInstructionSize + kMB - 4,
+                         start + 2 * kInstructionSize + 128 * kMB - 4};
+  VIXL_CHECK(stencil.Instantiate(code.data(), in_range));
+  const Instruction* instr = reinterpret_cast<const Instruction*>(code.data());
+  for (int i = 0; i < 3; i++) {
+    VIXL_CHECK(
+        reinterpret_cast<uintptr_t>(
+            instr->GetInstructionAtOffset(i * kInstructionSize)
+                ->GetImmPCOffsetTarget()) == in_range[i]);
+  }
+
+  uint64_t out_of_range[] = {start + kMB, start, start};
+  VIXL_CHECK(!stencil.Instantiate(code.data(), out_of_range));
+  uint64_t misaligned[] = {start + 2, start, start};
+  VIXL_CHECK(!stencil.Instantiate(code.data(), misaligned));
+  uint64_t bl_out_of_range[] = {start, start, start - 129 * kMB};
+  VIXL_CHECK(!stencil.Instantiate(code.data(), bl_out_of_range));
+}
+
+}  // namespace aarch64
+}  // namespace vixl
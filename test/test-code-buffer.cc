@@ -163,4 +163,114 @@ TEST(emit) {
                     expected_size) == 0);
 }
 
+#if defined(VIXL_CODE_BUFFER_MMAP) && defined(__linux__)
+TEST(dual_mapping) {
+  CodeBuffer buffer;
+  VIXL_CHECK(!buffer.IsDualMapped());
+  VIXL_CHECK(buffer.GetExecutableStartAddress<uintptr_t>() ==
+             buffer.GetStartAddress<uintptr_t>());
+
+  buffer.EnableDualMapping();
+  VIXL_CHECK(buffer.IsDualMapped());
+  TestDefaultsHelper(buffer);
+  VIXL_CHECK(buffer.GetExecutableStartAddress<uintptr_t>() !=
+             buffer.GetStartAddress<uintptr_t>());
+
+  // Data written to the writable view is visible in the executable view,
+  // without changing permissions.
+  const uint64_t value = 0x0123456789abcdef;
+  buffer.Emit64(value);
+  buffer.SetExecutable();
+  VIXL_CHECK(*buffer.GetExecutableStartAddress<const uint64_t*>() == value);
+  const uint64_t patched = ~value;
+  buffer.UpdateData(0, &patched, sizeof(patched));
+  VIXL_CHECK(*buffer.GetExecutableStartAddress<const uint64_t*>() == patched);
+  buffer.SetWritable();
+
+  // Growing the buffer preserves both views.
+  buffer.EnsureSpaceFor(CodeBuffer::kDefaultCapacity);
+  VIXL_CHECK(buffer.GetCapacity() > CodeBuffer::kDefaultCapacity);
+  for (size_t i = 0; i < CodeBuffer::kDefaultCapacity / sizeof(value); i++) {
+    buffer.Emit64(value + i);
+  }
+  VIXL_CHECK(buffer.GetExecutableEndAddress<uintptr_t>() -
+                 buffer.GetExecutableStartAddress<uintptr_t>() ==
+             buffer.GetSizeInBytes());
+  VIXL_CHECK(memcmp(buffer.GetStartAddress<const void*>(),
+                    buffer.GetExecutableStartAddress<const void*>(),
+                    buffer.GetSizeInBytes()) == 0);
+
+  buffer.SetClean();
+}
+#endif
+
+TEST(shared) {
+  const size_t kChunk = SharedCodeBuffer::kChunkAlignment;
+  SharedCodeBuffer shared(16 * kChunk);
+  byte* base = shared.GetStartAddress<byte*>();
+
+  // Chunks are allocated one after the other, and are aligned.
+  byte* a = shared.Reserve(10);
+  byte* b = shared.Reserve(kChunk + 1);
+  VIXL_CHECK(a == base);
+  VIXL_CHECK(b == base + kChunk);
+  VIXL_CHECK(shared.GetUsedBytes() == 3 * kChunk);
+
+  // Only the last chunk can be extended, or have its end given back.
+  VIXL_CHECK(!shared.Extend(a, 10, 2 * kChunk));
+  VIXL_CHECK(shared.Extend(b, kChunk + 1, 4 * kChunk));
+  VIXL_CHECK(shared.GetUsedBytes() == 5 * kChunk);
+  shared.Release(a, 10, 0);
+  VIXL_CHECK(shared.GetUsedBytes() == 5 * kChunk);
+  shared.Release(b, 4 * kChunk, 1);
+  VIXL_CHECK(shared.GetUsedBytes() == 2 * kChunk);
+
+  // Reservations fail cleanly when the buffer is full.
+  VIXL_CHECK(shared.Reserve(15 * kChunk) == NULL);
+  VIXL_CHECK(!shared.Extend(b, 1, 16 * kChunk));
+  VIXL_CHECK(shared.Reserve(14 * kChunk) == base + 2 * kChunk);
+
+  shared.Reset();
+  VIXL_CHECK(shared.GetUsedBytes() == 0);
+}
+
+TEST(shared_grow) {
+  const size_t kChunk = SharedCodeBuffer::kChunkAlignment;
+  SharedCodeBuffer shared(64 * kChunk);
+  byte* base = shared.GetStartAddress<byte*>();
+  const uint64_t value = 0x0123456789abcdef;
+  size_t end;
+  {
+    CodeBuffer buffer(&shared, kChunk);
+    VIXL_CHECK(buffer.IsShared());
+    VIXL_CHECK(buffer.IsManaged());
+    VIXL_CHECK(buffer.GetStartAddress<byte*>() == base);
+
+    // With no other chunk after it, the buffer grows in place.
+    for (size_t i = 0; i < (kChunk / sizeof(value)); i++) {
+      buffer.Emit64(value + i);
+    }
+    buffer.EnsureSpaceFor(kChunk);
+    VIXL_CHECK(buffer.GetStartAddress<byte*>() == base);
+
+    {
+      // Otherwise, its contents move to a new chunk. `other` is destroyed
+      // first, but is no longer the last chunk, so its space is lost.
+      CodeBuffer other(&shared, kChunk);
+      buffer.EnsureSpaceFor(buffer.GetCapacity() + 1);
+      VIXL_CHECK(buffer.GetStartAddress<byte*>() >
+                 other.GetStartAddress<byte*>());
+      VIXL_CHECK(memcmp(buffer.GetStartAddress<const void*>(),
+                        base,
+                        buffer.GetSizeInBytes()) == 0);
+    }
+    buffer.Emit64(~value);
+    buffer.SetClean();
+    end = buffer.GetEndAddress<byte*>() - base;
+    VIXL_CHECK(shared.GetUsedBytes() > AlignUp(end, kChunk));
+  }
+  // The unused end of the last chunk is given back on destruction.
+  VIXL_CHECK(shared.GetUsedBytes() == AlignUp(end, kChunk));
+}
+
 }  // namespace vixl
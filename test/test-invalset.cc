@@ -420,4 +420,37 @@ TEST(move) {
 }
 
 
+TEST(arena) {
+  Arena arena;
+  TestSet set;
+  set.SetArena(&arena);
+
+  for (unsigned i = 0; i < 4 * kNPreallocatedElements; i++) {
+    set.insert(Obj(i, i));
+  }
+  VIXL_CHECK(set.size() == 4 * kNPreallocatedElements);
+  VIXL_CHECK(arena.GetAllocatedSize() > 0);
+  set.erase(Obj(0, 0));
+  VIXL_CHECK(set.GetMinElement() == Obj(1, 1));
+
+  // Clearing the set lets it forget its arena storage, so the arena can be
+  // reset and the set used again.
+  set.clear();
+  arena.Reset();
+  VIXL_CHECK(arena.GetAllocatedSize() == 0);
+  for (unsigned i = 0; i < 4 * kNPreallocatedElements; i++) {
+    set.insert(Obj(-static_cast<KeyType>(i), i));
+  }
+  VIXL_CHECK(set.size() == 4 * kNPreallocatedElements);
+  VIXL_CHECK(set.GetMinElementKey() ==
+             -static_cast<KeyType>(4 * kNPreallocatedElements - 1));
+
+  // Allocations larger than the arena's blocks are still honoured.
+  void* large = arena.Allocate(4 * Arena::kDefaultBlockSize, 64);
+  VIXL_CHECK((reinterpret_cast<uintptr_t>(large) % 64) == 0);
+  memset(large, 0, 4 * Arena::kDefaultBlockSize);
+  set.clear();
+}
+
+
 }  // namespace vixl